@@ -0,0 +1,63 @@
+/**
+ * @file    bench_prime_count.c
+ * @brief   Times Meissel-Lehmer prime counting against the sieve count.
+ *
+ * Usage: bench_prime_count [MAX_X [THREADS]]
+ *
+ * Runs x = 10^6, 10^7, ... up to MAX_X (default 10^13). The sieve count is
+ * timed alongside while x <= 10^10.
+ *
+ * @date    2026-10-18
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "prime_count.h"
+
+#define SIEVE_CHECK_MAX 10000000000ULL
+
+static double now_seconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+    uint64_t max_x, x, formula, sieved;
+    unsigned threads;
+    double start, t_formula, t_sieve;
+
+    max_x = (argc > 1) ? strtoull(argv[1], NULL, 10) : 10000000000000ULL;
+    threads = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 0;
+
+    printf("%16s %16s %12s %12s\n", "x", "pi(x)", "formula s", "sieve s");
+    for (x = 1000000; x <= max_x; x *= 10) {
+        start = now_seconds();
+        if (prime_count(x, threads, &formula) != SV_SUCCESS) {
+            fprintf(stderr, "prime_count(%llu) failed\n", (unsigned long long)x);
+            return EXIT_FAILURE;
+        }
+        t_formula = now_seconds() - start;
+
+        if (x > SIEVE_CHECK_MAX) {
+            printf("%16llu %16llu %12.4f %12s\n", (unsigned long long)x,
+                    (unsigned long long)formula, t_formula, "-");
+            continue;
+        }
+        start = now_seconds();
+        if (prime_count_sieve(x, &sieved) != SV_SUCCESS) {
+            fprintf(stderr, "prime_count_sieve(%llu) failed\n", (unsigned long long)x);
+            return EXIT_FAILURE;
+        }
+        t_sieve = now_seconds() - start;
+        printf("%16llu %16llu %12.4f %12.4f%s\n", (unsigned long long)x,
+                (unsigned long long)formula, t_formula, t_sieve,
+                (formula == sieved) ? "" : "  MISMATCH");
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,369 @@
+/**
+ * @file    bench_sieve.c
+ * @brief   Benchmarks every sieve variant over N = 2^MIN ... 2^MAX and
+ *          reports the results as JSON.
+ *
+ * Usage: bench_sieve [-m MIN_EXP] [-M MAX_EXP] [-s STEP] [-x MONO_EXP]
+ *                    [-t THREADS] [-v VARIANT,...] [-o FILE]
+ *
+ * Variants count pi(N) with
+ *   monolithic  one odd-only bitmap over [0, N] (the BitSieve approach)
+ *   wheel       one mod-30 wheel bitmap over [0, N]
+ *   segmented   sieve_count_primes, SIEVE_SEGMENTED
+ *   bucket      sieve_count_primes, SIEVE_BUCKET
+ *   parallel    sieve_count_primes_parallel, SIEVE_SEGMENTED
+ *
+ * Each measurement runs in a forked child so that its peak RSS can be read
+ * from wait4(); cache misses come from perf_event_open when the kernel
+ * allows it and are reported as null otherwise. The whole-range bitmaps
+ * need N / 16 and N / 30 bytes, so they stop at 2^MONO_EXP (default 32).
+ *
+ * @date    2026-10-18
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "sieve.h"
+
+/* What a child reports back through its pipe */
+typedef struct {
+    int status;
+    uint64_t primes;
+    double wall;
+    long long cache_misses;      /* -1 when unavailable                   */
+} RunResult;
+
+typedef int (*VariantFn)(uint64_t n, unsigned threads, uint64_t *count);
+
+typedef struct {
+    const char *name;
+    VariantFn run;
+    int whole_range;             /* Bounded by the -x exponent            */
+} Variant;
+
+/* --- variants ------------------------------------------------------------- */
+
+static int count_monolithic(uint64_t n, unsigned threads, uint64_t *count) {
+    uint64_t *bits, words, k, i, p, total;
+
+    (void)threads;
+    if (n < 2) {
+        *count = 0;
+        return SV_SUCCESS;
+    }
+    /* bit k stands for 2k + 1 */
+    words = ((n - 1) / 2) / 64 + 1;
+    bits = (uint64_t *)malloc(words * sizeof(uint64_t));
+    if (bits == NULL) {
+        return SV_MEM_ERROR;
+    }
+    memset(bits, 0xFF, words * sizeof(uint64_t));
+    bits[0] &= ~(uint64_t)1;
+    for (p = 3; p * p <= n; p += 2) {
+        if (bits[(p / 2) / 64] >> ((p / 2) % 64) & 1) {
+            for (k = p * p / 2; k <= (n - 1) / 2; k += p) {
+                bits[k / 64] &= ~((uint64_t)1 << (k % 64));
+            }
+        }
+    }
+
+    total = 1;
+    k = (n - 1) / 2;
+    for (i = 0; i < k / 64; i++) {
+        total += (uint64_t)__builtin_popcountll(bits[i]);
+    }
+    total += (uint64_t)__builtin_popcountll(bits[k / 64] &
+            ((k % 64 == 63) ? ~(uint64_t)0 : ((uint64_t)1 << (k % 64 + 1)) - 1));
+    free(bits);
+    *count = total;
+    return SV_SUCCESS;
+}
+
+static int count_wheel(uint64_t n, unsigned threads, uint64_t *count) {
+    static const uint8_t residue[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+    static const int8_t bit_of[30] = {
+        -1,  0, -1, -1, -1, -1, -1,  1, -1, -1, -1,  2, -1,  3, -1,
+        -1, -1,  4, -1,  5, -1, -1, -1,  6, -1, -1, -1, -1, -1,  7
+    };
+    uint8_t *wheel;
+    uint64_t bytes, b, qb, p, m, total;
+    int j, jq;
+
+    (void)threads;
+    if (n < 7) {
+        *count = (n >= 2) + (n >= 3) + (n >= 5);
+        return SV_SUCCESS;
+    }
+    bytes = n / 30 + 1;
+    wheel = (uint8_t *)malloc(bytes);
+    if (wheel == NULL) {
+        return SV_MEM_ERROR;
+    }
+    memset(wheel, 0xFF, bytes);
+    wheel[0] &= (uint8_t)~1U;
+
+    /* cross off p * q for every wheel number q >= p */
+    for (b = 0; b * 30 * b * 30 <= n; b++) {
+        for (j = 0; j < 8; j++) {
+            p = 30 * b + residue[j];
+            if (!(wheel[b] >> j & 1) || p < 7) {
+                continue;
+            }
+            if (p * p > n) {
+                break;
+            }
+            for (qb = b; ; qb++) {
+                for (jq = 0; jq < 8; jq++) {
+                    m = p * (30 * qb + residue[jq]);
+                    if (m < p * p) {
+                        continue;
+                    }
+                    if (m > n) {
+                        goto next_prime;
+                    }
+                    wheel[m / 30] &= (uint8_t)~(1U << bit_of[m % 30]);
+                }
+            }
+next_prime:
+            ;
+        }
+    }
+
+    total = 3;
+    for (b = 0; b < n / 30; b++) {
+        total += (uint64_t)__builtin_popcount(wheel[b]);
+    }
+    for (j = 0; j < 8 && 30 * b + residue[j] <= n; j++) {
+        total += wheel[b] >> j & 1;
+    }
+    free(wheel);
+    *count = total;
+    return SV_SUCCESS;
+}
+
+static int count_segmented(uint64_t n, unsigned threads, uint64_t *count) {
+    (void)threads;
+    return sieve_count_primes(0, n, SIEVE_SEGMENTED, count);
+}
+
+static int count_bucket(uint64_t n, unsigned threads, uint64_t *count) {
+    (void)threads;
+    return sieve_count_primes(0, n, SIEVE_BUCKET, count);
+}
+
+static int count_parallel(uint64_t n, unsigned threads, uint64_t *count) {
+    return sieve_count_primes_parallel(0, n, SIEVE_SEGMENTED, threads, count);
+}
+
+static const Variant VARIANTS[] = {
+    {"monolithic", count_monolithic, 1},
+    {"wheel", count_wheel, 1},
+    {"segmented", count_segmented, 0},
+    {"bucket", count_bucket, 0},
+    {"parallel", count_parallel, 0}
+};
+#define NUM_VARIANTS (sizeof(VARIANTS) / sizeof(VARIANTS[0]))
+
+/* --- measurement ---------------------------------------------------------- */
+
+static double now_seconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Open a user-space cache-miss counter covering this process and its threads */
+static int open_cache_counter(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+/* Child side: run one variant and write a RunResult to fd */
+static void run_child(const Variant *v, uint64_t n, unsigned threads, int fd) {
+    RunResult r;
+    long long misses;
+    double start;
+    int counter;
+
+    r.cache_misses = -1;
+    counter = open_cache_counter();
+#ifdef __linux__
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+    start = now_seconds();
+    r.status = v->run(n, threads, &r.primes);
+    r.wall = now_seconds() - start;
+#ifdef __linux__
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &misses, sizeof(misses)) == (ssize_t)sizeof(misses)) {
+            r.cache_misses = misses;
+        }
+        close(counter);
+    }
+#else
+    (void)misses;
+#endif
+    if (write(fd, &r, sizeof(r)) != (ssize_t)sizeof(r)) {
+        _exit(EXIT_FAILURE);
+    }
+    _exit(EXIT_SUCCESS);
+}
+
+/* Parent side: fork, collect the child's result and its peak RSS */
+static int measure(const Variant *v, uint64_t n, unsigned threads,
+        RunResult *r, long *peak_rss_kib) {
+    struct rusage usage;
+    pid_t pid;
+    int fds[2], wstatus;
+    ssize_t got;
+
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    fflush(NULL);
+    pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        run_child(v, n, threads, fds[1]);
+    }
+    close(fds[1]);
+    got = read(fds[0], r, sizeof(*r));
+    close(fds[0]);
+    if (wait4(pid, &wstatus, 0, &usage) != pid || got != (ssize_t)sizeof(*r) ||
+            !WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0) {
+        return -1;
+    }
+    *peak_rss_kib = usage.ru_maxrss;
+    return 0;
+}
+
+/* --- driver --------------------------------------------------------------- */
+
+static int variant_selected(const char *list, const char *name) {
+    size_t len = strlen(name);
+    const char *p;
+
+    if (list == NULL) {
+        return 1;
+    }
+    for (p = list; (p = strstr(p, name)) != NULL; p += len) {
+        if ((p == list || p[-1] == ',') && (p[len] == ',' || p[len] == '\0')) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    unsigned min_exp = 20, max_exp = 34, step = 2, mono_exp = 32, threads = 0;
+    const char *variants = NULL, *out_path = NULL;
+    FILE *out;
+    RunResult r;
+    long rss;
+    unsigned e;
+    size_t v;
+    uint64_t n;
+    int opt, first = 1;
+
+    while ((opt = getopt(argc, argv, "m:M:s:x:t:v:o:")) != -1) {
+        switch (opt) {
+            case 'm': min_exp = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'M': max_exp = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 's': step = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'x': mono_exp = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 't': threads = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'v': variants = optarg; break;
+            case 'o': out_path = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-m MIN_EXP] [-M MAX_EXP] [-s STEP] "
+                        "[-x MONO_EXP] [-t THREADS] [-v VARIANT,...] [-o FILE]\n",
+                        argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (max_exp > 40 || step == 0) {
+        fprintf(stderr, "Exponents must stay <= 40 with a non-zero step.\n");
+        return EXIT_FAILURE;
+    }
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (online > 0) ? (unsigned)online : 1;
+    }
+    out = out_path ? fopen(out_path, "w") : stdout;
+    if (out == NULL) {
+        perror(out_path);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(out, "{\n  \"threads\": %u,\n  \"results\": [", threads);
+    for (e = min_exp; e <= max_exp; e += step) {
+        n = (uint64_t)1 << e;
+        for (v = 0; v < NUM_VARIANTS; v++) {
+            if (!variant_selected(variants, VARIANTS[v].name) ||
+                    (VARIANTS[v].whole_range && e > mono_exp)) {
+                continue;
+            }
+            fprintf(stderr, "%-10s 2^%u...\n", VARIANTS[v].name, e);
+            if (measure(&VARIANTS[v], n, threads, &r, &rss) != 0 ||
+                    r.status != SV_SUCCESS) {
+                fprintf(stderr, "%s failed at 2^%u\n", VARIANTS[v].name, e);
+                continue;
+            }
+            fprintf(out, "%s\n    {\"variant\": \"%s\", \"log2_n\": %u, \"n\": %llu, "
+                    "\"primes\": %llu, \"wall_s\": %.6f, \"primes_per_s\": %.1f, "
+                    "\"peak_rss_kib\": %ld, \"cache_misses\": ",
+                    first ? "" : ",", VARIANTS[v].name, e, (unsigned long long)n,
+                    (unsigned long long)r.primes, r.wall,
+                    r.wall > 0 ? (double)r.primes / r.wall : 0.0, rss);
+            if (r.cache_misses >= 0) {
+                fprintf(out, "%lld}", r.cache_misses);
+            } else {
+                fprintf(out, "null}");
+            }
+            first = 0;
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    return EXIT_SUCCESS;
+}
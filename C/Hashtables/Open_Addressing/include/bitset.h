@@ -0,0 +1,241 @@
+/**
+ * @file    bitset.h
+ * @brief   Fixed-size bitsets over cache-line aligned 64-bit words.
+ *
+ * Single-bit access is inline and uses shifts and masks only. Whole-set
+ * operations (popcount, rank, scans, logical combination) live in
+ * bitset.c; popcount picks an AVX2 or POPCNT kernel at run time when the
+ * CPU has one and falls back to portable code otherwise. The word-level
+ * kernels are exported as well, so code holding raw bit buffers (sieve
+ * windows, for instance) shares the same implementation.
+ *
+ * Bits at or beyond nbits in the last word are always zero.
+ *
+ * @date    2026-10-18
+ */
+
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <stdint.h>
+
+/* --- Macros -------------------------------------------------------------- */
+
+/** Alignment of the word storage in bytes (one cache line) */
+#define BITSET_ALIGN 64
+/** Returned by the scans when no bit qualifies */
+#define BITSET_NONE UINT64_MAX
+
+/* --- Error Return Codes --------------------------------------------------- */
+
+#define BS_SUCCESS      0
+#define BS_INVALID_ARG -5
+
+/* --- Data Structures ----------------------------------------------------- */
+
+/**
+ * @struct bitset
+ * @brief  A bitset of nbits bits; visible so bit access can be inlined.
+ */
+typedef struct bitset {
+    uint64_t *words;     /* BITSET_ALIGN-aligned storage                 */
+    uint64_t nbits;      /* Number of addressable bits                   */
+    uint64_t nwords;     /* Words holding them, (nbits + 63) / 64        */
+} Bitset;
+
+/* --- Inline Bit Access --------------------------------------------------- */
+
+/**
+ * @brief Set bit i.
+ *
+ * @param bs  Pointer to the bitset.
+ * @param i   Bit index, below nbits.
+ */
+static inline void bitset_set(
+        Bitset *bs,
+        uint64_t i
+) {
+    bs->words[i >> 6] |= (uint64_t)1 << (i & 63);
+}
+
+/**
+ * @brief Clear bit i.
+ *
+ * @param bs  Pointer to the bitset.
+ * @param i   Bit index, below nbits.
+ */
+static inline void bitset_clear(
+        Bitset *bs,
+        uint64_t i
+) {
+    bs->words[i >> 6] &= ~((uint64_t)1 << (i & 63));
+}
+
+/**
+ * @brief Test bit i.
+ *
+ * @param bs  Pointer to the bitset.
+ * @param i   Bit index, below nbits.
+ * @return 1 if the bit is set, 0 otherwise.
+ */
+static inline int bitset_test(
+        const Bitset *bs,
+        uint64_t i
+) {
+    return (int)((bs->words[i >> 6] >> (i & 63)) & 1);
+}
+
+/* --- Function Prototypes ------------------------------------------------- */
+
+/**
+ * @brief Allocate a bitset with every bit clear.
+ *
+ * @param nbits  Number of bits.
+ * @return A pointer to the bitset, or NULL on failure.
+ */
+Bitset *init_bitset(
+        uint64_t nbits
+);
+
+/**
+ * @brief Free the memory allocated for a bitset.
+ *
+ * @param bs  Pointer to the bitset (may be NULL).
+ */
+void free_bitset(
+        Bitset *bs
+);
+
+/**
+ * @brief Set every bit in [lo, hi).
+ *
+ * @param bs  Pointer to the bitset.
+ * @param lo  First bit (inclusive).
+ * @param hi  End bit (exclusive), at most nbits.
+ */
+void bitset_set_range(
+        Bitset *bs,
+        uint64_t lo,
+        uint64_t hi
+);
+
+/**
+ * @brief Clear every bit in [lo, hi).
+ *
+ * @param bs  Pointer to the bitset.
+ * @param lo  First bit (inclusive).
+ * @param hi  End bit (exclusive), at most nbits.
+ */
+void bitset_clear_range(
+        Bitset *bs,
+        uint64_t lo,
+        uint64_t hi
+);
+
+/**
+ * @brief Count the set bits.
+ *
+ * @param bs  Pointer to the bitset.
+ * @return The number of set bits.
+ */
+uint64_t bitset_popcount(
+        const Bitset *bs
+);
+
+/**
+ * @brief Count the set bits below position i.
+ *
+ * @param bs  Pointer to the bitset.
+ * @param i   End position (exclusive), at most nbits.
+ * @return The number of set bits in [0, i).
+ */
+uint64_t bitset_rank(
+        const Bitset *bs,
+        uint64_t i
+);
+
+/**
+ * @brief Find the first set bit at or after from.
+ *
+ * @param bs    Pointer to the bitset.
+ * @param from  Start position.
+ * @return Its index, or BITSET_NONE.
+ */
+uint64_t bitset_next_set(
+        const Bitset *bs,
+        uint64_t from
+);
+
+/**
+ * @brief Find the first clear bit at or after from.
+ *
+ * @param bs    Pointer to the bitset.
+ * @param from  Start position.
+ * @return Its index, or BITSET_NONE.
+ */
+uint64_t bitset_next_unset(
+        const Bitset *bs,
+        uint64_t from
+);
+
+/**
+ * @brief Find the last set bit at or before from.
+ *
+ * @param bs    Pointer to the bitset.
+ * @param from  Start position (clamped to nbits - 1).
+ * @return Its index, or BITSET_NONE.
+ */
+uint64_t bitset_prev_set(
+        const Bitset *bs,
+        uint64_t from
+);
+
+/**
+ * @brief dst &= src.
+ *
+ * @param dst  Destination bitset.
+ * @param src  Source bitset of the same size.
+ * @return BS_SUCCESS, or BS_INVALID_ARG if the sizes differ.
+ */
+int bitset_and(
+        Bitset *dst,
+        const Bitset *src
+);
+
+/**
+ * @brief dst |= src.
+ *
+ * @param dst  Destination bitset.
+ * @param src  Source bitset of the same size.
+ * @return BS_SUCCESS, or BS_INVALID_ARG if the sizes differ.
+ */
+int bitset_or(
+        Bitset *dst,
+        const Bitset *src
+);
+
+/**
+ * @brief dst &= ~src.
+ *
+ * @param dst  Destination bitset.
+ * @param src  Source bitset of the same size.
+ * @return BS_SUCCESS, or BS_INVALID_ARG if the sizes differ.
+ */
+int bitset_andnot(
+        Bitset *dst,
+        const Bitset *src
+);
+
+/**
+ * @brief Count the set bits of a raw word buffer.
+ *
+ * @param words   Buffer (any alignment).
+ * @param nwords  Number of 64-bit words.
+ * @return The number of set bits.
+ */
+uint64_t bitset_popcount_words(
+        const uint64_t *words,
+        uint64_t nwords
+);
+
+#endif /* BITSET_H */
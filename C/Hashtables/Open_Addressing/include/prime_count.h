@@ -0,0 +1,60 @@
+/**
+ * @file    prime_count.h
+ * @brief   Combinatorial prime counting pi(x) with the Meissel-Lehmer
+ *          formula.
+ *
+ * With y = cbrt(x) and a = pi(y),
+ *
+ *     pi(x) = phi(x, a) + a - 1 - P2(x, a)
+ *
+ * where phi(x, a) counts the integers <= x free of the first a primes and
+ * P2(x, a) counts those with exactly two prime factors above p_a. phi is
+ * expanded recursively, cut short with a pi(n) lookup for n <= sqrt(x) and
+ * a wheel table for the first six primes; its top-level terms are shared
+ * out between threads. P2 needs pi(x / p) for sqrt(x) < x / p <= x^(2/3),
+ * which the segmented sieve supplies in slices, one slice per thread.
+ *
+ * @date    2026-10-18
+ */
+
+#ifndef PRIME_COUNT_H
+#define PRIME_COUNT_H
+
+#include <stdint.h>
+#include "sieve.h"
+
+/* --- Macros -------------------------------------------------------------- */
+
+/** Largest x accepted by prime_count (x^(2/3) must stay sieveable) */
+#define PRIME_COUNT_MAX ((uint64_t)1 << 62)
+
+/* --- Function Prototypes ------------------------------------------------- */
+
+/**
+ * @brief Count the primes <= x with the Meissel-Lehmer formula.
+ *
+ * @param x            Upper bound (inclusive), at most PRIME_COUNT_MAX.
+ * @param num_threads  Worker threads, or 0 for one per online CPU.
+ * @param count        Receives pi(x).
+ * @return SV_SUCCESS on success, or an error code on failure.
+ */
+int prime_count(
+        uint64_t x,
+        unsigned num_threads,
+        uint64_t *count
+);
+
+/**
+ * @brief Count the primes <= x by sieving [0, x]; the reference for
+ *        prime_count.
+ *
+ * @param x      Upper bound (inclusive), below SIEVE_LIMIT_MAX.
+ * @param count  Receives pi(x).
+ * @return SV_SUCCESS on success, or an error code on failure.
+ */
+int prime_count_sieve(
+        uint64_t x,
+        uint64_t *count
+);
+
+#endif /* PRIME_COUNT_H */
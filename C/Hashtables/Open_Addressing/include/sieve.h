@@ -0,0 +1,270 @@
+/**
+ * @file    sieve.h
+ * @brief   Segmented and bucket sieves of Eratosthenes over 64-bit ranges.
+ *
+ * The segmented sieve walks [lo, hi] in cache-sized windows of odd numbers
+ * and crosses off every base prime up to sqrt(hi) in each window. Far from
+ * zero most base primes have no multiple inside a given window, so the
+ * bucket mode (after T. Oliveira e Silva) files every prime larger than a
+ * window into a per-window bucket keyed by its next multiple; a window then
+ * only touches the large primes that actually hit it.
+ *
+ * A RangeSieve keeps the primality map of an arbitrary window [L, R] for
+ * repeated queries, allocating memory for the window only.
+ *
+ * @date    2026-10-18
+ */
+
+#ifndef SIEVE_H
+#define SIEVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* --- Macros -------------------------------------------------------------- */
+
+/** Odd numbers covered by one sieve window (32 KiB of bits) */
+#define SIEVE_SEGMENT_BITS (1U << 18)
+/** Exclusive upper bound accepted for the sieved range */
+#define SIEVE_LIMIT_MAX ((uint64_t)1 << 63)
+
+/* --- Error Return Codes --------------------------------------------------- */
+
+#define SV_SUCCESS      0
+#define SV_STOPPED      1
+#define SV_NO_SPACE    -2
+#define SV_MEM_ERROR   -4
+#define SV_INVALID_ARG -5
+#define SV_IO_ERROR    -6
+
+/* --- Data Structures ----------------------------------------------------- */
+
+/**
+ * @enum  SieveMode
+ * @brief Strategy used for base primes larger than a sieve window.
+ */
+typedef enum {
+    SIEVE_SEGMENTED, /**< every base prime is visited in every window      */
+    SIEVE_BUCKET     /**< large primes are only visited when they hit      */
+} SieveMode;
+
+/**
+ * @struct range_sieve
+ * @brief  Materialised primality map of a window [lo, hi], one bit per odd
+ *         number, independent of how far the window lies from zero.
+ */
+typedef struct range_sieve RangeSieve;
+
+/**
+ * @brief Callback invoked for every prime found in a range.
+ *
+ * @param prime  The prime.
+ * @param ctx    User context passed through unchanged.
+ * @return 0 to continue, non-zero to stop the enumeration.
+ */
+typedef int (*PrimeCallback)(uint64_t prime, void *ctx);
+
+/**
+ * @brief Callback invoked for every sieved window.
+ *
+ * Bit k of @p bits is set iff seg_lo + 2k is prime; bits at or beyond
+ * @p nbits are zero. The number 2 is never represented.
+ *
+ * @param seg_lo  Odd number represented by bit 0.
+ * @param bits    Window bitmap, one bit per odd number.
+ * @param nbits   Number of valid bits in the window.
+ * @param ctx     User context passed through unchanged.
+ * @return 0 to continue, non-zero to stop sieving.
+ */
+typedef int (*SegmentCallback)(
+        uint64_t seg_lo,
+        const uint64_t *bits,
+        uint32_t nbits,
+        void *ctx
+);
+
+/* --- Function Prototypes ------------------------------------------------- */
+
+/**
+ * @brief Collect all odd primes up to and including a limit.
+ *
+ * @param limit   Largest candidate (at most 2^32 - 1).
+ * @param primes  Receives a malloc'd array of primes; free() it when done.
+ * @param count   Receives the number of primes written.
+ * @return SV_SUCCESS on success, or an error code on failure.
+ */
+int sieve_odd_primes(
+        uint32_t limit,
+        uint32_t **primes,
+        size_t *count
+);
+
+/**
+ * @brief Sieve [lo, hi] window by window and hand each window to a callback.
+ *
+ * @param lo       Lower bound (inclusive).
+ * @param hi       Upper bound (inclusive), below SIEVE_LIMIT_MAX.
+ * @param mode     Large prime strategy.
+ * @param segment  Callback receiving each window.
+ * @param ctx      User context for the callback.
+ * @return SV_SUCCESS, SV_STOPPED if the callback stopped early, or an
+ *         error code on failure.
+ */
+int sieve_segments(
+        uint64_t lo,
+        uint64_t hi,
+        SieveMode mode,
+        SegmentCallback segment,
+        void *ctx
+);
+
+/**
+ * @brief Count the primes in [lo, hi].
+ *
+ * @param lo     Lower bound (inclusive).
+ * @param hi     Upper bound (inclusive), below SIEVE_LIMIT_MAX.
+ * @param mode   Large prime strategy.
+ * @param count  Receives the number of primes.
+ * @return SV_SUCCESS on success, or an error code on failure.
+ */
+int sieve_count_primes(
+        uint64_t lo,
+        uint64_t hi,
+        SieveMode mode,
+        uint64_t *count
+);
+
+/**
+ * @brief Count the primes in [lo, hi], splitting the range into one
+ *        contiguous slice per thread.
+ *
+ * @param lo           Lower bound (inclusive).
+ * @param hi           Upper bound (inclusive), below SIEVE_LIMIT_MAX.
+ * @param mode         Large prime strategy.
+ * @param num_threads  Worker threads, or 0 for one per online CPU.
+ * @param count        Receives the number of primes.
+ * @return SV_SUCCESS on success, or an error code on failure.
+ */
+int sieve_count_primes_parallel(
+        uint64_t lo,
+        uint64_t hi,
+        SieveMode mode,
+        unsigned num_threads,
+        uint64_t *count
+);
+
+/**
+ * @brief Enumerate the primes in [lo, hi] in increasing order.
+ *
+ * @param lo        Lower bound (inclusive).
+ * @param hi        Upper bound (inclusive), below SIEVE_LIMIT_MAX.
+ * @param mode      Large prime strategy.
+ * @param callback  Called once per prime.
+ * @param ctx       User context for the callback.
+ * @return SV_SUCCESS, SV_STOPPED if the callback stopped early, or an
+ *         error code on failure.
+ */
+int sieve_foreach_prime(
+        uint64_t lo,
+        uint64_t hi,
+        SieveMode mode,
+        PrimeCallback callback,
+        void *ctx
+);
+
+/**
+ * @brief Sieve the window [lo, hi] and keep its primality map.
+ *
+ * Only the window itself is allocated (one bit per odd number) together
+ * with the base primes up to sqrt(hi).
+ *
+ * @param lo  Lower bound (inclusive).
+ * @param hi  Upper bound (inclusive), below SIEVE_LIMIT_MAX.
+ * @return A pointer to the range sieve, or NULL on failure.
+ */
+RangeSieve *init_range_sieve(
+        uint64_t lo,
+        uint64_t hi
+);
+
+/**
+ * @brief Free the memory allocated for a range sieve.
+ *
+ * @param rs  Pointer to the range sieve (may be NULL).
+ */
+void free_range_sieve(
+        RangeSieve *rs
+);
+
+/**
+ * @brief Test whether n is prime.
+ *
+ * @param rs  Pointer to the range sieve.
+ * @param n   Number to test.
+ * @return 1 if n lies in the window and is prime, 0 otherwise.
+ */
+int range_is_prime(
+        const RangeSieve *rs,
+        uint64_t n
+);
+
+/**
+ * @brief Count the primes in the window.
+ *
+ * @param rs  Pointer to the range sieve.
+ * @return The number of primes in [lo, hi].
+ */
+uint64_t range_count_primes(
+        const RangeSieve *rs
+);
+
+/**
+ * @brief Find the smallest prime >= target inside the window.
+ *
+ * @param rs      Pointer to the range sieve.
+ * @param target  Search start.
+ * @return The prime, or 0 if there is none in the window.
+ */
+uint64_t range_next_prime(
+        const RangeSieve *rs,
+        uint64_t target
+);
+
+/**
+ * @brief Find the largest prime <= target inside the window.
+ *
+ * @param rs      Pointer to the range sieve.
+ * @param target  Search start.
+ * @return The prime, or 0 if there is none in the window.
+ */
+uint64_t range_prev_prime(
+        const RangeSieve *rs,
+        uint64_t target
+);
+
+/**
+ * @brief Enumerate the primes of the window in increasing order.
+ *
+ * @param rs        Pointer to the range sieve.
+ * @param callback  Called once per prime.
+ * @param ctx       User context for the callback.
+ * @return SV_SUCCESS, SV_STOPPED if the callback stopped early, or an
+ *         error code on failure.
+ */
+int range_foreach_prime(
+        const RangeSieve *rs,
+        PrimeCallback callback,
+        void *ctx
+);
+
+/**
+ * @brief Integer square root, floor(sqrt(n)).
+ *
+ * @param n  Input value.
+ * @return The largest r with r * r <= n.
+ */
+uint64_t isqrt_u64(
+        uint64_t n
+);
+
+#endif /* SIEVE_H */
@@ -0,0 +1,126 @@
+/**
+ * @file    sieve_cache.h
+ * @brief   Sieve persisted to a versioned file and memory-mapped read-only.
+ *
+ * The file holds a mod-30 wheel bitmap: byte b describes 30b + r for the
+ * eight residues r coprime to 30, so [0, limit] costs limit / 30 bytes. A
+ * fixed header carries the limit, the prime count, a payload checksum and a
+ * checksum of the header itself. Opening a valid file is a single mmap, and
+ * every process mapping it shares the same page-cache pages; a missing,
+ * short, foreign or corrupt file is rebuilt with the segmented sieve and
+ * atomically replaced.
+ *
+ * @date    2026-10-18
+ */
+
+#ifndef SIEVE_CACHE_H
+#define SIEVE_CACHE_H
+
+#include <stdint.h>
+#include "sieve.h"
+
+/* --- Macros -------------------------------------------------------------- */
+
+/** On-disk format version; bumped whenever the layout changes */
+#define SIEVE_CACHE_VERSION 1
+/** Largest limit a cache file may cover */
+#define SIEVE_CACHE_LIMIT_MAX ((uint64_t)1 << 40)
+
+/** Flag: also checksum the whole bitmap when opening an existing file */
+#define SIEVE_CACHE_VERIFY 0x1
+
+/* --- Data Structures ----------------------------------------------------- */
+
+/**
+ * @struct sieve_cache
+ * @brief  Read-only mapping of a wheel-compressed sieve file.
+ */
+typedef struct sieve_cache SieveCache;
+
+/* --- Function Prototypes ------------------------------------------------- */
+
+/**
+ * @brief Map the sieve file at path, rebuilding it if it cannot serve limit.
+ *
+ * A file is reused when its header checksum, version and size are valid and
+ * it covers at least @p limit; with SIEVE_CACHE_VERIFY the bitmap checksum
+ * is checked as well. Otherwise the sieve is recomputed up to @p limit,
+ * written to a temporary file and renamed over @p path.
+ *
+ * @param path   Cache file location.
+ * @param limit  Largest number that must be answerable.
+ * @param flags  0 or SIEVE_CACHE_VERIFY.
+ * @param cache  Receives the opened cache.
+ * @return SV_SUCCESS on success, or an error code on failure.
+ */
+int open_sieve_cache(
+        const char *path,
+        uint64_t limit,
+        unsigned flags,
+        SieveCache **cache
+);
+
+/**
+ * @brief Unmap a sieve cache.
+ *
+ * @param cache  Pointer to the cache (may be NULL).
+ */
+void close_sieve_cache(
+        SieveCache *cache
+);
+
+/**
+ * @brief Report whether open_sieve_cache had to recompute the file.
+ *
+ * @param cache  Pointer to the cache.
+ * @return 1 if the sieve was rebuilt, 0 if an existing file was mapped.
+ */
+int sieve_cache_rebuilt(
+        const SieveCache *cache
+);
+
+/**
+ * @brief Largest number covered by the mapped file.
+ *
+ * @param cache  Pointer to the cache.
+ * @return The file's limit, which may exceed the one requested.
+ */
+uint64_t sieve_cache_limit(
+        const SieveCache *cache
+);
+
+/**
+ * @brief Number of primes up to the file's limit.
+ *
+ * @param cache  Pointer to the cache.
+ * @return pi(sieve_cache_limit(cache)).
+ */
+uint64_t sieve_cache_prime_count(
+        const SieveCache *cache
+);
+
+/**
+ * @brief Test whether n is prime.
+ *
+ * @param cache  Pointer to the cache.
+ * @param n      Number to test.
+ * @return 1 if n is covered and prime, 0 otherwise.
+ */
+int sieve_cache_is_prime(
+        const SieveCache *cache,
+        uint64_t n
+);
+
+/**
+ * @brief Find the smallest prime >= target.
+ *
+ * @param cache   Pointer to the cache.
+ * @param target  Search start.
+ * @return The prime, or 0 if there is none up to the file's limit.
+ */
+uint64_t sieve_cache_next_prime(
+        const SieveCache *cache,
+        uint64_t target
+);
+
+#endif /* SIEVE_CACHE_H */
@@ -0,0 +1,123 @@
+/**
+ * @file    spf_sieve.h
+ * @brief   Smallest-prime-factor table for batch factorisation of 32-bit
+ *          integers.
+ *
+ * Every composite n <= limit has a prime factor <= sqrt(limit) < 2^16, so
+ * the table stores, for each odd n, the 1-based index of its smallest prime
+ * factor among those base primes in a uint16_t (0 marks a prime). That is
+ * one byte per integer instead of four. The base primes come from a linear
+ * (Euler) sieve; the table itself is filled window by window on several
+ * threads, each entry written once by its smallest prime factor.
+ *
+ * @date    2026-10-18
+ */
+
+#ifndef SPF_SIEVE_H
+#define SPF_SIEVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sieve.h"
+
+/* --- Macros -------------------------------------------------------------- */
+
+/** Odd numbers per window filled by one thread at a time (64 KiB) */
+#define SPF_SEGMENT_ENTRIES (1U << 15)
+/** Most prime factors (with multiplicity) a 32-bit integer can have */
+#define SPF_MAX_FACTORS 32
+
+/* --- Data Structures ----------------------------------------------------- */
+
+/**
+ * @struct spf_table
+ * @brief  Smallest-prime-factor table covering [0, limit].
+ */
+typedef struct spf_table SpfTable;
+
+/* --- Function Prototypes ------------------------------------------------- */
+
+/**
+ * @brief Build a smallest-prime-factor table.
+ *
+ * @param limit        Largest integer covered by the table.
+ * @param num_threads  Worker threads, or 0 for one per online CPU.
+ * @return A pointer to the table, or NULL on failure.
+ */
+SpfTable *init_spf_table(
+        uint32_t limit,
+        unsigned num_threads
+);
+
+/**
+ * @brief Free the memory allocated for a smallest-prime-factor table.
+ *
+ * @param table  Pointer to the table (may be NULL).
+ */
+void free_spf_table(
+        SpfTable *table
+);
+
+/**
+ * @brief Get the largest integer covered by a table.
+ *
+ * @param table  Pointer to the table.
+ * @return The table limit.
+ */
+uint32_t spf_limit(
+        const SpfTable *table
+);
+
+/**
+ * @brief Look up the smallest prime factor of n.
+ *
+ * @param table  Pointer to the table.
+ * @param n      Integer to look up.
+ * @return The smallest prime factor, or 0 if n < 2 or n > limit.
+ */
+uint32_t spf_lookup(
+        const SpfTable *table,
+        uint32_t n
+);
+
+/**
+ * @brief Factorise n into primes in O(number of factors).
+ *
+ * @param table    Pointer to the table.
+ * @param n        Integer to factorise (2 <= n <= limit).
+ * @param factors  Receives the prime factors in non-decreasing order,
+ *                 with multiplicity; room for SPF_MAX_FACTORS suffices.
+ * @param max      Capacity of @p factors.
+ * @return The number of factors, or an error code on failure.
+ */
+int spf_factorize(
+        const SpfTable *table,
+        uint32_t n,
+        uint32_t *factors,
+        int max
+);
+
+/**
+ * @brief Factorise a batch of integers into one packed factor buffer.
+ *
+ * The factors of values[i] are factors[offsets[i] .. offsets[i + 1] - 1];
+ * values below 2 have no factors.
+ *
+ * @param table     Pointer to the table.
+ * @param values    Integers to factorise (each <= limit).
+ * @param count     Number of integers.
+ * @param factors   Receives the packed prime factors.
+ * @param capacity  Capacity of @p factors (count * SPF_MAX_FACTORS suffices).
+ * @param offsets   Receives count + 1 offsets into @p factors.
+ * @return SV_SUCCESS on success, or an error code on failure.
+ */
+int spf_factorize_batch(
+        const SpfTable *table,
+        const uint32_t *values,
+        size_t count,
+        uint32_t *factors,
+        size_t capacity,
+        size_t *offsets
+);
+
+#endif /* SPF_SIEVE_H */
@@ -0,0 +1,359 @@
+/**
+ * @file    bitset.c
+ * @brief   Fixed-size bitsets over cache-line aligned 64-bit words.
+ * @date    2026-10-18
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "bitset.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BITSET_X86 1
+#include <immintrin.h>
+#endif
+
+/* Mask of the bits at or above position b of a word (b < 64) */
+#define MASK_FROM(b) (~(uint64_t)0 << (b))
+/* Mask of the bits below position b of a word (b < 64) */
+#define MASK_BELOW(b) (((uint64_t)1 << (b)) - 1)
+
+typedef uint64_t (*PopcountKernel)(const uint64_t *words, uint64_t nwords);
+
+/* --- function prototypes -------------------------------------------------- */
+
+static uint64_t popcount_portable(const uint64_t *words, uint64_t nwords);
+#ifdef BITSET_X86
+static uint64_t popcount_popcnt(const uint64_t *words, uint64_t nwords);
+static uint64_t popcount_avx2(const uint64_t *words, uint64_t nwords);
+#endif
+static PopcountKernel select_popcount(void);
+static void fill_range(Bitset *bs, uint64_t lo, uint64_t hi, int value);
+
+/* Resolved on first use; every thread resolves to the same kernel */
+static PopcountKernel popcount_kernel = NULL;
+
+/* --- bitset interface ----------------------------------------------------- */
+
+Bitset *init_bitset(
+        uint64_t nbits
+) {
+    Bitset *bs;
+    size_t bytes;
+    void *words;
+
+    bs = (Bitset *)malloc(sizeof(Bitset));
+    if (bs == NULL) {
+        return NULL;
+    }
+    bs->nbits = nbits;
+    bs->nwords = (nbits + 63) / 64;
+
+    /* whole cache lines, so vector kernels never straddle the allocation */
+    bytes = (size_t)((bs->nwords * sizeof(uint64_t) + BITSET_ALIGN - 1) /
+            BITSET_ALIGN * BITSET_ALIGN);
+    if (bytes == 0) {
+        bytes = BITSET_ALIGN;
+    }
+    if (posix_memalign(&words, BITSET_ALIGN, bytes) != 0) {
+        free(bs);
+        return NULL;
+    }
+    memset(words, 0, bytes);
+    bs->words = (uint64_t *)words;
+    return bs;
+}
+
+void free_bitset(
+        Bitset *bs
+) {
+    if (bs) {
+        free(bs->words);
+        free(bs);
+    }
+}
+
+void bitset_set_range(
+        Bitset *bs,
+        uint64_t lo,
+        uint64_t hi
+) {
+    fill_range(bs, lo, hi, 1);
+}
+
+void bitset_clear_range(
+        Bitset *bs,
+        uint64_t lo,
+        uint64_t hi
+) {
+    fill_range(bs, lo, hi, 0);
+}
+
+uint64_t bitset_popcount(
+        const Bitset *bs
+) {
+    return bitset_popcount_words(bs->words, bs->nwords);
+}
+
+uint64_t bitset_rank(
+        const Bitset *bs,
+        uint64_t i
+) {
+    uint64_t count;
+
+    if (i > bs->nbits) {
+        i = bs->nbits;
+    }
+    count = bitset_popcount_words(bs->words, i >> 6);
+    if (i & 63) {
+        count += (uint64_t)__builtin_popcountll(bs->words[i >> 6] & MASK_BELOW(i & 63));
+    }
+    return count;
+}
+
+uint64_t bitset_next_set(
+        const Bitset *bs,
+        uint64_t from
+) {
+    uint64_t i, w;
+
+    if (from >= bs->nbits) {
+        return BITSET_NONE;
+    }
+    i = from >> 6;
+    w = bs->words[i] & MASK_FROM(from & 63);
+    while (w == 0) {
+        if (++i >= bs->nwords) {
+            return BITSET_NONE;
+        }
+        w = bs->words[i];
+    }
+    return (i << 6) + (uint64_t)__builtin_ctzll(w);
+}
+
+uint64_t bitset_next_unset(
+        const Bitset *bs,
+        uint64_t from
+) {
+    uint64_t i, w, pos;
+
+    if (from >= bs->nbits) {
+        return BITSET_NONE;
+    }
+    i = from >> 6;
+    w = ~bs->words[i] & MASK_FROM(from & 63);
+    while (w == 0) {
+        if (++i >= bs->nwords) {
+            return BITSET_NONE;
+        }
+        w = ~bs->words[i];
+    }
+    /* the zero padding past nbits must not count as unset bits */
+    pos = (i << 6) + (uint64_t)__builtin_ctzll(w);
+    return (pos < bs->nbits) ? pos : BITSET_NONE;
+}
+
+uint64_t bitset_prev_set(
+        const Bitset *bs,
+        uint64_t from
+) {
+    uint64_t i, w;
+
+    if (bs->nbits == 0) {
+        return BITSET_NONE;
+    }
+    if (from >= bs->nbits) {
+        from = bs->nbits - 1;
+    }
+    i = from >> 6;
+    w = bs->words[i] & (~(uint64_t)0 >> (63 - (from & 63)));
+    while (w == 0) {
+        if (i == 0) {
+            return BITSET_NONE;
+        }
+        w = bs->words[--i];
+    }
+    return (i << 6) + 63 - (uint64_t)__builtin_clzll(w);
+}
+
+int bitset_and(
+        Bitset *dst,
+        const Bitset *src
+) {
+    uint64_t i;
+
+    if (dst == NULL || src == NULL || dst->nbits != src->nbits) {
+        return BS_INVALID_ARG;
+    }
+    for (i = 0; i < dst->nwords; i++) {
+        dst->words[i] &= src->words[i];
+    }
+    return BS_SUCCESS;
+}
+
+int bitset_or(
+        Bitset *dst,
+        const Bitset *src
+) {
+    uint64_t i;
+
+    if (dst == NULL || src == NULL || dst->nbits != src->nbits) {
+        return BS_INVALID_ARG;
+    }
+    for (i = 0; i < dst->nwords; i++) {
+        dst->words[i] |= src->words[i];
+    }
+    return BS_SUCCESS;
+}
+
+int bitset_andnot(
+        Bitset *dst,
+        const Bitset *src
+) {
+    uint64_t i;
+
+    if (dst == NULL || src == NULL || dst->nbits != src->nbits) {
+        return BS_INVALID_ARG;
+    }
+    for (i = 0; i < dst->nwords; i++) {
+        dst->words[i] &= ~src->words[i];
+    }
+    return BS_SUCCESS;
+}
+
+uint64_t bitset_popcount_words(
+        const uint64_t *words,
+        uint64_t nwords
+) {
+    PopcountKernel kernel;
+
+    kernel = __atomic_load_n(&popcount_kernel, __ATOMIC_RELAXED);
+    if (kernel == NULL) {
+        kernel = select_popcount();
+        __atomic_store_n(&popcount_kernel, kernel, __ATOMIC_RELAXED);
+    }
+    return kernel(words, nwords);
+}
+
+/* --- utility functions ---------------------------------------------------- */
+
+static void fill_range(
+        Bitset *bs,
+        uint64_t lo,
+        uint64_t hi,
+        int value
+) {
+    uint64_t first, last, mask;
+
+    if (hi > bs->nbits) {
+        hi = bs->nbits;
+    }
+    if (lo >= hi) {
+        return;
+    }
+    first = lo >> 6;
+    last = (hi - 1) >> 6;
+    if (first == last) {
+        mask = MASK_FROM(lo & 63) & (~(uint64_t)0 >> (63 - ((hi - 1) & 63)));
+        bs->words[first] = value ? bs->words[first] | mask : bs->words[first] & ~mask;
+        return;
+    }
+
+    mask = MASK_FROM(lo & 63);
+    bs->words[first] = value ? bs->words[first] | mask : bs->words[first] & ~mask;
+    if (last > first + 1) {
+        memset(&bs->words[first + 1], value ? 0xFF : 0,
+                (size_t)(last - first - 1) * sizeof(uint64_t));
+    }
+    mask = ~(uint64_t)0 >> (63 - ((hi - 1) & 63));
+    bs->words[last] = value ? bs->words[last] | mask : bs->words[last] & ~mask;
+}
+
+static uint64_t popcount_portable(
+        const uint64_t *words,
+        uint64_t nwords
+) {
+    uint64_t count = 0, i;
+
+    for (i = 0; i < nwords; i++) {
+        count += (uint64_t)__builtin_popcountll(words[i]);
+    }
+    return count;
+}
+
+#ifdef BITSET_X86
+
+/* Same loop, but compiled to the hardware instruction */
+__attribute__((target("popcnt")))
+static uint64_t popcount_popcnt(
+        const uint64_t *words,
+        uint64_t nwords
+) {
+    uint64_t count = 0, i;
+
+    for (i = 0; i < nwords; i++) {
+        count += (uint64_t)__builtin_popcountll(words[i]);
+    }
+    return count;
+}
+
+/*
+ * Nibble lookup (Mula): vpshufb maps each nibble to its bit count and
+ * vpsadbw folds the byte counts into four 64-bit lanes. Byte counters take
+ * at most 8 per iteration, so 31 iterations fit before they must be folded.
+ */
+__attribute__((target("avx2,popcnt")))
+static uint64_t popcount_avx2(
+        const uint64_t *words,
+        uint64_t nwords
+) {
+    const __m256i lookup = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc, bytes, v;
+    uint64_t i, count, lanes[4];
+    int j;
+
+    acc = zero;
+    i = 0;
+    while (i + 4 <= nwords) {
+        bytes = zero;
+        for (j = 0; j < 31 && i + 4 <= nwords; j++, i += 4) {
+            v = _mm256_loadu_si256((const __m256i *)(const void *)&words[i]);
+            bytes = _mm256_add_epi8(bytes, _mm256_add_epi8(
+                    _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low)),
+                    _mm256_shuffle_epi8(lookup,
+                        _mm256_and_si256(_mm256_srli_epi16(v, 4), low))));
+        }
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(bytes, zero));
+    }
+    _mm256_storeu_si256((__m256i *)(void *)lanes, acc);
+    count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+    for (; i < nwords; i++) {
+        count += (uint64_t)__builtin_popcountll(words[i]);
+    }
+    return count;
+}
+
+#endif /* BITSET_X86 */
+
+static PopcountKernel select_popcount(
+        void
+) {
+#ifdef BITSET_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return popcount_avx2;
+    }
+    if (__builtin_cpu_supports("popcnt")) {
+        return popcount_popcnt;
+    }
+#endif
+    return popcount_portable;
+}
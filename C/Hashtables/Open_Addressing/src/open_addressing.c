@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include "open_addressing.h"
+#include "bitset.h"
 #include "debug_hashtab.h"
 
 #define PRINT_BUFFER_SIZE 1024
@@ -25,6 +26,7 @@ struct htentry {
 /* a hash table container */
 struct hashtab {
     HTentry *table;      /* Underlying array of entries (slots)          */
+    Bitset *slots;       /* Slots ever filled (occupied or deleted)      */
     uint32_t size;       /* Current size (capacity) of the table         */
     uint32_t used;       /* Number of non-empty entries (active+deleted) */
     uint32_t active;     /* Number of active (non-deleted) entries       */
@@ -48,7 +50,7 @@ static uint32_t default_probe_func(uint32_t k, uint32_t i, uint32_t m);
 
 static int insert_entry(HashTab *ht, uint32_t hash_key, void *key, void *value);
 static void free_entry(HashTab *ht, HTentry *entry);
-static void rehash_entries(HashTab *ht, HTentry *old_table, uint32_t old_size);
+static void rehash_entries(HashTab *ht, HTentry *old_table, const Bitset *old_slots);
 static void resize(HashTab *ht, uint32_t new_size);
 
 /* --- hash table interface ------------------------------------------------- */
@@ -91,7 +93,8 @@ HashTab *init_ht(
     self->freeval = freeval ? freeval : NULL;
 
     self->table = (HTentry *)calloc(self->size, sizeof(HTentry));
-	if (self->table == NULL) {
+    self->slots = init_bitset(self->size);
+	if (self->table == NULL || self->slots == NULL) {
 		fprintf(stderr, "Hashtable allocation failed");
 		exit(EXIT_FAILURE);
 	}
@@ -222,7 +225,7 @@ int remove_ht(
 int free_ht(
 		HashTab *self
 ) {
-    unsigned int i;
+    uint64_t i;
 
     /* TODO:
      * -check free succesfull and return HT_FAILURE
@@ -232,13 +235,15 @@ int free_ht(
 		return HT_INVALID_ARG;
 	}
     
-    for (i = 0; i < self->size; i++) {
-        if (self->table[i].flag == 1 || self->table[i].flag == 2) {
-            free_entry(self, &self->table[i]);
-        }
+    /* occupied and deleted slots both still own their key and value */
+    for (i = bitset_next_set(self->slots, 0); i != BITSET_NONE;
+            i = bitset_next_set(self->slots, i + 1)) {
+        free_entry(self, &self->table[i]);
     }
 	free(self->table);
 	self->table = NULL;
+	free_bitset(self->slots);
+	self->slots = NULL;
 	self->hash_func = NULL;
 	self->cmp_func = NULL;
     self->p = NULL;
@@ -299,6 +304,7 @@ static int insert_entry(
         flag = ht->table[index].flag;
         /* empty */
         if (flag == 0) {
+            bitset_set(ht->slots, index);
             ht->table[index].flag = 1;
             ht->table[index].hash_key = hash_key;
             ht->table[index].key = key;           
@@ -337,10 +343,13 @@ static void free_entry(
 static void rehash_entries(
         HashTab *ht,
         HTentry *old_table,
-        uint32_t old_size
+        const Bitset *old_slots
 ) {
-    uint32_t i;
-    for (i = 0; i < old_size; i++) {
+    uint64_t i;
+
+    /* only filled slots can hold an entry; empty runs are skipped a word at a time */
+    for (i = bitset_next_set(old_slots, 0); i != BITSET_NONE;
+            i = bitset_next_set(old_slots, i + 1)) {
         if (old_table[i].flag == 1) {
             insert_entry(
                 ht,
@@ -358,21 +367,28 @@ static void resize(
         uint32_t new_size
 ) {
     HTentry *old_table, *new_table;
-    uint32_t i, old_size;
+    Bitset *old_slots, *new_slots;
     int insert_status;
 
-    old_size = ht->size;
     old_table = ht->table;
+    old_slots = ht->slots;
 
     new_table = (HTentry *)calloc(new_size, sizeof(HTentry));
+    new_slots = init_bitset(new_size);
+    if (new_table == NULL || new_slots == NULL) {
+        fprintf(stderr, "Hashtable allocation failed");
+        exit(EXIT_FAILURE);
+    }
 
     ht->table = new_table;
+    ht->slots = new_slots;
     ht->size = new_size;
     ht->active = 0;
     ht->used = 0;
 
-    rehash_entries(ht, old_table, old_size);
+    rehash_entries(ht, old_table, old_slots);
     free(old_table);// no good dangling pointers
+    free_bitset(old_slots);
 
 }
 /* --- default functions ---------------------------------------------------- */
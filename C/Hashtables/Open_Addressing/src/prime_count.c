@@ -0,0 +1,477 @@
+/**
+ * @file    prime_count.c
+ * @brief   Combinatorial prime counting pi(x) with the Meissel-Lehmer
+ *          formula.
+ * @date    2026-10-18
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "prime_count.h"
+
+/** Below this x the sieve is faster than the formula */
+#define SIEVE_BELOW 100000
+/** Primes folded into the phi wheel tables (2 * 3 * 5 * 7 * 11 * 13) */
+#define PHI_TINY_PRIMES 6
+
+/* pi(n) for n <= limit: odd-number bitmap plus per-word prefix counts */
+typedef struct {
+    uint64_t limit;      /* Largest n answered                           */
+    uint64_t *bits;      /* Bit k set iff 2k + 1 is prime                */
+    uint32_t *prefix;    /* Odd primes in the words before word w        */
+} PiTable;
+
+/* Everything the phi and P2 workers share */
+typedef struct {
+    uint64_t x;
+    uint32_t a;                  /* pi(cbrt(x))                           */
+    uint32_t *primes;            /* 1-based: primes[1] = 2, up to sqrt(x) */
+    uint32_t num_primes;         /* Primes held, excluding the 0 slot     */
+    PiTable pi;
+    uint32_t wheel[PHI_TINY_PRIMES + 1];     /* p1 * ... * pc             */
+    uint32_t totient[PHI_TINY_PRIMES + 1];   /* Euler phi of wheel[c]     */
+    uint16_t *tiny[PHI_TINY_PRIMES + 1];     /* Coprime counts in a wheel */
+
+    /* phi: top-level terms handed out one at a time */
+    pthread_mutex_t lock;
+    int lock_ready;
+    uint32_t next_term;
+
+    /* P2: pi(x / p_b) targets in increasing order */
+    uint64_t *targets;
+    uint64_t *target_pi;
+    size_t num_targets;
+} MeisselCtx;
+
+/* One worker's share of the computation */
+typedef struct {
+    MeisselCtx *ctx;
+    int64_t phi_sum;             /* Sum of its top-level phi terms        */
+    uint64_t lo, hi;             /* P2 sieve slice [lo, hi]               */
+    size_t first, last;          /* Targets falling in the slice          */
+    uint64_t running;            /* Primes seen so far in the slice       */
+    size_t next;                 /* Next target to resolve                */
+    int status;
+} MeisselWorker;
+
+/* --- function prototypes -------------------------------------------------- */
+
+static uint64_t icbrt_u64(uint64_t x);
+static unsigned resolve_threads(unsigned num_threads);
+static int run_workers(void *(*fn)(void *), MeisselWorker *workers,
+        unsigned n);
+static int init_context(MeisselCtx *c, uint64_t x);
+static void free_context(MeisselCtx *c);
+static uint64_t pi_lookup(const PiTable *t, uint64_t n);
+static int64_t phi_tiny(const MeisselCtx *c, uint64_t x, uint32_t a);
+static int64_t phi(const MeisselCtx *c, uint64_t x, uint32_t a);
+static void *phi_worker(void *arg);
+static void *p2_worker(void *arg);
+static int p2_segment(uint64_t seg_lo, const uint64_t *bits, uint32_t nbits,
+        void *ctx);
+
+/* --- prime counting interface --------------------------------------------- */
+
+int prime_count(
+        uint64_t x,
+        unsigned num_threads,
+        uint64_t *count
+) {
+    MeisselCtx c;
+    MeisselWorker *workers;
+    uint64_t span, lo, p2;
+    int64_t phi_x;
+    size_t b, j;
+    unsigned t;
+    int status;
+
+    if (count == NULL || x > PRIME_COUNT_MAX) {
+        return SV_INVALID_ARG;
+    }
+    if (x < SIEVE_BELOW) {
+        return prime_count_sieve(x, count);
+    }
+
+    status = init_context(&c, x);
+    if (status != SV_SUCCESS) {
+        return status;
+    }
+
+    num_threads = resolve_threads(num_threads);
+    workers = (MeisselWorker *)calloc(num_threads, sizeof(MeisselWorker));
+    if (workers == NULL) {
+        free_context(&c);
+        return SV_MEM_ERROR;
+    }
+    for (t = 0; t < num_threads; t++) {
+        workers[t].ctx = &c;
+    }
+
+    /* phi(x, a) = phi(x, 6) - sum_{6 < i <= a} phi(x / p_i, i - 1) */
+    phi_x = phi_tiny(&c, x, (c.a < PHI_TINY_PRIMES) ? c.a : PHI_TINY_PRIMES);
+    c.next_term = PHI_TINY_PRIMES + 1;
+    status = run_workers(phi_worker, workers, num_threads);
+    for (t = 0; t < num_threads; t++) {
+        phi_x -= workers[t].phi_sum;
+    }
+
+    /*
+     * P2(x, a) = sum_{a < b <= pi(sqrt x)} (pi(x / p_b) - (b - 1)); the
+     * targets x / p_b above the pi table are sieved in equal slices.
+     */
+    c.num_targets = 0;
+    for (b = c.num_primes; b > c.a; b--) {
+        c.targets[c.num_targets++] = x / c.primes[b];
+    }
+    lo = c.pi.limit + 1;
+    span = (c.num_targets && c.targets[c.num_targets - 1] >= lo) ?
+            c.targets[c.num_targets - 1] - lo + 1 : 0;
+    j = 0;
+    for (t = 0; t < num_threads && status == SV_SUCCESS; t++) {
+        workers[t].lo = lo + span / num_threads * t;
+        workers[t].hi = (t + 1 == num_threads) ? lo + span - 1 :
+                lo + span / num_threads * (t + 1) - 1;
+        while (j < c.num_targets && c.targets[j] < workers[t].lo) {
+            c.target_pi[j] = pi_lookup(&c.pi, c.targets[j]);
+            j++;
+        }
+        workers[t].first = j;
+        while (j < c.num_targets && c.targets[j] <= workers[t].hi) {
+            j++;
+        }
+        workers[t].last = j;
+    }
+    if (status == SV_SUCCESS && span > 0) {
+        status = run_workers(p2_worker, workers, num_threads);
+    }
+
+    if (status == SV_SUCCESS) {
+        /* slice counts are local; add the primes below each slice */
+        uint64_t below = pi_lookup(&c.pi, c.pi.limit);
+        for (t = 0; t < num_threads && span > 0; t++) {
+            for (j = workers[t].first; j < workers[t].last; j++) {
+                c.target_pi[j] += below;
+            }
+            below += workers[t].running;
+        }
+
+        p2 = 0;
+        for (j = 0, b = c.num_primes; j < c.num_targets; j++, b--) {
+            p2 += c.target_pi[j] - (b - 1);
+        }
+        *count = (uint64_t)phi_x + c.a - 1 - p2;
+    }
+
+    free(workers);
+    free_context(&c);
+    return status;
+}
+
+int prime_count_sieve(
+        uint64_t x,
+        uint64_t *count
+) {
+    return sieve_count_primes(0, x, SIEVE_BUCKET, count);
+}
+
+/* --- utility functions ---------------------------------------------------- */
+
+static uint64_t icbrt_u64(
+        uint64_t x
+) {
+    uint64_t lo = 0, hi = 2642246, mid;   /* 2642245^3 < 2^64 */
+
+    while (lo < hi) {
+        mid = (lo + hi + 1) / 2;
+        if (mid * mid * mid <= x) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+static unsigned resolve_threads(
+        unsigned num_threads
+) {
+    long online;
+
+    if (num_threads == 0) {
+        online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (online > 0) ? (unsigned)online : 1;
+    }
+    return num_threads;
+}
+
+/* Run fn on every worker; worker 0 and any that fail to start run here */
+static int run_workers(
+        void *(*fn)(void *),
+        MeisselWorker *workers,
+        unsigned n
+) {
+    pthread_t *threads;
+    unsigned t, started;
+    int status;
+
+    threads = (pthread_t *)malloc(n * sizeof(pthread_t));
+    if (threads == NULL) {
+        return SV_MEM_ERROR;
+    }
+    started = 1;
+    while (started < n &&
+            pthread_create(&threads[started], NULL, fn, &workers[started]) == 0) {
+        started++;
+    }
+    fn(&workers[0]);
+    for (t = 1; t < n; t++) {
+        if (t < started) {
+            pthread_join(threads[t], NULL);
+        } else {
+            fn(&workers[t]);
+        }
+    }
+    free(threads);
+
+    status = SV_SUCCESS;
+    for (t = 0; t < n; t++) {
+        if (workers[t].status != SV_SUCCESS) {
+            status = workers[t].status;
+        }
+    }
+    return status;
+}
+
+static int init_context(
+        MeisselCtx *c,
+        uint64_t x
+) {
+    uint32_t *odd, c_idx, r, k;
+    uint64_t root, cbrt_x, words, w, i;
+    size_t n_odd;
+    int status;
+
+    memset(c, 0, sizeof(*c));
+    c->x = x;
+    root = isqrt_u64(x);
+
+    status = sieve_odd_primes((uint32_t)root, &odd, &n_odd);
+    if (status != SV_SUCCESS) {
+        return status;
+    }
+    c->num_primes = (uint32_t)n_odd + 1;
+    c->primes = (uint32_t *)malloc((c->num_primes + 1) * sizeof(uint32_t));
+    if (c->primes == NULL) {
+        free(odd);
+        return SV_MEM_ERROR;
+    }
+    c->primes[0] = 0;
+    c->primes[1] = 2;
+    memcpy(&c->primes[2], odd, n_odd * sizeof(uint32_t));
+    free(odd);
+
+    cbrt_x = icbrt_u64(x);
+    for (c->a = 0; c->a < c->num_primes && c->primes[c->a + 1] <= cbrt_x; c->a++) {
+    }
+
+    /* pi table over [0, sqrt x] */
+    c->pi.limit = root;
+    words = ((root - 1) / 2) / 64 + 1;
+    c->pi.bits = (uint64_t *)calloc(words, sizeof(uint64_t));
+    c->pi.prefix = (uint32_t *)malloc(words * sizeof(uint32_t));
+    c->targets = (uint64_t *)malloc(c->num_primes * sizeof(uint64_t));
+    c->target_pi = (uint64_t *)malloc(c->num_primes * sizeof(uint64_t));
+    if (!c->pi.bits || !c->pi.prefix || !c->targets || !c->target_pi) {
+        free_context(c);
+        return SV_MEM_ERROR;
+    }
+    for (k = 2; k <= c->num_primes; k++) {
+        i = c->primes[k] / 2;
+        c->pi.bits[i / 64] |= (uint64_t)1 << (i % 64);
+    }
+    c->pi.prefix[0] = 0;
+    for (w = 1; w < words; w++) {
+        c->pi.prefix[w] = c->pi.prefix[w - 1] +
+                (uint32_t)__builtin_popcountll(c->pi.bits[w - 1]);
+    }
+
+    /* wheel tables: tiny[c][r] = #{1 <= k <= r : gcd(k, wheel[c]) = 1} */
+    c->wheel[0] = 1;
+    c->totient[0] = 1;
+    for (c_idx = 1; c_idx <= PHI_TINY_PRIMES; c_idx++) {
+        c->wheel[c_idx] = c->wheel[c_idx - 1] * c->primes[c_idx];
+        c->totient[c_idx] = c->totient[c_idx - 1] * (c->primes[c_idx] - 1);
+        c->tiny[c_idx] = (uint16_t *)malloc(c->wheel[c_idx] * sizeof(uint16_t));
+        if (c->tiny[c_idx] == NULL) {
+            free_context(c);
+            return SV_MEM_ERROR;
+        }
+        c->tiny[c_idx][0] = 0;
+        for (r = 1; r < c->wheel[c_idx]; r++) {
+            for (k = 1; k <= c_idx && r % c->primes[k] != 0; k++) {
+            }
+            c->tiny[c_idx][r] = (uint16_t)(c->tiny[c_idx][r - 1] + (k > c_idx));
+        }
+    }
+
+    if (pthread_mutex_init(&c->lock, NULL) != 0) {
+        free_context(c);
+        return SV_MEM_ERROR;
+    }
+    c->lock_ready = 1;
+    return SV_SUCCESS;
+}
+
+static void free_context(
+        MeisselCtx *c
+) {
+    int i;
+
+    for (i = 1; i <= PHI_TINY_PRIMES; i++) {
+        free(c->tiny[i]);
+    }
+    if (c->lock_ready) {
+        pthread_mutex_destroy(&c->lock);
+    }
+    free(c->targets);
+    free(c->target_pi);
+    free(c->pi.bits);
+    free(c->pi.prefix);
+    free(c->primes);
+    memset(c, 0, sizeof(*c));
+}
+
+static uint64_t pi_lookup(
+        const PiTable *t,
+        uint64_t n
+) {
+    uint64_t k, w, mask;
+
+    if (n < 2) {
+        return 0;
+    }
+    /* 2 plus the odd primes up to n */
+    k = (n - 1) / 2;
+    w = k / 64;
+    mask = (k % 64 == 63) ? ~(uint64_t)0 : ((uint64_t)1 << (k % 64 + 1)) - 1;
+    return 1 + t->prefix[w] + (uint64_t)__builtin_popcountll(t->bits[w] & mask);
+}
+
+static int64_t phi_tiny(
+        const MeisselCtx *c,
+        uint64_t x,
+        uint32_t a
+) {
+    if (a == 0) {
+        return (int64_t)x;
+    }
+    return (int64_t)((x / c->wheel[a]) * c->totient[a] + c->tiny[a][x % c->wheel[a]]);
+}
+
+/* Legendre's recursion, truncated by the wheel and the pi table */
+static int64_t phi(
+        const MeisselCtx *c,
+        uint64_t x,
+        uint32_t a
+) {
+    uint64_t y, p;
+    int64_t sum;
+    uint32_t i;
+
+    if (a <= PHI_TINY_PRIMES) {
+        return phi_tiny(c, x, a);
+    }
+    if (x < c->primes[a]) {
+        return x > 0;
+    }
+    /* below p_(a+1)^2 the survivors are 1 and the primes in (p_a, x] */
+    p = c->primes[a + 1];
+    if (x <= c->pi.limit && x < p * p) {
+        return (int64_t)pi_lookup(&c->pi, x) - a + 1;
+    }
+
+    sum = phi_tiny(c, x, PHI_TINY_PRIMES);
+    for (i = PHI_TINY_PRIMES + 1; i <= a; i++) {
+        y = x / c->primes[i];
+        if (y < c->primes[i]) {
+            /* phi(y, i - 1) = 1 from here on */
+            sum -= (int64_t)(a - i + 1);
+            break;
+        }
+        sum -= phi(c, y, i - 1);
+    }
+    return sum;
+}
+
+static void *phi_worker(
+        void *arg
+) {
+    MeisselWorker *w = (MeisselWorker *)arg;
+    MeisselCtx *c = w->ctx;
+    uint32_t i;
+    uint64_t y;
+
+    for (;;) {
+        pthread_mutex_lock(&c->lock);
+        i = c->next_term++;
+        pthread_mutex_unlock(&c->lock);
+        if (i > c->a) {
+            break;
+        }
+        y = c->x / c->primes[i];
+        w->phi_sum += (y < c->primes[i]) ? 1 : phi(c, y, i - 1);
+    }
+    return NULL;
+}
+
+static void *p2_worker(
+        void *arg
+) {
+    MeisselWorker *w = (MeisselWorker *)arg;
+
+    w->running = 0;
+    w->next = w->first;
+    if (w->lo <= w->hi) {
+        w->status = sieve_segments(w->lo, w->hi, SIEVE_BUCKET, p2_segment, w);
+    }
+    return NULL;
+}
+
+/* Resolve the targets ending in this window, then bank its primes */
+static int p2_segment(
+        uint64_t seg_lo,
+        const uint64_t *bits,
+        uint32_t nbits,
+        void *ctx
+) {
+    MeisselWorker *w = (MeisselWorker *)ctx;
+    MeisselCtx *c = w->ctx;
+    uint64_t t, k, i, count, seg_end;
+
+    seg_end = seg_lo + 2 * (uint64_t)nbits;
+    while (w->next < w->last && c->targets[w->next] < seg_end) {
+        t = c->targets[w->next];
+        count = 0;
+        if (t >= seg_lo) {
+            k = (t - seg_lo) / 2 + 1;
+            for (i = 0; i < k / 64; i++) {
+                count += (uint64_t)__builtin_popcountll(bits[i]);
+            }
+            if (k % 64) {
+                count += (uint64_t)__builtin_popcountll(bits[k / 64] &
+                        (((uint64_t)1 << (k % 64)) - 1));
+            }
+        }
+        c->target_pi[w->next++] = w->running + count;
+    }
+
+    for (i = 0; i < (nbits + 63) / 64; i++) {
+        w->running += (uint64_t)__builtin_popcountll(bits[i]);
+    }
+    return 0;
+}
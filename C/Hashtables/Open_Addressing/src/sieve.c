@@ -0,0 +1,718 @@
+/**
+ * @file    sieve.c
+ * @brief   Segmented and bucket sieves of Eratosthenes over 64-bit ranges.
+ * @date    2026-10-18
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "sieve.h"
+#include "bitset.h"
+
+/** Entries held by one bucket block (8 KiB) */
+#define BUCKET_BLOCK_ENTRIES 1024
+/** Bucket blocks allocated at once when the free list runs dry */
+#define BUCKET_POOL_BLOCKS 64
+
+/* A large sieving prime waiting for the window its next multiple falls in */
+typedef struct {
+    uint32_t prime;      /* Sieving prime, also its step in odd indices  */
+    uint32_t offset;     /* Bit of the next multiple within its window   */
+} BucketEntry;
+
+/* Fixed size chunk of a bucket; buckets are singly linked block lists */
+typedef struct bucket_block {
+    struct bucket_block *next;
+    uint32_t count;
+    BucketEntry entries[BUCKET_BLOCK_ENTRIES];
+} BucketBlock;
+
+/* Ring of buckets, one per window, reused modulo the ring size */
+typedef struct {
+    BucketBlock **buckets;   /* Bucket list heads, indexed by window      */
+    uint64_t mask;           /* Ring size - 1 (ring size is a power of 2) */
+    BucketBlock *free_list;  /* Recycled blocks                           */
+    BucketBlock **pools;     /* Every chunk allocated, for freeing        */
+    size_t pool_count;
+    size_t pool_cap;
+} BucketRing;
+
+/* A sieved window [lo, hi] kept for queries */
+struct range_sieve {
+    uint64_t lo;         /* Lower bound (inclusive)                      */
+    uint64_t hi;         /* Upper bound (inclusive)                      */
+    uint64_t first;      /* Odd number represented by bit 0             */
+    uint64_t nbits;      /* Odd numbers in the window                    */
+    Bitset *bits;        /* One bit per odd number, set when prime       */
+};
+
+/* One thread's slice of a parallel count */
+typedef struct {
+    uint64_t lo, hi;
+    SieveMode mode;
+    uint64_t count;
+    int status;
+} CountSlice;
+
+/* --- function prototypes -------------------------------------------------- */
+
+static uint64_t first_multiple_index(uint32_t prime, uint64_t first);
+static int init_bucket_ring(BucketRing *ring, uint32_t max_prime);
+static void free_bucket_ring(BucketRing *ring);
+static BucketBlock *alloc_bucket_block(BucketRing *ring);
+static int bucket_push(BucketRing *ring, uint64_t segment, uint32_t prime,
+        uint32_t offset);
+static int count_segment(uint64_t seg_lo, const uint64_t *bits,
+        uint32_t nbits, void *ctx);
+static int foreach_segment(uint64_t seg_lo, const uint64_t *bits,
+        uint32_t nbits, void *ctx);
+static int store_segment(uint64_t seg_lo, const uint64_t *bits,
+        uint32_t nbits, void *ctx);
+static void *count_slice(void *arg);
+
+/* --- sieve interface ------------------------------------------------------ */
+
+int sieve_odd_primes(
+        uint32_t limit,
+        uint32_t **primes,
+        size_t *count
+) {
+    Bitset *bits;
+    uint64_t n_odd, i, j, p, w;
+    uint32_t *out;
+    size_t total, k;
+
+    if (!primes || !count) {
+        return SV_INVALID_ARG;
+    }
+    *primes = NULL;
+    *count = 0;
+    if (limit < 3) {
+        return SV_SUCCESS;
+    }
+
+    /* bit i represents the odd number 2i + 1 */
+    n_odd = ((uint64_t)limit - 1) / 2 + 1;
+    bits = init_bitset(n_odd);
+    if (bits == NULL) {
+        return SV_MEM_ERROR;
+    }
+    bitset_set_range(bits, 1, n_odd);
+
+    for (i = 1; (2 * i + 1) * (2 * i + 1) <= limit; i++) {
+        if (bitset_test(bits, i)) {
+            p = 2 * i + 1;
+            for (j = (p * p) / 2; j < n_odd; j += p) {
+                bitset_clear(bits, j);
+            }
+        }
+    }
+
+    total = (size_t)bitset_popcount(bits);
+    out = (uint32_t *)malloc((total ? total : 1) * sizeof(uint32_t));
+    if (out == NULL) {
+        free_bitset(bits);
+        return SV_MEM_ERROR;
+    }
+    k = 0;
+    for (i = 0; i < bits->nwords; i++) {
+        for (w = bits->words[i]; w; w &= w - 1) {
+            out[k++] = (uint32_t)(2 * (i * 64 + (uint64_t)__builtin_ctzll(w)) + 1);
+        }
+    }
+
+    free_bitset(bits);
+    *primes = out;
+    *count = total;
+    return SV_SUCCESS;
+}
+
+int sieve_segments(
+        uint64_t lo,
+        uint64_t hi,
+        SieveMode mode,
+        SegmentCallback segment,
+        void *ctx
+) {
+    uint64_t first, total, num_segments, s, seg_base, end, j, idx, nseg;
+    uint64_t *next;
+    uint32_t *primes, p, off, nbits;
+    Bitset *window;
+    size_t nprimes, split, pending, k;
+    BucketRing ring;
+    BucketBlock *block, *done;
+    int status;
+
+    if (lo > hi || hi >= SIEVE_LIMIT_MAX || segment == NULL) {
+        return SV_INVALID_ARG;
+    }
+
+    /* first odd candidate; 2 is handled by the callers */
+    first = (lo < 3) ? 3 : (lo | 1);
+    if (first > hi) {
+        return SV_SUCCESS;
+    }
+    total = (hi - first) / 2 + 1;
+    num_segments = (total + SIEVE_SEGMENT_BITS - 1) / SIEVE_SEGMENT_BITS;
+
+    status = sieve_odd_primes((uint32_t)isqrt_u64(hi), &primes, &nprimes);
+    if (status != SV_SUCCESS) {
+        return status;
+    }
+
+    /* primes below split are crossed off directly in every window */
+    split = nprimes;
+    if (mode == SIEVE_BUCKET) {
+        for (split = 0; split < nprimes; split++) {
+            if (primes[split] >= SIEVE_SEGMENT_BITS) {
+                break;
+            }
+        }
+    }
+
+    memset(&ring, 0, sizeof(ring));
+    window = init_bitset(SIEVE_SEGMENT_BITS);
+    next = (uint64_t *)malloc((split ? split : 1) * sizeof(uint64_t));
+    if (window == NULL || next == NULL) {
+        status = SV_MEM_ERROR;
+        goto cleanup;
+    }
+
+    for (k = 0; k < split; k++) {
+        next[k] = first_multiple_index(primes[k], first);
+    }
+
+    if (split < nprimes) {
+        status = init_bucket_ring(&ring, primes[nprimes - 1]);
+        if (status != SV_SUCCESS) {
+            goto cleanup;
+        }
+    }
+    pending = split;
+
+    for (s = 0; s < num_segments; s++) {
+        seg_base = s * SIEVE_SEGMENT_BITS;
+
+        /*
+         * File large primes once their first multiple is within one ring
+         * turn. Primes starting at p * p can start arbitrarily far ahead,
+         * and filing them early would alias an earlier window's bucket.
+         */
+        for (; pending < nprimes; pending++) {
+            idx = first_multiple_index(primes[pending], first);
+            nseg = idx / SIEVE_SEGMENT_BITS;
+            if (nseg > s + ring.mask) {
+                break;
+            }
+            if (nseg < num_segments) {
+                status = bucket_push(&ring, nseg, primes[pending],
+                        (uint32_t)(idx - nseg * SIEVE_SEGMENT_BITS));
+                if (status != SV_SUCCESS) {
+                    goto cleanup;
+                }
+            }
+        }
+
+        nbits = (uint32_t)((total - seg_base < SIEVE_SEGMENT_BITS) ?
+                total - seg_base : SIEVE_SEGMENT_BITS);
+        end = seg_base + nbits;
+        /* bits past hi stay clear so callers can popcount whole words */
+        bitset_set_range(window, 0, nbits);
+        bitset_clear_range(window, nbits, SIEVE_SEGMENT_BITS);
+
+        /* small primes: several hits per window */
+        for (k = 0; k < split; k++) {
+            p = primes[k];
+            for (j = next[k]; j < end; j += p) {
+                bitset_clear(window, j - seg_base);
+            }
+            next[k] = j;
+        }
+
+        /* large primes: only those filed under this window */
+        if (ring.buckets) {
+            block = ring.buckets[s & ring.mask];
+            ring.buckets[s & ring.mask] = NULL;
+            while (block) {
+                for (k = 0; k < block->count; k++) {
+                    p = block->entries[k].prime;
+                    off = block->entries[k].offset;
+                    bitset_clear(window, off);
+                    idx = seg_base + off + p;
+                    nseg = idx / SIEVE_SEGMENT_BITS;
+                    if (nseg < num_segments) {
+                        status = bucket_push(&ring, nseg, p,
+                                (uint32_t)(idx - nseg * SIEVE_SEGMENT_BITS));
+                        if (status != SV_SUCCESS) {
+                            goto cleanup;
+                        }
+                    }
+                }
+                done = block;
+                block = block->next;
+                done->next = ring.free_list;
+                ring.free_list = done;
+            }
+        }
+
+        if (segment(first + 2 * seg_base, window->words, nbits, ctx)) {
+            status = SV_STOPPED;
+            break;
+        }
+    }
+
+cleanup:
+    free_bucket_ring(&ring);
+    free(next);
+    free_bitset(window);
+    free(primes);
+    return status;
+}
+
+int sieve_count_primes(
+        uint64_t lo,
+        uint64_t hi,
+        SieveMode mode,
+        uint64_t *count
+) {
+    int status;
+
+    if (count == NULL) {
+        return SV_INVALID_ARG;
+    }
+    *count = (lo <= 2 && hi >= 2) ? 1 : 0;
+
+    status = sieve_segments(lo, hi, mode, count_segment, count);
+    return status;
+}
+
+int sieve_count_primes_parallel(
+        uint64_t lo,
+        uint64_t hi,
+        SieveMode mode,
+        unsigned num_threads,
+        uint64_t *count
+) {
+    CountSlice *slices;
+    pthread_t *threads;
+    uint64_t span;
+    unsigned t, started;
+    long online;
+    int status;
+
+    if (count == NULL || lo > hi || hi >= SIEVE_LIMIT_MAX) {
+        return SV_INVALID_ARG;
+    }
+    if (num_threads == 0) {
+        online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (online > 0) ? (unsigned)online : 1;
+    }
+    /* slices narrower than a window only add base-prime overhead */
+    span = hi - lo + 1;
+    if (num_threads > span / (2 * (uint64_t)SIEVE_SEGMENT_BITS) + 1) {
+        num_threads = (unsigned)(span / (2 * (uint64_t)SIEVE_SEGMENT_BITS) + 1);
+    }
+
+    slices = (CountSlice *)malloc(num_threads * sizeof(CountSlice));
+    threads = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+    if (slices == NULL || threads == NULL) {
+        free(slices);
+        free(threads);
+        return SV_MEM_ERROR;
+    }
+    for (t = 0; t < num_threads; t++) {
+        slices[t].lo = lo + span / num_threads * t;
+        slices[t].hi = (t + 1 == num_threads) ? hi :
+                lo + span / num_threads * (t + 1) - 1;
+        slices[t].mode = mode;
+    }
+
+    /* slice 0 runs on the calling thread, as does any that failed to start */
+    started = 1;
+    while (started < num_threads &&
+            pthread_create(&threads[started], NULL, count_slice,
+                &slices[started]) == 0) {
+        started++;
+    }
+    count_slice(&slices[0]);
+    for (t = 1; t < num_threads; t++) {
+        if (t < started) {
+            pthread_join(threads[t], NULL);
+        } else {
+            count_slice(&slices[t]);
+        }
+    }
+
+    status = SV_SUCCESS;
+    *count = 0;
+    for (t = 0; t < num_threads; t++) {
+        if (slices[t].status != SV_SUCCESS) {
+            status = slices[t].status;
+        }
+        *count += slices[t].count;
+    }
+    free(slices);
+    free(threads);
+    return status;
+}
+
+/* Context threaded through foreach_segment */
+typedef struct {
+    PrimeCallback callback;
+    void *ctx;
+} ForeachCtx;
+
+int sieve_foreach_prime(
+        uint64_t lo,
+        uint64_t hi,
+        SieveMode mode,
+        PrimeCallback callback,
+        void *ctx
+) {
+    ForeachCtx fctx;
+
+    if (callback == NULL || lo > hi) {
+        return SV_INVALID_ARG;
+    }
+    if (lo <= 2 && hi >= 2 && callback(2, ctx)) {
+        return SV_STOPPED;
+    }
+
+    fctx.callback = callback;
+    fctx.ctx = ctx;
+    return sieve_segments(lo, hi, mode, foreach_segment, &fctx);
+}
+
+uint64_t isqrt_u64(
+        uint64_t n
+) {
+    uint64_t x, y;
+
+    if (n < 2) {
+        return n;
+    }
+    /* Newton iteration from a power of two above the root */
+    x = (uint64_t)1 << ((64 - __builtin_clzll(n)) / 2 + 1);
+    y = (x + n / x) / 2;
+    while (y < x) {
+        x = y;
+        y = (x + n / x) / 2;
+    }
+    return x;
+}
+
+/* --- range sieve interface ------------------------------------------------ */
+
+RangeSieve *init_range_sieve(
+        uint64_t lo,
+        uint64_t hi
+) {
+    RangeSieve *rs;
+
+    if (lo > hi || hi >= SIEVE_LIMIT_MAX) {
+        return NULL;
+    }
+
+    rs = (RangeSieve *)malloc(sizeof(RangeSieve));
+    if (rs == NULL) {
+        return NULL;
+    }
+    rs->lo = lo;
+    rs->hi = hi;
+    rs->first = (lo < 3) ? 3 : (lo | 1);
+    rs->nbits = (rs->first > hi) ? 0 : (hi - rs->first) / 2 + 1;
+
+    rs->bits = init_bitset(rs->nbits);
+    if (rs->bits == NULL) {
+        free(rs);
+        return NULL;
+    }
+
+    if (rs->nbits > 0 &&
+            sieve_segments(lo, hi, SIEVE_BUCKET, store_segment, rs) != SV_SUCCESS) {
+        free_range_sieve(rs);
+        return NULL;
+    }
+
+    return rs;
+}
+
+void free_range_sieve(
+        RangeSieve *rs
+) {
+    if (rs) {
+        free_bitset(rs->bits);
+        free(rs);
+    }
+}
+
+int range_is_prime(
+        const RangeSieve *rs,
+        uint64_t n
+) {
+    if (rs == NULL || n < rs->lo || n > rs->hi) {
+        return 0;
+    }
+    if (n == 2) {
+        return 1;
+    }
+    if (!(n & 1) || n < rs->first) {
+        return 0;
+    }
+    return bitset_test(rs->bits, (n - rs->first) / 2);
+}
+
+uint64_t range_count_primes(
+        const RangeSieve *rs
+) {
+    if (rs == NULL) {
+        return 0;
+    }
+    return ((rs->lo <= 2 && rs->hi >= 2) ? 1 : 0) + bitset_popcount(rs->bits);
+}
+
+uint64_t range_next_prime(
+        const RangeSieve *rs,
+        uint64_t target
+) {
+    uint64_t n, k;
+
+    if (rs == NULL || target > rs->hi) {
+        return 0;
+    }
+    if (target < rs->lo) {
+        target = rs->lo;
+    }
+    if (target <= 2 && rs->hi >= 2) {
+        return 2;
+    }
+
+    n = (target < rs->first) ? rs->first : (target | 1);
+    if (n > rs->hi) {
+        return 0;
+    }
+    k = bitset_next_set(rs->bits, (n - rs->first) / 2);
+    return (k == BITSET_NONE) ? 0 : rs->first + 2 * k;
+}
+
+uint64_t range_prev_prime(
+        const RangeSieve *rs,
+        uint64_t target
+) {
+    uint64_t n, k;
+
+    if (rs == NULL || target < rs->lo) {
+        return 0;
+    }
+    if (target > rs->hi) {
+        target = rs->hi;
+    }
+
+    n = (target & 1) ? target : target - 1;
+    if (rs->nbits > 0 && target >= rs->first) {
+        k = bitset_prev_set(rs->bits, (n - rs->first) / 2);
+        if (k != BITSET_NONE) {
+            return rs->first + 2 * k;
+        }
+    }
+
+    return (rs->lo <= 2 && target >= 2) ? 2 : 0;
+}
+
+int range_foreach_prime(
+        const RangeSieve *rs,
+        PrimeCallback callback,
+        void *ctx
+) {
+    uint64_t k;
+
+    if (rs == NULL || callback == NULL) {
+        return SV_INVALID_ARG;
+    }
+    if (rs->lo <= 2 && rs->hi >= 2 && callback(2, ctx)) {
+        return SV_STOPPED;
+    }
+
+    for (k = bitset_next_set(rs->bits, 0); k != BITSET_NONE;
+            k = bitset_next_set(rs->bits, k + 1)) {
+        if (callback(rs->first + 2 * k, ctx)) {
+            return SV_STOPPED;
+        }
+    }
+    return SV_SUCCESS;
+}
+
+/* --- utility functions ---------------------------------------------------- */
+
+/* Odd index (relative to first) of the first odd multiple of prime to strike */
+static uint64_t first_multiple_index(
+        uint32_t prime,
+        uint64_t first
+) {
+    uint64_t m;
+
+    m = (uint64_t)prime * prime;
+    if (m < first) {
+        m = first + (prime - first % prime) % prime;
+        if (!(m & 1)) {
+            m += prime;
+        }
+    }
+    return (m - first) / 2;
+}
+
+static int init_bucket_ring(
+        BucketRing *ring,
+        uint32_t max_prime
+) {
+    uint64_t size;
+
+    /* a prime jumps at most max_prime / SEGMENT_BITS + 1 windows ahead */
+    size = 1;
+    while (size < (uint64_t)max_prime / SIEVE_SEGMENT_BITS + 2) {
+        size <<= 1;
+    }
+
+    ring->buckets = (BucketBlock **)calloc(size, sizeof(BucketBlock *));
+    if (ring->buckets == NULL) {
+        return SV_MEM_ERROR;
+    }
+    ring->mask = size - 1;
+    return SV_SUCCESS;
+}
+
+static void free_bucket_ring(
+        BucketRing *ring
+) {
+    size_t i;
+
+    for (i = 0; i < ring->pool_count; i++) {
+        free(ring->pools[i]);
+    }
+    free(ring->pools);
+    free(ring->buckets);
+    memset(ring, 0, sizeof(*ring));
+}
+
+static BucketBlock *alloc_bucket_block(
+        BucketRing *ring
+) {
+    BucketBlock *pool, *block, **pools;
+    size_t i, cap;
+
+    if (ring->free_list == NULL) {
+        if (ring->pool_count == ring->pool_cap) {
+            cap = ring->pool_cap ? ring->pool_cap * 2 : 16;
+            pools = (BucketBlock **)realloc(ring->pools,
+                    cap * sizeof(BucketBlock *));
+            if (pools == NULL) {
+                return NULL;
+            }
+            ring->pools = pools;
+            ring->pool_cap = cap;
+        }
+        pool = (BucketBlock *)malloc(BUCKET_POOL_BLOCKS * sizeof(BucketBlock));
+        if (pool == NULL) {
+            return NULL;
+        }
+        ring->pools[ring->pool_count++] = pool;
+        for (i = 0; i < BUCKET_POOL_BLOCKS; i++) {
+            pool[i].next = ring->free_list;
+            ring->free_list = &pool[i];
+        }
+    }
+
+    block = ring->free_list;
+    ring->free_list = block->next;
+    return block;
+}
+
+static int bucket_push(
+        BucketRing *ring,
+        uint64_t segment,
+        uint32_t prime,
+        uint32_t offset
+) {
+    BucketBlock **head, *block;
+
+    head = &ring->buckets[segment & ring->mask];
+    block = *head;
+    if (block == NULL || block->count == BUCKET_BLOCK_ENTRIES) {
+        block = alloc_bucket_block(ring);
+        if (block == NULL) {
+            return SV_MEM_ERROR;
+        }
+        block->next = *head;
+        block->count = 0;
+        *head = block;
+    }
+    block->entries[block->count].prime = prime;
+    block->entries[block->count].offset = offset;
+    block->count++;
+    return SV_SUCCESS;
+}
+
+static int count_segment(
+        uint64_t seg_lo,
+        const uint64_t *bits,
+        uint32_t nbits,
+        void *ctx
+) {
+    uint64_t *count = (uint64_t *)ctx;
+
+    (void)seg_lo;
+    *count += bitset_popcount_words(bits, (nbits + 63) / 64);
+    return 0;
+}
+
+static int foreach_segment(
+        uint64_t seg_lo,
+        const uint64_t *bits,
+        uint32_t nbits,
+        void *ctx
+) {
+    ForeachCtx *fctx = (ForeachCtx *)ctx;
+    uint64_t w;
+    uint32_t i;
+
+    for (i = 0; i < (nbits + 63) / 64; i++) {
+        w = bits[i];
+        while (w) {
+            if (fctx->callback(seg_lo + 2 * ((uint64_t)i * 64 +
+                    (uint64_t)__builtin_ctzll(w)), fctx->ctx)) {
+                return 1;
+            }
+            w &= w - 1;
+        }
+    }
+    return 0;
+}
+
+static int store_segment(
+        uint64_t seg_lo,
+        const uint64_t *bits,
+        uint32_t nbits,
+        void *ctx
+) {
+    RangeSieve *rs = (RangeSieve *)ctx;
+
+    /* windows start on whole words, SIEVE_SEGMENT_BITS being a multiple of 64 */
+    memcpy(&rs->bits->words[(seg_lo - rs->first) / 2 / 64], bits,
+            ((nbits + 63) / 64) * sizeof(uint64_t));
+    return 0;
+}
+
+static void *count_slice(
+        void *arg
+) {
+    CountSlice *slice = (CountSlice *)arg;
+
+    slice->status = sieve_count_primes(slice->lo, slice->hi, slice->mode,
+            &slice->count);
+    return NULL;
+}
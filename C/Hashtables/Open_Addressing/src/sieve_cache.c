@@ -0,0 +1,349 @@
+/**
+ * @file    sieve_cache.c
+ * @brief   Sieve persisted to a versioned file and memory-mapped read-only.
+ * @date    2026-10-18
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "sieve_cache.h"
+
+#define CACHE_MAGIC "SVCACHE"
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+/* On-disk header; the wheel bitmap follows immediately */
+typedef struct {
+    char magic[8];               /* CACHE_MAGIC, NUL-terminated           */
+    uint32_t version;            /* SIEVE_CACHE_VERSION                   */
+    uint32_t header_size;        /* sizeof(CacheHeader)                   */
+    uint64_t limit;              /* Largest number covered                */
+    uint64_t payload_bytes;      /* Bitmap size, a multiple of 8          */
+    uint64_t prime_count;        /* pi(limit)                             */
+    uint64_t payload_checksum;   /* checksum_words over the bitmap        */
+    uint64_t reserved;
+    uint64_t header_checksum;    /* FNV-1a over every field above         */
+} CacheHeader;
+
+struct sieve_cache {
+    void *map;                   /* Whole file, read-only                 */
+    size_t map_size;
+    const uint8_t *wheel;        /* Bitmap inside the mapping             */
+    uint64_t limit;
+    uint64_t prime_count;
+    int rebuilt;
+};
+
+/* Build state threaded through the segment callback */
+typedef struct {
+    uint8_t *wheel;
+    uint64_t odd_primes;
+} CacheBuild;
+
+/* Residues coprime to 30 and the bit each one occupies in a wheel byte */
+static const uint8_t WHEEL_RESIDUE[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+static const int8_t WHEEL_BIT[30] = {
+    -1,  0, -1, -1, -1, -1, -1,  1, -1, -1, -1,  2, -1,  3, -1,
+    -1, -1,  4, -1,  5, -1, -1, -1,  6, -1, -1, -1, -1, -1,  7
+};
+
+/* --- function prototypes -------------------------------------------------- */
+
+static uint64_t payload_size(uint64_t limit);
+static uint64_t header_checksum(const CacheHeader *header);
+static uint64_t checksum_words(const uint8_t *data, uint64_t bytes);
+static int map_cache(const char *path, uint64_t limit, unsigned flags,
+        SieveCache *cache);
+static int build_cache(const char *path, uint64_t limit);
+static int build_segment(uint64_t seg_lo, const uint64_t *bits,
+        uint32_t nbits, void *ctx);
+
+/* --- sieve cache interface ------------------------------------------------ */
+
+int open_sieve_cache(
+        const char *path,
+        uint64_t limit,
+        unsigned flags,
+        SieveCache **cache
+) {
+    SieveCache *c;
+    int status;
+
+    if (path == NULL || cache == NULL || limit > SIEVE_CACHE_LIMIT_MAX ||
+            (flags & ~(unsigned)SIEVE_CACHE_VERIFY)) {
+        return SV_INVALID_ARG;
+    }
+    c = (SieveCache *)calloc(1, sizeof(SieveCache));
+    if (c == NULL) {
+        return SV_MEM_ERROR;
+    }
+
+    if (map_cache(path, limit, flags, c) != SV_SUCCESS) {
+        status = build_cache(path, limit);
+        if (status == SV_SUCCESS) {
+            /* a file we just wrote must validate; anything else is I/O */
+            status = map_cache(path, limit, SIEVE_CACHE_VERIFY, c);
+        }
+        if (status != SV_SUCCESS) {
+            free(c);
+            return status;
+        }
+        c->rebuilt = 1;
+    }
+    *cache = c;
+    return SV_SUCCESS;
+}
+
+void close_sieve_cache(
+        SieveCache *cache
+) {
+    if (cache) {
+        munmap(cache->map, cache->map_size);
+        free(cache);
+    }
+}
+
+int sieve_cache_rebuilt(
+        const SieveCache *cache
+) {
+    return cache->rebuilt;
+}
+
+uint64_t sieve_cache_limit(
+        const SieveCache *cache
+) {
+    return cache->limit;
+}
+
+uint64_t sieve_cache_prime_count(
+        const SieveCache *cache
+) {
+    return cache->prime_count;
+}
+
+int sieve_cache_is_prime(
+        const SieveCache *cache,
+        uint64_t n
+) {
+    int bit;
+
+    if (cache == NULL || n > cache->limit) {
+        return 0;
+    }
+    if (n < 7) {
+        return n == 2 || n == 3 || n == 5;
+    }
+    bit = WHEEL_BIT[n % 30];
+    return bit >= 0 && ((cache->wheel[n / 30] >> bit) & 1);
+}
+
+uint64_t sieve_cache_next_prime(
+        const SieveCache *cache,
+        uint64_t target
+) {
+    uint64_t b, last, n;
+    unsigned mask, r;
+
+    if (cache == NULL || target > cache->limit) {
+        return 0;
+    }
+    if (target <= 5) {
+        n = (target <= 2) ? 2 : (target == 3) ? 3 : 5;
+        return (n <= cache->limit) ? n : 0;
+    }
+
+    /* first byte: only residues at or above target % 30 */
+    b = target / 30;
+    mask = 0;
+    for (r = 0; r < 8; r++) {
+        if (WHEEL_RESIDUE[r] >= target % 30) {
+            mask |= 1U << r;
+        }
+    }
+    last = cache->limit / 30;
+    for (; b <= last; b++, mask = 0xFF) {
+        if (cache->wheel[b] & mask) {
+            n = 30 * b + WHEEL_RESIDUE[__builtin_ctz(cache->wheel[b] & mask)];
+            return (n <= cache->limit) ? n : 0;
+        }
+    }
+    return 0;
+}
+
+/* --- utility functions ---------------------------------------------------- */
+
+/* One byte per 30 numbers, padded so the bitmap checksums in whole words */
+static uint64_t payload_size(
+        uint64_t limit
+) {
+    return (limit / 30 + 1 + 7) & ~(uint64_t)7;
+}
+
+static uint64_t header_checksum(
+        const CacheHeader *header
+) {
+    const uint8_t *p = (const uint8_t *)header;
+    uint64_t h = FNV_OFFSET;
+    size_t i;
+
+    for (i = 0; i < offsetof(CacheHeader, header_checksum); i++) {
+        h = (h ^ p[i]) * FNV_PRIME;
+    }
+    return h;
+}
+
+/* FNV-1a over 64-bit words: cheap enough to run over gigabytes */
+static uint64_t checksum_words(
+        const uint8_t *data,
+        uint64_t bytes
+) {
+    uint64_t h = FNV_OFFSET, w, i;
+
+    for (i = 0; i < bytes; i += 8) {
+        memcpy(&w, data + i, 8);
+        h = (h ^ w) * FNV_PRIME;
+    }
+    return h;
+}
+
+/* Map and validate an existing file; leaves cache untouched on failure */
+static int map_cache(
+        const char *path,
+        uint64_t limit,
+        unsigned flags,
+        SieveCache *cache
+) {
+    const CacheHeader *header;
+    struct stat st;
+    void *map;
+    int fd, valid;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return SV_IO_ERROR;
+    }
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(CacheHeader)) {
+        close(fd);
+        return SV_IO_ERROR;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return SV_IO_ERROR;
+    }
+
+    header = (const CacheHeader *)map;
+    valid = memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+            header->header_checksum == header_checksum(header) &&
+            header->version == SIEVE_CACHE_VERSION &&
+            header->header_size == sizeof(CacheHeader) &&
+            header->limit >= limit &&
+            header->limit <= SIEVE_CACHE_LIMIT_MAX &&
+            header->payload_bytes == payload_size(header->limit) &&
+            (uint64_t)st.st_size == sizeof(CacheHeader) + header->payload_bytes;
+    if (valid && (flags & SIEVE_CACHE_VERIFY)) {
+        valid = header->payload_checksum ==
+                checksum_words((const uint8_t *)map + sizeof(CacheHeader),
+                    header->payload_bytes);
+    }
+    if (!valid) {
+        munmap(map, (size_t)st.st_size);
+        return SV_IO_ERROR;
+    }
+
+    cache->map = map;
+    cache->map_size = (size_t)st.st_size;
+    cache->wheel = (const uint8_t *)map + sizeof(CacheHeader);
+    cache->limit = header->limit;
+    cache->prime_count = header->prime_count;
+    return SV_SUCCESS;
+}
+
+/* Sieve [0, limit] into a wheel bitmap and atomically replace path */
+static int build_cache(
+        const char *path,
+        uint64_t limit
+) {
+    CacheHeader header;
+    CacheBuild build;
+    char *tmp;
+    size_t tmp_len;
+    FILE *fp;
+    int status, ok;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = SIEVE_CACHE_VERSION;
+    header.header_size = sizeof(CacheHeader);
+    header.limit = limit;
+    header.payload_bytes = payload_size(limit);
+
+    build.wheel = (uint8_t *)calloc(header.payload_bytes, 1);
+    if (build.wheel == NULL) {
+        return SV_MEM_ERROR;
+    }
+    build.odd_primes = 0;
+    status = sieve_segments(0, limit, SIEVE_BUCKET, build_segment, &build);
+    if (status != SV_SUCCESS) {
+        free(build.wheel);
+        return status;
+    }
+    header.prime_count = build.odd_primes + (limit >= 2);
+    header.payload_checksum = checksum_words(build.wheel, header.payload_bytes);
+    header.header_checksum = header_checksum(&header);
+
+    /* write beside the target, then rename over it */
+    tmp_len = strlen(path) + 32;
+    tmp = (char *)malloc(tmp_len);
+    if (tmp == NULL) {
+        free(build.wheel);
+        return SV_MEM_ERROR;
+    }
+    snprintf(tmp, tmp_len, "%s.tmp.%ld", path, (long)getpid());
+    fp = fopen(tmp, "wb");
+    ok = fp != NULL &&
+            fwrite(&header, sizeof(header), 1, fp) == 1 &&
+            fwrite(build.wheel, 1, header.payload_bytes, fp) == header.payload_bytes;
+    if (fp != NULL && fclose(fp) != 0) {
+        ok = 0;
+    }
+    ok = ok && rename(tmp, path) == 0;
+    if (!ok) {
+        remove(tmp);
+    }
+
+    free(tmp);
+    free(build.wheel);
+    return ok ? SV_SUCCESS : SV_IO_ERROR;
+}
+
+static int build_segment(
+        uint64_t seg_lo,
+        const uint64_t *bits,
+        uint32_t nbits,
+        void *ctx
+) {
+    CacheBuild *build = (CacheBuild *)ctx;
+    uint64_t word, n;
+    uint32_t w;
+
+    for (w = 0; w < (nbits + 63) / 64; w++) {
+        for (word = bits[w]; word; word &= word - 1) {
+            n = seg_lo + 2 * (64 * (uint64_t)w + (uint64_t)__builtin_ctzll(word));
+            build->odd_primes++;
+            if (n > 5) {
+                build->wheel[n / 30] |= (uint8_t)(1U << WHEEL_BIT[n % 30]);
+            }
+        }
+    }
+    return 0;
+}
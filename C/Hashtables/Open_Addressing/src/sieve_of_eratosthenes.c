@@ -4,14 +4,17 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
+#include "sieve.h"
+#include "bitset.h"
+#include "sieve_cache.h"
 
 #define MAX_POWER 29
 #define SIEVE_LIMIT (1U << (MAX_POWER + 1))
 
 
 typedef struct {
-    /** bit arry representing primality                                */
-    uint8_t *bits;
+    /** bit array representing primality, one bit per integer           */
+    Bitset *bits;
     /** maximum number represented in the sieve                        */
     uint32_t size;
 } BitSieve;
@@ -25,12 +28,10 @@ static void mark_non_prime(BitSieve *sieve, uint32_t index);
 static void bitwise_sieve_of_eratosthenes(BitSieve *sieve);
 static uint32_t power_of_two(uint32_t power);
 static uint32_t next_prime(BitSieve *sieve, uint32_t target);
-static uint32_t prev_prime(BitSieve *sieve, uint32_t target);
 
 static BitSieve *init_bit_sieve(uint32_t limit) {
 
     BitSieve *sieve;
-    uint32_t byte_len;
 
     sieve = (BitSieve*)malloc(sizeof(BitSieve));
     if (sieve == NULL) {
@@ -38,18 +39,14 @@ static BitSieve *init_bit_sieve(uint32_t limit) {
     }
     sieve->size = limit;
 
-    byte_len = (limit / 8) + 1;
-    sieve->bits = (uint8_t*)malloc(byte_len * sizeof(uint8_t));
+    sieve->bits = init_bitset((uint64_t)limit + 1);
     if (sieve->bits == NULL) {
+        free(sieve);
         return NULL;
     }
 
-    /* initialize all bits to 1 */
-    memset(sieve->bits, 0xFF, byte_len);
-
-    /* 0 and 1 not prime */
-    sieve->bits[0] &= ~(1 << 0);
-    sieve->bits[0] &= ~(1 << 1);
+    /* every number from 2 up starts out prime; 0 and 1 are not */
+    bitset_set_range(sieve->bits, 2, (uint64_t)limit + 1);
 
     return sieve;
 
@@ -57,35 +54,26 @@ static BitSieve *init_bit_sieve(uint32_t limit) {
 
 static void free_bit_sieve(BitSieve *sieve) {
     if (sieve) {
-        free(sieve->bits);
+        free_bitset(sieve->bits);
         free(sieve);
     }
 }
 
 static uint8_t is_prime_bit(BitSieve *sieve, uint32_t index) {
-    
-    uint32_t byte_index, bit_pos;
 
     if (index > sieve->size) {
         return 0;
     }
-    byte_index = index / 8;
-    bit_pos = index % 8;
-
-    return (sieve->bits[byte_index] & (1 << bit_pos)) ? 1 : 0;
+    return (uint8_t)bitset_test(sieve->bits, index);
 
 }
 
 static void mark_non_prime(BitSieve *sieve, uint32_t index) {
 
-    uint32_t byte_index, bit_pos;
     if (index > sieve->size) {
         return;
     }
-    byte_index = index / 8;
-    bit_pos = index % 8;
-
-    sieve->bits[byte_index] &= ~(1 << bit_pos);
+    bitset_clear(sieve->bits, index);
 
 }
 
@@ -114,51 +102,113 @@ static uint32_t power_of_two(uint32_t power) {
 
 static uint32_t next_prime(BitSieve *sieve, uint32_t target) {
 
-    uint32_t index;
+    uint64_t index;
 
     if (target > sieve->size) {
         return 0;
     }
 
-    for (index = target; index < sieve->size; index++) {
-        if (is_prime_bit(sieve, index)) {
-            return index;
-        }
+    index = bitset_next_set(sieve->bits, target);
+    if (index < sieve->size) {
+        return (uint32_t)index;
     }
 
     fprintf(stderr, "No prime found >= %u within the sieve limit.\n", target);
     exit(EXIT_FAILURE);
 }
 
-static uint32_t prev_prime(BitSieve *sieve, uint32_t target) {
-    uint32_t index;
-    if (target < 0) {
-        return 0;
+void populate_primes_near_powers(BitSieve* sieve, uint32_t* prime_near_powers) {
+    uint32_t power, target;
+
+    for (power = 0; power < MAX_POWER; power++) {
+        target = power_of_two(power);
+        prime_near_powers[power] = next_prime(sieve, target);
     }
+}
 
-    for (index = target; index > 0; index--) {
-        if (is_prime_bit(sieve, index)) {
-            return index;
-        }
+/* Count the primes in [lo, hi] with the segmented or bucket sieve */
+static int count_range_primes(const char *mode_arg, const char *lo_arg,
+        const char *hi_arg) {
+    uint64_t lo, hi, count;
+    SieveMode mode;
+    clock_t start_time, end_time;
+    int status;
+
+    if (strcmp(mode_arg, "segmented") == 0) {
+        mode = SIEVE_SEGMENTED;
+    } else if (strcmp(mode_arg, "bucket") == 0) {
+        mode = SIEVE_BUCKET;
+    } else {
+        fprintf(stderr, "Unknown sieve mode '%s'.\n", mode_arg);
+        return EXIT_FAILURE;
     }
+    lo = strtoull(lo_arg, NULL, 10);
+    hi = strtoull(hi_arg, NULL, 10);
 
-    return 0;
+    printf("Counting primes in [%llu, %llu] (%s sieve)...\n",
+            (unsigned long long)lo, (unsigned long long)hi, mode_arg);
+    start_time = clock();
+    status = sieve_count_primes(lo, hi, mode, &count);
+    end_time = clock();
+    if (status != SV_SUCCESS) {
+        fprintf(stderr, "Sieve failed (status=%d).\n", status);
+        return EXIT_FAILURE;
+    }
+    printf("%llu primes, sieved in %.4f seconds.\n", (unsigned long long)count,
+            (double)(end_time - start_time) / CLOCKS_PER_SEC);
+
+    return EXIT_SUCCESS;
 }
 
-void populate_primes_near_powers(BitSieve* sieve, uint32_t* prime_near_powers) {
-    uint32_t power, target;
+/* Map (or build once) a sieve cache file and query it */
+static int query_sieve_cache(const char *path, const char *limit_arg) {
+    SieveCache *cache;
+    uint64_t limit, target, prime;
+    clock_t start_time, end_time;
+    int status;
 
-    for (power = 0; power < MAX_POWER; power++) {
-        target = power_of_two(power);
-        prime_near_powers[power] = next_prime(sieve, target);
+    limit = strtoull(limit_arg, NULL, 10);
+    start_time = clock();
+    status = open_sieve_cache(path, limit, 0, &cache);
+    end_time = clock();
+    if (status != SV_SUCCESS) {
+        fprintf(stderr, "Cannot open sieve cache '%s' (status=%d).\n", path, status);
+        return EXIT_FAILURE;
+    }
+    printf("Sieve cache %s up to %llu %s in %.4f seconds, %llu primes.\n", path,
+            (unsigned long long)sieve_cache_limit(cache),
+            sieve_cache_rebuilt(cache) ? "built" : "mapped",
+            (double)(end_time - start_time) / CLOCKS_PER_SEC,
+            (unsigned long long)sieve_cache_prime_count(cache));
+
+    for (target = 1; target <= limit && target != 0; target <<= 1) {
+        prime = sieve_cache_next_prime(cache, target);
+        if (prime == 0) {
+            break;
+        }
+        printf("Next prime >= %llu: %llu\n", (unsigned long long)target,
+                (unsigned long long)prime);
     }
+
+    close_sieve_cache(cache);
+    return EXIT_SUCCESS;
 }
 
-int main() {
+int main(int argc, char **argv) {
     uint32_t *prime_near_powers, power, current_power, prime;
     clock_t start_time, end_time;
     double elapsed_time;
 
+    if (argc == 4 && strcmp(argv[1], "cache") == 0) {
+        return query_sieve_cache(argv[2], argv[3]);
+    } else if (argc == 4) {
+        return count_range_primes(argv[1], argv[2], argv[3]);
+    } else if (argc != 1) {
+        fprintf(stderr, "Usage: %s [segmented|bucket LO HI | cache FILE LIMIT]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
     printf("Initializing bitwise sieve up to %u...\n", SIEVE_LIMIT);
     BitSieve* sieve = init_bit_sieve(SIEVE_LIMIT);
     printf("Bitwise sieve initialized.\n");
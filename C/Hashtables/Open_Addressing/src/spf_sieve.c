@@ -0,0 +1,313 @@
+/**
+ * @file    spf_sieve.c
+ * @brief   Smallest-prime-factor table for batch factorisation of 32-bit
+ *          integers.
+ * @date    2026-10-18
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "spf_sieve.h"
+
+/* Smallest-prime-factor table over the odd numbers up to limit */
+struct spf_table {
+    uint32_t limit;      /* Largest integer covered                      */
+    uint32_t *primes;    /* Odd base primes up to sqrt(limit)            */
+    uint32_t num_primes; /* Number of base primes                        */
+    uint64_t entries;    /* Odd numbers in [1, limit]                    */
+    uint16_t *spf;       /* Entry k is 2k + 1: 0 if prime, else 1-based  */
+                         /* index of its smallest factor in primes       */
+};
+
+/* One worker filling every nthreads-th window */
+typedef struct {
+    SpfTable *table;
+    uint64_t num_segments;
+    unsigned tid;
+    unsigned nthreads;
+} SpfWorker;
+
+/* --- function prototypes -------------------------------------------------- */
+
+static int linear_sieve_odd_primes(uint32_t limit, uint32_t **primes,
+        uint32_t *count);
+static void fill_segment(SpfTable *table, uint64_t k0, uint64_t k1);
+static void *spf_worker(void *arg);
+
+/* --- spf table interface -------------------------------------------------- */
+
+SpfTable *init_spf_table(
+        uint32_t limit,
+        unsigned num_threads
+) {
+    SpfTable *table;
+    SpfWorker *workers;
+    pthread_t *threads;
+    uint64_t num_segments;
+    unsigned t, started;
+    long online;
+
+    table = (SpfTable *)malloc(sizeof(SpfTable));
+    if (table == NULL) {
+        return NULL;
+    }
+    table->limit = limit;
+    table->entries = ((uint64_t)limit + 1) / 2;
+    table->spf = (uint16_t *)calloc(table->entries ? table->entries : 1,
+            sizeof(uint16_t));
+    if (table->spf == NULL ||
+            linear_sieve_odd_primes((uint32_t)isqrt_u64(limit), &table->primes,
+                &table->num_primes) != SV_SUCCESS) {
+        free(table->spf);
+        free(table);
+        return NULL;
+    }
+
+    num_segments = (table->entries + SPF_SEGMENT_ENTRIES - 1) / SPF_SEGMENT_ENTRIES;
+    if (num_threads == 0) {
+        online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (online > 0) ? (unsigned)online : 1;
+    }
+    if (num_threads > num_segments) {
+        num_threads = num_segments ? (unsigned)num_segments : 1;
+    }
+
+    workers = (SpfWorker *)malloc(num_threads * sizeof(SpfWorker));
+    threads = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+    if (workers == NULL || threads == NULL) {
+        free(workers);
+        free(threads);
+        free_spf_table(table);
+        return NULL;
+    }
+    for (t = 0; t < num_threads; t++) {
+        workers[t].table = table;
+        workers[t].num_segments = num_segments;
+        workers[t].tid = t;
+        workers[t].nthreads = num_threads;
+    }
+
+    /* worker 0 runs on the calling thread, as does any that failed to start */
+    started = 1;
+    while (started < num_threads &&
+            pthread_create(&threads[started], NULL, spf_worker,
+                &workers[started]) == 0) {
+        started++;
+    }
+    spf_worker(&workers[0]);
+    for (t = 1; t < num_threads; t++) {
+        if (t < started) {
+            pthread_join(threads[t], NULL);
+        } else {
+            spf_worker(&workers[t]);
+        }
+    }
+
+    free(workers);
+    free(threads);
+    return table;
+}
+
+void free_spf_table(
+        SpfTable *table
+) {
+    if (table) {
+        free(table->spf);
+        free(table->primes);
+        free(table);
+    }
+}
+
+uint32_t spf_limit(
+        const SpfTable *table
+) {
+    return table->limit;
+}
+
+uint32_t spf_lookup(
+        const SpfTable *table,
+        uint32_t n
+) {
+    uint16_t v;
+
+    if (table == NULL || n < 2 || n > table->limit) {
+        return 0;
+    }
+    if (!(n & 1)) {
+        return 2;
+    }
+    v = table->spf[n / 2];
+    return v ? table->primes[v - 1] : n;
+}
+
+int spf_factorize(
+        const SpfTable *table,
+        uint32_t n,
+        uint32_t *factors,
+        int max
+) {
+    int count, twos;
+    uint16_t v;
+    uint32_t p;
+
+    if (table == NULL || factors == NULL || n < 2 || n > table->limit) {
+        return SV_INVALID_ARG;
+    }
+
+    twos = __builtin_ctz(n);
+    if (twos > max) {
+        return SV_NO_SPACE;
+    }
+    for (count = 0; count < twos; count++) {
+        factors[count] = 2;
+    }
+    n >>= twos;
+
+    while (n > 1) {
+        if (count == max) {
+            return SV_NO_SPACE;
+        }
+        v = table->spf[n / 2];
+        p = v ? table->primes[v - 1] : n;
+        factors[count++] = p;
+        n /= p;
+    }
+    return count;
+}
+
+int spf_factorize_batch(
+        const SpfTable *table,
+        const uint32_t *values,
+        size_t count,
+        uint32_t *factors,
+        size_t capacity,
+        size_t *offsets
+) {
+    size_t i, pos, room;
+    int n;
+
+    if (table == NULL || (count && (values == NULL || factors == NULL)) ||
+            offsets == NULL) {
+        return SV_INVALID_ARG;
+    }
+
+    pos = 0;
+    offsets[0] = 0;
+    for (i = 0; i < count; i++) {
+        if (values[i] >= 2) {
+            room = capacity - pos;
+            n = spf_factorize(table, values[i], &factors[pos],
+                    room > SPF_MAX_FACTORS ? SPF_MAX_FACTORS : (int)room);
+            if (n < 0) {
+                return n;
+            }
+            pos += (size_t)n;
+        }
+        offsets[i + 1] = pos;
+    }
+    return SV_SUCCESS;
+}
+
+/* --- utility functions ---------------------------------------------------- */
+
+/* Euler's linear sieve: every composite is struck once, by its smallest factor */
+static int linear_sieve_odd_primes(
+        uint32_t limit,
+        uint32_t **primes,
+        uint32_t *count
+) {
+    uint32_t *lp, *pr, *odd, i, j, np;
+
+    lp = (uint32_t *)calloc((size_t)limit + 1, sizeof(uint32_t));
+    pr = (uint32_t *)malloc(((size_t)limit / 2 + 1) * sizeof(uint32_t));
+    if (lp == NULL || pr == NULL) {
+        free(lp);
+        free(pr);
+        return SV_MEM_ERROR;
+    }
+
+    np = 0;
+    for (i = 2; i <= limit; i++) {
+        if (lp[i] == 0) {
+            lp[i] = i;
+            pr[np++] = i;
+        }
+        for (j = 0; j < np && pr[j] <= lp[i] && (uint64_t)i * pr[j] <= limit; j++) {
+            lp[i * pr[j]] = pr[j];
+        }
+    }
+    free(lp);
+
+    /* the table only describes odd numbers, so 2 is left out */
+    odd = (uint32_t *)malloc((np ? np : 1) * sizeof(uint32_t));
+    if (odd == NULL) {
+        free(pr);
+        return SV_MEM_ERROR;
+    }
+    *count = 0;
+    for (j = 0; j < np; j++) {
+        if (pr[j] != 2) {
+            odd[(*count)++] = pr[j];
+        }
+    }
+    free(pr);
+    *primes = odd;
+    return SV_SUCCESS;
+}
+
+/* Fill entries [k0, k1): ascending primes claim the entries still unset */
+static void fill_segment(
+        SpfTable *table,
+        uint64_t k0,
+        uint64_t k1
+) {
+    uint64_t lo, hi, m, k, p;
+    uint32_t i;
+
+    lo = 2 * k0 + 1;
+    hi = 2 * k1 - 1;
+    for (i = 0; i < table->num_primes; i++) {
+        p = table->primes[i];
+        if (p * p > hi) {
+            break;
+        }
+        m = lo + (p - lo % p) % p;
+        if (!(m & 1)) {
+            m += p;
+        }
+        if (m < p * p) {
+            m = p * p;
+        }
+        for (k = (m - 1) / 2; k < k1; k += p) {
+            if (table->spf[k] == 0) {
+                table->spf[k] = (uint16_t)(i + 1);
+            }
+        }
+    }
+    if (k0 == 0) {
+        /* 1 is not prime, but it has no factor to record either */
+        table->spf[0] = 0;
+    }
+}
+
+static void *spf_worker(
+        void *arg
+) {
+    SpfWorker *w = (SpfWorker *)arg;
+    uint64_t s, k0, k1;
+
+    for (s = w->tid; s < w->num_segments; s += w->nthreads) {
+        k0 = s * SPF_SEGMENT_ENTRIES;
+        k1 = k0 + SPF_SEGMENT_ENTRIES;
+        if (k1 > w->table->entries) {
+            k1 = w->table->entries;
+        }
+        fill_segment(w->table, k0, k1);
+    }
+    return NULL;
+}
@@ -0,0 +1,244 @@
+/**
+ * @file    test_bitset.c
+ * @brief   Test program for the bitset module.
+ */
+
+#include "unity.h"
+#include "bitset.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Deterministic pseudo-random bits (xorshift64) */
+static uint64_t rng_state = 88172645463325252ULL;
+
+static uint64_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+/* Fill a bitset with random bits, one bitset_set at a time */
+static Bitset *random_bitset(uint64_t nbits) {
+    Bitset *bs = init_bitset(nbits);
+    uint64_t i;
+
+    TEST_ASSERT_NOT_NULL(bs);
+    for (i = 0; i < nbits; i++) {
+        if (next_random() & 1) {
+            bitset_set(bs, i);
+        }
+    }
+    return bs;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/* --------------------------------------------------------------------------
+   BasicTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Storage is aligned and zeroed; single bits round-trip.
+ */
+void test_set_clear_test(void)
+{
+    Bitset *bs = init_bitset(1000);
+    uint64_t i;
+
+    TEST_ASSERT_NOT_NULL(bs);
+    TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t)bs->words % BITSET_ALIGN);
+    TEST_ASSERT_EQUAL_UINT64(16, bs->nwords);
+    TEST_ASSERT_EQUAL_UINT64(0, bitset_popcount(bs));
+
+    for (i = 0; i < 1000; i += 3) {
+        bitset_set(bs, i);
+    }
+    for (i = 0; i < 1000; i++) {
+        TEST_ASSERT_EQUAL_INT(i % 3 == 0, bitset_test(bs, i));
+    }
+    bitset_clear(bs, 999);
+    bitset_clear(bs, 1);
+    TEST_ASSERT_EQUAL_INT(0, bitset_test(bs, 999));
+    TEST_ASSERT_EQUAL_UINT64(333, bitset_popcount(bs));
+    free_bitset(bs);
+}
+
+/**
+ * @brief Range fills hit exactly [lo, hi) across word boundaries.
+ */
+void test_ranges(void)
+{
+    const uint64_t cases[][2] = {{0, 0}, {5, 6}, {3, 60}, {60, 70}, {64, 128},
+                                 {1, 499}, {130, 300}, {0, 500}};
+    Bitset *bs = init_bitset(500);
+    uint64_t c, i;
+
+    for (c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        bitset_clear_range(bs, 0, 500);
+        bitset_set_range(bs, cases[c][0], cases[c][1]);
+        for (i = 0; i < 500; i++) {
+            TEST_ASSERT_EQUAL_INT(i >= cases[c][0] && i < cases[c][1], bitset_test(bs, i));
+        }
+        TEST_ASSERT_EQUAL_UINT64(cases[c][1] - cases[c][0], bitset_popcount(bs));
+
+        bitset_set_range(bs, 0, 500);
+        bitset_clear_range(bs, cases[c][0], cases[c][1]);
+        TEST_ASSERT_EQUAL_UINT64(500 - (cases[c][1] - cases[c][0]), bitset_popcount(bs));
+    }
+
+    /* ranges are clipped to nbits, leaving the padding clear */
+    bitset_set_range(bs, 490, 10000);
+    TEST_ASSERT_EQUAL_UINT64(0, bs->words[7] >> (500 % 64));
+    free_bitset(bs);
+}
+
+/* --------------------------------------------------------------------------
+   AdvancedTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Popcount and rank agree with bit-by-bit counting on long sets.
+ */
+void test_popcount_and_rank(void)
+{
+    Bitset *bs = random_bitset(100003);
+    uint64_t i, count;
+
+    count = 0;
+    for (i = 0; i <= 100003; i++) {
+        if (i % 61 == 0 || i > 99900) {
+            TEST_ASSERT_EQUAL_UINT64(count, bitset_rank(bs, i));
+        }
+        if (i < 100003) {
+            count += (uint64_t)bitset_test(bs, i);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT64(count, bitset_popcount(bs));
+    TEST_ASSERT_EQUAL_UINT64(count, bitset_popcount_words(bs->words, bs->nwords));
+    TEST_ASSERT_EQUAL_UINT64(bitset_rank(bs, 641), bitset_popcount_words(bs->words, 10) +
+            (uint64_t)__builtin_popcountll(bs->words[10] & 1));
+    free_bitset(bs);
+}
+
+/**
+ * @brief Forward and backward scans visit exactly the expected bits.
+ */
+void test_scans(void)
+{
+    Bitset *bs = random_bitset(5000);
+    uint64_t i, expected;
+
+    for (i = 0; i < 5000; i++) {
+        for (expected = i; expected < 5000 && !bitset_test(bs, expected); expected++) {
+        }
+        TEST_ASSERT_EQUAL_UINT64(expected < 5000 ? expected : BITSET_NONE,
+                bitset_next_set(bs, i));
+        for (expected = i; expected < 5000 && bitset_test(bs, expected); expected++) {
+        }
+        TEST_ASSERT_EQUAL_UINT64(expected < 5000 ? expected : BITSET_NONE,
+                bitset_next_unset(bs, i));
+        for (expected = i + 1; expected > 0 && !bitset_test(bs, expected - 1); expected--) {
+        }
+        TEST_ASSERT_EQUAL_UINT64(expected > 0 ? expected - 1 : BITSET_NONE,
+                bitset_prev_set(bs, i));
+    }
+    free_bitset(bs);
+}
+
+/**
+ * @brief AND, OR and ANDNOT combine word by word.
+ */
+void test_logical_ops(void)
+{
+    Bitset *a = random_bitset(777), *b = random_bitset(777);
+    Bitset *x = init_bitset(777);
+    uint64_t i;
+    int va, vb;
+
+    TEST_ASSERT_EQUAL_INT(BS_SUCCESS, bitset_or(x, a));
+    TEST_ASSERT_EQUAL_INT(BS_SUCCESS, bitset_and(x, b));
+    for (i = 0; i < 777; i++) {
+        TEST_ASSERT_EQUAL_INT(bitset_test(a, i) && bitset_test(b, i), bitset_test(x, i));
+    }
+
+    bitset_clear_range(x, 0, 777);
+    TEST_ASSERT_EQUAL_INT(BS_SUCCESS, bitset_or(x, a));
+    TEST_ASSERT_EQUAL_INT(BS_SUCCESS, bitset_andnot(x, b));
+    for (i = 0; i < 777; i++) {
+        TEST_ASSERT_EQUAL_INT(bitset_test(a, i) && !bitset_test(b, i), bitset_test(x, i));
+    }
+
+    TEST_ASSERT_EQUAL_INT(BS_SUCCESS, bitset_or(x, b));
+    for (i = 0; i < 777; i++) {
+        va = bitset_test(a, i);
+        vb = bitset_test(b, i);
+        TEST_ASSERT_EQUAL_INT(va || vb, bitset_test(x, i));
+    }
+    free_bitset(a);
+    free_bitset(b);
+    free_bitset(x);
+}
+
+/* --------------------------------------------------------------------------
+   EdgeCaseTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Empty sets, out-of-range scans and mismatched sizes.
+ */
+void test_edge_cases(void)
+{
+    Bitset *empty = init_bitset(0), *small = init_bitset(64), *other = init_bitset(65);
+
+    TEST_ASSERT_NOT_NULL(empty);
+    TEST_ASSERT_EQUAL_UINT64(0, bitset_popcount(empty));
+    TEST_ASSERT_EQUAL_UINT64(0, bitset_rank(empty, 10));
+    TEST_ASSERT_EQUAL_UINT64(BITSET_NONE, bitset_next_set(empty, 0));
+    TEST_ASSERT_EQUAL_UINT64(BITSET_NONE, bitset_next_unset(empty, 0));
+    TEST_ASSERT_EQUAL_UINT64(BITSET_NONE, bitset_prev_set(empty, 0));
+
+    bitset_set_range(small, 0, 64);
+    TEST_ASSERT_EQUAL_UINT64(64, bitset_popcount(small));
+    TEST_ASSERT_EQUAL_UINT64(BITSET_NONE, bitset_next_unset(small, 0));
+    TEST_ASSERT_EQUAL_UINT64(63, bitset_prev_set(small, 1000));
+    TEST_ASSERT_EQUAL_UINT64(BITSET_NONE, bitset_next_set(small, 64));
+
+    TEST_ASSERT_EQUAL_INT(BS_INVALID_ARG, bitset_and(small, other));
+    TEST_ASSERT_EQUAL_INT(BS_INVALID_ARG, bitset_or(NULL, other));
+    TEST_ASSERT_EQUAL_INT(BS_INVALID_ARG, bitset_andnot(small, NULL));
+
+    free_bitset(empty);
+    free_bitset(small);
+    free_bitset(other);
+    free_bitset(NULL);
+}
+
+/* --------------------------------------------------------------------------
+   Test Runner
+ * -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    /* BasicTests */
+    RUN_TEST(test_set_clear_test);
+    RUN_TEST(test_ranges);
+
+    /* AdvancedTests */
+    RUN_TEST(test_popcount_and_rank);
+    RUN_TEST(test_scans);
+    RUN_TEST(test_logical_ops);
+
+    /* EdgeCaseTests */
+    RUN_TEST(test_edge_cases);
+
+    return UNITY_END();
+}
@@ -0,0 +1,136 @@
+/**
+ * @file    test_prime_count.c
+ * @brief   Test program for Meissel-Lehmer prime counting.
+ */
+
+#include "unity.h"
+#include "prime_count.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/* --------------------------------------------------------------------------
+   BasicTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Small published values, including the sieve fallback range.
+ */
+void test_known_small_values(void)
+{
+    const uint64_t x[] = {0, 1, 2, 3, 10, 100, 1000, 10000, 100000, 1000000};
+    const uint64_t expected[] = {0, 0, 1, 2, 4, 25, 168, 1229, 9592, 78498};
+    uint64_t count;
+    size_t i;
+
+    for (i = 0; i < sizeof(x) / sizeof(x[0]); i++) {
+        TEST_ASSERT_EQUAL_INT(SV_SUCCESS, prime_count(x[i], 1, &count));
+        TEST_ASSERT_EQUAL_UINT64(expected[i], count);
+    }
+}
+
+/**
+ * @brief The formula agrees with a plain sieve count.
+ */
+void test_matches_sieve(void)
+{
+    uint64_t x, formula, sieved;
+
+    for (x = 100000; x <= 50000000; x = x * 3 + 7) {
+        TEST_ASSERT_EQUAL_INT(SV_SUCCESS, prime_count(x, 2, &formula));
+        TEST_ASSERT_EQUAL_INT(SV_SUCCESS, prime_count_sieve(x, &sieved));
+        TEST_ASSERT_EQUAL_UINT64(sieved, formula);
+    }
+}
+
+/* --------------------------------------------------------------------------
+   AdvancedTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Published values of pi(10^k) out of reach of a quick sieve.
+ */
+void test_known_large_values(void)
+{
+    uint64_t count;
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, prime_count(10000000000ULL, 0, &count));
+    TEST_ASSERT_EQUAL_UINT64(455052511ULL, count);
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, prime_count(100000000000ULL, 0, &count));
+    TEST_ASSERT_EQUAL_UINT64(4118054813ULL, count);
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, prime_count(1000000000000ULL, 0, &count));
+    TEST_ASSERT_EQUAL_UINT64(37607912018ULL, count);
+}
+
+/**
+ * @brief Results do not depend on how the work is split.
+ */
+void test_thread_counts_agree(void)
+{
+    uint64_t single, many;
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, prime_count(987654321ULL, 1, &single));
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, prime_count(987654321ULL, 7, &many));
+    TEST_ASSERT_EQUAL_UINT64(single, many);
+}
+
+/* --------------------------------------------------------------------------
+   EdgeCaseTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Both sides of a prime square and of a cube root step.
+ */
+void test_boundaries(void)
+{
+    const uint64_t x[] = {1018080, 1018081, 1018082, 1000999, 1061208, 1061209};
+    uint64_t formula, sieved;
+    size_t i;
+
+    for (i = 0; i < sizeof(x) / sizeof(x[0]); i++) {
+        TEST_ASSERT_EQUAL_INT(SV_SUCCESS, prime_count(x[i], 3, &formula));
+        TEST_ASSERT_EQUAL_INT(SV_SUCCESS, prime_count_sieve(x[i], &sieved));
+        TEST_ASSERT_EQUAL_UINT64(sieved, formula);
+    }
+}
+
+/**
+ * @brief Out-of-range input and missing outputs are rejected.
+ */
+void test_invalid_args(void)
+{
+    uint64_t count;
+
+    TEST_ASSERT_EQUAL_INT(SV_INVALID_ARG, prime_count(100, 1, NULL));
+    TEST_ASSERT_EQUAL_INT(SV_INVALID_ARG, prime_count(PRIME_COUNT_MAX + 1, 1, &count));
+}
+
+/* --------------------------------------------------------------------------
+   Test Runner
+ * -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    /* BasicTests */
+    RUN_TEST(test_known_small_values);
+    RUN_TEST(test_matches_sieve);
+
+    /* AdvancedTests */
+    RUN_TEST(test_known_large_values);
+    RUN_TEST(test_thread_counts_agree);
+
+    /* EdgeCaseTests */
+    RUN_TEST(test_boundaries);
+    RUN_TEST(test_invalid_args);
+
+    return UNITY_END();
+}
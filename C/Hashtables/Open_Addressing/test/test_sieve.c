@@ -0,0 +1,386 @@
+/**
+ * @file    test_sieve.c
+ * @brief   Test program for the segmented, bucket and range sieves.
+ */
+
+#include "unity.h"
+#include "sieve.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+/* --------------------------------------------------------------------------
+   Reference primality test (deterministic Miller-Rabin for 64-bit n)
+ * -------------------------------------------------------------------------- */
+__extension__ typedef unsigned __int128 u128;
+
+static uint64_t mulmod(uint64_t a, uint64_t b, uint64_t m) {
+    return (uint64_t)((u128)a * b % m);
+}
+
+static uint64_t powmod(uint64_t b, uint64_t e, uint64_t m) {
+    uint64_t r = 1;
+    b %= m;
+    while (e) {
+        if (e & 1) {
+            r = mulmod(r, b, m);
+        }
+        b = mulmod(b, b, m);
+        e >>= 1;
+    }
+    return r;
+}
+
+static int is_prime_reference(uint64_t n) {
+    static const uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    uint64_t d, x;
+    int s, i, r;
+
+    if (n < 2) {
+        return 0;
+    }
+    for (i = 0; i < 12; i++) {
+        if (n % bases[i] == 0) {
+            return n == bases[i];
+        }
+    }
+    d = n - 1;
+    s = 0;
+    while (!(d & 1)) {
+        d >>= 1;
+        s++;
+    }
+    for (i = 0; i < 12; i++) {
+        x = powmod(bases[i], d, n);
+        if (x == 1 || x == n - 1) {
+            continue;
+        }
+        for (r = 1; r < s; r++) {
+            x = mulmod(x, x, n);
+            if (x == n - 1) {
+                break;
+            }
+        }
+        if (r == s) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Collects enumerated primes and checks they arrive in increasing order */
+typedef struct {
+    uint64_t count;
+    uint64_t last;
+    uint64_t first;
+    int ordered;
+    int all_prime;
+} Collector;
+
+static int collect_prime(uint64_t prime, void *ctx) {
+    Collector *c = (Collector *)ctx;
+    if (c->count == 0) {
+        c->first = prime;
+    } else if (prime <= c->last) {
+        c->ordered = 0;
+    }
+    if (!is_prime_reference(prime)) {
+        c->all_prime = 0;
+    }
+    c->last = prime;
+    c->count++;
+    return 0;
+}
+
+static int stop_at_first(uint64_t prime, void *ctx) {
+    *(uint64_t *)ctx = prime;
+    return 1;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/* --------------------------------------------------------------------------
+   BasicTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief The base prime sieve returns the odd primes up to its limit.
+ */
+void test_odd_primes_small(void)
+{
+    const uint32_t expected[] = {3, 5, 7, 11, 13, 17, 19, 23, 29};
+    uint32_t *primes;
+    size_t count;
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, sieve_odd_primes(30, &primes, &count));
+    TEST_ASSERT_EQUAL_UINT32(9, count);
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, primes, 9);
+    free(primes);
+}
+
+/**
+ * @brief Small and degenerate ranges, including the even prime.
+ */
+void test_count_small_ranges(void)
+{
+    uint64_t count;
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, sieve_count_primes(0, 1, SIEVE_BUCKET, &count));
+    TEST_ASSERT_EQUAL_UINT64(0, count);
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, sieve_count_primes(2, 2, SIEVE_BUCKET, &count));
+    TEST_ASSERT_EQUAL_UINT64(1, count);
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, sieve_count_primes(0, 10, SIEVE_SEGMENTED, &count));
+    TEST_ASSERT_EQUAL_UINT64(4, count);
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, sieve_count_primes(24, 28, SIEVE_SEGMENTED, &count));
+    TEST_ASSERT_EQUAL_UINT64(0, count);
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, sieve_count_primes(97, 97, SIEVE_BUCKET, &count));
+    TEST_ASSERT_EQUAL_UINT64(1, count);
+}
+
+/**
+ * @brief pi(10^7) = 664579 in both modes (spans many windows).
+ */
+void test_count_pi_10_7(void)
+{
+    uint64_t segmented, bucket;
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS,
+            sieve_count_primes(0, 10000000, SIEVE_SEGMENTED, &segmented));
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS,
+            sieve_count_primes(0, 10000000, SIEVE_BUCKET, &bucket));
+    TEST_ASSERT_EQUAL_UINT64(664579, segmented);
+    TEST_ASSERT_EQUAL_UINT64(664579, bucket);
+}
+
+/* --------------------------------------------------------------------------
+   AdvancedTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Far windows agree between modes and contain only true primes.
+ */
+void test_far_window_matches_reference(void)
+{
+    const uint64_t lo = 1000000000000ULL, hi = lo + 200000;
+    Collector c = {0, 0, 0, 1, 1};
+    uint64_t n, expected = 0, segmented;
+
+    for (n = lo; n <= hi; n++) {
+        expected += (uint64_t)is_prime_reference(n);
+    }
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS,
+            sieve_foreach_prime(lo, hi, SIEVE_BUCKET, collect_prime, &c));
+    TEST_ASSERT_EQUAL_UINT64(expected, c.count);
+    TEST_ASSERT_TRUE(c.ordered);
+    TEST_ASSERT_TRUE(c.all_prime);
+    TEST_ASSERT_EQUAL_UINT64(1000000000039ULL, c.first);
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS,
+            sieve_count_primes(lo, hi, SIEVE_SEGMENTED, &segmented));
+    TEST_ASSERT_EQUAL_UINT64(expected, segmented);
+}
+
+/**
+ * @brief Modes agree over a window long enough for primes whose square lies
+ *        many windows past the start.
+ */
+void test_long_window_modes_agree(void)
+{
+    const uint64_t lo = 1000000000000ULL, hi = lo + 30000000;
+    uint64_t segmented, bucket;
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS,
+            sieve_count_primes(lo, hi, SIEVE_SEGMENTED, &segmented));
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS,
+            sieve_count_primes(lo, hi, SIEVE_BUCKET, &bucket));
+    TEST_ASSERT_EQUAL_UINT64(segmented, bucket);
+}
+
+/**
+ * @brief Parallel counts match the serial count for any thread count.
+ */
+void test_parallel_count_matches(void)
+{
+    uint64_t serial, parallel;
+    unsigned threads;
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS,
+            sieve_count_primes(0, 20000000, SIEVE_SEGMENTED, &serial));
+    for (threads = 1; threads <= 5; threads++) {
+        TEST_ASSERT_EQUAL_INT(SV_SUCCESS, sieve_count_primes_parallel(0, 20000000,
+                (threads & 1) ? SIEVE_BUCKET : SIEVE_SEGMENTED, threads, &parallel));
+        TEST_ASSERT_EQUAL_UINT64(serial, parallel);
+    }
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, sieve_count_primes_parallel(2, 3, SIEVE_BUCKET, 8, &parallel));
+    TEST_ASSERT_EQUAL_UINT64(2, parallel);
+}
+
+/**
+ * @brief The bucket sieve reaches windows near 10^15 and stops on request.
+ */
+void test_bucket_near_10_15(void)
+{
+    const uint64_t lo = 1000000000000000ULL;
+    uint64_t prime = 0;
+
+    TEST_ASSERT_EQUAL_INT(SV_STOPPED,
+            sieve_foreach_prime(lo, lo + 1000000, SIEVE_BUCKET, stop_at_first, &prime));
+    TEST_ASSERT_EQUAL_UINT64(1000000000000037ULL, prime);
+}
+
+/* --------------------------------------------------------------------------
+   RangeSieveTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Every query on a window near 10^12 agrees with the reference test.
+ */
+void test_range_matches_reference(void)
+{
+    const uint64_t lo = 1000000000000ULL - 500, hi = lo + 3000;
+    Collector c = {0, 0, 0, 1, 1};
+    RangeSieve *rs;
+    uint64_t n, expected = 0;
+
+    rs = init_range_sieve(lo, hi);
+    TEST_ASSERT_NOT_NULL(rs);
+
+    for (n = lo - 5; n <= hi + 5; n++) {
+        int in_range = (n >= lo && n <= hi);
+        TEST_ASSERT_EQUAL_INT(in_range && is_prime_reference(n), range_is_prime(rs, n));
+        expected += (uint64_t)(in_range && is_prime_reference(n));
+    }
+    TEST_ASSERT_EQUAL_UINT64(expected, range_count_primes(rs));
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, range_foreach_prime(rs, collect_prime, &c));
+    TEST_ASSERT_EQUAL_UINT64(expected, c.count);
+    TEST_ASSERT_TRUE(c.ordered);
+    TEST_ASSERT_TRUE(c.all_prime);
+
+    TEST_ASSERT_EQUAL_UINT64(1000000000039ULL, range_next_prime(rs, 1000000000000ULL));
+    TEST_ASSERT_EQUAL_UINT64(1000000000039ULL, range_next_prime(rs, 1000000000039ULL));
+    TEST_ASSERT_EQUAL_UINT64(c.first, range_next_prime(rs, 0));
+    TEST_ASSERT_EQUAL_UINT64(c.last, range_prev_prime(rs, hi + 100));
+    TEST_ASSERT_EQUAL_UINT64(c.first, range_prev_prime(rs, c.first + 1));
+    TEST_ASSERT_EQUAL_UINT64(0, range_prev_prime(rs, c.first - 1));
+    TEST_ASSERT_EQUAL_UINT64(0, range_next_prime(rs, c.last + 1));
+
+    free_range_sieve(rs);
+}
+
+/**
+ * @brief Windows touching zero handle 0, 1 and 2 correctly.
+ */
+void test_range_low_window(void)
+{
+    RangeSieve *rs;
+
+    rs = init_range_sieve(0, 100);
+    TEST_ASSERT_NOT_NULL(rs);
+    TEST_ASSERT_EQUAL_UINT64(25, range_count_primes(rs));
+    TEST_ASSERT_FALSE(range_is_prime(rs, 0));
+    TEST_ASSERT_FALSE(range_is_prime(rs, 1));
+    TEST_ASSERT_TRUE(range_is_prime(rs, 2));
+    TEST_ASSERT_TRUE(range_is_prime(rs, 97));
+    TEST_ASSERT_EQUAL_UINT64(2, range_next_prime(rs, 0));
+    TEST_ASSERT_EQUAL_UINT64(3, range_next_prime(rs, 3));
+    TEST_ASSERT_EQUAL_UINT64(2, range_prev_prime(rs, 2));
+    TEST_ASSERT_EQUAL_UINT64(0, range_prev_prime(rs, 1));
+    TEST_ASSERT_EQUAL_UINT64(89, range_prev_prime(rs, 96));
+    free_range_sieve(rs);
+
+    rs = init_range_sieve(1, 1);
+    TEST_ASSERT_NOT_NULL(rs);
+    TEST_ASSERT_EQUAL_UINT64(0, range_count_primes(rs));
+    TEST_ASSERT_EQUAL_UINT64(0, range_next_prime(rs, 0));
+    free_range_sieve(rs);
+
+    TEST_ASSERT_NULL(init_range_sieve(5, 4));
+}
+
+/**
+ * @brief A multi-window range near 10^15 matches the streaming count.
+ */
+void test_range_far_multi_window(void)
+{
+    const uint64_t lo = 1000000000000000ULL, hi = lo + 2 * SIEVE_SEGMENT_BITS * 3 + 17;
+    RangeSieve *rs;
+    uint64_t count;
+
+    rs = init_range_sieve(lo, hi);
+    TEST_ASSERT_NOT_NULL(rs);
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, sieve_count_primes(lo, hi, SIEVE_SEGMENTED, &count));
+    TEST_ASSERT_EQUAL_UINT64(count, range_count_primes(rs));
+    TEST_ASSERT_EQUAL_UINT64(1000000000000037ULL, range_next_prime(rs, lo));
+    TEST_ASSERT_TRUE(is_prime_reference(range_prev_prime(rs, hi)));
+    free_range_sieve(rs);
+}
+
+/* --------------------------------------------------------------------------
+   EdgeCaseTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Invalid ranges and arguments are rejected.
+ */
+void test_invalid_args(void)
+{
+    uint64_t count;
+
+    TEST_ASSERT_EQUAL_INT(SV_INVALID_ARG, sieve_count_primes(10, 9, SIEVE_BUCKET, &count));
+    TEST_ASSERT_EQUAL_INT(SV_INVALID_ARG,
+            sieve_count_primes(0, SIEVE_LIMIT_MAX, SIEVE_BUCKET, &count));
+    TEST_ASSERT_EQUAL_INT(SV_INVALID_ARG, sieve_count_primes(0, 10, SIEVE_BUCKET, NULL));
+    TEST_ASSERT_EQUAL_INT(SV_INVALID_ARG,
+            sieve_foreach_prime(0, 10, SIEVE_BUCKET, NULL, NULL));
+}
+
+/**
+ * @brief isqrt_u64 is exact around perfect squares.
+ */
+void test_isqrt(void)
+{
+    TEST_ASSERT_EQUAL_UINT64(0, isqrt_u64(0));
+    TEST_ASSERT_EQUAL_UINT64(1, isqrt_u64(3));
+    TEST_ASSERT_EQUAL_UINT64(2, isqrt_u64(4));
+    TEST_ASSERT_EQUAL_UINT64(31622776, isqrt_u64(1000000000000000ULL));
+    TEST_ASSERT_EQUAL_UINT64(4294967295ULL, isqrt_u64(18446744073709551615ULL));
+}
+
+/* --------------------------------------------------------------------------
+   Test Runner
+ * -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    /* BasicTests */
+    RUN_TEST(test_odd_primes_small);
+    RUN_TEST(test_count_small_ranges);
+    RUN_TEST(test_count_pi_10_7);
+
+    /* AdvancedTests */
+    RUN_TEST(test_far_window_matches_reference);
+    RUN_TEST(test_long_window_modes_agree);
+    RUN_TEST(test_parallel_count_matches);
+    RUN_TEST(test_bucket_near_10_15);
+
+    /* RangeSieveTests */
+    RUN_TEST(test_range_matches_reference);
+    RUN_TEST(test_range_low_window);
+    RUN_TEST(test_range_far_multi_window);
+
+    /* EdgeCaseTests */
+    RUN_TEST(test_invalid_args);
+    RUN_TEST(test_isqrt);
+
+    return UNITY_END();
+}
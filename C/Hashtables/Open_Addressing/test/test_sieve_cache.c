@@ -0,0 +1,193 @@
+/**
+ * @file    test_sieve_cache.c
+ * @brief   Test program for the memory-mapped sieve cache file.
+ */
+
+#include "unity.h"
+#include "sieve_cache.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define CACHE_PATH "test_sieve_cache.bin"
+#define CACHE_LIMIT 3000000U
+
+/* Overwrite one byte of the cache file in place */
+static void corrupt_byte(long offset) {
+    FILE *fp;
+    int c;
+
+    fp = fopen(CACHE_PATH, "r+b");
+    TEST_ASSERT_NOT_NULL(fp);
+    fseek(fp, offset, SEEK_SET);
+    c = fgetc(fp);
+    fseek(fp, offset, SEEK_SET);
+    fputc(c ^ 0x5A, fp);
+    fclose(fp);
+}
+
+/* Open the cache, asserting success, and report whether it was rebuilt */
+static int open_and_close(uint64_t limit, unsigned flags) {
+    SieveCache *cache = NULL;
+    int rebuilt;
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, open_sieve_cache(CACHE_PATH, limit, flags, &cache));
+    rebuilt = sieve_cache_rebuilt(cache);
+    close_sieve_cache(cache);
+    return rebuilt;
+}
+
+void setUp(void)
+{
+    remove(CACHE_PATH);
+}
+
+void tearDown(void)
+{
+    remove(CACHE_PATH);
+}
+
+/* --------------------------------------------------------------------------
+   BasicTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief A fresh cache answers like the segmented sieve.
+ */
+void test_matches_sieve(void)
+{
+    SieveCache *cache = NULL;
+    RangeSieve *rs;
+    uint64_t n, count;
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, open_sieve_cache(CACHE_PATH, CACHE_LIMIT, 0, &cache));
+    TEST_ASSERT_EQUAL_INT(1, sieve_cache_rebuilt(cache));
+    TEST_ASSERT_EQUAL_UINT64(CACHE_LIMIT, sieve_cache_limit(cache));
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, sieve_count_primes(0, CACHE_LIMIT, SIEVE_SEGMENTED, &count));
+    TEST_ASSERT_EQUAL_UINT64(count, sieve_cache_prime_count(cache));
+
+    rs = init_range_sieve(0, CACHE_LIMIT);
+    TEST_ASSERT_NOT_NULL(rs);
+    for (n = 0; n <= CACHE_LIMIT + 1; n++) {
+        TEST_ASSERT_EQUAL_INT(n == 2 || range_is_prime(rs, n), sieve_cache_is_prime(cache, n));
+    }
+    for (n = 3; n <= CACHE_LIMIT; n += 997) {
+        TEST_ASSERT_EQUAL_UINT64(range_next_prime(rs, n), sieve_cache_next_prime(cache, n));
+    }
+    free_range_sieve(rs);
+    close_sieve_cache(cache);
+}
+
+/**
+ * @brief A second open maps the existing file; smaller limits reuse it too.
+ */
+void test_reopen_uses_file(void)
+{
+    SieveCache *cache = NULL;
+
+    TEST_ASSERT_EQUAL_INT(1, open_and_close(CACHE_LIMIT, 0));
+    TEST_ASSERT_EQUAL_INT(0, open_and_close(CACHE_LIMIT, 0));
+    TEST_ASSERT_EQUAL_INT(0, open_and_close(CACHE_LIMIT, SIEVE_CACHE_VERIFY));
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, open_sieve_cache(CACHE_PATH, 1000, 0, &cache));
+    TEST_ASSERT_EQUAL_INT(0, sieve_cache_rebuilt(cache));
+    TEST_ASSERT_EQUAL_UINT64(CACHE_LIMIT, sieve_cache_limit(cache));
+    TEST_ASSERT_EQUAL_INT(1, sieve_cache_is_prime(cache, 2999999));
+    close_sieve_cache(cache);
+}
+
+/* --------------------------------------------------------------------------
+   AdvancedTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Header damage is always caught; bitmap damage needs VERIFY.
+ */
+void test_corruption_rebuilds(void)
+{
+    TEST_ASSERT_EQUAL_INT(1, open_and_close(CACHE_LIMIT, 0));
+    corrupt_byte(16);
+    TEST_ASSERT_EQUAL_INT(1, open_and_close(CACHE_LIMIT, 0));
+    TEST_ASSERT_EQUAL_INT(0, open_and_close(CACHE_LIMIT, 0));
+
+    corrupt_byte(64 + 12345);
+    TEST_ASSERT_EQUAL_INT(0, open_and_close(CACHE_LIMIT, 0));
+    TEST_ASSERT_EQUAL_INT(1, open_and_close(CACHE_LIMIT, SIEVE_CACHE_VERIFY));
+    TEST_ASSERT_EQUAL_INT(0, open_and_close(CACHE_LIMIT, SIEVE_CACHE_VERIFY));
+}
+
+/**
+ * @brief A request beyond the file's limit rebuilds it larger.
+ */
+void test_larger_limit_rebuilds(void)
+{
+    TEST_ASSERT_EQUAL_INT(1, open_and_close(100000, 0));
+    TEST_ASSERT_EQUAL_INT(1, open_and_close(200000, 0));
+    TEST_ASSERT_EQUAL_INT(0, open_and_close(150000, 0));
+}
+
+/* --------------------------------------------------------------------------
+   EdgeCaseTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Tiny limits and the boundaries of the covered range.
+ */
+void test_small_limits(void)
+{
+    SieveCache *cache = NULL;
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, open_sieve_cache(CACHE_PATH, 0, 0, &cache));
+    TEST_ASSERT_EQUAL_UINT64(0, sieve_cache_prime_count(cache));
+    TEST_ASSERT_EQUAL_UINT64(0, sieve_cache_next_prime(cache, 0));
+    close_sieve_cache(cache);
+    remove(CACHE_PATH);
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS, open_sieve_cache(CACHE_PATH, 30, 0, &cache));
+    TEST_ASSERT_EQUAL_UINT64(10, sieve_cache_prime_count(cache));
+    TEST_ASSERT_EQUAL_UINT64(2, sieve_cache_next_prime(cache, 0));
+    TEST_ASSERT_EQUAL_UINT64(5, sieve_cache_next_prime(cache, 4));
+    TEST_ASSERT_EQUAL_UINT64(29, sieve_cache_next_prime(cache, 24));
+    TEST_ASSERT_EQUAL_UINT64(0, sieve_cache_next_prime(cache, 30));
+    TEST_ASSERT_EQUAL_INT(0, sieve_cache_is_prime(cache, 31));
+    close_sieve_cache(cache);
+}
+
+/**
+ * @brief Bad arguments and unwritable locations are reported.
+ */
+void test_invalid_args(void)
+{
+    SieveCache *cache = NULL;
+
+    TEST_ASSERT_EQUAL_INT(SV_INVALID_ARG, open_sieve_cache(NULL, 10, 0, &cache));
+    TEST_ASSERT_EQUAL_INT(SV_INVALID_ARG, open_sieve_cache(CACHE_PATH, 10, 0, NULL));
+    TEST_ASSERT_EQUAL_INT(SV_INVALID_ARG, open_sieve_cache(CACHE_PATH, 10, 0x80, &cache));
+    TEST_ASSERT_EQUAL_INT(SV_INVALID_ARG,
+            open_sieve_cache(CACHE_PATH, SIEVE_CACHE_LIMIT_MAX + 1, 0, &cache));
+    TEST_ASSERT_EQUAL_INT(SV_IO_ERROR,
+            open_sieve_cache("no_such_dir/cache.bin", 10, 0, &cache));
+}
+
+/* --------------------------------------------------------------------------
+   Test Runner
+ * -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    /* BasicTests */
+    RUN_TEST(test_matches_sieve);
+    RUN_TEST(test_reopen_uses_file);
+
+    /* AdvancedTests */
+    RUN_TEST(test_corruption_rebuilds);
+    RUN_TEST(test_larger_limit_rebuilds);
+
+    /* EdgeCaseTests */
+    RUN_TEST(test_small_limits);
+    RUN_TEST(test_invalid_args);
+
+    return UNITY_END();
+}
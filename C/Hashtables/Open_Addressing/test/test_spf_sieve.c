@@ -0,0 +1,200 @@
+/**
+ * @file    test_spf_sieve.c
+ * @brief   Test program for the smallest-prime-factor table.
+ */
+
+#include "unity.h"
+#include "spf_sieve.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define TABLE_LIMIT 2000000U
+
+/* Global table shared by all tests; built once by main */
+static SpfTable *table = NULL;
+
+/* Smallest prime factor by trial division */
+static uint32_t spf_reference(uint32_t n) {
+    uint32_t p;
+
+    if (n % 2 == 0) {
+        return 2;
+    }
+    for (p = 3; p * p <= n; p += 2) {
+        if (n % p == 0) {
+            return p;
+        }
+    }
+    return n;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/* --------------------------------------------------------------------------
+   BasicTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Lookups agree with trial division across the whole table.
+ */
+void test_lookup_matches_reference(void)
+{
+    uint32_t n;
+
+    TEST_ASSERT_EQUAL_UINT32(TABLE_LIMIT, spf_limit(table));
+    for (n = 2; n <= TABLE_LIMIT; n += (n < 100000) ? 1 : 97) {
+        TEST_ASSERT_EQUAL_UINT32(spf_reference(n), spf_lookup(table, n));
+    }
+    TEST_ASSERT_EQUAL_UINT32(spf_reference(TABLE_LIMIT), spf_lookup(table, TABLE_LIMIT));
+}
+
+/**
+ * @brief Factorisations are ascending, prime and multiply back to n.
+ */
+void test_factorize_products(void)
+{
+    uint32_t factors[SPF_MAX_FACTORS], n, product;
+    int count, i;
+
+    for (n = 2; n <= TABLE_LIMIT; n += (n < 50000) ? 1 : 1009) {
+        count = spf_factorize(table, n, factors, SPF_MAX_FACTORS);
+        TEST_ASSERT_GREATER_THAN_INT(0, count);
+        product = 1;
+        for (i = 0; i < count; i++) {
+            TEST_ASSERT_EQUAL_UINT32(factors[i], spf_lookup(table, factors[i]));
+            if (i > 0) {
+                TEST_ASSERT_TRUE(factors[i - 1] <= factors[i]);
+            }
+            product *= factors[i];
+        }
+        TEST_ASSERT_EQUAL_UINT32(n, product);
+    }
+}
+
+/**
+ * @brief Known factorisations, powers of two and a prime square.
+ */
+void test_factorize_known_values(void)
+{
+    const uint32_t expected_360[] = {2, 2, 2, 3, 3, 5};
+    const uint32_t expected_square[] = {1399, 1399};
+    uint32_t factors[SPF_MAX_FACTORS];
+    int i;
+
+    TEST_ASSERT_EQUAL_INT(6, spf_factorize(table, 360, factors, SPF_MAX_FACTORS));
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected_360, factors, 6);
+
+    TEST_ASSERT_EQUAL_INT(20, spf_factorize(table, 1U << 20, factors, SPF_MAX_FACTORS));
+    for (i = 0; i < 20; i++) {
+        TEST_ASSERT_EQUAL_UINT32(2, factors[i]);
+    }
+
+    TEST_ASSERT_EQUAL_INT(2, spf_factorize(table, 1399U * 1399U, factors, SPF_MAX_FACTORS));
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected_square, factors, 2);
+
+    TEST_ASSERT_EQUAL_INT(1, spf_factorize(table, 1999993, factors, SPF_MAX_FACTORS));
+    TEST_ASSERT_EQUAL_UINT32(1999993, factors[0]);
+}
+
+/**
+ * @brief The batch API packs factors behind CSR-style offsets.
+ */
+void test_factorize_batch(void)
+{
+    const uint32_t values[] = {12, 1, 97, 0, 1024, 999999};
+    const uint32_t expected[] = {2, 2, 3, 97, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+                                 3, 3, 3, 7, 11, 13, 37};
+    const size_t expected_offsets[] = {0, 3, 3, 4, 4, 14, 21};
+    uint32_t factors[6 * SPF_MAX_FACTORS];
+    size_t offsets[7];
+
+    TEST_ASSERT_EQUAL_INT(SV_SUCCESS,
+            spf_factorize_batch(table, values, 6, factors, 6 * SPF_MAX_FACTORS, offsets));
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, factors, 21);
+    TEST_ASSERT_EQUAL_MEMORY(expected_offsets, offsets, sizeof(expected_offsets));
+
+    TEST_ASSERT_EQUAL_INT(SV_NO_SPACE,
+            spf_factorize_batch(table, values, 6, factors, 10, offsets));
+}
+
+/* --------------------------------------------------------------------------
+   EdgeCaseTests
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Out-of-range values and small buffers are rejected.
+ */
+void test_invalid_args(void)
+{
+    uint32_t factors[4];
+
+    TEST_ASSERT_EQUAL_UINT32(0, spf_lookup(table, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, spf_lookup(table, 1));
+    TEST_ASSERT_EQUAL_UINT32(0, spf_lookup(table, TABLE_LIMIT + 1));
+    TEST_ASSERT_EQUAL_INT(SV_INVALID_ARG, spf_factorize(table, 1, factors, 4));
+    TEST_ASSERT_EQUAL_INT(SV_INVALID_ARG, spf_factorize(table, TABLE_LIMIT + 1, factors, 4));
+    TEST_ASSERT_EQUAL_INT(SV_NO_SPACE, spf_factorize(table, 1024, factors, 4));
+    TEST_ASSERT_EQUAL_INT(SV_NO_SPACE, spf_factorize(table, 2 * 3 * 5 * 7 * 11, factors, 4));
+}
+
+/**
+ * @brief Tables built with different thread counts are identical.
+ */
+void test_thread_counts_agree(void)
+{
+    SpfTable *single, *many;
+    uint32_t n;
+
+    single = init_spf_table(300007, 1);
+    many = init_spf_table(300007, 7);
+    TEST_ASSERT_NOT_NULL(single);
+    TEST_ASSERT_NOT_NULL(many);
+    for (n = 0; n <= 300008; n++) {
+        TEST_ASSERT_EQUAL_UINT32(spf_lookup(single, n), spf_lookup(many, n));
+    }
+    free_spf_table(single);
+    free_spf_table(many);
+
+    single = init_spf_table(0, 4);
+    TEST_ASSERT_NOT_NULL(single);
+    TEST_ASSERT_EQUAL_UINT32(0, spf_lookup(single, 2));
+    free_spf_table(single);
+}
+
+/* --------------------------------------------------------------------------
+   Test Runner
+ * -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    int result;
+
+    table = init_spf_table(TABLE_LIMIT, 0);
+    if (table == NULL) {
+        fprintf(stderr, "Failed to build the smallest-prime-factor table.\n");
+        return EXIT_FAILURE;
+    }
+
+    UNITY_BEGIN();
+
+    /* BasicTests */
+    RUN_TEST(test_lookup_matches_reference);
+    RUN_TEST(test_factorize_products);
+    RUN_TEST(test_factorize_known_values);
+    RUN_TEST(test_factorize_batch);
+
+    /* EdgeCaseTests */
+    RUN_TEST(test_invalid_args);
+    RUN_TEST(test_thread_counts_agree);
+
+    result = UNITY_END();
+    free_spf_table(table);
+    return result;
+}
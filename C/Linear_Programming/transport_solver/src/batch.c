@@ -0,0 +1,523 @@
+#define _POSIX_C_SOURCE 200809L  // sysconf, open_memstream
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "transport.h"
+#include "workspace.h"
+#include "min_cost_flow.h"
+#include "batch.h"
+
+/** Jobs in flight per worker, so queues stay stocked while the oldest result is awaited. */
+#define JOBS_PER_WORKER 4
+
+typedef struct BatchPool BatchPool;
+
+typedef enum {
+    JOB_FREE,
+    JOB_QUEUED,     // Read, waiting in a worker's queue or being solved
+    JOB_DONE        // Solved (or failed), waiting to be written
+} JobState;
+
+/**
+ * One problem in flight and, once solved, its formatted solution.
+ */
+typedef struct {
+    TransportProblem tp;
+    JobState state;
+    Boolean failed;
+    char *output;           // The solution as it is to be written
+    size_t output_length;
+} BatchJob;
+
+/**
+ * One worker of the pool with its queue of job numbers and the scratch
+ * space it solves in. Worker 0 is the calling thread.
+ */
+typedef struct {
+    BatchPool *pool;
+    int id;
+    pthread_t thread;
+    Boolean started;
+    pthread_mutex_t lock;   // Guards the queue
+    long *queue;            // Ring of job numbers, oldest first
+    int head, count;
+    SolverWorkspace ws;
+    Solution solution;
+} BatchWorker;
+
+struct BatchPool {
+    BatchWorker *workers;
+    int num_workers;
+    BatchJob *jobs;         // Ring of the jobs in flight; job k sits at k % window
+    int window;
+    AllocationMethod method;
+    Boolean use_modi;
+    SolutionFormat format;
+    pthread_mutex_t lock;   // Guards queued, stop and the job states
+    pthread_cond_t work;    // Signalled when a job is queued or the pool stops
+    pthread_cond_t done;    // Signalled when a job is finished
+    int queued;             // Jobs sitting in the queues
+    Boolean stop;
+};
+
+/**
+ * Makes sure a worker's workspace fits a problem, growing it to the
+ * largest problem the worker has seen.
+ *
+ * @param w Pointer to the worker.
+ * @param tp Pointer to the balanced problem.
+ * @return SOLVER_OK, or SOLVER_OUT_OF_MEMORY.
+ */
+static SolverStatus fit_workspace(
+        BatchWorker *w,
+        const TransportProblem *tp
+) {
+    int m = tp->supply_size, n = tp->demand_size;
+
+    if (check_workspace_fits(&w->ws, m, n) == SOLVER_OK) {
+        return SOLVER_OK;
+    }
+    if (w->ws.arena) {
+        if (w->ws.max_supply_size > m) m = w->ws.max_supply_size;
+        if (w->ws.max_demand_size > n) n = w->ws.max_demand_size;
+        free_solver_workspace(&w->ws);
+    }
+    return init_solver_workspace(&w->ws, m, n);
+}
+
+/**
+ * Solves a balanced problem into the worker's solution. The North-West
+ * Corner and Least Cost Methods run in the worker's workspace; VAM keeps
+ * its incremental penalties, which beat a workspace's scans on all but
+ * the smallest problems.
+ *
+ * @param w Pointer to the worker.
+ * @param tp Pointer to the balanced problem.
+ * @param total_cost Receives the total cost of the plan.
+ * @return SOLVER_OK, or the reason no plan was written.
+ */
+static SolverStatus solve_job(
+        BatchWorker *w,
+        TransportProblem *tp,
+        int *total_cost
+) {
+    SolverStatus status = SOLVER_OK;
+
+    switch (w->pool->method) {
+        case VOGELS_APPROXIMATION:
+            status = vogels_incremental_solve(tp, &w->solution, total_cost, FALSE);
+            break;
+        case NORTH_WEST_CORNER:
+            status = fit_workspace(w, tp);
+            if (status == SOLVER_OK) {
+                status = north_west_corner_solve(&w->ws, tp, &w->solution, total_cost, FALSE);
+            }
+            break;
+        case LEAST_COST:
+            status = fit_workspace(w, tp);
+            if (status == SOLVER_OK) {
+                status = least_cost_solve(&w->ws, tp, &w->solution, total_cost, FALSE);
+            }
+            break;
+        case NETWORK_SIMPLEX:
+            status = network_simplex_solve(tp, &w->solution, total_cost, FALSE);
+            break;
+        case SUCCESSIVE_SHORTEST_PATH:
+            status = min_cost_flow_solve(tp, &w->solution, MCF_SUCCESSIVE_SHORTEST_PATH, total_cost,
+                                         FALSE);
+            break;
+        case COST_SCALING:
+            status = min_cost_flow_solve(tp, &w->solution, MCF_COST_SCALING, total_cost, FALSE);
+            break;
+        default:
+            fprintf(stderr, "Method not implemented in throughput mode.\n");
+            exit(EXIT_FAILURE);
+    }
+    if (status == SOLVER_OK && w->pool->use_modi) {
+        status = modi_solve(tp, &w->solution, total_cost, FALSE);
+    }
+    return status;
+}
+
+/**
+ * Solves a job and formats its solution, then frees its problem and marks
+ * it done.
+ *
+ * @param w Pointer to the worker running the job.
+ * @param k Job number.
+ */
+static void run_job(
+        BatchWorker *w,
+        long k
+) {
+    BatchPool *pool = w->pool;
+    BatchJob *job = &pool->jobs[k % pool->window];
+    int total_cost = 0;
+    SolverStatus status;
+    FILE *out;
+
+    if (balance_transport_problem(&job->tp) != 0) {
+        status = SOLVER_QUANTITY_OVERFLOW;
+    } else {
+        reshape_solution(&w->solution, job->tp.supply_size, job->tp.demand_size);
+        status = solve_job(w, &job->tp, &total_cost);
+    }
+
+    job->output = NULL;
+    job->output_length = 0;
+    if (status == SOLVER_OK) {
+        out = open_memstream(&job->output, &job->output_length);
+        if (!out) {
+            fprintf(stderr, "Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        write_solution(out, &w->solution, total_cost, pool->format);
+        if (fclose(out) != 0) {
+            fprintf(stderr, "Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        fprintf(stderr, "Problem %ld: %s\n", k + 1, solver_status_message(status));
+    }
+    free_transport_problem(&job->tp);
+
+    pthread_mutex_lock(&pool->lock);
+    job->failed = (status == SOLVER_OK) ? FALSE : TRUE;
+    job->state = JOB_DONE;
+    pthread_cond_signal(&pool->done);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Queues a job with a worker.
+ *
+ * @param pool Pointer to the pool.
+ * @param id Worker to queue it with.
+ * @param k Job number.
+ */
+static void push_job(
+        BatchPool *pool,
+        int id,
+        long k
+) {
+    BatchWorker *w = &pool->workers[id];
+
+    pthread_mutex_lock(&pool->lock);
+    pool->jobs[k % pool->window].state = JOB_QUEUED;
+    pthread_mutex_lock(&w->lock);
+    w->queue[(w->head + w->count) % pool->window] = k;
+    w->count++;
+    pthread_mutex_unlock(&w->lock);
+    pool->queued++;
+    pthread_cond_signal(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Takes the oldest job of a worker's own queue or, when that is empty, of
+ * the next worker's that has one.
+ *
+ * @param pool Pointer to the pool.
+ * @param id Worker looking for work.
+ * @param k Receives the job number.
+ * @return TRUE if a job was taken.
+ */
+static Boolean take_job(
+        BatchPool *pool,
+        int id,
+        long *k
+) {
+    int v;
+
+    for (v = 0; v < pool->num_workers; v++) {
+        BatchWorker *victim = &pool->workers[(id + v) % pool->num_workers];
+        Boolean found = FALSE;
+
+        pthread_mutex_lock(&victim->lock);
+        if (victim->count > 0) {
+            *k = victim->queue[victim->head];
+            victim->head = (victim->head + 1) % pool->window;
+            victim->count--;
+            found = TRUE;
+        }
+        pthread_mutex_unlock(&victim->lock);
+
+        if (found) {
+            pthread_mutex_lock(&pool->lock);
+            pool->queued--;
+            pthread_mutex_unlock(&pool->lock);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * Thread body of a pool worker: runs jobs while any are queued.
+ *
+ * @param arg Pointer to the worker's BatchWorker.
+ * @return NULL once the pool is stopped and the queues are empty.
+ */
+static void *batch_worker(
+        void *arg
+) {
+    BatchWorker *w = (BatchWorker *)arg;
+    BatchPool *pool = w->pool;
+    long k;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->queued == 0 && !pool->stop) {
+            pthread_cond_wait(&pool->work, &pool->lock);
+        }
+        if (pool->queued == 0) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        if (take_job(pool, w->id, &k)) {
+            run_job(w, k);
+        }
+    }
+}
+
+/**
+ * Starts the worker threads of a pool; worker 0 is the calling thread. A
+ * thread that cannot be started leaves its queue to be emptied by the
+ * others.
+ *
+ * @param pool Pointer to the pool to initialise.
+ * @param num_workers Number of workers, the calling thread included.
+ * @param method Solution method.
+ * @param use_modi Boolean flag to optimise each solution with MODI.
+ * @param format Layout of the solutions.
+ */
+static void init_batch_pool(
+        BatchPool *pool,
+        int num_workers,
+        AllocationMethod method,
+        Boolean use_modi,
+        SolutionFormat format
+) {
+    int w;
+
+    pool->num_workers = num_workers;
+    pool->window = JOBS_PER_WORKER * num_workers;
+    pool->method = method;
+    pool->use_modi = use_modi;
+    pool->format = format;
+    pool->queued = 0;
+    pool->stop = FALSE;
+    pool->workers = (BatchWorker *)calloc(num_workers, sizeof(BatchWorker));
+    pool->jobs = (BatchJob *)calloc(pool->window, sizeof(BatchJob));
+    if (!pool->workers || !pool->jobs) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (pthread_mutex_init(&pool->lock, NULL) != 0 ||
+            pthread_cond_init(&pool->work, NULL) != 0 ||
+            pthread_cond_init(&pool->done, NULL) != 0) {
+        fprintf(stderr, "Thread pool initialisation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (w = 0; w < num_workers; w++) {
+        BatchWorker *worker = &pool->workers[w];
+
+        worker->pool = pool;
+        worker->id = w;
+        worker->queue = (long *)malloc(pool->window * sizeof(long));
+        if (!worker->queue || pthread_mutex_init(&worker->lock, NULL) != 0) {
+            fprintf(stderr, "Thread pool initialisation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        init_solution(&worker->solution, 1, 1);
+        worker->started = (w > 0 &&
+                pthread_create(&worker->thread, NULL, batch_worker, worker) == 0) ? TRUE : FALSE;
+    }
+}
+
+/**
+ * Stops and joins the worker threads and frees the pool. Every job must be
+ * written by then.
+ *
+ * @param pool Pointer to the pool.
+ */
+static void free_batch_pool(
+        BatchPool *pool
+) {
+    int w;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = TRUE;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (w = 0; w < pool->num_workers; w++) {
+        BatchWorker *worker = &pool->workers[w];
+
+        if (worker->started) {
+            pthread_join(worker->thread, NULL);
+        }
+        pthread_mutex_destroy(&worker->lock);
+        free(worker->queue);
+        free_solver_workspace(&worker->ws);
+        free_solution(&worker->solution);
+    }
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->work);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool->jobs);
+}
+
+/**
+ * Writes the finished jobs at the front of the window, in input order.
+ *
+ * @param pool Pointer to the pool.
+ * @param written Number of jobs written so far.
+ * @param out Destination stream.
+ * @param failures Incremented for each job that failed.
+ * @return The new number of jobs written.
+ */
+static long write_finished_jobs(
+        BatchPool *pool,
+        long written,
+        FILE *out,
+        int *failures
+) {
+    for (;;) {
+        BatchJob *job = &pool->jobs[written % pool->window];
+        Boolean done;
+
+        pthread_mutex_lock(&pool->lock);
+        done = (job->state == JOB_DONE) ? TRUE : FALSE;
+        pthread_mutex_unlock(&pool->lock);
+        if (!done) {
+            return written;
+        }
+
+        if (job->failed) {
+            (*failures)++;
+        } else {
+            fwrite(job->output, 1, job->output_length, out);
+        }
+        free(job->output);
+        job->output = NULL;
+        job->state = JOB_FREE;
+        written++;
+    }
+}
+
+/**
+ * Reads the next problem, moving on through the streams as each one ends.
+ *
+ * @param paths Stream files, or "-" for standard input.
+ * @param count Number of stream files.
+ * @param next Index of the next stream file to open.
+ * @param stream The open stream, or NULL if none is open.
+ * @param tp Pointer to the TransportationProblem structure to fill.
+ * @return 1 if a problem was read, 0 after the last one, -1 on error.
+ */
+static int next_problem(
+        char *const *paths,
+        int count,
+        int *next,
+        ProblemStream **stream,
+        TransportProblem *tp
+) {
+    int got;
+
+    for (;;) {
+        if (!*stream) {
+            if (*next == count) {
+                return 0;
+            }
+            *stream = open_problem_stream(paths[(*next)++]);
+            if (!*stream) {
+                return -1;
+            }
+        }
+        got = read_stream_problem(*stream, tp);
+        if (got != 0) {
+            return got;
+        }
+        close_problem_stream(*stream);
+        *stream = NULL;
+    }
+}
+
+/**
+ * Solves every problem of the given streams on a pool of threads and
+ * writes the solutions in input order. Reading stops at the first bad
+ * problem; the problems before it are still solved and written.
+ *
+ * @param paths Stream files, or "-" for standard input.
+ * @param count Number of stream files.
+ * @param method Solution method; any but pvam.
+ * @param use_modi Boolean flag to optimise each solution with MODI.
+ * @param num_threads Number of threads; 0 or less uses one per online processor.
+ * @param out Destination stream.
+ * @param format Layout of the solutions.
+ * @return 0 if every problem was read and solved, -1 otherwise.
+ */
+int solve_problem_streams(
+        char *const *paths,
+        int count,
+        AllocationMethod method,
+        Boolean use_modi,
+        int num_threads,
+        FILE *out,
+        SolutionFormat format
+) {
+    BatchPool pool;
+    ProblemStream *stream = NULL;
+    long read = 0, written = 0, k;
+    int next = 0, failures = 0;
+    Boolean end = FALSE, bad_input = FALSE;
+
+    if (num_threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (online > 0) ? (int)online : 1;
+    }
+    init_batch_pool(&pool, num_threads, method, use_modi, format);
+
+    while (!end || written < read) {
+        written = write_finished_jobs(&pool, written, out, &failures);
+
+        // Keep the window full while there is input
+        if (!end && read - written < pool.window) {
+            int got = next_problem(paths, count, &next, &stream, &pool.jobs[read % pool.window].tp);
+            if (got == 1) {
+                push_job(&pool, (int)(read % pool.num_workers), read);
+                read++;
+            } else {
+                end = TRUE;
+                bad_input = (got < 0) ? TRUE : FALSE;
+            }
+            continue;
+        }
+        if (written == read) {
+            continue;
+        }
+
+        // Help with the queued jobs, or wait for the oldest one to finish
+        if (take_job(&pool, 0, &k)) {
+            run_job(&pool.workers[0], k);
+            continue;
+        }
+        pthread_mutex_lock(&pool.lock);
+        while (pool.jobs[written % pool.window].state != JOB_DONE) {
+            pthread_cond_wait(&pool.done, &pool.lock);
+        }
+        pthread_mutex_unlock(&pool.lock);
+    }
+
+    if (stream) {
+        close_problem_stream(stream);
+    }
+    free_batch_pool(&pool);
+    return (bad_input || failures > 0) ? -1 : 0;
+}
@@ -0,0 +1,22 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include "transport.h"
+
+/*
+ * Throughput mode.
+ *
+ * Solves every problem of one or more problem streams (see
+ * problem_file.c), many at a time. The calling thread reads the problems
+ * and deals them out to the queues of a pool of workers; a worker that
+ * runs out of work takes the oldest job of another worker's queue. Each
+ * worker keeps its own solver workspace and solution, so a solve allocates
+ * little beyond the problem itself. The solutions are written in the order
+ * the problems were read.
+ */
+
+int solve_problem_streams(char *const *paths, int count, AllocationMethod method, Boolean use_modi,
+                          int num_threads, FILE *out, SolutionFormat format);
+
+#endif // BATCH_H
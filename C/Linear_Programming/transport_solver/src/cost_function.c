@@ -0,0 +1,586 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include "cost_function.h"
+
+#if !defined(LINE_KERNELS_SCALAR) && (defined(__GNUC__) || defined(__clang__)) && \
+        (defined(__x86_64__) || defined(__i386__))
+#define COST_FUNCTION_X86 1
+#include <immintrin.h>
+#else
+#define COST_FUNCTION_X86 0
+#endif
+
+#define COST_BATCH 256              // Distances computed per pass of a row or column batch
+#define EARTH_DIAMETER_KM 12742.0176 // Twice the mean Earth radius
+#define DEGREES_TO_RADIANS 0.017453292519943295
+
+/**
+ * One side of a batch: the points the batch runs over. Distances are
+ * symmetric, so rows and columns are both "one fixed point against many".
+ */
+typedef struct {
+    const double *x;
+    const double *y;
+    const double *trig;   // Haversine trig blocks of this side
+    size_t stride;        // Points on this side, the length of each trig block
+} PointSet;
+
+/**
+ * Allocates a vector of count doubles, all set to value.
+ *
+ * @param count Number of values.
+ * @param value Initial value.
+ * @return The vector; release it with free().
+ */
+static double *alloc_doubles(
+        int count,
+        double value
+) {
+    double *v = (double *)malloc(((size_t)count + 1) * sizeof(double));
+    int k;
+
+    if (!v) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (k = 0; k < count; k++) {
+        v[k] = value;
+    }
+    return v;
+}
+
+/**
+ * Allocates a distance-based cost function. The caller fills in the
+ * coordinates and any per-point rate factors, then calls
+ * prepare_cost_function().
+ *
+ * @param metric COST_EUCLIDEAN, COST_MANHATTAN or COST_HAVERSINE.
+ * @param supply_size Number of supply points.
+ * @param demand_size Number of demand points.
+ * @param rate Cost per unit of distance.
+ * @return The cost function; release it with free_cost_function().
+ */
+CostFunction *init_cost_function(
+        CostMetric metric,
+        int supply_size,
+        int demand_size,
+        double rate
+) {
+    CostFunction *cf = (CostFunction *)calloc(1, sizeof(CostFunction));
+
+    if (!cf) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    cf->metric = metric;
+    cf->supply_size = supply_size;
+    cf->demand_size = demand_size;
+    cf->rate = rate;
+    cf->supply_x = alloc_doubles(supply_size, 0.0);
+    cf->supply_y = alloc_doubles(supply_size, 0.0);
+    cf->demand_x = alloc_doubles(demand_size, 0.0);
+    cf->demand_y = alloc_doubles(demand_size, 0.0);
+    cf->supply_rate = alloc_doubles(supply_size, 1.0);
+    cf->demand_rate = alloc_doubles(demand_size, 1.0);
+    return cf;
+}
+
+/**
+ * Allocates a cost function that asks a callback for every cost.
+ *
+ * @param supply_size Number of supply points.
+ * @param demand_size Number of demand points.
+ * @param callback Function computing the cost of a lane.
+ * @param context Passed to the callback unchanged.
+ * @return The cost function; release it with free_cost_function().
+ */
+CostFunction *init_cost_callback(
+        int supply_size,
+        int demand_size,
+        CostCallback callback,
+        void *context
+) {
+    CostFunction *cf = (CostFunction *)calloc(1, sizeof(CostFunction));
+
+    if (!cf) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    cf->metric = COST_CALLBACK;
+    cf->supply_size = supply_size;
+    cf->demand_size = demand_size;
+    cf->callback = callback;
+    cf->context = context;
+    return cf;
+}
+
+/**
+ * Converts degrees to the four trig blocks a haversine batch reads:
+ * cos and sin of the latitude, then cos and sin of the longitude.
+ *
+ * @param x Longitudes in degrees.
+ * @param y Latitudes in degrees.
+ * @param count Number of points.
+ * @return The trig blocks, 4 * count values.
+ */
+static double *haversine_trig(
+        const double *x,
+        const double *y,
+        int count
+) {
+    double *trig = alloc_doubles(4 * count, 0.0);
+    size_t n = (size_t)count;
+    int k;
+
+    for (k = 0; k < count; k++) {
+        trig[k] = cos(y[k] * DEGREES_TO_RADIANS);
+        trig[n + k] = sin(y[k] * DEGREES_TO_RADIANS);
+        trig[2 * n + k] = cos(x[k] * DEGREES_TO_RADIANS);
+        trig[3 * n + k] = sin(x[k] * DEGREES_TO_RADIANS);
+    }
+    return trig;
+}
+
+/**
+ * Precomputes what the evaluation needs from the coordinates and rates.
+ * Call it again after changing them.
+ *
+ * @param cf Pointer to the cost function.
+ */
+void prepare_cost_function(
+        CostFunction *cf
+) {
+    int i;
+
+    if (cf->metric == COST_CALLBACK) {
+        return;
+    }
+    free(cf->supply_scale);
+    cf->supply_scale = alloc_doubles(cf->supply_size, 0.0);
+    for (i = 0; i < cf->supply_size; i++) {
+        cf->supply_scale[i] = cf->rate * cf->supply_rate[i];
+    }
+    if (cf->metric == COST_HAVERSINE) {
+        free(cf->supply_trig);
+        free(cf->demand_trig);
+        cf->supply_trig = haversine_trig(cf->supply_x, cf->supply_y, cf->supply_size);
+        cf->demand_trig = haversine_trig(cf->demand_x, cf->demand_y, cf->demand_size);
+    }
+}
+
+/**
+ * Frees a cost function.
+ *
+ * @param cf Pointer to the cost function (may be NULL).
+ */
+void free_cost_function(
+        CostFunction *cf
+) {
+    if (!cf) {
+        return;
+    }
+    free(cf->supply_x);
+    free(cf->supply_y);
+    free(cf->demand_x);
+    free(cf->demand_y);
+    free(cf->supply_rate);
+    free(cf->demand_rate);
+    free(cf->supply_scale);
+    free(cf->supply_trig);
+    free(cf->demand_trig);
+    free(cf);
+}
+
+/**
+ * Maps a metric name from a problem file to its CostMetric.
+ *
+ * @param name Metric name; it does not need a terminating NUL.
+ * @param length Number of characters in name.
+ * @param metric Receives the metric.
+ * @return TRUE for euclidean, manhattan or haversine.
+ */
+Boolean parse_cost_metric(
+        const char *name,
+        size_t length,
+        CostMetric *metric
+) {
+    static const struct {
+        const char *name;
+        CostMetric metric;
+    } metrics[] = {
+        {"euclidean", COST_EUCLIDEAN},
+        {"manhattan", COST_MANHATTAN},
+        {"haversine", COST_HAVERSINE}
+    };
+    size_t k;
+
+    for (k = 0; k < sizeof(metrics) / sizeof(metrics[0]); k++) {
+        if (strlen(metrics[k].name) == length && strncmp(name, metrics[k].name, length) == 0) {
+            *metric = metrics[k].metric;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * Rounds a cost to the nearest integer, halves up, clamped to the int range.
+ *
+ * @param x Unrounded cost.
+ * @return The cost.
+ */
+static int round_cost(
+        double x
+) {
+    x = floor(x + 0.5);
+    if (x > INT_MAX) x = INT_MAX;
+    if (x < INT_MIN) x = INT_MIN;
+    return (int)x;
+}
+
+/**
+ * Turns the inner haversine term into a distance.
+ *
+ * @param h Haversine of the central angle.
+ * @return Great-circle distance in kilometres.
+ */
+static double haversine_distance(
+        double h
+) {
+    return EARTH_DIAMETER_KM * asin(sqrt(h));
+}
+
+/**
+ * Distance between a fixed point and point k of a set, before any asin.
+ * The operations are those of the vector batch, so the results agree bit
+ * for bit.
+ *
+ * @param cf Pointer to the cost function.
+ * @param fx Fixed point's x.
+ * @param fy Fixed point's y.
+ * @param ftrig Fixed point's trig values, each a block stride apart.
+ * @param fstride Block stride of ftrig.
+ * @param set Points the batch runs over.
+ * @param k Index in set.
+ * @return The distance, or the haversine term for COST_HAVERSINE.
+ */
+static double point_distance(
+        const CostFunction *cf,
+        double fx,
+        double fy,
+        const double *ftrig,
+        size_t fstride,
+        const PointSet *set,
+        size_t k
+) {
+    double dx, dy, a, cos_dlat, cos_dlon, h;
+
+    switch (cf->metric) {
+        case COST_EUCLIDEAN:
+            dx = fx - set->x[k];
+            dy = fy - set->y[k];
+            return sqrt(dx * dx + dy * dy);
+        case COST_MANHATTAN:
+            return fabs(fx - set->x[k]) + fabs(fy - set->y[k]);
+        default:
+            a = ftrig[0] * set->trig[k];
+            cos_dlat = a + ftrig[fstride] * set->trig[set->stride + k];
+            cos_dlon = ftrig[2 * fstride] * set->trig[2 * set->stride + k] +
+                       ftrig[3 * fstride] * set->trig[3 * set->stride + k];
+            h = (1.0 - cos_dlat) * 0.5 + a * ((1.0 - cos_dlon) * 0.5);
+            h = (h < 0.0) ? 0.0 : h;
+            return (h > 1.0) ? 1.0 : h;
+    }
+}
+
+/**
+ * Evaluates the cost of one lane.
+ *
+ * @param cf Pointer to the cost function.
+ * @param supply Supply point.
+ * @param demand Demand point.
+ * @return The cost; 0 on a lane to or from a dummy point.
+ */
+int cost_function_at(
+        const CostFunction *cf,
+        int supply,
+        int demand
+) {
+    PointSet set;
+    double d;
+
+    if (supply >= cf->supply_size || demand >= cf->demand_size) {
+        return 0;
+    }
+    if (cf->metric == COST_CALLBACK) {
+        return cf->callback(supply, demand, cf->context);
+    }
+    set.x = cf->demand_x;
+    set.y = cf->demand_y;
+    set.trig = cf->demand_trig;
+    set.stride = (size_t)cf->demand_size;
+    d = point_distance(cf, cf->supply_x[supply], cf->supply_y[supply],
+                       cf->supply_trig ? cf->supply_trig + supply : NULL,
+                       (size_t)cf->supply_size, &set, (size_t)demand);
+    if (cf->metric == COST_HAVERSINE) {
+        d = haversine_distance(d);
+    }
+    return round_cost(d * cf->supply_scale[supply] * cf->demand_rate[demand]);
+}
+
+/**
+ * Scalar batch: distances from a fixed point to set points first..first+len-1.
+ */
+static void scalar_distances(
+        const CostFunction *cf,
+        double fx,
+        double fy,
+        const double *ftrig,
+        size_t fstride,
+        const PointSet *set,
+        size_t first,
+        int len,
+        double *dist
+) {
+    int k;
+
+    for (k = 0; k < len; k++) {
+        dist[k] = point_distance(cf, fx, fy, ftrig, fstride, set, first + k);
+    }
+}
+
+/**
+ * Scalar batch: scales and rounds distances. The product is taken as
+ * (distance * first factor) * second factor, with the varying factor first
+ * for column batches and second for row batches, matching cost_function_at.
+ */
+static void scalar_scale(
+        const double *dist,
+        int len,
+        const double *factors,
+        double fixed,
+        Boolean varying_first,
+        int *out
+) {
+    int k;
+
+    for (k = 0; k < len; k++) {
+        out[k] = varying_first ? round_cost(dist[k] * factors[k] * fixed)
+                               : round_cost(dist[k] * fixed * factors[k]);
+    }
+}
+
+#if COST_FUNCTION_X86
+
+/**
+ * AVX2 batch: distances from a fixed point to set points first..first+len-1,
+ * four at a time, with the same operations as point_distance.
+ */
+__attribute__((target("avx2")))
+static void avx2_distances(
+        const CostFunction *cf,
+        double fx,
+        double fy,
+        const double *ftrig,
+        size_t fstride,
+        const PointSet *set,
+        size_t first,
+        int len,
+        double *dist
+) {
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d vx = _mm256_set1_pd(fx), vy = _mm256_set1_pd(fy);
+    __m256d dx, dy, d, a, cos_dlat, cos_dlon, h;
+    __m256d t0 = zero, t1 = zero, t2 = zero, t3 = zero;
+    int k = 0;
+
+    if (cf->metric == COST_HAVERSINE) {
+        t0 = _mm256_set1_pd(ftrig[0]);
+        t1 = _mm256_set1_pd(ftrig[fstride]);
+        t2 = _mm256_set1_pd(ftrig[2 * fstride]);
+        t3 = _mm256_set1_pd(ftrig[3 * fstride]);
+    }
+    for (; k + 4 <= len; k += 4) {
+        size_t p = first + k;
+        switch (cf->metric) {
+            case COST_EUCLIDEAN:
+                dx = _mm256_sub_pd(vx, _mm256_loadu_pd(set->x + p));
+                dy = _mm256_sub_pd(vy, _mm256_loadu_pd(set->y + p));
+                d = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+                break;
+            case COST_MANHATTAN:
+                dx = _mm256_andnot_pd(sign, _mm256_sub_pd(vx, _mm256_loadu_pd(set->x + p)));
+                dy = _mm256_andnot_pd(sign, _mm256_sub_pd(vy, _mm256_loadu_pd(set->y + p)));
+                d = _mm256_add_pd(dx, dy);
+                break;
+            default:
+                a = _mm256_mul_pd(t0, _mm256_loadu_pd(set->trig + p));
+                cos_dlat = _mm256_add_pd(a, _mm256_mul_pd(t1,
+                        _mm256_loadu_pd(set->trig + set->stride + p)));
+                cos_dlon = _mm256_add_pd(
+                        _mm256_mul_pd(t2, _mm256_loadu_pd(set->trig + 2 * set->stride + p)),
+                        _mm256_mul_pd(t3, _mm256_loadu_pd(set->trig + 3 * set->stride + p)));
+                h = _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(one, cos_dlat), half),
+                                  _mm256_mul_pd(a, _mm256_mul_pd(_mm256_sub_pd(one, cos_dlon), half)));
+                d = _mm256_min_pd(_mm256_max_pd(h, zero), one);
+                break;
+        }
+        _mm256_storeu_pd(dist + k, d);
+    }
+    scalar_distances(cf, fx, fy, ftrig, fstride, set, first + k, len - k, dist + k);
+}
+
+/**
+ * AVX2 batch: scales, rounds and clamps four distances at a time, as
+ * scalar_scale does.
+ */
+__attribute__((target("avx2")))
+static void avx2_scale(
+        const double *dist,
+        int len,
+        const double *factors,
+        double fixed,
+        Boolean varying_first,
+        int *out
+) {
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d high = _mm256_set1_pd((double)INT_MAX);
+    const __m256d low = _mm256_set1_pd((double)INT_MIN);
+    __m256d vf = _mm256_set1_pd(fixed), x, f;
+    int k = 0;
+
+    for (; k + 4 <= len; k += 4) {
+        x = _mm256_loadu_pd(dist + k);
+        f = _mm256_loadu_pd(factors + k);
+        x = varying_first ? _mm256_mul_pd(_mm256_mul_pd(x, f), vf)
+                          : _mm256_mul_pd(_mm256_mul_pd(x, vf), f);
+        x = _mm256_floor_pd(_mm256_add_pd(x, half));
+        x = _mm256_max_pd(_mm256_min_pd(x, high), low);
+        _mm_storeu_si128((__m128i *)(void *)(out + k), _mm256_cvttpd_epi32(x));
+    }
+    scalar_scale(dist + k, len - k, factors + k, fixed, varying_first, out + k);
+}
+
+#endif // COST_FUNCTION_X86
+
+/**
+ * Evaluates the costs of a fixed point against count points of the other
+ * side, COST_BATCH distances at a time.
+ *
+ * @param cf Pointer to the cost function.
+ * @param is_row TRUE if the fixed point is a supply point.
+ * @param index Fixed point.
+ * @param count Number of points on the other side, dummies included.
+ * @param out Receives count costs.
+ */
+static void evaluate_line(
+        const CostFunction *cf,
+        Boolean is_row,
+        int index,
+        int count,
+        int *out
+) {
+    double dist[COST_BATCH];
+    int real = is_row ? cf->demand_size : cf->supply_size;
+    int fixed_real = is_row ? cf->supply_size : cf->demand_size;
+    const double *factors = is_row ? cf->demand_rate : cf->supply_scale;
+    const double *ftrig = is_row ? cf->supply_trig : cf->demand_trig;
+    double fx, fy, fixed;
+    PointSet set;
+    int first, len, k;
+#if COST_FUNCTION_X86
+    Boolean vector = __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+#endif
+
+    // Lanes to or from dummy points cost nothing
+    if (real > count) real = count;
+    if (index >= fixed_real) real = 0;
+    memset(out + real, 0, (size_t)(count - real) * sizeof(int));
+    if (real == 0) {
+        return;
+    }
+    if (cf->metric == COST_CALLBACK) {
+        for (k = 0; k < real; k++) {
+            out[k] = is_row ? cf->callback(index, k, cf->context)
+                            : cf->callback(k, index, cf->context);
+        }
+        return;
+    }
+
+    set.x = is_row ? cf->demand_x : cf->supply_x;
+    set.y = is_row ? cf->demand_y : cf->supply_y;
+    set.trig = is_row ? cf->demand_trig : cf->supply_trig;
+    set.stride = (size_t)(is_row ? cf->demand_size : cf->supply_size);
+    fx = is_row ? cf->supply_x[index] : cf->demand_x[index];
+    fy = is_row ? cf->supply_y[index] : cf->demand_y[index];
+    fixed = is_row ? cf->supply_scale[index] : cf->demand_rate[index];
+    if (ftrig) {
+        ftrig += index;
+    }
+
+    for (first = 0; first < real; first += COST_BATCH) {
+        len = (real - first < COST_BATCH) ? real - first : COST_BATCH;
+#if COST_FUNCTION_X86
+        if (vector) {
+            avx2_distances(cf, fx, fy, ftrig, (size_t)fixed_real, &set, (size_t)first, len, dist);
+        } else
+#endif
+        {
+            scalar_distances(cf, fx, fy, ftrig, (size_t)fixed_real, &set, (size_t)first, len, dist);
+        }
+        if (cf->metric == COST_HAVERSINE) {
+            for (k = 0; k < len; k++) {
+                dist[k] = haversine_distance(dist[k]);
+            }
+        }
+        // Rows scale by the supply point first, columns by the demand point last
+#if COST_FUNCTION_X86
+        if (vector) {
+            avx2_scale(dist, len, factors + first, fixed, is_row ? FALSE : TRUE, out + first);
+        } else
+#endif
+        {
+            scalar_scale(dist, len, factors + first, fixed, is_row ? FALSE : TRUE, out + first);
+        }
+    }
+}
+
+/**
+ * Evaluates the costs of a whole row.
+ *
+ * @param cf Pointer to the cost function.
+ * @param supply Supply point.
+ * @param count Number of demand points, dummies included.
+ * @param out Receives count costs.
+ */
+void cost_function_row(
+        const CostFunction *cf,
+        int supply,
+        int count,
+        int *out
+) {
+    evaluate_line(cf, TRUE, supply, count, out);
+}
+
+/**
+ * Evaluates the costs of a whole column.
+ *
+ * @param cf Pointer to the cost function.
+ * @param demand Demand point.
+ * @param count Number of supply points, dummies included.
+ * @param out Receives count costs.
+ */
+void cost_function_column(
+        const CostFunction *cf,
+        int demand,
+        int count,
+        int *out
+) {
+    evaluate_line(cf, FALSE, demand, count, out);
+}
@@ -0,0 +1,71 @@
+#ifndef COST_FUNCTION_H
+#define COST_FUNCTION_H
+
+#include "transport.h"
+
+/*
+ * Implicit costs: the cost of a lane is computed from the coordinates of
+ * its supply and demand point when it is needed instead of being stored,
+ * so a problem of any size needs memory for its points only.
+ *
+ * The cost of lane (i, j) is
+ *
+ *     round(distance(i, j) * rate * supply_rate[i] * demand_rate[j])
+ *
+ * with the per-point factors defaulting to 1, so the rate of a lane can
+ * depend on both its ends without a rate per lane being stored. Haversine
+ * distances take x as longitude and y as latitude in degrees and are in
+ * kilometres. A callback computes arbitrary costs instead.
+ *
+ * Whole rows and columns are evaluated in batches, with AVX2 on x86 builds
+ * made with GCC or Clang (-DLINE_KERNELS_SCALAR forces the scalar loop, as
+ * for the scan kernels). Both paths round the same products, so a batch
+ * gives exactly the costs cost_function_at() gives one at a time. Points
+ * beyond supply_size or demand_size are dummies added by balancing and
+ * cost 0.
+ */
+
+typedef enum {
+    COST_EUCLIDEAN,
+    COST_MANHATTAN,
+    COST_HAVERSINE,
+    COST_CALLBACK
+} CostMetric;
+
+/** Computes the cost of lane (supply, demand) for COST_CALLBACK. */
+typedef int (*CostCallback)(int supply, int demand, void *context);
+
+struct CostFunction {
+    CostMetric metric;
+    int supply_size;       // Points with coordinates; later points are dummies
+    int demand_size;
+    double rate;           // Cost per unit of distance
+    double *supply_x;      // Coordinates, or longitude/latitude in degrees
+    double *supply_y;
+    double *demand_x;
+    double *demand_y;
+    double *supply_rate;   // Per-point rate factors, 1 until set
+    double *demand_rate;
+    CostCallback callback;
+    void *context;
+
+    // Filled by prepare_cost_function()
+    double *supply_scale;  // rate * supply_rate[i]
+    double *supply_trig;   // Haversine: cos/sin of latitude and longitude, 4 per point
+    double *demand_trig;
+};
+
+// Construction
+CostFunction *init_cost_function(CostMetric metric, int supply_size, int demand_size, double rate);
+CostFunction *init_cost_callback(int supply_size, int demand_size, CostCallback callback,
+                                 void *context);
+void prepare_cost_function(CostFunction *cf);
+void free_cost_function(CostFunction *cf);
+Boolean parse_cost_metric(const char *name, size_t length, CostMetric *metric);
+
+// Evaluation
+int cost_function_at(const CostFunction *cf, int supply, int demand);
+void cost_function_row(const CostFunction *cf, int supply, int count, int *out);
+void cost_function_column(const CostFunction *cf, int demand, int count, int *out);
+
+#endif // COST_FUNCTION_H
@@ -1,7 +1,10 @@
+#define _POSIX_C_SOURCE 200809L  // getline
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include "transport.h"
+#include "text_scanner.h"
 
 // Function to split a string by commas and convert to integers
 void parse_comma_separated_values(
@@ -9,16 +12,19 @@ void parse_comma_separated_values(
         int *array,
         int expected_size
 ) {
-    char *token;
-    char input_copy[MAX_INPUT_SIZE];
+    TextScanner scanner;
+    ScanStatus status;
     int index = 0;
 
-    strcpy(input_copy, input);  // Copy since strtok modifies the string
-    token = strtok(input_copy, ",");
-
-    while (token != NULL && index < expected_size) {
-        array[index] = atoi(token);
-        token = strtok(NULL, ",");
+    // Scan the line in place, so rows of any width fit
+    init_text_scanner(&scanner, input, strlen(input));
+    while (index < expected_size && (status = scan_int(&scanner, &array[index])) != SCAN_END) {
+        if (status != SCAN_OK) {
+            printf("Warning: %s '%.*s' at column %zu.\n",
+                   (status == SCAN_RANGE) ? "Out-of-range value" : "Malformed value",
+                   (int)scan_field_length(&scanner), scanner.field, scanner.field_column);
+            break;
+        }
         index++;
     }
 
@@ -27,6 +33,33 @@ void parse_comma_separated_values(
     }
 }
 
+// Function to read the next non-blank line of standard input, without the newline.
+// The buffer grows as needed; release it with free().
+static char *read_input_line(void) {
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    int ch;
+
+    // Skip leading blanks and the newline left over by earlier prompts
+    while ((ch = getchar()) != EOF && isspace(ch)) { }
+    if (ch == EOF) {
+        fprintf(stderr, "Unexpected end of input.\n");
+        exit(EXIT_FAILURE);
+    }
+    ungetc(ch, stdin);
+
+    length = getline(&line, &capacity, stdin);
+    if (length < 0) {
+        fprintf(stderr, "Unexpected end of input.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (length > 0 && line[length - 1] == '\n') {
+        line[length - 1] = '\0';
+    }
+    return line;
+}
+
 // Function to get confirmation from the user
 int get_confirmation(
         const char *message
@@ -37,6 +70,17 @@ int get_confirmation(
     return (strcmp(response, "y") == 0 || strcmp(response, "Y") == 0);
 }
 
+// Function to check a supply or demand vector for negative values
+static int has_negative_value(
+        const int *vector,
+        int size
+) {
+    for (int i = 0; i < size; i++) {
+        if (vector[i] < 0) return 1;
+    }
+    return 0;
+}
+
 // Function to input a vector with comma-separated values
 void input_vector(
         int *vector,
@@ -46,11 +90,16 @@ void input_vector(
     int valid = 0;
 
     while (!valid) {
-        char input[MAX_INPUT_SIZE];
         printf("%s (comma-separated, size %d): ", prompt, size);
-        scanf(" %[^\n]", input);  // Read the entire line
-        
+        char *input = read_input_line();  // Read the entire line
+
         parse_comma_separated_values(input, vector, size);
+        free(input);
+
+        if (has_negative_value(vector, size)) {
+            printf("Supplies and demands must not be negative.\n");
+            continue;
+        }
 
         printf("Vector entered: ");
         print_vector(vector, size);
@@ -62,7 +111,7 @@ void input_vector(
 
 // Function to input a matrix
 void input_matrix(
-        int **matrix,
+        int *matrix,
         int rows,
         int cols,
         const char *prompt
@@ -70,14 +119,14 @@ void input_matrix(
     for (int i = 0; i < rows; i++) {
         int valid = 0;
         while (!valid) {
-            char input[MAX_INPUT_SIZE];
             printf("%s (row %d, comma-separated, size %d): ", prompt, i + 1, cols);
-            scanf(" %[^\n]", input);
-            
-            parse_comma_separated_values(input, matrix[i], cols);
+            char *input = read_input_line();
+
+            parse_comma_separated_values(input, &matrix[(size_t)i * cols], cols);
+            free(input);
 
             printf("Row %d entered: ", i + 1);
-            print_vector(matrix[i], cols);
+            print_vector(&matrix[(size_t)i * cols], cols);
             if (get_confirmation("Is this correct?")) {
                 valid = 1;
             }
@@ -98,11 +147,11 @@ void print_vector(
 
 // Utility function to print a matrix
 void print_matrix(
-        int **matrix,
+        const int *matrix,
         int rows,
         int cols
 ) {
     for (int i = 0; i < rows; i++) {
-        print_vector(matrix[i], cols);
+        print_vector(&matrix[(size_t)i * cols], cols);
     }
 }
@@ -1,37 +1,77 @@
+#ifndef TP_TEMPLATE
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
 #include "transport.h"
+#include "line_kernels.h"
+#include "workspace.h"
+
+// Least Cost Method, compiled once per precision
+#define TP_TEMPLATE "least_cost.c"
+#include "precision_template.h"
+
+#else // Template body
+
+#define scan_row_min TP_NAME(scan_row_min)
+#define find_min_cost_cell TP_NAME(find_min_cost_cell)
+
+/**
+ * Finds the minimum cost of row i over the open columns.
+ *
+ * @param tp Pointer to the TransportationProblem structure.
+ * @param i Row to scan.
+ * @param col_done Done mask of completed columns.
+ * @param row_min Array to store the row's minimum cost in.
+ * @param row_arg Array to store the column of the row's minimum in, -1 if none.
+ * @param scratch Space for one row of costs, used for implicit costs and a dummy's line.
+ */
+static void scan_row_min(
+    TP_PROBLEM *tp,
+    int i,
+    const uint64_t *col_done,
+    TP_VALUE *row_min,
+    int *row_arg,
+    TP_VALUE *scratch
+) {
+    TP_VALUE row_min2;
+
+    TP_NAME(line_min2)(TP_NAME(cost_row)(tp, i, scratch), col_done, tp->cost_columns,
+                       &row_min[i], &row_min2, &row_arg[i]);
+    LINE_MIN2_ADD_DUMMY(col_done, tp->cost_columns, tp->demand_size,
+                        &row_min[i], &row_min2, &row_arg[i]);
+}
 
 /**
- * Finds the cell with the minimum cost that is not yet allocated.
+ * Finds the cell with the minimum cost that is not yet allocated, from the
+ * cached minimum of every open row.
  * 
  * @param tp Pointer to the TransportationProblem structure.
- * @param row_done Array indicating completed rows.
- * @param col_done Array indicating completed columns.
+ * @param row_done Done mask of completed rows.
+ * @param row_min Minimum cost of each row over the open columns.
+ * @param row_arg Column of each row's minimum, -1 if none.
  * @param min_row Pointer to store the row index of the minimum cost cell.
  * @param min_col Pointer to store the column index of the minimum cost cell.
  * @return TRUE if a minimum cost cell is found, FALSE otherwise.
  */
 static Boolean find_min_cost_cell(
-    TransportProblem *tp,
-    Boolean *row_done,
-    Boolean *col_done,
+    TP_PROBLEM *tp,
+    const uint64_t *row_done,
+    const TP_VALUE *row_min,
+    const int *row_arg,
     int *min_row,
     int *min_col
 ) {
-    int min_cost = INT_MAX;
+    TP_VALUE min_cost = TP_MAX;
     int r = -1, c = -1;
 
+    // Only a strictly smaller row minimum moves the pick, so ties keep the
+    // first cell in row-major order
     for (int i = 0; i < tp->supply_size; i++) {
-        if (row_done[i]) continue;
-        for (int j = 0; j < tp->demand_size; j++) {
-            if (col_done[j]) continue;
-            if (tp->cost_matrix[i][j] < min_cost) {
-                min_cost = tp->cost_matrix[i][j];
-                r = i;
-                c = j;
-            }
+        if (DONE_MASK_TEST(row_done, i)) continue;
+        if (row_arg[i] != -1 && row_min[i] < min_cost) {
+            min_cost = row_min[i];
+            r = i;
+            c = row_arg[i];
         }
     }
 
@@ -46,65 +86,85 @@ static Boolean find_min_cost_cell(
 
 /**
  * Solves the transportation problem using the Least Cost Cell Method.
- * 
+ *
+ * Each row's minimum over the open columns is kept between allocations.
+ * Closing a row leaves the other rows' minima as they are, and closing a
+ * column only changes the rows whose minimum sat in it, so only those rows
+ * are scanned again. That keeps implicit costs, which are evaluated on
+ * every scan, from being recomputed for the whole matrix at every step.
+ * Scratch space is taken from a workspace.
+ *
+ * @param ws Workspace the problem fits in; reset first.
  * @param tp Pointer to the TransportationProblem structure containing supply, demand, and cost matrix.
- * @param results Pre-allocated 2D array to store the allocation results.
+ * @param solution Solution to fill with the allocated cells; emptied first.
+ * @param total_cost Receives the total cost of the transportation plan.
  * @param print_iterations Boolean flag to enable/disable printing each allocation step.
- * @return Total cost of the transportation plan.
+ * @return SOLVER_OK, SOLVER_TOO_LARGE if the problem does not fit in the workspace, or
+ *         SOLVER_COST_OVERFLOW (with the solution emptied) if the total cost does not fit.
  */
-int least_cost_method(
-    TransportProblem *tp,
-    int **results,
+SolverStatus TP_NAME(least_cost_solve)(
+    SolverWorkspace *ws,
+    TP_PROBLEM *tp,
+    TP_SOLUTION *solution,
+    TP_VALUE *total_cost,
     Boolean print_iterations
 ) {
-    int total_cost = 0;
     int iteration = 0;
-    int i, j, allocation;
+    int i, j;
+    TP_VALUE allocation;
+    TP_WIDE plan_cost = 0;
 
-    // Create copies of supply and demand to avoid modifying the original data
-    int *supply = (int *)malloc(tp->supply_size * sizeof(int));
-    int *demand = (int *)malloc(tp->demand_size * sizeof(int));
-    Boolean *row_done = (Boolean *)calloc(tp->supply_size, sizeof(Boolean));
-    Boolean *col_done = (Boolean *)calloc(tp->demand_size, sizeof(Boolean));
+    if (check_workspace_fits(ws, tp->supply_size, tp->demand_size) != SOLVER_OK) {
+        return SOLVER_TOO_LARGE;
+    }
+    reset_solver_workspace(ws);
 
-    if (!supply || !demand || !row_done || !col_done) {
-        fprintf(stderr, "Memory allocation failed.\n");
-        exit(EXIT_FAILURE);
+    // Create copies of supply and demand to avoid modifying the original data
+    TP_VALUE *supply = (TP_VALUE *)workspace_alloc(ws, tp->supply_size * sizeof(TP_VALUE));
+    TP_VALUE *demand = (TP_VALUE *)workspace_alloc(ws, tp->demand_size * sizeof(TP_VALUE));
+    uint64_t *row_done = workspace_done_mask(ws, tp->supply_size);
+    uint64_t *col_done = workspace_done_mask(ws, tp->demand_size);
+    TP_VALUE *line = (TP_VALUE *)workspace_alloc(ws, (tp->demand_size + 1) * sizeof(TP_VALUE));
+    TP_VALUE *row_min = (TP_VALUE *)workspace_alloc(ws, (tp->supply_size + 1) * sizeof(TP_VALUE));
+    int *row_arg = (int *)workspace_alloc(ws, (tp->supply_size + 1) * sizeof(int));
+
+    if (!supply || !demand || !row_done || !col_done || !line || !row_min || !row_arg) {
+        return SOLVER_TOO_LARGE;
     }
 
     for (i = 0; i < tp->supply_size; i++) {
         supply[i] = tp->supply[i];
+        scan_row_min(tp, i, col_done, row_min, row_arg, line);
     }
 
     for (j = 0; j < tp->demand_size; j++) {
         demand[j] = tp->demand[j];
     }
 
-    // Initialize results matrix to zeros
-    for (i = 0; i < tp->supply_size; i++) {
-        for (j = 0; j < tp->demand_size; j++) {
-            results[i][j] = 0;
-        }
-    }
+    TP_NAME(clear_solution)(solution);
+    *total_cost = 0;
 
     // Allocation loop
     while (1) {
         int min_row, min_col;
-        if (!find_min_cost_cell(tp, row_done, col_done, &min_row, &min_col)) {
+        if (!find_min_cost_cell(tp, row_done, row_min, row_arg, &min_row, &min_col)) {
             break;  // No more cells to allocate
         }
 
         // Determine the allocation quantity
         allocation = (supply[min_row] < demand[min_col]) ? supply[min_row] : demand[min_col];
-        results[min_row][min_col] = allocation;
-        total_cost += allocation * tp->cost_matrix[min_row][min_col];
+        TP_NAME(add_to_solution)(solution, min_row, min_col, allocation);
+        plan_cost += (TP_WIDE)allocation * TP_COST_AT(tp, min_row, min_col);
         iteration++;
 
         if (print_iterations) {
-            printf("Allocation %d: %d units to cell (%d, %d) with cost %d.\n",
-                   iteration, allocation, min_row, min_col, tp->cost_matrix[min_row][min_col]);
-            printf("  Remaining Supply[%d]: %d\n", min_row, supply[min_row] - allocation);
-            printf("  Remaining Demand[%d]: %d\n\n", min_col, demand[min_col] - allocation);
+            printf("Allocation %d: " TP_FMT " units to cell (%d, %d) with cost " TP_FMT ".\n",
+                   iteration, TP_PRINT(allocation), min_row, min_col,
+                   TP_PRINT(TP_COST_AT(tp, min_row, min_col)));
+            printf("  Remaining Supply[%d]: " TP_FMT "\n", min_row,
+                   TP_PRINT(supply[min_row] - allocation));
+            printf("  Remaining Demand[%d]: " TP_FMT "\n\n", min_col,
+                   TP_PRINT(demand[min_col] - allocation));
         }
 
         // Update supply and demand
@@ -113,19 +173,57 @@ int least_cost_method(
 
         // Mark row or column as done
         if (supply[min_row] == 0) {
-            row_done[min_row] = TRUE;
+            DONE_MASK_SET(row_done, min_row);
         }
 
         if (demand[min_col] == 0) {
-            col_done[min_col] = TRUE;
+            DONE_MASK_SET(col_done, min_col);
+            for (i = 0; i < tp->supply_size; i++) {
+                if (!DONE_MASK_TEST(row_done, i) && row_arg[i] == min_col) {
+                    scan_row_min(tp, i, col_done, row_min, row_arg, line);
+                }
+            }
         }
     }
 
-    // Free allocated memory
-    free(supply);
-    free(demand);
-    free(row_done);
-    free(col_done);
+    if (!TP_FITS(plan_cost)) {
+        TP_NAME(clear_solution)(solution);
+        return SOLVER_COST_OVERFLOW;
+    }
+    *total_cost = (TP_VALUE)plan_cost;
+    return SOLVER_OK;
+}
+
+/**
+ * Solves the transportation problem using the Least Cost Cell Method, as
+ * least_cost_solve() does, in a workspace of its own.
+ *
+ * @param tp Pointer to the TransportationProblem structure containing supply, demand, and cost matrix.
+ * @param solution Solution to fill with the allocated cells; emptied first.
+ * @param print_iterations Boolean flag to enable/disable printing each allocation step.
+ * @return Total cost of the transportation plan.
+ */
+TP_VALUE TP_NAME(least_cost_method)(
+    TP_PROBLEM *tp,
+    TP_SOLUTION *solution,
+    Boolean print_iterations
+) {
+    SolverWorkspace ws;
+    TP_VALUE total_cost = 0;
+    SolverStatus status = init_solver_workspace(&ws, tp->supply_size, tp->demand_size);
 
+    if (status == SOLVER_OK) {
+        status = TP_NAME(least_cost_solve)(&ws, tp, solution, &total_cost, print_iterations);
+    }
+    free_solver_workspace(&ws);
+    if (status != SOLVER_OK) {
+        fprintf(stderr, "%s\n", solver_status_message(status));
+        exit(EXIT_FAILURE);
+    }
     return total_cost;
 }
+
+#undef scan_row_min
+#undef find_min_cost_cell
+
+#endif // TP_TEMPLATE
@@ -0,0 +1,363 @@
+#define _POSIX_C_SOURCE 200809L  // sysconf
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "transport.h"
+#include "workspace.h"
+#include "line_kernels.h"
+
+/*
+ * Least Cost Method over a single sorted cell order.
+ *
+ * Every cell becomes one 64-bit key, its sign-flipped cost in the high half
+ * and its row-major index in the low half, and the keys are sorted once by
+ * cost with a stable LSD radix sort. Since the keys start out in index
+ * order, equal costs stay in row-major order, which is the tie-break
+ * find_min_cost_cell() applies. Closed rows and columns never reopen, so
+ * walking the sorted keys and skipping cells on a closed line visits
+ * exactly the cells the repeated scans of least_cost_method would pick.
+ */
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define MIN_CELLS_PER_THREAD (1 << 16) // Smaller chunks are not worth a thread
+
+/**
+ * The slice of the keys one thread counts and scatters in a radix pass.
+ */
+typedef struct {
+    const uint64_t *src;
+    uint64_t *dst;
+    size_t begin, end;
+    int shift;
+    size_t count[RADIX_BUCKETS];  // Histogram, then this chunk's scatter offsets
+} RadixChunk;
+
+/**
+ * Counts the digit values of one chunk.
+ *
+ * @param arg Pointer to the chunk's RadixChunk.
+ * @return NULL.
+ */
+static void *radix_histogram(
+        void *arg
+) {
+    RadixChunk *chunk = (RadixChunk *)arg;
+    size_t k;
+
+    memset(chunk->count, 0, sizeof(chunk->count));
+    for (k = chunk->begin; k < chunk->end; k++) {
+        chunk->count[(chunk->src[k] >> chunk->shift) & (RADIX_BUCKETS - 1)]++;
+    }
+    return NULL;
+}
+
+/**
+ * Moves the keys of one chunk to their place in the output.
+ *
+ * @param arg Pointer to the chunk's RadixChunk, with count holding its offsets.
+ * @return NULL.
+ */
+static void *radix_scatter(
+        void *arg
+) {
+    RadixChunk *chunk = (RadixChunk *)arg;
+    size_t k;
+
+    for (k = chunk->begin; k < chunk->end; k++) {
+        chunk->dst[chunk->count[(chunk->src[k] >> chunk->shift) & (RADIX_BUCKETS - 1)]++] =
+                chunk->src[k];
+    }
+    return NULL;
+}
+
+/**
+ * Runs fn on every chunk, one thread per chunk. The calling thread takes
+ * chunk 0 and any chunk whose thread fails to start.
+ *
+ * @param fn Work function.
+ * @param chunks Chunks to process.
+ * @param threads Thread handles, one per chunk.
+ * @param started Scratch flags, one per chunk.
+ * @param num_chunks Number of chunks.
+ */
+static void run_chunks(
+        void *(*fn)(void *),
+        RadixChunk *chunks,
+        pthread_t *threads,
+        Boolean *started,
+        int num_chunks
+) {
+    int t;
+
+    for (t = 1; t < num_chunks; t++) {
+        started[t] = (pthread_create(&threads[t], NULL, fn, &chunks[t]) == 0) ? TRUE : FALSE;
+    }
+    fn(&chunks[0]);
+    for (t = 1; t < num_chunks; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        } else {
+            fn(&chunks[t]);
+        }
+    }
+}
+
+/**
+ * Sorts keys by their high 32 bits with a stable LSD radix sort split
+ * across threads. Each pass counts digits per chunk, turns the counts into
+ * per-chunk offsets (digit-major, chunk-minor, so the order within a digit
+ * is preserved) and scatters every chunk in parallel. Passes on a byte that
+ * all keys share are skipped.
+ *
+ * @param keys Keys to sort.
+ * @param scratch Buffer of the same size.
+ * @param count Number of keys.
+ * @param num_threads Maximum number of threads.
+ * @return Whichever of keys and scratch holds the sorted keys, or NULL if
+ *         the chunk bookkeeping cannot be allocated.
+ */
+static uint64_t *radix_sort_keys(
+        uint64_t *keys,
+        uint64_t *scratch,
+        size_t count,
+        int num_threads
+) {
+    uint64_t *src = keys, *dst = scratch, *tmp;
+    int num_chunks = num_threads;
+    int t, b, shift;
+    size_t sum;
+
+    if ((size_t)num_chunks > count / MIN_CELLS_PER_THREAD) {
+        num_chunks = (int)(count / MIN_CELLS_PER_THREAD);
+    }
+    if (num_chunks < 1) {
+        num_chunks = 1;
+    }
+
+    RadixChunk *chunks = (RadixChunk *)malloc(num_chunks * sizeof(RadixChunk));
+    pthread_t *threads = (pthread_t *)malloc(num_chunks * sizeof(pthread_t));
+    Boolean *started = (Boolean *)malloc(num_chunks * sizeof(Boolean));
+    if (!chunks || !threads || !started) {
+        free(chunks);
+        free(threads);
+        free(started);
+        return NULL;
+    }
+    for (t = 0; t < num_chunks; t++) {
+        chunks[t].begin = count * t / num_chunks;
+        chunks[t].end = count * (t + 1) / num_chunks;
+    }
+
+    for (shift = 32; shift < 64; shift += RADIX_BITS) {
+        for (t = 0; t < num_chunks; t++) {
+            chunks[t].src = src;
+            chunks[t].dst = dst;
+            chunks[t].shift = shift;
+        }
+        run_chunks(radix_histogram, chunks, threads, started, num_chunks);
+
+        if (count == 0) break;
+        // Every key shares this byte: nothing to reorder
+        b = (int)((src[0] >> shift) & (RADIX_BUCKETS - 1));
+        sum = 0;
+        for (t = 0; t < num_chunks; t++) {
+            sum += chunks[t].count[b];
+        }
+        if (sum == count) continue;
+
+        sum = 0;
+        for (b = 0; b < RADIX_BUCKETS; b++) {
+            for (t = 0; t < num_chunks; t++) {
+                size_t c = chunks[t].count[b];
+                chunks[t].count[b] = sum;
+                sum += c;
+            }
+        }
+        run_chunks(radix_scatter, chunks, threads, started, num_chunks);
+
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    free(chunks);
+    free(threads);
+    free(started);
+    return src;
+}
+
+/**
+ * Solves the transportation problem using the Least Cost Cell Method,
+ * sorting the cells once instead of rescanning the matrix for every
+ * allocation. The allocations are the same as those of least_cost_solve().
+ * Problems with more than 2^32 cells, and problems with implicit costs,
+ * whose sort keys would take the memory the costs were spared, fall back
+ * to least_cost_solve(), which only rescans the rows a closed column
+ * affects. The supply and demand copies and the done masks come from the
+ * workspace; the sort keys grow with the cells, not the points, so they
+ * are allocated per solve.
+ *
+ * @param ws Workspace sized for the problem.
+ * @param tp Pointer to the TransportationProblem structure containing supply, demand, and cost matrix.
+ * @param solution Solution to fill with the allocated cells; emptied first.
+ * @param total_cost Receives the total cost of the transportation plan.
+ * @param print_iterations Boolean flag to enable/disable printing each allocation step.
+ * @return SOLVER_OK, SOLVER_TOO_LARGE if the problem does not fit in the workspace,
+ *         SOLVER_OUT_OF_MEMORY if the sort keys cannot be allocated, or
+ *         SOLVER_COST_OVERFLOW (with the solution emptied) if the total cost
+ *         does not fit.
+ */
+SolverStatus least_cost_sorted_solve(
+        SolverWorkspace *ws,
+        TransportProblem *tp,
+        Solution *solution,
+        int *total_cost,
+        Boolean print_iterations
+) {
+    size_t cells = (size_t)tp->supply_size * tp->demand_size;
+    long long plan_cost = 0;
+    int iteration = 0;
+    int i, j, allocation;
+    int open_rows = tp->supply_size, open_cols = tp->demand_size;
+    size_t k;
+
+    if (cells > UINT32_MAX || !tp->cost) {
+        return least_cost_solve(ws, tp, solution, total_cost, print_iterations);
+    }
+    if (check_workspace_fits(ws, tp->supply_size, tp->demand_size) != SOLVER_OK) {
+        return SOLVER_TOO_LARGE;
+    }
+    reset_solver_workspace(ws);
+
+    int *supply = (int *)workspace_alloc(ws, tp->supply_size * sizeof(int));
+    int *demand = (int *)workspace_alloc(ws, tp->demand_size * sizeof(int));
+    uint64_t *row_done = workspace_done_mask(ws, tp->supply_size);
+    uint64_t *col_done = workspace_done_mask(ws, tp->demand_size);
+
+    if (!supply || !demand || !row_done || !col_done) {
+        return SOLVER_TOO_LARGE;
+    }
+
+    uint64_t *keys = (uint64_t *)malloc((cells + 1) * sizeof(uint64_t));
+    uint64_t *scratch = (uint64_t *)malloc((cells + 1) * sizeof(uint64_t));
+
+    if (!keys || !scratch) {
+        free(keys);
+        free(scratch);
+        return SOLVER_OUT_OF_MEMORY;
+    }
+
+    for (i = 0; i < tp->supply_size; i++) {
+        supply[i] = tp->supply[i];
+    }
+
+    for (j = 0; j < tp->demand_size; j++) {
+        demand[j] = tp->demand[j];
+    }
+
+    clear_solution(solution);
+
+    // Flipping the sign bit makes unsigned order match signed order. Keys
+    // carry the cell's row-major index, so equal costs keep row-major
+    // order; a dummy point's cells are not stored and cost 0
+    for (i = 0, k = 0; i < tp->supply_size; i++) {
+        const int *row = (i < tp->cost_rows) ? &tp->cost[COST_INDEX(tp, i, 0)] : NULL;
+        for (j = 0; j < tp->demand_size; j++, k++) {
+            int c = (row && j < tp->cost_columns) ? row[j] : 0;
+            keys[k] = ((uint64_t)((uint32_t)c ^ 0x80000000u) << 32) | (uint32_t)k;
+        }
+    }
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t *order = radix_sort_keys(keys, scratch, cells, (online > 0) ? (int)online : 1);
+
+    if (!order) {
+        free(keys);
+        free(scratch);
+        return SOLVER_OUT_OF_MEMORY;
+    }
+    // Allocation loop over the cells in increasing cost
+    for (k = 0; k < cells && open_rows > 0 && open_cols > 0; k++) {
+        size_t cell = (size_t)(uint32_t)order[k];
+        int min_row = (int)(cell / tp->demand_size);
+        int min_col = (int)(cell % tp->demand_size);
+        int cost;
+
+        if (DONE_MASK_TEST(row_done, min_row) || DONE_MASK_TEST(col_done, min_col)) continue;
+        cost = COST_AT(tp, min_row, min_col);
+        if (cost == INT_MAX) {
+            break;  // find_min_cost_cell never picks an INT_MAX cell either
+        }
+
+        // Determine the allocation quantity
+        allocation = (supply[min_row] < demand[min_col]) ? supply[min_row] : demand[min_col];
+        add_to_solution(solution, min_row, min_col, allocation);
+        plan_cost += (long long)allocation * cost;
+        iteration++;
+
+        if (print_iterations) {
+            printf("Allocation %d: %d units to cell (%d, %d) with cost %d.\n",
+                   iteration, allocation, min_row, min_col, cost);
+            printf("  Remaining Supply[%d]: %d\n", min_row, supply[min_row] - allocation);
+            printf("  Remaining Demand[%d]: %d\n\n", min_col, demand[min_col] - allocation);
+        }
+
+        // Update supply and demand
+        supply[min_row] -= allocation;
+        demand[min_col] -= allocation;
+
+        // Mark row or column as done
+        if (supply[min_row] == 0) {
+            DONE_MASK_SET(row_done, min_row);
+            open_rows--;
+        }
+
+        if (demand[min_col] == 0) {
+            DONE_MASK_SET(col_done, min_col);
+            open_cols--;
+        }
+    }
+
+    free(keys);
+    free(scratch);
+
+    if (plan_cost > INT_MAX || plan_cost < INT_MIN) {
+        clear_solution(solution);
+        return SOLVER_COST_OVERFLOW;
+    }
+    *total_cost = (int)plan_cost;
+    return SOLVER_OK;
+}
+
+/**
+ * Solves the transportation problem using the Least Cost Cell Method, as
+ * least_cost_sorted_solve() does, in a workspace of its own.
+ *
+ * @param tp Pointer to the TransportationProblem structure containing supply, demand, and cost matrix.
+ * @param solution Solution to fill with the allocated cells; emptied first.
+ * @param print_iterations Boolean flag to enable/disable printing each allocation step.
+ * @return Total cost of the transportation plan.
+ */
+int least_cost_sorted_method(
+        TransportProblem *tp,
+        Solution *solution,
+        Boolean print_iterations
+) {
+    SolverWorkspace ws;
+    int total_cost = 0;
+    SolverStatus status = init_solver_workspace(&ws, tp->supply_size, tp->demand_size);
+
+    if (status == SOLVER_OK) {
+        status = least_cost_sorted_solve(&ws, tp, solution, &total_cost, print_iterations);
+    }
+    free_solver_workspace(&ws);
+    if (status != SOLVER_OK) {
+        fprintf(stderr, "%s\n", solver_status_message(status));
+        exit(EXIT_FAILURE);
+    }
+    return total_cost;
+}
@@ -0,0 +1,291 @@
+#ifndef TP_TEMPLATE
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "line_kernels.h"
+
+#if !defined(LINE_KERNELS_SCALAR) && (defined(__GNUC__) || defined(__clang__)) && \
+        (defined(__x86_64__) || defined(__i386__))
+#define LINE_KERNELS_X86 1
+#include <immintrin.h>
+#else
+#define LINE_KERNELS_X86 0
+#endif
+
+/**
+ * Allocates a done mask for n lines with every line open.
+ *
+ * @param n Number of lines.
+ * @return The mask; release it with free().
+ */
+uint64_t *alloc_done_mask(
+        int n
+) {
+    uint64_t *mask = (uint64_t *)calloc(DONE_MASK_WORDS(n) + 1, sizeof(uint64_t));
+
+    if (!mask) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    return mask;
+}
+
+/**
+ * Continues a two-smallest scan over line[first..len-1] one element at a
+ * time. A cost only replaces the minimum when it is strictly smaller, so
+ * argmin stays at the first occurrence.
+ *
+ * @param line Costs of the row or column.
+ * @param done Done mask of the crossing lines.
+ * @param first Index to start at.
+ * @param len Length of the line.
+ * @param min1 In/out smallest open cost.
+ * @param min2 In/out second smallest open cost.
+ * @param argmin In/out index of min1.
+ */
+static void scalar_min2(
+        const int *line,
+        const uint64_t *done,
+        int first,
+        int len,
+        int *min1,
+        int *min2,
+        int *argmin
+) {
+    int i, c;
+    int m1 = *min1, m2 = *min2, p = *argmin;
+
+    for (i = first; i < len; ++i) {
+        if (DONE_MASK_TEST(done, i)) continue;
+        c = line[i];
+        if (c < m1) {
+            m2 = m1;
+            m1 = c;
+            p = i;
+        } else if (c < m2) {
+            m2 = c;
+        }
+    }
+    *min1 = m1;
+    *min2 = m2;
+    *argmin = p;
+}
+
+#if LINE_KERNELS_X86
+
+/**
+ * Merges per-lane results into one (min1, min2, argmin) triple. Each lane
+ * holds the two smallest costs of the elements it saw and the first index
+ * of its minimum, so the overall answer is the two smallest lane values and
+ * the lowest index among the lanes holding the overall minimum.
+ *
+ * @param lane_min1 Smallest cost of each lane.
+ * @param lane_min2 Second smallest cost of each lane.
+ * @param lane_idx Index of each lane's smallest cost, -1 if none.
+ * @param lanes Number of lanes.
+ * @param min1 Output smallest cost.
+ * @param min2 Output second smallest cost.
+ * @param argmin Output index of min1.
+ */
+static void reduce_lanes(
+        const int *lane_min1,
+        const int *lane_min2,
+        const int *lane_idx,
+        int lanes,
+        int *min1,
+        int *min2,
+        int *argmin
+) {
+    int l, v;
+    int m1 = INT_MAX, m2 = INT_MAX, p = -1;
+
+    for (l = 0; l < lanes; l++) {
+        v = lane_min1[l];
+        if (v < m1) {
+            m2 = m1;
+            m1 = v;
+            p = lane_idx[l];
+        } else {
+            if (v == m1 && lane_idx[l] != -1 && (p == -1 || lane_idx[l] < p)) {
+                p = lane_idx[l];
+            }
+            if (v < m2) m2 = v;
+        }
+        if (lane_min2[l] < m2) m2 = lane_min2[l];
+    }
+    *min1 = m1;
+    *min2 = m2;
+    *argmin = p;
+}
+
+/**
+ * AVX2 kernel: eight lanes, the mask byte expanded to lanes with a compare.
+ */
+__attribute__((target("avx2")))
+static void avx2_min2(
+        const int *line,
+        const uint64_t *done,
+        int len,
+        int *min1,
+        int *min2,
+        int *argmin
+) {
+    int lane_min1[8], lane_min2[8], lane_idx[8];
+    const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i big = _mm256_set1_epi32(INT_MAX);
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i vmin1 = big, vmin2 = big;
+    __m256i vidx = _mm256_set1_epi32(-1);
+    __m256i vi = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i closed, c, lt;
+    int i = 0;
+
+    for (; i + 8 <= len; i += 8) {
+        // i is a multiple of 8, so the byte never straddles two words
+        int byte = (int)((done[i >> 6] >> (i & 63)) & 0xFF);
+        closed = _mm256_and_si256(_mm256_set1_epi32(byte), bits);
+        closed = _mm256_cmpeq_epi32(closed, bits);
+        c = _mm256_blendv_epi8(_mm256_loadu_si256((const __m256i *)(line + i)), big, closed);
+
+        lt = _mm256_cmpgt_epi32(vmin1, c);
+        vmin2 = _mm256_min_epi32(vmin2, _mm256_max_epi32(vmin1, c));
+        vmin1 = _mm256_min_epi32(vmin1, c);
+        vidx = _mm256_blendv_epi8(vidx, vi, lt);
+        vi = _mm256_add_epi32(vi, step);
+    }
+
+    _mm256_storeu_si256((__m256i *)lane_min1, vmin1);
+    _mm256_storeu_si256((__m256i *)lane_min2, vmin2);
+    _mm256_storeu_si256((__m256i *)lane_idx, vidx);
+    reduce_lanes(lane_min1, lane_min2, lane_idx, 8, min1, min2, argmin);
+    scalar_min2(line, done, i, len, min1, min2, argmin);
+}
+
+/**
+ * AVX-512 kernel: sixteen lanes, the mask bits used directly as a load mask,
+ * which also covers the tail.
+ */
+__attribute__((target("avx512f")))
+static void avx512_min2(
+        const int *line,
+        const uint64_t *done,
+        int len,
+        int *min1,
+        int *min2,
+        int *argmin
+) {
+    int lane_min1[16], lane_min2[16], lane_idx[16];
+    const __m512i big = _mm512_set1_epi32(INT_MAX);
+    const __m512i step = _mm512_set1_epi32(16);
+    __m512i vmin1 = big, vmin2 = big;
+    __m512i vidx = _mm512_set1_epi32(-1);
+    __m512i vi = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m512i c;
+    __mmask16 open, lt;
+    int i;
+
+    for (i = 0; i < len; i += 16) {
+        open = (__mmask16)~(done[i >> 6] >> (i & 63));
+        if (len - i < 16) {
+            open &= (__mmask16)((1u << (len - i)) - 1);
+        }
+        c = _mm512_mask_loadu_epi32(big, open, line + i);
+
+        lt = _mm512_cmplt_epi32_mask(c, vmin1);
+        vmin2 = _mm512_min_epi32(vmin2, _mm512_max_epi32(vmin1, c));
+        vmin1 = _mm512_min_epi32(vmin1, c);
+        vidx = _mm512_mask_mov_epi32(vidx, lt, vi);
+        vi = _mm512_add_epi32(vi, step);
+    }
+
+    _mm512_storeu_si512(lane_min1, vmin1);
+    _mm512_storeu_si512(lane_min2, vmin2);
+    _mm512_storeu_si512(lane_idx, vidx);
+    reduce_lanes(lane_min1, lane_min2, lane_idx, 16, min1, min2, argmin);
+}
+
+#endif // LINE_KERNELS_X86
+
+/**
+ * Finds the smallest and second smallest cost of a row or column, skipping
+ * the positions whose crossing line is closed, and the first position of
+ * the smallest. A repeated minimum counts twice, so min2 may equal min1.
+ *
+ * @param line Costs of the row or column, contiguous.
+ * @param done Done mask of the crossing lines (columns for a row, rows for a column).
+ * @param len Length of the line.
+ * @param min1 Output smallest open cost, INT_MAX if there is none.
+ * @param min2 Output second smallest open cost, INT_MAX if there is none.
+ * @param argmin Output position of min1, -1 if there is none.
+ */
+void line_min2(
+        const int *line,
+        const uint64_t *done,
+        int len,
+        int *min1,
+        int *min2,
+        int *argmin
+) {
+#if LINE_KERNELS_X86
+    if (__builtin_cpu_supports("avx512f")) {
+        avx512_min2(line, done, len, min1, min2, argmin);
+        return;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        avx2_min2(line, done, len, min1, min2, argmin);
+        return;
+    }
+#endif
+    *min1 = INT_MAX;
+    *min2 = INT_MAX;
+    *argmin = -1;
+    scalar_min2(line, done, 0, len, min1, min2, argmin);
+}
+
+// Scalar kernels for the wide precisions; int32 has the vector ones above
+#define TP_TEMPLATE "line_kernels.c"
+#define TP_WIDE_ONLY
+#include "precision_template.h"
+
+#else // Template body
+
+/**
+ * Finds the two smallest open costs of a line and the first position of
+ * the smallest, exactly as line_min2() does, for a wide precision. The
+ * loop is plain; 64-bit lanes gain little from the int32 kernels' masks.
+ *
+ * @param line Costs of the row or column, contiguous.
+ * @param done Done mask of the crossing lines.
+ * @param len Length of the line.
+ * @param min1 Output smallest open cost, TP_MAX if there is none.
+ * @param min2 Output second smallest open cost, TP_MAX if there is none.
+ * @param argmin Output position of min1, -1 if there is none.
+ */
+void TP_NAME(line_min2)(
+        const TP_VALUE *line,
+        const uint64_t *done,
+        int len,
+        TP_VALUE *min1,
+        TP_VALUE *min2,
+        int *argmin
+) {
+    TP_VALUE m1 = TP_MAX, m2 = TP_MAX, c;
+    int i, p = -1;
+
+    for (i = 0; i < len; ++i) {
+        if (DONE_MASK_TEST(done, i)) continue;
+        c = line[i];
+        if (c < m1) {
+            m2 = m1;
+            m1 = c;
+            p = i;
+        } else if (c < m2) {
+            m2 = c;
+        }
+    }
+    *min1 = m1;
+    *min2 = m2;
+    *argmin = p;
+}
+
+#endif // TP_TEMPLATE
@@ -0,0 +1,55 @@
+#ifndef LINE_KERNELS_H
+#define LINE_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Scan kernels shared by the transport heuristics.
+ *
+ * Closed rows and columns are tracked in done masks: bitmaps with bit i of
+ * word i / 64 set once line i is closed. The kernels read the mask a vector
+ * at a time and blend closed lanes out instead of branching per element.
+ * AVX-512 and AVX2 versions are picked at run time on x86 builds made with
+ * GCC or Clang; every other build, or one compiled with
+ * -DLINE_KERNELS_SCALAR, uses the scalar loop. The int64 and double
+ * versions (see precision.h) are scalar loops.
+ */
+
+/** Number of 64-bit words in a done mask covering n lines. */
+#define DONE_MASK_WORDS(n) (((size_t)(n) + 63) / 64)
+
+/** Marks line i as closed. */
+#define DONE_MASK_SET(mask, i) ((mask)[(size_t)(i) >> 6] |= (uint64_t)1 << ((size_t)(i) & 63))
+
+/** Non-zero if line i is closed. */
+#define DONE_MASK_TEST(mask, i) (((mask)[(size_t)(i) >> 6] >> ((size_t)(i) & 63)) & 1)
+
+/**
+ * Takes a dummy point's cell into a line_min2() result. The line's costs
+ * cover its first covered entries; the dummy, if any, is entry covered, past
+ * them, and costs 0. It is folded in as line_min2() would have taken it as
+ * the last entry, so it only becomes the minimum on a strictly lower cost.
+ */
+#define LINE_MIN2_ADD_DUMMY(done, covered, len, min1, min2, argmin)  \
+    do {                                                            \
+        if ((covered) < (len) && !DONE_MASK_TEST(done, covered)) {  \
+            if (0 < *(min1)) {                                      \
+                *(min2) = *(min1);                                  \
+                *(min1) = 0;                                        \
+                *(argmin) = (covered);                              \
+            } else if (0 < *(min2)) {                               \
+                *(min2) = 0;                                        \
+            }                                                       \
+        }                                                           \
+    } while (0)
+
+uint64_t *alloc_done_mask(int n);
+
+void line_min2(const int *line, const uint64_t *done, int len, int *min1, int *min2, int *argmin);
+void line_min2_i64(const int64_t *line, const uint64_t *done, int len, int64_t *min1, int64_t *min2,
+                   int *argmin);
+void line_min2_f64(const double *line, const uint64_t *done, int len, double *min1, double *min2,
+                   int *argmin);
+
+#endif // LINE_KERNELS_H
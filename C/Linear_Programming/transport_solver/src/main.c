@@ -1,17 +1,24 @@
+#ifndef TP_TEMPLATE
+#define _POSIX_C_SOURCE 200809L  // getopt
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include "transport.h"
+#include "precision.h"
+#include "min_cost_flow.h"
+#include "sparse_problem.h"
+#include "batch.h"
 
 /**
  * Function to print the allocation matrix.
  * 
- * @param matrix 2D array containing the allocation results.
+ * @param matrix Row-major buffer containing the allocation results.
  * @param rows Number of supply points.
  * @param cols Number of demand points.
  */
 void print_allocation_matrix(
-        int **matrix,
+        const int *matrix,
         int rows,
         int cols
 ) {
@@ -27,85 +34,546 @@ void print_allocation_matrix(
     for (i = 0; i < rows; i++) {
         printf("S%-3d", i + 1);
         for (j = 0; j < cols; j++) {
-            printf("%-4d", matrix[i][j]);
+            printf("%-4d", matrix[(size_t)i * cols + j]);
         }
         printf("\n");
     }
 }
 
 /**
- * Balances the transportation problem by adding dummy supply or demand nodes if necessary.
- * 
- * @param tp Pointer to the TransportationProblem structure to be balanced.
+ * Solves a balanced problem with the given method.
+ *
+ * @param tp Pointer to the TransportationProblem structure.
+ * @param solution Solution to fill with the plan.
+ * @param method Solution method.
+ * @param num_threads Threads for the parallel VAM; 0 uses one per processor.
+ * @param print_iterations Boolean flag to enable/disable printing each iteration.
+ * @return Total cost of the transportation plan.
  */
-void balance_transport_problem(TransportProblem *tp) {
-    int total_supply = 0, total_demand = 0;
+static int solve(
+        TransportProblem *tp,
+        Solution *solution,
+        AllocationMethod method,
+        int num_threads,
+        Boolean print_iterations
+) {
+    switch (method) {
+        case VOGELS_APPROXIMATION:
+            return vogels_incremental_method(tp, solution, print_iterations);
+        case VOGELS_PARALLEL:
+            return vogels_parallel_method(tp, solution, num_threads, print_iterations);
+        case NORTH_WEST_CORNER:
+            return north_west_corner_method(tp, solution, print_iterations);
+        case LEAST_COST:
+            return least_cost_sorted_method(tp, solution, print_iterations);
+        case NETWORK_SIMPLEX:
+            return network_simplex_method(tp, solution, print_iterations);
+        case SUCCESSIVE_SHORTEST_PATH:
+            return min_cost_flow_method(tp, solution, MCF_SUCCESSIVE_SHORTEST_PATH,
+                                        print_iterations);
+        case COST_SCALING:
+            return min_cost_flow_method(tp, solution, MCF_COST_SCALING, print_iterations);
+        // Add more cases for additional methods
+        default:
+            fprintf(stderr, "Method not implemented.\n");
+            exit(EXIT_FAILURE);
+    }
+}
 
-    // Calculate total supply
-    for (int i = 0; i < tp->supply_size; i++) {
-        total_supply += tp->supply[i];
+/**
+ * Solves a balanced problem with forbidden routes with the given method.
+ *
+ * @param sp Pointer to the SparseTransportProblem structure.
+ * @param flow Pre-allocated per-route buffer to store the allocation results.
+ * @param method Solution method; vam, nwc, lcm, ssp and cs have sparse versions.
+ * @param print_iterations Boolean flag to enable/disable printing each iteration.
+ * @return Total cost of the transportation plan.
+ */
+static int solve_sparse(
+        SparseTransportProblem *sp,
+        int *flow,
+        AllocationMethod method,
+        Boolean print_iterations
+) {
+    switch (method) {
+        case VOGELS_APPROXIMATION:
+            return sparse_vogels_method(sp, flow, print_iterations);
+        case NORTH_WEST_CORNER:
+            return sparse_north_west_corner_method(sp, flow, print_iterations);
+        case LEAST_COST:
+            return sparse_least_cost_method(sp, flow, print_iterations);
+        case SUCCESSIVE_SHORTEST_PATH:
+            return sparse_min_cost_flow_method(sp, flow, MCF_SUCCESSIVE_SHORTEST_PATH,
+                                               print_iterations);
+        case COST_SCALING:
+            return sparse_min_cost_flow_method(sp, flow, MCF_COST_SCALING, print_iterations);
+        default:
+            fprintf(stderr, "Method not implemented for problems with forbidden routes.\n");
+            exit(EXIT_FAILURE);
     }
+}
+
+/**
+ * Tells whether a method only builds an initial solution, which MODI can
+ * then improve.
+ *
+ * @param method Solution method.
+ * @return TRUE for the heuristic methods.
+ */
+static Boolean is_initial_method(
+        AllocationMethod method
+) {
+    return (method == VOGELS_APPROXIMATION || method == VOGELS_PARALLEL ||
+            method == NORTH_WEST_CORNER || method == LEAST_COST) ? TRUE : FALSE;
+}
 
-    // Calculate total demand
-    for (int j = 0; j < tp->demand_size; j++) {
-        total_demand += tp->demand[j];
+/**
+ * Prints the batch mode usage.
+ *
+ * @param out Destination stream.
+ * @param prog Name the program was run as.
+ */
+static void print_usage(
+        FILE *out,
+        const char *prog
+) {
+    fprintf(out,
+            "Usage: %s                         interactive mode\n"
+            "       %s [options] PROBLEM       batch mode\n"
+            "       %s -b [options] STREAM...  throughput mode\n"
+            "\n"
+            "Options:\n"
+            "  -m METHOD  vam (default), pvam, nwc, lcm, ns, ssp or cs\n"
+            "             (vam, nwc, lcm, ssp or cs for a problem with forbidden routes)\n"
+            "  -p TYPE    quantities and costs are int32 (default), int64 or double;\n"
+            "             the wide types take text files with a cost matrix, no ns,\n"
+            "             and ssp and cs up to int64\n"
+            "  -b         solve every problem of the STREAM files, plain-text files of\n"
+            "             dense problems one after the other, in parallel; the solutions\n"
+            "             are written in input order (int32, no pvam or -v)\n"
+            "  -t N       threads for pvam or -b (default: one per processor)\n"
+            "  -M         optimise a vam, pvam, nwc or lcm solution with MODI\n"
+            "  -o FILE    write the solution to FILE instead of stdout\n"
+            "  -f FORMAT  solution layout: matrix (default), list (default with forbidden\n"
+            "             routes), csv or bin; list, csv and bin give only the cells that\n"
+            "             carry units\n"
+            "  -v         print each iteration\n"
+            "  -h         show this help\n"
+            "\n"
+            "Conversion (the problem is written as is, without solving):\n"
+            "  -C FILE    save PROBLEM as a binary problem file\n"
+            "  -W BITS    cost width of the binary file: 16, 32 (default) or 64\n"
+            "  -S COST    store only the cells whose cost is not COST (dense problems)\n",
+            prog, prog, prog);
+}
+
+/**
+ * Maps a method name from the command line to its AllocationMethod.
+ *
+ * @param name Method name.
+ * @param method Receives the method.
+ * @return TRUE if the name is known.
+ */
+static Boolean parse_method(
+        const char *name,
+        AllocationMethod *method
+) {
+    static const struct {
+        const char *name;
+        AllocationMethod method;
+    } methods[] = {
+        {"vam", VOGELS_APPROXIMATION},
+        {"pvam", VOGELS_PARALLEL},
+        {"nwc", NORTH_WEST_CORNER},
+        {"lcm", LEAST_COST},
+        {"ns", NETWORK_SIMPLEX},
+        {"ssp", SUCCESSIVE_SHORTEST_PATH},
+        {"cs", COST_SCALING}
+    };
+    size_t k;
+
+    for (k = 0; k < sizeof(methods) / sizeof(methods[0]); k++) {
+        if (strcmp(name, methods[k].name) == 0) {
+            *method = methods[k].method;
+            return TRUE;
+        }
     }
+    return FALSE;
+}
 
-    // Supply > Demand: Add Dummy Demand
-    if (total_supply > total_demand) {
-        int dummy_demand = total_supply - total_demand;
-        tp->demand = realloc(tp->demand, (tp->demand_size + 1) * sizeof(int));
-        if (!tp->demand) {
-            fprintf(stderr, "Memory allocation failed for dummy demand.\n");
-            exit(EXIT_FAILURE);
+/**
+ * Maps a precision name from the command line to its Precision.
+ *
+ * @param name Precision name.
+ * @param precision Receives the precision.
+ * @return TRUE if the name is known.
+ */
+static Boolean parse_precision(
+        const char *name,
+        Precision *precision
+) {
+    static const struct {
+        const char *name;
+        Precision precision;
+    } precisions[] = {
+        {"int32", PRECISION_INT32},
+        {"int64", PRECISION_INT64},
+        {"double", PRECISION_DOUBLE}
+    };
+    size_t k;
+
+    for (k = 0; k < sizeof(precisions) / sizeof(precisions[0]); k++) {
+        if (strcmp(name, precisions[k].name) == 0) {
+            *precision = precisions[k].precision;
+            return TRUE;
         }
-        tp->demand[tp->demand_size] = dummy_demand;
-        tp->demand_size++;
-
-        // Add zero-cost column to the cost matrix
-        for (int i = 0; i < tp->supply_size; i++) {
-            tp->cost_matrix[i] = realloc(tp->cost_matrix[i], tp->demand_size * sizeof(int));
-            if (!tp->cost_matrix[i]) {
-                fprintf(stderr, "Memory allocation failed for cost matrix expansion.\n");
-                exit(EXIT_FAILURE);
-            }
-            tp->cost_matrix[i][tp->demand_size - 1] = 0;  // Zero cost for dummy demand
+    }
+    return FALSE;
+}
+
+/**
+ * Maps a solution format name from the command line to its SolutionFormat.
+ *
+ * @param name Format name.
+ * @param format Receives the format.
+ * @return TRUE if the name is known.
+ */
+static Boolean parse_format(
+        const char *name,
+        SolutionFormat *format
+) {
+    static const struct {
+        const char *name;
+        SolutionFormat format;
+    } formats[] = {
+        {"matrix", SOLUTION_MATRIX},
+        {"list", SOLUTION_LIST},
+        {"csv", SOLUTION_CSV},
+        {"bin", SOLUTION_BINARY}
+    };
+    size_t k;
+
+    for (k = 0; k < sizeof(formats) / sizeof(formats[0]); k++) {
+        if (strcmp(name, formats[k].name) == 0) {
+            *format = formats[k].format;
+            return TRUE;
         }
     }
-    // Demand > Supply: Add Dummy Supply
-    else if (total_demand > total_supply) {
-        int dummy_supply = total_demand - total_supply;
-        tp->supply = realloc(tp->supply, (tp->supply_size + 1) * sizeof(int));
-        if (!tp->supply) {
-            fprintf(stderr, "Memory allocation failed for dummy supply.\n");
-            exit(EXIT_FAILURE);
+    return FALSE;
+}
+
+/**
+ * Opens the batch output.
+ *
+ * @param output_path Output file, or NULL for stdout.
+ * @return The stream, or NULL on error (reported on stderr).
+ */
+static FILE *open_output(
+        const char *output_path
+) {
+    FILE *out = output_path ? fopen(output_path, "w") : stdout;
+
+    if (!out) {
+        perror(output_path);
+    }
+    return out;
+}
+
+/**
+ * Closes the batch output.
+ *
+ * @param out Stream from open_output().
+ * @param output_path Output file, or NULL for stdout.
+ * @return EXIT_SUCCESS, or EXIT_FAILURE if the file could not be written.
+ */
+static int close_output(
+        FILE *out,
+        const char *output_path
+) {
+    if (out != stdout && fclose(out) != 0) {
+        perror(output_path);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// Batch solving of the wide precisions
+#define TP_TEMPLATE "main.c"
+#define TP_WIDE_ONLY
+#include "precision_template.h"
+
+/**
+ * Solves or converts a problem with forbidden routes in batch mode.
+ *
+ * @param sp Pointer to the loaded SparseTransportProblem structure; freed here.
+ * @param method Solution method.
+ * @param print_iterations Boolean flag to enable/disable printing each iteration.
+ * @param output_path Output file, or NULL for stdout.
+ * @param format Layout of the solution.
+ * @param convert_path Binary file to convert to, or NULL to solve.
+ * @param cost_bits Cost width of the binary file in bits.
+ * @return Process exit status.
+ */
+static int run_sparse_batch(
+        SparseTransportProblem *sp,
+        AllocationMethod method,
+        Boolean print_iterations,
+        const char *output_path,
+        SolutionFormat format,
+        const char *convert_path,
+        int cost_bits
+) {
+    int status = EXIT_FAILURE;
+
+    if (convert_path) {
+        if (save_sparse_problem_binary(convert_path, sp, cost_bits / 8) == 0) {
+            status = EXIT_SUCCESS;
         }
-        tp->supply[tp->supply_size] = dummy_supply;
-        tp->supply_size++;
+        free_sparse_problem(sp);
+        return status;
+    }
+    if (method == VOGELS_PARALLEL || method == NETWORK_SIMPLEX) {
+        fprintf(stderr, "pvam and ns need a dense problem; use vam, nwc, lcm, ssp or cs.\n");
+        free_sparse_problem(sp);
+        return EXIT_FAILURE;
+    }
 
-        // Add zero-cost row to the cost matrix
-        tp->cost_matrix = realloc(tp->cost_matrix, tp->supply_size * sizeof(int *));
-        if (!tp->cost_matrix) {
-            fprintf(stderr, "Memory allocation failed for cost matrix row addition.\n");
-            exit(EXIT_FAILURE);
+    if (balance_sparse_problem(sp) != 0) {
+        fprintf(stderr, "%s\n", solver_status_message(SOLVER_QUANTITY_OVERFLOW));
+        free_sparse_problem(sp);
+        return EXIT_FAILURE;
+    }
+    int *flow = alloc_sparse_results(sp);
+    int total_cost = solve_sparse(sp, flow, method, print_iterations);
+
+    if (!sparse_plan_is_complete(sp, flow)) {
+        fprintf(stderr, "No complete plan was found over the allowed routes.\n");
+    } else {
+        FILE *out = open_output(output_path);
+        if (out) {
+            Solution solution;
+            init_solution(&solution, sp->supply_size, sp->demand_size);
+            sparse_flow_to_solution(sp, flow, &solution);
+            write_solution(out, &solution, total_cost, format);
+            free_solution(&solution);
+            status = close_output(out, output_path);
         }
-        tp->cost_matrix[tp->supply_size - 1] = (int *)malloc(tp->demand_size * sizeof(int));
-        if (!tp->cost_matrix[tp->supply_size - 1]) {
-            fprintf(stderr, "Memory allocation failed for dummy supply row.\n");
-            exit(EXIT_FAILURE);
+    }
+
+    free_sparse_problem(sp);
+    free(flow);
+    return status;
+}
+
+/**
+ * Solves every problem of a set of problem streams in throughput mode.
+ *
+ * @param paths Stream files, or "-" for standard input.
+ * @param count Number of stream files.
+ * @param method Solution method.
+ * @param use_modi Boolean flag to optimise each solution with MODI.
+ * @param num_threads Number of threads; 0 uses one per processor.
+ * @param print_iterations Must be FALSE; iterations of parallel solves would interleave.
+ * @param precision Must be PRECISION_INT32.
+ * @param output_path Output file, or NULL for stdout.
+ * @param format Layout of the solutions.
+ * @param convert_path Must be NULL.
+ * @return Process exit status.
+ */
+static int run_stream_batch(
+        char *const *paths,
+        int count,
+        AllocationMethod method,
+        Boolean use_modi,
+        int num_threads,
+        Boolean print_iterations,
+        Precision precision,
+        const char *output_path,
+        SolutionFormat format,
+        const char *convert_path
+) {
+    if (method == VOGELS_PARALLEL || print_iterations || precision != PRECISION_INT32 ||
+            convert_path) {
+        fprintf(stderr, "-b solves int32 problems with any method but pvam, without -v or -C.\n");
+        return EXIT_FAILURE;
+    }
+
+    FILE *out = open_output(output_path);
+    if (!out) {
+        return EXIT_FAILURE;
+    }
+    int solved = solve_problem_streams(paths, count, method, use_modi, num_threads, out, format);
+    int status = close_output(out, output_path);
+    return (solved == 0) ? status : EXIT_FAILURE;
+}
+
+/**
+ * Solves one problem file without any prompts.
+ *
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return Process exit status.
+ */
+static int run_batch(
+        int argc,
+        char **argv
+) {
+    AllocationMethod method = VOGELS_APPROXIMATION;
+    Precision precision = PRECISION_INT32;
+    Boolean use_modi = FALSE;
+    Boolean print_iterations = FALSE;
+    Boolean streams = FALSE;
+    const char *output_path = NULL;
+    SolutionFormat format = SOLUTION_MATRIX;
+    Boolean format_given = FALSE;
+    const char *convert_path = NULL;
+    int cost_bits = 32;
+    Boolean sparse = FALSE;
+    int default_cost = 0;
+    int num_threads = 0;
+    int opt;
+    TransportProblem tp;
+    SparseTransportProblem sp;
+
+    while ((opt = getopt(argc, argv, "m:p:t:Mbo:f:vhC:W:S:")) != -1) {
+        switch (opt) {
+            case 'm':
+                if (!parse_method(optarg, &method)) {
+                    fprintf(stderr, "Unknown method '%s'.\n", optarg);
+                    print_usage(stderr, argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'p':
+                if (!parse_precision(optarg, &precision)) {
+                    fprintf(stderr, "Unknown precision '%s'.\n", optarg);
+                    print_usage(stderr, argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 't':
+                num_threads = atoi(optarg);
+                break;
+            case 'M':
+                use_modi = TRUE;
+                break;
+            case 'b':
+                streams = TRUE;
+                break;
+            case 'o':
+                output_path = optarg;
+                break;
+            case 'f':
+                if (!parse_format(optarg, &format)) {
+                    fprintf(stderr, "Unknown solution format '%s'.\n", optarg);
+                    print_usage(stderr, argv[0]);
+                    return EXIT_FAILURE;
+                }
+                format_given = TRUE;
+                break;
+            case 'v':
+                print_iterations = TRUE;
+                break;
+            case 'h':
+                print_usage(stdout, argv[0]);
+                return EXIT_SUCCESS;
+            case 'C':
+                convert_path = optarg;
+                break;
+            case 'W':
+                cost_bits = atoi(optarg);
+                break;
+            case 'S':
+                sparse = TRUE;
+                default_cost = atoi(optarg);
+                break;
+            default:
+                print_usage(stderr, argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind == argc || (!streams && optind != argc - 1)) {
+        print_usage(stderr, argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (use_modi && !is_initial_method(method)) {
+        fprintf(stderr, "-M only applies to vam, pvam, nwc and lcm.\n");
+        return EXIT_FAILURE;
+    }
+    if (streams) {
+        return run_stream_batch(argv + optind, argc - optind, method, use_modi, num_threads,
+                                print_iterations, precision, output_path, format, convert_path);
+    }
+    if (precision != PRECISION_INT32) {
+        if (convert_path) {
+            fprintf(stderr, "-C needs int32 precision.\n");
+            return EXIT_FAILURE;
+        }
+        if (method == NETWORK_SIMPLEX ||
+                (precision == PRECISION_DOUBLE &&
+                 (method == SUCCESSIVE_SHORTEST_PATH || method == COST_SCALING))) {
+            fprintf(stderr, "ns needs int32 precision, ssp and cs int32 or int64.\n");
+            return EXIT_FAILURE;
         }
-        for (int j = 0; j < tp->demand_size; j++) {
-            tp->cost_matrix[tp->supply_size - 1][j] = 0;  // Zero cost for dummy supply
+        if (precision == PRECISION_INT64) {
+            return run_wide_batch_i64(argv[optind], method, use_modi, num_threads,
+                                      print_iterations, output_path, format);
         }
+        return run_wide_batch_f64(argv[optind], method, use_modi, num_threads,
+                                  print_iterations, output_path, format);
     }
-    // Balanced: No Action Needed
-    else {
-        // The problem is already balanced
-        return;
+
+    int loaded = load_any_problem_file(argv[optind], &tp, &sp);
+    if (loaded < 0) {
+        return EXIT_FAILURE;
     }
+    if (loaded == 1) {
+        if (use_modi || sparse) {
+            fprintf(stderr, "-M and -S need a dense problem.\n");
+            free_sparse_problem(&sp);
+            return EXIT_FAILURE;
+        }
+        return run_sparse_batch(&sp, method, print_iterations, output_path,
+                                format_given ? format : SOLUTION_LIST, convert_path, cost_bits);
+    }
+    if (convert_path) {
+        int saved = save_problem_binary(convert_path, &tp, cost_bits / 8, sparse, default_cost);
+        free_transport_problem(&tp);
+        return (saved == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (balance_transport_problem(&tp) != 0) {
+        fprintf(stderr, "%s\n", solver_status_message(SOLVER_QUANTITY_OVERFLOW));
+        free_transport_problem(&tp);
+        return EXIT_FAILURE;
+    }
+    Solution solution;
+    init_solution(&solution, tp.supply_size, tp.demand_size);
+
+    int total_cost = solve(&tp, &solution, method, num_threads, print_iterations);
+    if (use_modi) {
+        total_cost = modi_method(&tp, &solution, print_iterations);
+    }
+
+    FILE *out = open_output(output_path);
+    if (!out) {
+        free_transport_problem(&tp);
+        free_solution(&solution);
+        return EXIT_FAILURE;
+    }
+    write_solution(out, &solution, total_cost, format);
+    int status = close_output(out, output_path);
+
+    free_transport_problem(&tp);
+    free_solution(&solution);
+    return status;
 }
 
-int main() {
+/**
+ * Asks for the problem and the method at the prompts and solves it.
+ *
+ * @return Process exit status.
+ */
+static int run_interactive(void) {
 
     char choice[MAX_INPUT_SIZE];
     int supply_size, demand_size;
@@ -126,13 +594,8 @@ int main() {
     printf("Enter the number of demand points: ");
     scanf("%d", &demand_size);
 
-    // Initialize the transportation problem
-    tp.supply_size = supply_size;
-    tp.demand_size = demand_size;
-
-    // Allocate memory for supply and demand vectors
-    tp.supply = (int *)malloc(supply_size * sizeof(int));
-    tp.demand = (int *)malloc(demand_size * sizeof(int));
+    // Initialize the transportation problem (vectors and one contiguous cost buffer)
+    init_transport_problem(&tp, supply_size, demand_size);
 
     // Input supply vector
     input_vector(tp.supply, supply_size, "Enter the supply vector");
@@ -140,14 +603,8 @@ int main() {
     // Input demand vector
     input_vector(tp.demand, demand_size, "Enter the demand vector");
 
-    // Allocate memory for cost matrix
-    tp.cost_matrix = (int **)malloc(supply_size * sizeof(int *));
-    for (int i = 0; i < supply_size; i++) {
-        tp.cost_matrix[i] = (int *)malloc(demand_size * sizeof(int));
-    }
-
     // Input cost matrix
-    input_matrix(tp.cost_matrix, supply_size, demand_size, "Enter the cost matrix");
+    input_matrix(tp.cost, supply_size, demand_size, "Enter the cost matrix");
 
     // Output final result for confirmation
     printf("\nFinal Supply Vector: ");
@@ -155,30 +612,31 @@ int main() {
     printf("Final Demand Vector: ");
     print_vector(tp.demand, tp.demand_size);
     printf("Final Cost Matrix: \n");
-    print_matrix(tp.cost_matrix, tp.supply_size, tp.demand_size);
+    print_matrix(tp.cost, tp.supply_size, tp.demand_size);
 
     // Balance the transportation problem
-    balance_transport_problem(&tp);
-
-    // Allocate results matrix
-    int **results = (int **)malloc(tp.supply_size * sizeof(int *));
-    for (int i = 0; i < tp.supply_size; i++) {
-        results[i] = (int *)malloc(tp.demand_size * sizeof(int));
-        if (!results[i]) {
-            fprintf(stderr, "Memory allocation failed for results row %d.\n", i);
-            exit(EXIT_FAILURE);
-        }
+    if (balance_transport_problem(&tp) != 0) {
+        fprintf(stderr, "%s\n", solver_status_message(SOLVER_QUANTITY_OVERFLOW));
+        free_transport_problem(&tp);
+        return EXIT_FAILURE;
     }
 
+    // The plan, as the cells that carry units
+    Solution solution;
+    init_solution(&solution, tp.supply_size, tp.demand_size);
+
     // Ask user for solution method
     printf("Select Allocation Method:\n");
     printf("1. Vogel's Approximation Method\n");
     printf("2. North-West Corner Method\n");
     printf("3. Least Cost Method\n");  // Added Least Cost Method option
+    printf("4. Network Simplex Method (optimal)\n");
+    printf("5. Min-Cost Flow, Successive Shortest Paths (optimal)\n");
+    printf("6. Min-Cost Flow, Cost Scaling (optimal)\n");
 
     int selected;
     while (1) {
-        printf("Enter your choice(1,2,3): ");
+        printf("Enter your choice(1-6): ");
         if (scanf("%d", &selected) == 1) {
             break; // Valid input received
         } else {
@@ -200,6 +658,15 @@ int main() {
         case 3:
             method = LEAST_COST;
             break;
+        case 4:
+            method = NETWORK_SIMPLEX;
+            break;
+        case 5:
+            method = SUCCESSIVE_SHORTEST_PATH;
+            break;
+        case 6:
+            method = COST_SCALING;
+            break;
         default:
             fprintf(stderr, "Invalid choice.\n");
             exit(EXIT_FAILURE);
@@ -213,37 +680,137 @@ int main() {
         print_iterations = TRUE;
     }
 
-    int total_cost = 0;
+    int total_cost = solve(&tp, &solution, method, 0, print_iterations);
+
+    // Ask user if they want to improve the initial solution to an optimal one
+    if (is_initial_method(method)) {
+        printf("Do you want to optimise the solution with the MODI method? (y/n): ");
+        scanf("%s", choice);
+        if (strcmp(choice, "y") == 0 || strcmp(choice, "Y") == 0) {
+            printf("\nInitial Total Cost: %d\n", total_cost);
+            total_cost = modi_method(&tp, &solution, print_iterations);
+        }
+    }
+
+    printf("\nSolution:\n");
+    int *matrix = solution_to_matrix(&solution);
+    print_matrix(matrix, tp.supply_size, tp.demand_size);
+    printf("Total Cost: %d\n", total_cost);
+
+    // Free allocated memory
+    free_transport_problem(&tp);
+    free_solution(&solution);
+    free(matrix);
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    // Any argument selects the batch mode
+    if (argc > 1) {
+        return run_batch(argc, argv);
+    }
+    return run_interactive();
+}
+
+#else // Template body
+
+#define solve_wide TP_NAME(solve_wide)
+#define run_wide_batch TP_NAME(run_wide_batch)
+
+/**
+ * Solves a balanced problem of the precision with the given method.
+ *
+ * @param tp Pointer to the problem structure.
+ * @param solution Solution to fill with the plan.
+ * @param method Solution method; vam, pvam, nwc and lcm, and ssp and cs for integers.
+ * @param num_threads Threads for the parallel VAM; 0 uses one per processor.
+ * @param print_iterations Boolean flag to enable/disable printing each iteration.
+ * @return Total cost of the transportation plan.
+ */
+static TP_VALUE solve_wide(
+        TP_PROBLEM *tp,
+        TP_SOLUTION *solution,
+        AllocationMethod method,
+        int num_threads,
+        Boolean print_iterations
+) {
     switch (method) {
         case VOGELS_APPROXIMATION:
-            total_cost = vogels_approximation_method(&tp, results, print_iterations);
-            break;
+            return TP_NAME(vogels_approximation_method)(tp, solution, print_iterations);
+        case VOGELS_PARALLEL:
+            return TP_NAME(vogels_parallel_method)(tp, solution, num_threads, print_iterations);
         case NORTH_WEST_CORNER:
-            total_cost = north_west_corner_method(&tp, results, print_iterations);
-            break;
+            return TP_NAME(north_west_corner_method)(tp, solution, print_iterations);
         case LEAST_COST:
-            total_cost = least_cost_method(&tp, results, print_iterations);
-            break;
-        // Add more cases for additional methods
+            return TP_NAME(least_cost_method)(tp, solution, print_iterations);
+#if !TP_FLOATING
+        case SUCCESSIVE_SHORTEST_PATH:
+            return TP_NAME(min_cost_flow_method)(tp, solution, MCF_SUCCESSIVE_SHORTEST_PATH,
+                                                 print_iterations);
+        case COST_SCALING:
+            return TP_NAME(min_cost_flow_method)(tp, solution, MCF_COST_SCALING, print_iterations);
+#endif
         default:
-            fprintf(stderr, "Method not implemented.\n");
+            fprintf(stderr, "Method not implemented in this precision.\n");
             exit(EXIT_FAILURE);
     }
+}
 
-    printf("\nSolution:\n");
-    print_matrix(results, tp.supply_size, tp.demand_size);
-    printf("Total Cost: %d\n", total_cost);
+/**
+ * Solves one plain-text problem file of the precision without any prompts.
+ *
+ * @param path Problem file, or "-" for standard input.
+ * @param method Solution method.
+ * @param use_modi Boolean flag to optimise the solution with MODI.
+ * @param num_threads Threads for the parallel VAM; 0 uses one per processor.
+ * @param print_iterations Boolean flag to enable/disable printing each iteration.
+ * @param output_path Output file, or NULL for stdout.
+ * @param format Layout of the solution.
+ * @return Process exit status.
+ */
+static int run_wide_batch(
+        const char *path,
+        AllocationMethod method,
+        Boolean use_modi,
+        int num_threads,
+        Boolean print_iterations,
+        const char *output_path,
+        SolutionFormat format
+) {
+    TP_PROBLEM tp;
+    TP_SOLUTION solution;
 
-    // Free allocated memory
-    for (int i = 0; i < tp.supply_size; i++) {
-        free(tp.cost_matrix[i]);
-        free(results[i]);
+    if (TP_NAME(load_problem_file)(path, &tp) != 0) {
+        return EXIT_FAILURE;
+    }
+    if (TP_NAME(balance_transport_problem)(&tp) != 0) {
+        fprintf(stderr, "%s\n", solver_status_message(SOLVER_QUANTITY_OVERFLOW));
+        TP_NAME(free_transport_problem)(&tp);
+        return EXIT_FAILURE;
     }
-    free(tp.cost_matrix);
-    free(tp.supply);
-    free(tp.demand);
-    free(results);
+    TP_NAME(init_solution)(&solution, tp.supply_size, tp.demand_size);
 
-    return 0;
+    TP_VALUE total_cost = solve_wide(&tp, &solution, method, num_threads, print_iterations);
+    if (use_modi) {
+        total_cost = TP_NAME(modi_method)(&tp, &solution, print_iterations);
+    }
+
+    FILE *out = open_output(output_path);
+    if (!out) {
+        TP_NAME(free_transport_problem)(&tp);
+        TP_NAME(free_solution)(&solution);
+        return EXIT_FAILURE;
+    }
+    TP_NAME(write_solution)(out, &solution, total_cost, format);
+    int status = close_output(out, output_path);
+
+    TP_NAME(free_transport_problem)(&tp);
+    TP_NAME(free_solution)(&solution);
+    return status;
 }
 
+#undef solve_wide
+#undef run_wide_batch
+
+#endif // TP_TEMPLATE
@@ -0,0 +1,833 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "min_cost_flow.h"
+#include "sparse_problem.h"
+
+#define COST_SCALING_ALPHA 16 // Epsilon shrinks by this factor per refine phase
+#define DIST_INFINITY LLONG_MAX
+
+/**
+ * Allocates an empty flow network.
+ *
+ * @param node_count Number of nodes.
+ * @param arc_hint Expected number of arcs (may be 0).
+ * @return Pointer to the new network.
+ */
+FlowNetwork *init_flow_network(
+        int node_count,
+        int arc_hint
+) {
+    FlowNetwork *net = (FlowNetwork *)calloc(1, sizeof(FlowNetwork));
+
+    if (arc_hint < 16) {
+        arc_hint = 16;
+    }
+    if (net) {
+        net->node_count = node_count;
+        net->arc_capacity = arc_hint;
+        net->supply = (long long *)calloc(node_count + 1, sizeof(long long));
+        net->arc_tail = (int *)malloc(arc_hint * sizeof(int));
+        net->arc_head = (int *)malloc(arc_hint * sizeof(int));
+        net->arc_cap = (long long *)malloc(arc_hint * sizeof(long long));
+        net->arc_cost = (long long *)malloc(arc_hint * sizeof(long long));
+    }
+    if (!net || !net->supply || !net->arc_tail || !net->arc_head || !net->arc_cap ||
+            !net->arc_cost) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    return net;
+}
+
+/**
+ * Adds a directed arc to the network.
+ *
+ * @param net Pointer to the network.
+ * @param tail Node the arc leaves.
+ * @param head Node the arc enters.
+ * @param capacity Upper bound on the flow (finite, non-negative).
+ * @param cost Cost per unit of flow.
+ * @return Index of the arc, for flow_on_arc().
+ */
+int add_flow_arc(
+        FlowNetwork *net,
+        int tail,
+        int head,
+        long long capacity,
+        long long cost
+) {
+    if (net->arc_count == net->arc_capacity) {
+        net->arc_capacity *= 2;
+        net->arc_tail = (int *)realloc(net->arc_tail, net->arc_capacity * sizeof(int));
+        net->arc_head = (int *)realloc(net->arc_head, net->arc_capacity * sizeof(int));
+        net->arc_cap = (long long *)realloc(net->arc_cap, net->arc_capacity * sizeof(long long));
+        net->arc_cost = (long long *)realloc(net->arc_cost, net->arc_capacity * sizeof(long long));
+        if (!net->arc_tail || !net->arc_head || !net->arc_cap || !net->arc_cost) {
+            fprintf(stderr, "Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    net->arc_tail[net->arc_count] = tail;
+    net->arc_head[net->arc_count] = head;
+    net->arc_cap[net->arc_count] = capacity;
+    net->arc_cost[net->arc_count] = cost;
+    return net->arc_count++;
+}
+
+/**
+ * Sets the supply of a node: positive where flow originates, negative where
+ * it is consumed. Supplies must sum to zero.
+ *
+ * @param net Pointer to the network.
+ * @param node Node index.
+ * @param supply Supply of the node.
+ */
+void set_node_supply(
+        FlowNetwork *net,
+        int node,
+        long long supply
+) {
+    net->supply[node] = supply;
+}
+
+/**
+ * Frees the memory allocated for a network.
+ *
+ * @param net Pointer to the network (may be NULL).
+ */
+void free_flow_network(
+        FlowNetwork *net
+) {
+    if (!net) {
+        return;
+    }
+    free(net->supply);
+    free(net->arc_tail);
+    free(net->arc_head);
+    free(net->arc_cap);
+    free(net->arc_cost);
+    free(net->first);
+    free(net->head);
+    free(net->rev);
+    free(net->residual);
+    free(net->cost);
+    free(net->arc_pos);
+    free(net);
+}
+
+/**
+ * Returns the flow on an added arc after solve_min_cost_flow().
+ *
+ * @param net Pointer to the solved network.
+ * @param arc Index returned by add_flow_arc().
+ * @return Flow on the arc.
+ */
+long long flow_on_arc(
+        const FlowNetwork *net,
+        int arc
+) {
+    // The reverse residual arc holds exactly the flow pushed forward
+    return net->residual[net->rev[net->arc_pos[arc]]];
+}
+
+/**
+ * Builds the CSR residual graph from the added arcs with a counting sort by
+ * tail. Arc a becomes a forward residual arc at its tail (capacity cap) and
+ * a reverse one at its head (capacity 0, negated cost).
+ *
+ * @param net Pointer to the network.
+ */
+static void build_residual_graph(
+        FlowNetwork *net
+) {
+    int nodes = net->node_count;
+    int total = 2 * net->arc_count;
+    int a, v, f, r;
+    int *next;
+
+    free(net->first);
+    free(net->head);
+    free(net->rev);
+    free(net->residual);
+    free(net->cost);
+    free(net->arc_pos);
+    net->first = (int *)calloc(nodes + 1, sizeof(int));
+    net->head = (int *)malloc((total + 1) * sizeof(int));
+    net->rev = (int *)malloc((total + 1) * sizeof(int));
+    net->residual = (long long *)malloc((total + 1) * sizeof(long long));
+    net->cost = (long long *)malloc((total + 1) * sizeof(long long));
+    net->arc_pos = (int *)malloc((net->arc_count + 1) * sizeof(int));
+    next = (int *)malloc((nodes + 1) * sizeof(int));
+    if (!net->first || !net->head || !net->rev || !net->residual || !net->cost ||
+            !net->arc_pos || !next) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (a = 0; a < net->arc_count; a++) {
+        net->first[net->arc_tail[a] + 1]++;
+        net->first[net->arc_head[a] + 1]++;
+    }
+    for (v = 0; v < nodes; v++) {
+        net->first[v + 1] += net->first[v];
+        next[v] = net->first[v];
+    }
+
+    for (a = 0; a < net->arc_count; a++) {
+        f = next[net->arc_tail[a]]++;
+        r = next[net->arc_head[a]]++;
+        net->head[f] = net->arc_head[a];
+        net->rev[f] = r;
+        net->residual[f] = net->arc_cap[a];
+        net->cost[f] = net->arc_cost[a];
+        net->head[r] = net->arc_tail[a];
+        net->rev[r] = f;
+        net->residual[r] = 0;
+        net->cost[r] = -net->arc_cost[a];
+        net->arc_pos[a] = f;
+    }
+
+    free(next);
+}
+
+/* --- successive shortest paths -------------------------------------------- */
+
+/**
+ * Restores heap order upwards from position i of a binary min-heap of
+ * (key, node) pairs.
+ *
+ * @param key Heap keys.
+ * @param node Heap nodes.
+ * @param i Position to sift up from.
+ */
+static void heap_sift_up(
+        long long *key,
+        int *node,
+        int i
+) {
+    long long k = key[i];
+    int v = node[i];
+
+    while (i > 0 && key[(i - 1) / 2] > k) {
+        key[i] = key[(i - 1) / 2];
+        node[i] = node[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    key[i] = k;
+    node[i] = v;
+}
+
+/**
+ * Removes the root of a binary min-heap of (key, node) pairs.
+ *
+ * @param key Heap keys.
+ * @param node Heap nodes.
+ * @param size Number of entries before the removal.
+ */
+static void heap_pop(
+        long long *key,
+        int *node,
+        int size
+) {
+    long long k = key[size - 1];
+    int v = node[size - 1];
+    int i = 0, c;
+
+    size--;
+    while ((c = 2 * i + 1) < size) {
+        if (c + 1 < size && key[c + 1] < key[c]) c++;
+        if (key[c] >= k) break;
+        key[i] = key[c];
+        node[i] = node[c];
+        i = c;
+    }
+    key[i] = k;
+    node[i] = v;
+}
+
+/**
+ * Successive shortest paths. Negative-cost arcs are saturated up front so
+ * every residual arc starts with a non-negative reduced cost; each round
+ * then runs Dijkstra from all nodes with excess at once, stops at the first
+ * node with a deficit, augments along that path and shifts the potentials
+ * of the settled nodes so reduced costs stay non-negative.
+ *
+ * @param net Pointer to the network with its residual graph built.
+ * @param excess Per-node excess, initialised to the supplies.
+ * @param print_iterations Boolean flag to enable/disable printing each augmentation.
+ * @return MCF_OPTIMAL, or MCF_INFEASIBLE if some excess cannot reach a deficit.
+ */
+static McfStatus successive_shortest_path(
+        FlowNetwork *net,
+        long long *excess,
+        Boolean print_iterations
+) {
+    int nodes = net->node_count;
+    int total = 2 * net->arc_count;
+    long long *pi = (long long *)calloc(nodes, sizeof(long long));
+    long long *dist = (long long *)malloc(nodes * sizeof(long long));
+    int *pred = (int *)malloc(nodes * sizeof(int));
+    Boolean *settled = (Boolean *)calloc(nodes, sizeof(Boolean));
+    int *touched = (int *)malloc(nodes * sizeof(int));
+    long long *heap_key = (long long *)malloc((total + nodes + 1) * sizeof(long long));
+    int *heap_node = (int *)malloc((total + nodes + 1) * sizeof(int));
+    McfStatus status = MCF_OPTIMAL;
+    int a, u, v, t, heap_size, touched_count, length, augmentation = 0;
+    long long d, delta, path_cost;
+
+    if (!pi || !dist || !pred || !settled || !touched || !heap_key || !heap_node) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (a = 0; a < total; a++) {
+        if (net->cost[a] < 0 && net->residual[a] > 0) {
+            delta = net->residual[a];
+            net->residual[a] = 0;
+            net->residual[net->rev[a]] += delta;
+            excess[net->head[net->rev[a]]] -= delta;
+            excess[net->head[a]] += delta;
+        }
+    }
+    for (v = 0; v < nodes; v++) {
+        dist[v] = DIST_INFINITY;
+    }
+
+    while (1) {
+        heap_size = 0;
+        touched_count = 0;
+        for (v = 0; v < nodes; v++) {
+            if (excess[v] > 0) {
+                dist[v] = 0;
+                pred[v] = -1;
+                touched[touched_count++] = v;
+                heap_key[heap_size] = 0;
+                heap_node[heap_size] = v;
+                heap_sift_up(heap_key, heap_node, heap_size++);
+            }
+        }
+        if (heap_size == 0) {
+            break;  // Every excess has been routed
+        }
+
+        // Dijkstra on reduced costs until the first deficit node is settled
+        t = -1;
+        while (heap_size > 0) {
+            d = heap_key[0];
+            u = heap_node[0];
+            heap_pop(heap_key, heap_node, heap_size--);
+            if (settled[u] || d > dist[u]) continue;
+            settled[u] = TRUE;
+            if (excess[u] < 0) {
+                t = u;
+                break;
+            }
+            for (a = net->first[u]; a < net->first[u + 1]; a++) {
+                if (net->residual[a] == 0) continue;
+                v = net->head[a];
+                if (settled[v]) continue;
+                d = dist[u] + net->cost[a] + pi[u] - pi[v];
+                if (d < dist[v]) {
+                    if (dist[v] == DIST_INFINITY) {
+                        touched[touched_count++] = v;
+                    }
+                    dist[v] = d;
+                    pred[v] = a;
+                    heap_key[heap_size] = d;
+                    heap_node[heap_size] = v;
+                    heap_sift_up(heap_key, heap_node, heap_size++);
+                }
+            }
+        }
+        if (t == -1) {
+            status = MCF_INFEASIBLE;
+            break;
+        }
+
+        // Bottleneck along the path back to its source
+        delta = -excess[t];
+        length = 0;
+        path_cost = 0;
+        for (v = t; pred[v] != -1; v = net->head[net->rev[pred[v]]]) {
+            if (net->residual[pred[v]] < delta) delta = net->residual[pred[v]];
+            path_cost += net->cost[pred[v]];
+            length++;
+        }
+        if (excess[v] < delta) delta = excess[v];
+        excess[v] -= delta;
+        excess[t] += delta;
+        for (v = t; pred[v] != -1; v = net->head[net->rev[pred[v]]]) {
+            net->residual[pred[v]] -= delta;
+            net->residual[net->rev[pred[v]]] += delta;
+        }
+
+        augmentation++;
+        if (print_iterations) {
+            printf("Augmentation %d: %lld units along %d arcs at unit cost %lld.\n",
+                   augmentation, delta, length, path_cost);
+        }
+
+        // Settled nodes move by their distance relative to t; everything else
+        // keeps its potential, which is the same shift up to a constant
+        for (u = 0; u < touched_count; u++) {
+            v = touched[u];
+            if (settled[v]) {
+                pi[v] += dist[v] - dist[t];
+            }
+        }
+        for (u = 0; u < touched_count; u++) {
+            dist[touched[u]] = DIST_INFINITY;
+            settled[touched[u]] = FALSE;
+        }
+    }
+
+    free(pi);
+    free(dist);
+    free(pred);
+    free(settled);
+    free(touched);
+    free(heap_key);
+    free(heap_node);
+
+    return status;
+}
+
+/* --- cost scaling --------------------------------------------------------- */
+
+/**
+ * Goldberg-Tarjan cost scaling. Costs are multiplied by the node count so
+ * that an epsilon of 1 in scaled units means optimality in the original
+ * ones. Each refine phase saturates every arc with negative reduced cost
+ * and then discharges active nodes in FIFO order: push along admissible
+ * arcs (residual capacity and negative reduced cost) from the current-arc
+ * pointer, relabel when none is left.
+ *
+ * @param net Pointer to the network with its residual graph built.
+ * @param excess Per-node excess, initialised to the supplies.
+ * @param print_iterations Boolean flag to enable/disable printing each refine phase.
+ * @return MCF_OPTIMAL, or MCF_INFEASIBLE if the supplies cannot be routed.
+ */
+static McfStatus cost_scaling(
+        FlowNetwork *net,
+        long long *excess,
+        Boolean print_iterations
+) {
+    int nodes = net->node_count;
+    int total = 2 * net->arc_count;
+    long long *pi = (long long *)calloc(nodes, sizeof(long long));
+    long long *pi_start = (long long *)malloc(nodes * sizeof(long long));
+    int *current = (int *)malloc(nodes * sizeof(int));
+    int *queue = (int *)malloc((nodes + 1) * sizeof(int));
+    Boolean *queued = (Boolean *)calloc(nodes, sizeof(Boolean));
+    McfStatus status = MCF_OPTIMAL;
+    long long epsilon = 1, max_cost = 0, c, delta, best, bound, pushes, relabels, previous;
+    int a, u, v, front, back, count, phase = 0;
+
+    if (!pi || !pi_start || !current || !queue || !queued) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (a = 0; a < total; a++) {
+        net->cost[a] *= nodes;
+        c = (net->cost[a] < 0) ? -net->cost[a] : net->cost[a];
+        if (c > max_cost) max_cost = c;
+    }
+    if (max_cost > epsilon) {
+        epsilon = max_cost;
+    }
+
+    do {
+        previous = epsilon;
+        epsilon = (epsilon / COST_SCALING_ALPHA > 1) ? epsilon / COST_SCALING_ALPHA : 1;
+        // A node with excess keeps a residual path of at most nodes - 1 arcs
+        // to a deficit, each previous-epsilon-optimal from the last phase (not
+        // alpha * epsilon: the division rounds and clamps), so a feasible
+        // network never needs a larger drop than this
+        bound = (previous + epsilon) * nodes + epsilon;
+        pushes = 0;
+        relabels = 0;
+
+        for (a = 0; a < total; a++) {
+            u = net->head[net->rev[a]];
+            v = net->head[a];
+            if (net->residual[a] > 0 && net->cost[a] + pi[u] - pi[v] < 0) {
+                delta = net->residual[a];
+                net->residual[a] = 0;
+                net->residual[net->rev[a]] += delta;
+                excess[u] -= delta;
+                excess[v] += delta;
+            }
+        }
+
+        // The queue is a ring: a node is in it at most once
+        front = 0;
+        back = 0;
+        count = 0;
+        for (v = 0; v < nodes; v++) {
+            current[v] = net->first[v];
+            pi_start[v] = pi[v];
+            if (excess[v] > 0) {
+                queue[back] = v;
+                back = (back + 1) % (nodes + 1);
+                queued[v] = TRUE;
+                count++;
+            }
+        }
+
+        while (count > 0 && status == MCF_OPTIMAL) {
+            u = queue[front];
+            front = (front + 1) % (nodes + 1);
+            queued[u] = FALSE;
+            count--;
+
+            while (excess[u] > 0) {
+                for (a = current[u]; a < net->first[u + 1]; a++) {
+                    if (net->residual[a] == 0) continue;
+                    v = net->head[a];
+                    if (net->cost[a] + pi[u] - pi[v] >= 0) continue;
+                    delta = (excess[u] < net->residual[a]) ? excess[u] : net->residual[a];
+                    net->residual[a] -= delta;
+                    net->residual[net->rev[a]] += delta;
+                    excess[u] -= delta;
+                    excess[v] += delta;
+                    pushes++;
+                    if (excess[v] > 0 && !queued[v]) {
+                        queue[back] = v;
+                        back = (back + 1) % (nodes + 1);
+                        queued[v] = TRUE;
+                        count++;
+                    }
+                    if (excess[u] == 0) break;
+                }
+                current[u] = a;
+                if (excess[u] == 0) break;
+
+                // Relabel: make the best residual arc admissible by epsilon
+                best = LLONG_MIN;
+                for (a = net->first[u]; a < net->first[u + 1]; a++) {
+                    if (net->residual[a] > 0 && pi[net->head[a]] - net->cost[a] > best) {
+                        best = pi[net->head[a]] - net->cost[a];
+                    }
+                }
+                if (best == LLONG_MIN || pi_start[u] - (best - epsilon) > bound) {
+                    status = MCF_INFEASIBLE;
+                    break;
+                }
+                pi[u] = best - epsilon;
+                current[u] = net->first[u];
+                relabels++;
+            }
+        }
+
+        phase++;
+        if (print_iterations) {
+            printf("Refine %d: epsilon %lld, %lld pushes, %lld relabels.\n",
+                   phase, epsilon, pushes, relabels);
+        }
+    } while (epsilon > 1 && status == MCF_OPTIMAL);
+
+    for (a = 0; a < total; a++) {
+        net->cost[a] /= nodes;
+    }
+
+    free(pi);
+    free(pi_start);
+    free(current);
+    free(queue);
+    free(queued);
+
+    return status;
+}
+
+/**
+ * Solves the minimum-cost flow problem on the network.
+ *
+ * @param net Pointer to the network; supplies must sum to zero.
+ * @param algorithm Which algorithm to run.
+ * @param total_cost Receives the cost of the optimal flow.
+ * @param print_iterations Boolean flag to enable/disable printing progress.
+ * @return MCF_OPTIMAL, or MCF_INFEASIBLE if the supplies cannot be routed.
+ */
+McfStatus solve_min_cost_flow(
+        FlowNetwork *net,
+        McfAlgorithm algorithm,
+        long long *total_cost,
+        Boolean print_iterations
+) {
+    long long *excess = (long long *)malloc((net->node_count + 1) * sizeof(long long));
+    long long sum = 0;
+    McfStatus status;
+    int v, a;
+
+    if (!excess) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (v = 0; v < net->node_count; v++) {
+        excess[v] = net->supply[v];
+        sum += net->supply[v];
+    }
+
+    build_residual_graph(net);
+
+    if (sum != 0) {
+        status = MCF_INFEASIBLE;
+    } else if (algorithm == MCF_COST_SCALING) {
+        status = cost_scaling(net, excess, print_iterations);
+    } else {
+        status = successive_shortest_path(net, excess, print_iterations);
+    }
+
+    *total_cost = 0;
+    if (status == MCF_OPTIMAL) {
+        for (a = 0; a < net->arc_count; a++) {
+            *total_cost += flow_on_arc(net, a) * net->arc_cost[a];
+        }
+    }
+
+    free(excess);
+
+    return status;
+}
+
+/**
+ * Solves the transportation problem to optimality as a min-cost flow on the
+ * bipartite network: row i is node i, column j is node m + j, and each cell
+ * is an arc with capacity equal to the total supply.
+ *
+ * @param tp Pointer to a balanced TransportationProblem structure.
+ * @param solution Solution to fill with the optimal plan; emptied first.
+ * @param algorithm Min-cost flow algorithm to use.
+ * @param total_cost Receives the total cost of the optimal transportation plan.
+ * @param print_iterations Boolean flag to enable/disable printing progress.
+ * @return SOLVER_OK; SOLVER_NEGATIVE_QUANTITY, SOLVER_INFEASIBLE or
+ *         SOLVER_COST_OVERFLOW with the solution emptied.
+ */
+SolverStatus min_cost_flow_solve(
+        TransportProblem *tp,
+        Solution *solution,
+        McfAlgorithm algorithm,
+        int *total_cost,
+        Boolean print_iterations
+) {
+    int m = tp->supply_size;
+    int n = tp->demand_size;
+    FlowNetwork *net;
+    long long total_supply = 0, plan_cost;
+    SolverStatus status = SOLVER_OK;
+    int i, j;
+
+    clear_solution(solution);
+    for (i = 0; i < m; i++) {
+        if (tp->supply[i] < 0) return SOLVER_NEGATIVE_QUANTITY;
+    }
+    for (j = 0; j < n; j++) {
+        if (tp->demand[j] < 0) return SOLVER_NEGATIVE_QUANTITY;
+    }
+
+    net = init_flow_network(m + n, m * n);
+    for (i = 0; i < m; i++) {
+        set_node_supply(net, i, tp->supply[i]);
+        total_supply += tp->supply[i];
+    }
+    for (j = 0; j < n; j++) {
+        set_node_supply(net, m + j, -(long long)tp->demand[j]);
+    }
+    // Arc i * n + j carries cell (i, j)
+    for (i = 0; i < m; i++) {
+        for (j = 0; j < n; j++) {
+            add_flow_arc(net, i, m + j, total_supply, COST_AT(tp, i, j));
+        }
+    }
+
+    if (solve_min_cost_flow(net, algorithm, &plan_cost, print_iterations) != MCF_OPTIMAL) {
+        status = SOLVER_INFEASIBLE;
+    } else if (plan_cost > INT_MAX || plan_cost < INT_MIN) {
+        status = SOLVER_COST_OVERFLOW;
+    } else {
+        for (i = 0; i < m; i++) {
+            for (j = 0; j < n; j++) {
+                add_to_solution(solution, i, j, (int)flow_on_arc(net, i * n + j));
+            }
+        }
+        *total_cost = (int)plan_cost;
+    }
+
+    free_flow_network(net);
+
+    return status;
+}
+
+/**
+ * Solves the transportation problem to optimality as a min-cost flow, as
+ * min_cost_flow_solve() does; a failure is reported and ends the process.
+ *
+ * @param tp Pointer to a balanced TransportationProblem structure.
+ * @param solution Solution to fill with the optimal plan; emptied first.
+ * @param algorithm Min-cost flow algorithm to use.
+ * @param print_iterations Boolean flag to enable/disable printing progress.
+ * @return Total cost of the optimal transportation plan.
+ */
+int min_cost_flow_method(
+        TransportProblem *tp,
+        Solution *solution,
+        McfAlgorithm algorithm,
+        Boolean print_iterations
+) {
+    int total_cost = 0;
+    SolverStatus status = min_cost_flow_solve(tp, solution, algorithm, &total_cost,
+                                              print_iterations);
+
+    if (status != SOLVER_OK) {
+        fprintf(stderr, "%s\n", solver_status_message(status));
+        exit(EXIT_FAILURE);
+    }
+    return total_cost;
+}
+
+/**
+ * Solves an int64 transportation problem to optimality as a min-cost flow,
+ * on the same network as min_cost_flow_method(); the network already
+ * counts in 64 bits. A problem without a plan, or whose costs are too
+ * large for that arithmetic, is reported and ends the process.
+ *
+ * @param tp Pointer to a balanced TransportProblemI64 structure.
+ * @param solution Solution to fill with the optimal plan; emptied first.
+ * @param algorithm Min-cost flow algorithm to use.
+ * @param print_iterations Boolean flag to enable/disable printing progress.
+ * @return Total cost of the optimal transportation plan.
+ */
+int64_t min_cost_flow_method_i64(
+        TransportProblemI64 *tp,
+        SolutionI64 *solution,
+        McfAlgorithm algorithm,
+        Boolean print_iterations
+) {
+    int m = tp->supply_size;
+    int n = tp->demand_size;
+    FlowNetwork *net = init_flow_network(m + n, m * n);
+    long long total_supply = 0, total_cost;
+    WideI64 max_cost = 0, c;
+    WideI64 nodes = m + n;
+    int i, j;
+    Boolean negative = FALSE;
+
+    for (i = 0; i < m; i++) {
+        if (tp->supply[i] < 0) negative = TRUE;
+    }
+    for (j = 0; j < n; j++) {
+        if (tp->demand[j] < 0) negative = TRUE;
+    }
+    if (negative) {
+        fprintf(stderr, "%s\n", solver_status_message(SOLVER_NEGATIVE_QUANTITY));
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < m; i++) {
+        set_node_supply(net, i, tp->supply[i]);
+        total_supply += tp->supply[i];
+    }
+    for (j = 0; j < n; j++) {
+        set_node_supply(net, m + j, -(long long)tp->demand[j]);
+    }
+    for (i = 0; i < m; i++) {
+        for (j = 0; j < n; j++) {
+            add_flow_arc(net, i, m + j, total_supply, WIDE_COST_AT(tp, i, j));
+            c = (WIDE_COST_AT(tp, i, j) < 0) ? -(WideI64)WIDE_COST_AT(tp, i, j) : WIDE_COST_AT(tp, i, j);
+            if (c > max_cost) max_cost = c;
+        }
+    }
+
+    // The plan costs at most the total supply times the largest cost. Cost
+    // scaling multiplies the costs by the node count and moves a potential
+    // by about twice the scaled largest cost times the node count, so the
+    // reduced costs stay below 8 nodes^2 times the largest cost
+    if (max_cost * total_supply > INT64_MAX || max_cost > INT64_MAX / (8 * nodes * nodes)) {
+        fprintf(stderr, "%s\n", solver_status_message(SOLVER_COST_OVERFLOW));
+        exit(EXIT_FAILURE);
+    }
+
+    if (solve_min_cost_flow(net, algorithm, &total_cost, print_iterations) != MCF_OPTIMAL) {
+        fprintf(stderr, "%s\n", solver_status_message(SOLVER_INFEASIBLE));
+        exit(EXIT_FAILURE);
+    }
+
+    clear_solution_i64(solution);
+    for (i = 0; i < m; i++) {
+        for (j = 0; j < n; j++) {
+            add_to_solution_i64(solution, i, j, flow_on_arc(net, i * n + j));
+        }
+    }
+
+    free_flow_network(net);
+
+    return total_cost;
+}
+
+/**
+ * Solves a sparse transportation problem to optimality as a min-cost flow.
+ * The network is built as in min_cost_flow_method() but with one arc per
+ * allowed route, so forbidden routes cost nothing in memory or time. A
+ * problem without a plan over the allowed routes is reported and ends the
+ * process.
+ *
+ * @param sp Pointer to a balanced SparseTransportProblem structure.
+ * @param flow Pre-allocated per-route buffer to store the optimal allocation.
+ * @param algorithm Min-cost flow algorithm to use.
+ * @param print_iterations Boolean flag to enable/disable printing progress.
+ * @return Total cost of the optimal transportation plan.
+ */
+int sparse_min_cost_flow_method(
+        SparseTransportProblem *sp,
+        int *flow,
+        McfAlgorithm algorithm,
+        Boolean print_iterations
+) {
+    int m = sp->supply_size;
+    int n = sp->demand_size;
+    FlowNetwork *net = init_flow_network(m + n, (int)sp->route_count);
+    long long total_supply = 0, total_cost;
+    size_t e;
+    int i, j;
+    Boolean negative = FALSE;
+
+    for (i = 0; i < m; i++) {
+        if (sp->supply[i] < 0) negative = TRUE;
+    }
+    for (j = 0; j < n; j++) {
+        if (sp->demand[j] < 0) negative = TRUE;
+    }
+    if (negative) {
+        fprintf(stderr, "%s\n", solver_status_message(SOLVER_NEGATIVE_QUANTITY));
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < m; i++) {
+        set_node_supply(net, i, sp->supply[i]);
+        total_supply += sp->supply[i];
+    }
+    for (j = 0; j < n; j++) {
+        set_node_supply(net, m + j, -(long long)sp->demand[j]);
+    }
+    // Arc e carries route e
+    for (e = 0; e < sp->route_count; e++) {
+        add_flow_arc(net, sp->route_row[e], m + sp->route_col[e], total_supply, sp->route_cost[e]);
+    }
+
+    if (solve_min_cost_flow(net, algorithm, &total_cost, print_iterations) != MCF_OPTIMAL) {
+        fprintf(stderr, "No plan meets every demand using only the allowed routes.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (total_cost > INT_MAX || total_cost < INT_MIN) {
+        fprintf(stderr, "%s\n", solver_status_message(SOLVER_COST_OVERFLOW));
+        exit(EXIT_FAILURE);
+    }
+
+    for (e = 0; e < sp->route_count; e++) {
+        flow[e] = (int)flow_on_arc(net, (int)e);
+    }
+
+    free_flow_network(net);
+
+    return (int)total_cost;
+}
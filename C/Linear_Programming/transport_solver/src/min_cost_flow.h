@@ -0,0 +1,67 @@
+#ifndef MIN_COST_FLOW_H
+#define MIN_COST_FLOW_H
+
+#include "transport.h"
+#include "precision.h"
+
+/*
+ * General minimum-cost flow on a directed network with node supplies.
+ *
+ * Arcs are collected with add_flow_arc() and turned into a compressed
+ * sparse row (CSR) residual graph when the network is solved: every arc
+ * and its reverse residual arc are stored contiguously by tail node, so a
+ * node's out-arcs are one slice of flat arrays. Capacities must be finite;
+ * for "uncapacitated" arcs pass the total supply.
+ */
+
+typedef enum {
+    MCF_SUCCESSIVE_SHORTEST_PATH, // Dijkstra with node potentials
+    MCF_COST_SCALING              // Goldberg-Tarjan push-relabel with epsilon scaling
+} McfAlgorithm;
+
+typedef enum {
+    MCF_OPTIMAL,
+    MCF_INFEASIBLE
+} McfStatus;
+
+typedef struct {
+    int node_count;
+    long long *supply;     // Positive for sources, negative for sinks
+
+    // Arcs as added, before the CSR build
+    int arc_count;
+    int arc_capacity;
+    int *arc_tail;
+    int *arc_head;
+    long long *arc_cap;
+    long long *arc_cost;
+
+    // CSR residual graph: out-arcs of node v are first[v] .. first[v + 1] - 1
+    int *first;
+    int *head;
+    int *rev;              // Index of the paired residual arc
+    long long *residual;   // Remaining capacity
+    long long *cost;
+    int *arc_pos;          // Residual position of each added arc
+} FlowNetwork;
+
+// Network construction
+FlowNetwork *init_flow_network(int node_count, int arc_hint);
+int add_flow_arc(FlowNetwork *net, int tail, int head, long long capacity, long long cost);
+void set_node_supply(FlowNetwork *net, int node, long long supply);
+void free_flow_network(FlowNetwork *net);
+
+// Solving
+McfStatus solve_min_cost_flow(FlowNetwork *net, McfAlgorithm algorithm, long long *total_cost,
+                              Boolean print_iterations);
+long long flow_on_arc(const FlowNetwork *net, int arc);
+
+// Transportation problem as a bipartite network
+SolverStatus min_cost_flow_solve(TransportProblem *tp, Solution *solution, McfAlgorithm algorithm,
+                                 int *total_cost, Boolean print_iterations);
+int min_cost_flow_method(TransportProblem *tp, Solution *solution, McfAlgorithm algorithm,
+                         Boolean print_iterations);
+int64_t min_cost_flow_method_i64(TransportProblemI64 *tp, SolutionI64 *solution,
+                                 McfAlgorithm algorithm, Boolean print_iterations);
+
+#endif // MIN_COST_FLOW_H
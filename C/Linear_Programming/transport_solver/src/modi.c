@@ -0,0 +1,413 @@
+#ifndef TP_TEMPLATE
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "transport.h"
+#include "workspace.h"
+
+/*
+ * Rows and columns are nodes of one bipartite graph: row i is node i and
+ * column j is node supply_size + j. The basic cells are the edges of a
+ * spanning tree over those nodes, so a balanced m x n problem always keeps
+ * exactly m + n - 1 of them, some possibly carrying zero (epsilon) units.
+ */
+
+/**
+ * Finds the representative of a node in the union-find forest.
+ *
+ * @param set Union-find parent array.
+ * @param x Node index.
+ * @return Representative of the set holding x.
+ */
+static int find_set(
+        int *set,
+        int x
+) {
+    while (set[x] != x) {
+        set[x] = set[set[x]];
+        x = set[x];
+    }
+    return x;
+}
+
+/**
+ * Orders cells row-major, by a stable counting sort on the columns and then
+ * one on the rows, in time linear in the cells and points.
+ *
+ * @param row Row of each cell.
+ * @param column Column of each cell.
+ * @param count Number of cells.
+ * @param m Number of rows.
+ * @param n Number of columns.
+ * @param start Scratch space for max(m, n) + 1 offsets.
+ * @param by_column Scratch space for count cell indices.
+ * @param order Receives the cell indices in row-major order.
+ */
+static void sort_cells(
+        const int *row,
+        const int *column,
+        int count,
+        int m,
+        int n,
+        int *start,
+        int *by_column,
+        int *order
+) {
+    int x, k;
+
+    for (x = 0; x <= n; x++) {
+        start[x] = 0;
+    }
+    for (k = 0; k < count; k++) {
+        start[column[k] + 1]++;
+    }
+    for (x = 0; x < n; x++) {
+        start[x + 1] += start[x];
+    }
+    for (k = 0; k < count; k++) {
+        by_column[start[column[k]]++] = k;
+    }
+
+    for (x = 0; x <= m; x++) {
+        start[x] = 0;
+    }
+    for (k = 0; k < count; k++) {
+        start[row[k] + 1]++;
+    }
+    for (x = 0; x < m; x++) {
+        start[x + 1] += start[x];
+    }
+    for (x = 0; x < count; x++) {
+        k = by_column[x];
+        order[start[row[k]]++] = k;
+    }
+}
+
+// The MODI method, compiled once per precision
+#define TP_TEMPLATE "modi.c"
+#include "precision_template.h"
+
+#else // Template body
+
+#define compute_potentials TP_NAME(compute_potentials)
+
+/**
+ * Builds the tree adjacency of the current basis and roots it at row 0,
+ * computing the potentials u (rows) and v (columns) with u[0] = 0 so that
+ * u[i] + v[j] equals the cost of every basic cell.
+ *
+ * @param tp Pointer to the TransportationProblem structure.
+ * @param basis_row Row of each basic cell.
+ * @param basis_col Column of each basic cell.
+ * @param head First adjacency entry of each node, -1 if none.
+ * @param next Next adjacency entry (two entries per basic cell).
+ * @param parent Parent node of each node in the rooted tree.
+ * @param parent_cell Basic cell joining each node to its parent.
+ * @param depth Depth of each node below the root.
+ * @param potential u followed by v, one value per node.
+ * @param queue Scratch space for the breadth-first walk.
+ */
+static void compute_potentials(
+        TP_PROBLEM *tp,
+        const int *basis_row,
+        const int *basis_col,
+        int *head,
+        int *next,
+        int *parent,
+        int *parent_cell,
+        int *depth,
+        TP_WIDE *potential,
+        int *queue
+) {
+    int m = tp->supply_size;
+    int nodes = m + tp->demand_size;
+    int basic = nodes - 1;
+    int k, e, x, y, front, back;
+
+    for (x = 0; x < nodes; x++) {
+        head[x] = -1;
+        parent[x] = -1;
+    }
+    // Entry 2k leaves the row of cell k, entry 2k + 1 leaves its column
+    for (k = 0; k < basic; k++) {
+        next[2 * k] = head[basis_row[k]];
+        head[basis_row[k]] = 2 * k;
+        next[2 * k + 1] = head[m + basis_col[k]];
+        head[m + basis_col[k]] = 2 * k + 1;
+    }
+
+    potential[0] = 0;
+    depth[0] = 0;
+    parent[0] = 0;
+    parent_cell[0] = -1;
+    queue[0] = 0;
+    front = 0;
+    back = 1;
+    while (front < back) {
+        x = queue[front++];
+        for (e = head[x]; e != -1; e = next[e]) {
+            k = e / 2;
+            y = (e % 2 == 0) ? m + basis_col[k] : basis_row[k];
+            if (parent[y] != -1) continue;
+            parent[y] = x;
+            parent_cell[y] = k;
+            depth[y] = depth[x] + 1;
+            potential[y] = TP_COST_AT(tp, basis_row[k], basis_col[k]) - potential[x];
+            queue[back++] = y;
+        }
+    }
+}
+
+/**
+ * Improves an initial basic feasible solution to an optimal one with the
+ * modified distribution (MODI / u-v) method.
+ *
+ * The cells of solution are taken as the starting point and are replaced
+ * by the optimal plan, in row-major order. They form the initial basis;
+ * when there are fewer than m + n - 1 of them (a degenerate solution) zero
+ * "epsilon" cells are added that connect the basis without closing a loop.
+ * Each iteration computes the potentials, enters the cell with the most
+ * negative reduced cost and shifts units around the loop it closes in the
+ * basis tree, dropping the first cell on the loop that runs empty. With
+ * floating-point costs a reduced cost has to fall below a small tolerance,
+ * relative to the largest cost, before its cell enters.
+ *
+ * @param tp Pointer to a balanced TransportationProblem structure.
+ * @param solution Solution produced by one of the allocation methods; replaced by the optimal plan.
+ * @param total_cost Receives the total cost of the optimal transportation plan.
+ * @param print_iterations Boolean flag to enable/disable printing each pivot.
+ * @return SOLVER_OK, or SOLVER_COST_OVERFLOW (with the solution emptied) if
+ *         the total cost does not fit.
+ */
+SolverStatus TP_NAME(modi_solve)(
+        TP_PROBLEM *tp,
+        TP_SOLUTION *solution,
+        TP_VALUE *total_cost,
+        Boolean print_iterations
+) {
+    int m = tp->supply_size;
+    int n = tp->demand_size;
+    int nodes = m + n;
+    int basic = nodes - 1;
+    int cells = (int)solution->count;
+    int i, j, k, count, x, y, a, b, len, half, leave;
+    int enter_row, enter_col, iteration = 0;
+    TP_VALUE theta;
+    TP_WIDE reduced, best, threshold = 0;
+    TP_WIDE plan_cost = 0;
+
+    int *basis_row = (int *)malloc(basic * sizeof(int));
+    int *basis_col = (int *)malloc(basic * sizeof(int));
+    TP_VALUE *basis_quantity = (TP_VALUE *)malloc(basic * sizeof(TP_VALUE));
+    char *is_basic = (char *)calloc((size_t)m * n, sizeof(char));
+    int *set = (int *)malloc(nodes * sizeof(int));
+    int *head = (int *)malloc(nodes * sizeof(int));
+    int *next = (int *)malloc(2 * basic * sizeof(int));
+    int *parent = (int *)malloc(nodes * sizeof(int));
+    int *parent_cell = (int *)malloc(nodes * sizeof(int));
+    int *depth = (int *)malloc(nodes * sizeof(int));
+    int *queue = (int *)malloc(nodes * sizeof(int));
+    int *loop = (int *)malloc(nodes * sizeof(int));
+    TP_WIDE *potential = (TP_WIDE *)malloc(nodes * sizeof(TP_WIDE));
+    int *start = (int *)malloc((nodes + 1) * sizeof(int));
+    int *by_column = (int *)malloc((cells + 1) * sizeof(int));
+    int *order = (int *)malloc((cells + 1) * sizeof(int));
+
+    if (!basis_row || !basis_col || !basis_quantity || !is_basic || !set || !head || !next ||
+            !parent || !parent_cell || !depth || !queue || !loop || !potential || !start ||
+            !by_column || !order) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // The allocated cells form the initial basis, taken in row-major order
+    for (x = 0; x < nodes; x++) {
+        set[x] = x;
+    }
+    sort_cells(solution->row, solution->column, cells, m, n, start, by_column, order);
+    count = 0;
+    for (x = 0; x < cells; x++) {
+        i = solution->row[order[x]];
+        j = solution->column[order[x]];
+        if (solution->quantity[order[x]] == 0) continue;
+        a = find_set(set, i);
+        b = find_set(set, m + j);
+        if (a == b || solution->quantity[order[x]] < 0) {
+            fprintf(stderr, "MODI requires a basic feasible solution as its starting point.\n");
+            exit(EXIT_FAILURE);
+        }
+        set[a] = b;
+        basis_row[count] = i;
+        basis_col[count] = j;
+        basis_quantity[count] = solution->quantity[order[x]];
+        is_basic[(size_t)i * n + j] = 1;
+        count++;
+    }
+
+    // Degenerate solution: complete the spanning tree with epsilon cells
+    for (i = 0; i < m && count < basic; i++) {
+        for (j = 0; j < n && count < basic; j++) {
+            a = find_set(set, i);
+            b = find_set(set, m + j);
+            if (a == b) continue;
+            set[a] = b;
+            basis_row[count] = i;
+            basis_col[count] = j;
+            basis_quantity[count] = 0;
+            is_basic[(size_t)i * n + j] = 1;
+            count++;
+            if (print_iterations) {
+                printf("Degenerate basis: epsilon cell added at (%d, %d).\n", i, j);
+            }
+        }
+    }
+
+#if TP_FLOATING
+    for (i = 0; i < m; i++) {
+        for (j = 0; j < n; j++) {
+            if (fabs(TP_COST_AT(tp, i, j)) > threshold) threshold = fabs(TP_COST_AT(tp, i, j));
+        }
+    }
+    threshold = -1e-9 * (1 + threshold);
+#endif
+
+    while (1) {
+        compute_potentials(tp, basis_row, basis_col, head, next, parent, parent_cell,
+                           depth, potential, queue);
+
+        // Entering cell: the most negative reduced cost c_ij - u_i - v_j
+        best = threshold;
+        enter_row = -1;
+        enter_col = -1;
+        for (i = 0; i < m; i++) {
+            for (j = 0; j < n; j++) {
+                if (is_basic[(size_t)i * n + j]) continue;
+                reduced = TP_COST_AT(tp, i, j) - potential[i] - potential[m + j];
+                if (reduced < best) {
+                    best = reduced;
+                    enter_row = i;
+                    enter_col = j;
+                }
+            }
+        }
+        if (enter_row == -1) {
+            break;  // Every reduced cost is non-negative: optimal
+        }
+
+        // The loop runs from the entering column up the tree to the entering row.
+        // Cells on the column side are collected in order, cells on the row
+        // side are collected backwards from the end of the loop.
+        x = m + enter_col;
+        y = enter_row;
+        len = 0;
+        half = 0;
+        while (depth[x] > depth[y]) {
+            loop[len++] = parent_cell[x];
+            x = parent[x];
+        }
+        while (depth[y] > depth[x]) {
+            queue[half++] = parent_cell[y];
+            y = parent[y];
+        }
+        while (x != y) {
+            loop[len++] = parent_cell[x];
+            x = parent[x];
+            queue[half++] = parent_cell[y];
+            y = parent[y];
+        }
+        while (half > 0) {
+            loop[len++] = queue[--half];
+        }
+
+        // Even positions lose units, odd positions gain them
+        leave = 0;
+        for (k = 2; k < len; k += 2) {
+            if (basis_quantity[loop[k]] < basis_quantity[loop[leave]]) {
+                leave = k;
+            }
+        }
+        theta = basis_quantity[loop[leave]];
+
+        for (k = 0; k < len; k++) {
+            basis_quantity[loop[k]] += (k % 2 == 0) ? -theta : theta;
+        }
+
+        iteration++;
+        if (print_iterations) {
+            printf("Iteration %d:\n", iteration);
+            printf("  Entering cell (%d, %d) with reduced cost " TP_WIDE_FMT ".\n",
+                   enter_row, enter_col, TP_WIDE_PRINT(best));
+            printf("  Leaving cell (%d, %d), " TP_FMT " units shifted around a loop of %d cells.\n\n",
+                   basis_row[loop[leave]], basis_col[loop[leave]], TP_PRINT(theta), len + 1);
+        }
+
+        k = loop[leave];
+        is_basic[(size_t)basis_row[k] * n + basis_col[k]] = 0;
+        basis_row[k] = enter_row;
+        basis_col[k] = enter_col;
+        basis_quantity[k] = theta;
+        is_basic[(size_t)enter_row * n + enter_col] = 1;
+    }
+
+    // The optimal plan is the basis, written out in row-major order
+    sort_cells(basis_row, basis_col, basic, m, n, start, loop, queue);
+    TP_NAME(clear_solution)(solution);
+    for (x = 0; x < basic; x++) {
+        k = queue[x];
+        TP_NAME(add_to_solution)(solution, basis_row[k], basis_col[k], basis_quantity[k]);
+        plan_cost += (TP_WIDE)basis_quantity[k] * TP_COST_AT(tp, basis_row[k], basis_col[k]);
+    }
+
+    // Free allocated memory
+    free(basis_row);
+    free(basis_col);
+    free(basis_quantity);
+    free(is_basic);
+    free(set);
+    free(head);
+    free(next);
+    free(parent);
+    free(parent_cell);
+    free(depth);
+    free(queue);
+    free(loop);
+    free(potential);
+    free(start);
+    free(by_column);
+    free(order);
+
+    if (!TP_FITS(plan_cost)) {
+        TP_NAME(clear_solution)(solution);
+        return SOLVER_COST_OVERFLOW;
+    }
+    *total_cost = (TP_VALUE)plan_cost;
+    return SOLVER_OK;
+}
+
+/**
+ * Improves an initial basic feasible solution to an optimal one as
+ * modi_solve() does, exiting if the total cost does not fit.
+ *
+ * @param tp Pointer to a balanced TransportationProblem structure.
+ * @param solution Solution produced by one of the allocation methods; replaced by the optimal plan.
+ * @param print_iterations Boolean flag to enable/disable printing each pivot.
+ * @return Total cost of the optimal transportation plan.
+ */
+TP_VALUE TP_NAME(modi_method)(
+        TP_PROBLEM *tp,
+        TP_SOLUTION *solution,
+        Boolean print_iterations
+) {
+    TP_VALUE total_cost = 0;
+    SolverStatus status = TP_NAME(modi_solve)(tp, solution, &total_cost, print_iterations);
+
+    if (status != SOLVER_OK) {
+        fprintf(stderr, "%s\n", solver_status_message(status));
+        exit(EXIT_FAILURE);
+    }
+    return total_cost;
+}
+
+#undef compute_potentials
+
+#endif // TP_TEMPLATE
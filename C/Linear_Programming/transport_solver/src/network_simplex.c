@@ -0,0 +1,554 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include "transport.h"
+#include "workspace.h"
+
+/*
+ * Primal network simplex on the bipartite transportation network.
+ *
+ * Row i is node i, column j is node m + j and an artificial root is node
+ * m + n. Real arcs run from row i to column j; they are uncapacitated, so a
+ * non-tree arc always sits at zero flow and only the m + n tree arcs need
+ * storage. Each tree arc is kept at its lower node: pred[x] names the arc
+ * joining x to parent[x] and flow[x] is the flow on it.
+ *
+ * The start is the artificial basis (every node hangs from the root by a
+ * big-M arc) oriented so that the tree is strongly feasible; the leaving
+ * arc rule below keeps it that way, which rules out cycling under
+ * degeneracy. Entering arcs are priced by block search.
+ */
+
+#define ARTIFICIAL_ARC -1 // pred value of an arc between a node and the root
+
+/** Direction of a tree arc relative to the node it hangs from. */
+typedef enum {
+    DIR_DOWN, /**< arc runs from the parent to the node */
+    DIR_UP    /**< arc runs from the node to the parent */
+} ArcDirection;
+
+/**
+ * Spanning tree basis and pricing state of one solve.
+ */
+typedef struct {
+    TransportProblem *tp;
+    int m, n;
+    int nodes;               // m + n + 1, the root included
+    int root;
+    long long art_cost;      // Cost of the artificial arcs
+
+    int *parent;             // Parent node, -1 at the root
+    long long *pred;         // Arc to the parent: i * n + j, or ARTIFICIAL_ARC
+    ArcDirection *pred_dir;
+    long long *flow;         // Flow on pred[x]
+    int *thread;             // Preorder successor (cyclic through the root)
+    int *rev_thread;         // Preorder predecessor
+    int *depth;              // Edges between the node and the root
+    long long *pi;           // Node potentials
+
+    ArcDirection *art_dir;   // Orientation of each node's artificial arc
+
+    int *order;              // Scratch: moved subtree in old preorder
+    int *new_order;          // Scratch: moved subtree in new preorder
+    int *stem;               // Scratch: path from the entering node to the leaving one
+    int *mark;               // Position on the stem, -1 if not on it
+    int *start;              // Scratch: where each stem node's old subtree starts in order
+    int *end;                // Scratch: and where it ends
+    int *line;               // Scratch: costs of the row being priced, if implicit or padded
+
+    long long block_size;    // Arcs priced per block
+    int next_row, next_col;  // Where the next block search starts
+} NetworkSimplex;
+
+/**
+ * Returns the cost of a tree arc.
+ *
+ * @param ns Pointer to the solver state.
+ * @param arc Arc index (the cell's offset in the results), or ARTIFICIAL_ARC.
+ * @return Cost of the arc.
+ */
+static long long arc_cost(
+        const NetworkSimplex *ns,
+        long long arc
+) {
+    if (arc == ARTIFICIAL_ARC) {
+        return ns->art_cost;
+    }
+    // Without a dummy demand point the cost buffer is laid out like the results
+    if (ns->tp->cost && ns->tp->cost_columns == ns->n && arc < (long long)ns->tp->cost_rows * ns->n) {
+        return ns->tp->cost[arc];
+    }
+    return COST_AT(ns->tp, (int)(arc / ns->n), (int)(arc % ns->n));
+}
+
+/**
+ * Allocates the solver state and builds the artificial starting basis.
+ *
+ * @param ns Pointer to the solver state to initialise.
+ * @param tp Pointer to a balanced TransportationProblem structure.
+ */
+static void init_network_simplex(
+        NetworkSimplex *ns,
+        TransportProblem *tp
+) {
+    long long max_cost = 0, c, arcs;
+    int i, j, x;
+
+    ns->tp = tp;
+    ns->m = tp->supply_size;
+    ns->n = tp->demand_size;
+    ns->nodes = ns->m + ns->n + 1;
+    ns->root = ns->m + ns->n;
+
+    ns->parent = (int *)malloc(ns->nodes * sizeof(int));
+    ns->pred = (long long *)malloc(ns->nodes * sizeof(long long));
+    ns->pred_dir = (ArcDirection *)malloc(ns->nodes * sizeof(ArcDirection));
+    ns->flow = (long long *)malloc(ns->nodes * sizeof(long long));
+    ns->thread = (int *)malloc(ns->nodes * sizeof(int));
+    ns->rev_thread = (int *)malloc(ns->nodes * sizeof(int));
+    ns->depth = (int *)malloc(ns->nodes * sizeof(int));
+    ns->pi = (long long *)malloc(ns->nodes * sizeof(long long));
+    ns->order = (int *)malloc(ns->nodes * sizeof(int));
+    ns->new_order = (int *)malloc(ns->nodes * sizeof(int));
+    ns->stem = (int *)malloc(ns->nodes * sizeof(int));
+    ns->mark = (int *)malloc(ns->nodes * sizeof(int));
+    ns->art_dir = (ArcDirection *)malloc(ns->nodes * sizeof(ArcDirection));
+    ns->start = (int *)malloc(ns->nodes * sizeof(int));
+    ns->end = (int *)malloc(ns->nodes * sizeof(int));
+    ns->line = (int *)malloc((ns->n + 1) * sizeof(int));
+
+    if (!ns->parent || !ns->pred || !ns->pred_dir || !ns->flow || !ns->thread ||
+            !ns->rev_thread || !ns->depth || !ns->pi || !ns->order || !ns->new_order ||
+            !ns->stem || !ns->mark || !ns->art_dir || !ns->start || !ns->end || !ns->line) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Big-M: dearer than any path of real arcs through every node
+    for (i = 0; i < ns->m; i++) {
+        const int *row = cost_row(tp, i, ns->line);
+        for (j = 0; j < tp->cost_columns; j++) {
+            c = row[j];
+            if (c < 0) c = -c;
+            if (c > max_cost) max_cost = c;
+        }
+    }
+    ns->art_cost = (max_cost + 1) * ns->nodes;
+
+    ns->parent[ns->root] = -1;
+    ns->pred[ns->root] = ARTIFICIAL_ARC;
+    ns->pred_dir[ns->root] = DIR_UP;
+    ns->flow[ns->root] = 0;
+    ns->depth[ns->root] = 0;
+    ns->pi[ns->root] = 0;
+    ns->thread[ns->root] = 0;
+    ns->rev_thread[0] = ns->root;
+
+    // Supply nodes (and empty demand nodes) point up to the root, demand
+    // nodes are fed from it; zero-flow arcs then all point towards the root
+    for (x = 0; x < ns->root; x++) {
+        ns->parent[x] = ns->root;
+        ns->pred[x] = ARTIFICIAL_ARC;
+        ns->depth[x] = 1;
+        ns->thread[x] = x + 1;
+        ns->rev_thread[x + 1] = x;
+        ns->mark[x] = -1;
+        if (x < ns->m) {
+            ns->pred_dir[x] = DIR_UP;
+            ns->flow[x] = tp->supply[x];
+        } else if (tp->demand[x - ns->m] == 0) {
+            ns->pred_dir[x] = DIR_UP;
+            ns->flow[x] = 0;
+        } else {
+            ns->pred_dir[x] = DIR_DOWN;
+            ns->flow[x] = tp->demand[x - ns->m];
+        }
+        ns->art_dir[x] = ns->pred_dir[x];
+        ns->pi[x] = (ns->pred_dir[x] == DIR_UP) ? -ns->art_cost : ns->art_cost;
+    }
+    ns->mark[ns->root] = -1;
+
+    // Block size of about sqrt(arcs), as in common network simplex codes
+    arcs = (long long)ns->m * ns->n;
+    ns->block_size = 10;
+    while (ns->block_size * ns->block_size < arcs) {
+        ns->block_size++;
+    }
+    ns->next_row = 0;
+    ns->next_col = 0;
+}
+
+/**
+ * Frees the solver state.
+ *
+ * @param ns Pointer to the solver state.
+ */
+static void free_network_simplex(
+        NetworkSimplex *ns
+) {
+    free(ns->parent);
+    free(ns->pred);
+    free(ns->pred_dir);
+    free(ns->flow);
+    free(ns->thread);
+    free(ns->rev_thread);
+    free(ns->depth);
+    free(ns->pi);
+    free(ns->order);
+    free(ns->new_order);
+    free(ns->stem);
+    free(ns->mark);
+    free(ns->art_dir);
+    free(ns->start);
+    free(ns->end);
+    free(ns->line);
+}
+
+/**
+ * Gives the costs of row i against every demand point. A dummy demand
+ * point lies past the covered costs, so its zero is appended in scratch to
+ * keep the pricing loop free of a per-arc test.
+ *
+ * @param ns Pointer to the solver state.
+ * @param i Supply point.
+ * @return The n costs of the row; valid until the scratch line is reused.
+ */
+static const int *pricing_row(NetworkSimplex *ns, int i) {
+    const int *row = cost_row(ns->tp, i, ns->line);
+    int covered = ns->tp->cost_columns;
+
+    if (covered == ns->n) {
+        return row;
+    }
+    if (row != ns->line) {
+        memcpy(ns->line, row, covered * sizeof(int));
+    }
+    memset(ns->line + covered, 0, (ns->n - covered) * sizeof(int));
+    return ns->line;
+}
+
+/**
+ * Block search pricing: scans the real arcs cyclically from where the last
+ * search stopped, a block at a time, and takes the most negative reduced
+ * cost of the first block that has one.
+ *
+ * @param ns Pointer to the solver state.
+ * @param in_row Row of the entering arc.
+ * @param in_col Column of the entering arc.
+ * @param in_cost Reduced cost of the entering arc.
+ * @return TRUE if an entering arc was found, FALSE if the basis is optimal.
+ */
+static Boolean find_entering_arc(
+        NetworkSimplex *ns,
+        int *in_row,
+        int *in_col,
+        long long *in_cost
+) {
+    long long total = (long long)ns->m * ns->n;
+    long long checked, count = ns->block_size, min = 0, c;
+    const long long *col_pi = ns->pi + ns->m;
+    int i = ns->next_row, j = ns->next_col;
+    const int *row;
+    long long row_pi;
+
+    if (total == 0) {
+        return FALSE;
+    }
+    row = pricing_row(ns, i);
+    row_pi = ns->pi[i];
+
+    for (checked = 0; checked < total; checked++) {
+        // Tree arcs price at exactly zero, so they never qualify
+        c = row[j] + row_pi - col_pi[j];
+        if (c < min) {
+            min = c;
+            *in_row = i;
+            *in_col = j;
+        }
+        if (++j == ns->n) {
+            j = 0;
+            if (++i == ns->m) i = 0;
+            row = pricing_row(ns, i);
+            row_pi = ns->pi[i];
+        }
+        if (--count == 0) {
+            if (min < 0) break;
+            count = ns->block_size;
+        }
+    }
+
+    ns->next_row = i;
+    ns->next_col = j;
+    *in_cost = min;
+    return (min < 0) ? TRUE : FALSE;
+}
+
+/**
+ * Re-hangs the subtree cut off by the leaving arc from the entering arc.
+ *
+ * The subtree below u_out is re-rooted at u_in (reversing the stem between
+ * them), hung from v_in and spliced into the thread right after v_in.
+ * Depths, arc directions and potentials are recomputed over the moved
+ * nodes only, so a pivot costs time linear in the subtree it moves.
+ *
+ * @param ns Pointer to the solver state.
+ * @param u_in Endpoint of the entering arc inside the moved subtree.
+ * @param v_in Endpoint of the entering arc outside it.
+ * @param in_arc Index of the entering arc.
+ * @param in_flow Flow on the entering arc after the pivot.
+ * @param u_out Node whose arc to its parent leaves the basis.
+ */
+static void update_tree(
+        NetworkSimplex *ns,
+        int u_in,
+        int v_in,
+        long long in_arc,
+        long long in_flow,
+        int u_out
+) {
+    int k, s, t, x, p, size, len, before, after;
+    long long arc, arc_flow, next_arc, next_flow;
+
+    // The stem, from the new subtree root up to the old one
+    k = 0;
+    for (x = u_in; ; x = ns->parent[x]) {
+        ns->mark[x] = k;
+        ns->stem[k++] = x;
+        if (x == u_out) break;
+    }
+
+    // The subtree in old preorder: the nodes threaded after u_out that are deeper
+    size = 0;
+    x = u_out;
+    do {
+        if (ns->mark[x] >= 0) {
+            ns->start[ns->mark[x]] = size;
+        }
+        ns->order[size++] = x;
+        x = ns->thread[x];
+    } while (x != ns->root && ns->depth[x] > ns->depth[u_out]);
+
+    // Old subtrees along the stem are nested, so one forward pass finds their ends
+    t = ns->start[0] + 1;
+    for (s = 0; s < k; s++) {
+        while (t < size && ns->depth[ns->order[t]] > ns->depth[ns->stem[s]]) {
+            t++;
+        }
+        ns->end[s] = t;
+    }
+
+    // New preorder: u_in's old subtree, then each further stem node with
+    // whatever its old subtree holds outside the previous stem node's
+    len = 0;
+    for (t = ns->start[0]; t < ns->end[0]; t++) {
+        ns->new_order[len++] = ns->order[t];
+    }
+    for (s = 1; s < k; s++) {
+        for (t = ns->start[s]; t < ns->start[s - 1]; t++) {
+            ns->new_order[len++] = ns->order[t];
+        }
+        for (t = ns->end[s - 1]; t < ns->end[s]; t++) {
+            ns->new_order[len++] = ns->order[t];
+        }
+    }
+
+    // Cut the old subtree out of the thread and splice the new one in after v_in
+    before = ns->rev_thread[u_out];
+    after = ns->thread[ns->order[size - 1]];
+    ns->thread[before] = after;
+    ns->rev_thread[after] = before;
+
+    after = ns->thread[v_in];
+    p = v_in;
+    for (t = 0; t < len; t++) {
+        x = ns->new_order[t];
+        ns->thread[p] = x;
+        ns->rev_thread[x] = p;
+        p = x;
+    }
+    ns->thread[p] = after;
+    ns->rev_thread[after] = p;
+
+    // Reverse the stem: each stem node now hangs from the one before it
+    arc = in_arc;
+    arc_flow = in_flow;
+    p = v_in;
+    for (s = 0; s < k; s++) {
+        x = ns->stem[s];
+        next_arc = ns->pred[x];
+        next_flow = ns->flow[x];
+        ns->parent[x] = p;
+        ns->pred[x] = arc;
+        ns->flow[x] = arc_flow;
+        ns->mark[x] = -1;
+        arc = next_arc;
+        arc_flow = next_flow;
+        p = x;
+    }
+
+    // Parents come before children in preorder, so one pass suffices.
+    // Artificial arcs always join the root and never sit on a stem.
+    for (t = 0; t < len; t++) {
+        x = ns->new_order[t];
+        p = ns->parent[x];
+        ns->depth[x] = ns->depth[p] + 1;
+        if (ns->pred[x] == ARTIFICIAL_ARC) {
+            ns->pred_dir[x] = ns->art_dir[x];
+        } else {
+            ns->pred_dir[x] = (x < ns->m) ? DIR_UP : DIR_DOWN;
+        }
+        if (ns->pred_dir[x] == DIR_UP) {
+            ns->pi[x] = ns->pi[p] - arc_cost(ns, ns->pred[x]);
+        } else {
+            ns->pi[x] = ns->pi[p] + arc_cost(ns, ns->pred[x]);
+        }
+    }
+}
+
+/**
+ * Solves the transportation problem to optimality with the primal network
+ * simplex method.
+ *
+ * Unlike the allocation methods this needs no starting solution, and unlike
+ * modi_method it prices only a block of cells per pivot and finds each
+ * pivot loop in time proportional to its length (by walking the two
+ * endpoints up to their common ancestor by depth), which keeps large
+ * instances tractable. Quantities and costs are accumulated in 64 bits.
+ *
+ * @param tp Pointer to a balanced TransportationProblem structure.
+ * @param solution Solution to fill with the optimal plan; emptied first.
+ * @param total_cost Receives the total cost of the optimal transportation plan.
+ * @param print_iterations Boolean flag to enable/disable printing each pivot.
+ * @return SOLVER_OK; SOLVER_INFEASIBLE if flow is left on an artificial
+ *         arc, or SOLVER_COST_OVERFLOW if the total cost does not fit in an
+ *         int, with the solution emptied.
+ */
+SolverStatus network_simplex_solve(
+        TransportProblem *tp,
+        Solution *solution,
+        int *total_cost,
+        Boolean print_iterations
+) {
+    NetworkSimplex ns;
+    int in_row = 0, in_col = 0, first, second, join, u_out, u_in, v_in, x;
+    long long in_cost, in_arc, delta;
+    long long plan_cost = 0;
+    int i, j;
+    Boolean out_on_first;
+    long long iteration = 0;
+    SolverStatus status = SOLVER_OK;
+
+    init_network_simplex(&ns, tp);
+
+    while (find_entering_arc(&ns, &in_row, &in_col, &in_cost)) {
+        in_arc = (long long)in_row * ns.n + in_col;
+        first = in_row;
+        second = ns.m + in_col;
+
+        // The pivot loop closes where the endpoints' root paths meet
+        x = first;
+        join = second;
+        while (x != join) {
+            if (ns.depth[x] < ns.depth[join]) {
+                join = ns.parent[join];
+            } else {
+                x = ns.parent[x];
+            }
+        }
+
+        // Flow runs first -> second -> up to join -> down to first. Only arcs
+        // against that direction can run empty. Ties go to the last such arc
+        // met from second's side, which keeps the tree strongly feasible.
+        delta = LLONG_MAX;
+        u_out = -1;
+        out_on_first = TRUE;
+        for (x = first; x != join; x = ns.parent[x]) {
+            if (ns.pred_dir[x] == DIR_UP && ns.flow[x] < delta) {
+                delta = ns.flow[x];
+                u_out = x;
+                out_on_first = TRUE;
+            }
+        }
+        for (x = second; x != join; x = ns.parent[x]) {
+            if (ns.pred_dir[x] == DIR_DOWN && ns.flow[x] <= delta) {
+                delta = ns.flow[x];
+                u_out = x;
+                out_on_first = FALSE;
+            }
+        }
+
+        for (x = first; x != join; x = ns.parent[x]) {
+            ns.flow[x] += (ns.pred_dir[x] == DIR_UP) ? -delta : delta;
+        }
+        for (x = second; x != join; x = ns.parent[x]) {
+            ns.flow[x] += (ns.pred_dir[x] == DIR_UP) ? delta : -delta;
+        }
+
+        u_in = out_on_first ? first : second;
+        v_in = out_on_first ? second : first;
+
+        iteration++;
+        if (print_iterations) {
+            printf("Pivot %lld: cell (%d, %d) enters with reduced cost %lld, %lld units moved.\n",
+                   iteration, in_row, in_col, in_cost, delta);
+        }
+
+        update_tree(&ns, u_in, v_in, in_arc, delta, u_out);
+    }
+
+    // Only tree arcs can carry flow
+    clear_solution(solution);
+    for (x = 0; x < ns.root; x++) {
+        if (ns.pred[x] == ARTIFICIAL_ARC) {
+            if (ns.flow[x] != 0) {
+                status = SOLVER_INFEASIBLE;
+            }
+            continue;
+        }
+        i = (int)(ns.pred[x] / ns.n);
+        j = (int)(ns.pred[x] % ns.n);
+        add_to_solution(solution, i, j, (int)ns.flow[x]);
+        plan_cost += ns.flow[x] * COST_AT(tp, i, j);
+    }
+
+    free_network_simplex(&ns);
+
+    if (status == SOLVER_OK && (plan_cost > INT_MAX || plan_cost < INT_MIN)) {
+        status = SOLVER_COST_OVERFLOW;
+    }
+    if (status != SOLVER_OK) {
+        clear_solution(solution);
+        return status;
+    }
+    if (print_iterations) {
+        printf("Optimal after %lld pivots.\n\n", iteration);
+    }
+    *total_cost = (int)plan_cost;
+    return SOLVER_OK;
+}
+
+/**
+ * Solves the transportation problem to optimality with the primal network
+ * simplex method, as network_simplex_solve() does; a failure is reported
+ * and ends the process.
+ *
+ * @param tp Pointer to a balanced TransportationProblem structure.
+ * @param solution Solution to fill with the optimal plan; emptied first.
+ * @param print_iterations Boolean flag to enable/disable printing each pivot.
+ * @return Total cost of the optimal transportation plan.
+ */
+int network_simplex_method(
+        TransportProblem *tp,
+        Solution *solution,
+        Boolean print_iterations
+) {
+    int total_cost = 0;
+    SolverStatus status = network_simplex_solve(tp, solution, &total_cost, print_iterations);
+
+    if (status != SOLVER_OK) {
+        fprintf(stderr, "%s\n", solver_status_message(status));
+        exit(EXIT_FAILURE);
+    }
+    return total_cost;
+}
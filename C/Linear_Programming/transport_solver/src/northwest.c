@@ -1,33 +1,51 @@
+#ifndef TP_TEMPLATE
 #include <stdio.h>
 #include <stdlib.h>
 #include "transport.h"
+#include "workspace.h"
+
+// North-West Corner Method, compiled once per precision
+#define TP_TEMPLATE "northwest.c"
+#include "precision_template.h"
+
+#else // Template body
 
 /**
- * Solves the transportation problem using the North-West Corner Method.
- * 
+ * Solves the transportation problem using the North-West Corner Method,
+ * taking its scratch space from a workspace.
+ *
+ * @param ws Workspace the problem fits in; reset first.
  * @param tp Pointer to the TransportationProblem structure containing supply, demand, and cost matrix.
- * @param results Pre-allocated 2D array to store the allocation results.
+ * @param solution Solution to fill with the allocated cells; emptied first.
+ * @param total_cost Receives the total cost of the transportation plan.
  * @param print_iterations Boolean flag to enable/disable printing each allocation step.
- * @return Total cost of the transportation plan.
+ * @return SOLVER_OK, SOLVER_TOO_LARGE if the problem does not fit in the workspace, or
+ *         SOLVER_COST_OVERFLOW (with the solution emptied) if the total cost does not fit.
  */
-int north_west_corner_method(
-        TransportProblem *tp,
-        int **results,
+SolverStatus TP_NAME(north_west_corner_solve)(
+        SolverWorkspace *ws,
+        TP_PROBLEM *tp,
+        TP_SOLUTION *solution,
+        TP_VALUE *total_cost,
         Boolean print_iterations
 ) {
     int i = 0; // Row index
     int j = 0; // Column index
-    int total_cost = 0;
-    int allocation;
+    TP_VALUE allocation;
+    TP_WIDE plan_cost = 0;
     int iteration = 0;
 
+    if (check_workspace_fits(ws, tp->supply_size, tp->demand_size) != SOLVER_OK) {
+        return SOLVER_TOO_LARGE;
+    }
+    reset_solver_workspace(ws);
+
     // Create copies of supply and demand to avoid modifying the original data
-    int *supply = (int *)malloc(tp->supply_size * sizeof(int));
-    int *demand = (int *)malloc(tp->demand_size * sizeof(int));
+    TP_VALUE *supply = (TP_VALUE *)workspace_alloc(ws, tp->supply_size * sizeof(TP_VALUE));
+    TP_VALUE *demand = (TP_VALUE *)workspace_alloc(ws, tp->demand_size * sizeof(TP_VALUE));
 
     if (!supply || !demand) {
-        fprintf(stderr, "Memory allocation failed.\n");
-        exit(EXIT_FAILURE);
+        return SOLVER_TOO_LARGE;
     }
 
     for (int k = 0; k < tp->supply_size; k++) {
@@ -38,40 +56,69 @@ int north_west_corner_method(
         demand[k] = tp->demand[k];
     }
 
-    // Initialize results matrix to zeros
-    for (int r = 0; r < tp->supply_size; r++) {
-        for (int c = 0; c < tp->demand_size; c++) {
-            results[r][c] = 0;
-        }
-    }
+    TP_NAME(clear_solution)(solution);
+    *total_cost = 0;
 
     // Allocation loop
     while (i < tp->supply_size && j < tp->demand_size) {
         allocation = (supply[i] < demand[j]) ? supply[i] : demand[j];
-        results[i][j] = allocation;
-        total_cost += allocation * tp->cost_matrix[i][j];
+        TP_NAME(add_to_solution)(solution, i, j, allocation);
+        plan_cost += (TP_WIDE)allocation * TP_COST_AT(tp, i, j);
         iteration++;
 
         if (print_iterations) {
-            printf("Allocation %d: %d units to cell (%d, %d) with cost %d.\n",
-                   iteration, allocation, i, j, tp->cost_matrix[i][j]);
-            printf("  Remaining Supply[%d]: %d\n", i, supply[i] - allocation);
-            printf("  Remaining Demand[%d]: %d\n\n", j, demand[j] - allocation);
+            printf("Allocation %d: " TP_FMT " units to cell (%d, %d) with cost " TP_FMT ".\n",
+                   iteration, TP_PRINT(allocation), i, j, TP_PRINT(TP_COST_AT(tp, i, j)));
+            printf("  Remaining Supply[%d]: " TP_FMT "\n", i, TP_PRINT(supply[i] - allocation));
+            printf("  Remaining Demand[%d]: " TP_FMT "\n\n", j, TP_PRINT(demand[j] - allocation));
         }
 
         supply[i] -= allocation;
         demand[j] -= allocation;
 
-        if (supply[i] == 0 && i < tp->supply_size - 1) {
+        // When both run out the next row starts with a zero allocation, so the
+        // plan keeps m + n - 1 cells and the loop ends once i or j runs off
+        if (supply[i] == 0) {
             i++;
-        } else if (demand[j] == 0 && j < tp->demand_size - 1) {
+        } else {
             j++;
         }
     }
 
-    // Free allocated memory
-    free(supply);
-    free(demand);
+    if (!TP_FITS(plan_cost)) {
+        TP_NAME(clear_solution)(solution);
+        return SOLVER_COST_OVERFLOW;
+    }
+    *total_cost = (TP_VALUE)plan_cost;
+    return SOLVER_OK;
+}
+
+/**
+ * Solves the transportation problem using the North-West Corner Method.
+ * 
+ * @param tp Pointer to the TransportationProblem structure containing supply, demand, and cost matrix.
+ * @param solution Solution to fill with the allocated cells; emptied first.
+ * @param print_iterations Boolean flag to enable/disable printing each allocation step.
+ * @return Total cost of the transportation plan.
+ */
+TP_VALUE TP_NAME(north_west_corner_method)(
+        TP_PROBLEM *tp,
+        TP_SOLUTION *solution,
+        Boolean print_iterations
+) {
+    SolverWorkspace ws;
+    TP_VALUE total_cost = 0;
+    SolverStatus status = init_solver_workspace(&ws, tp->supply_size, tp->demand_size);
 
+    if (status == SOLVER_OK) {
+        status = TP_NAME(north_west_corner_solve)(&ws, tp, solution, &total_cost, print_iterations);
+    }
+    free_solver_workspace(&ws);
+    if (status != SOLVER_OK) {
+        fprintf(stderr, "%s\n", solver_status_message(status));
+        exit(EXIT_FAILURE);
+    }
     return total_cost;
 }
+
+#endif // TP_TEMPLATE
@@ -0,0 +1,125 @@
+#ifndef PRECISION_H
+#define PRECISION_H
+
+#include <stdint.h>
+#include "transport.h"
+#include "workspace.h"
+
+/*
+ * Precision of a problem's quantities and costs, picked per run.
+ *
+ * int32 problems are TransportProblem itself and have every method and
+ * file format. int64 and double problems live in the structures below and
+ * are read from plain-text problem files. Their methods are the same
+ * source as the int32 ones: northwest.c, least_cost.c, vogels.c and
+ * modi.c are written once as templates over the value type and compiled
+ * for every precision (see precision_template.h), so each precision gets
+ * its own specialised loops and int32 keeps its vector kernels.
+ */
+
+typedef enum {
+    PRECISION_INT32,
+    PRECISION_INT64,
+    PRECISION_DOUBLE
+} Precision;
+
+/** Sums of int64 products of a quantity and a cost, exact until range-checked. */
+__extension__ typedef __int128 WideI64;
+
+/** A transportation problem with 64-bit integer quantities and costs. */
+typedef struct {
+    int supply_size;
+    int demand_size;
+    int64_t *supply;
+    int64_t *demand;
+    int64_t *cost;             // cost_rows x cost_columns, row-major
+    int64_t *cost_transposed;  // cost_columns x cost_rows, row-major; NULL until built
+    int cost_rows;             // Supply points the costs cover, as in TransportProblem
+    int cost_columns;          // Demand points the costs cover, as in TransportProblem
+} TransportProblemI64;
+
+/** A transportation problem with floating-point quantities and costs. */
+typedef struct {
+    int supply_size;
+    int demand_size;
+    double *supply;
+    double *demand;
+    double *cost;              // cost_rows x cost_columns, row-major
+    double *cost_transposed;   // cost_columns x cost_rows, row-major; NULL until built
+    int cost_rows;             // Supply points the costs cover, as in TransportProblem
+    int cost_columns;          // Demand points the costs cover, as in TransportProblem
+} TransportProblemF64;
+
+/** A solution of a TransportProblemI64, laid out as Solution. */
+typedef struct {
+    int supply_size;
+    int demand_size;
+    size_t count;
+    size_t capacity;
+    int *row;
+    int *column;
+    int64_t *quantity;
+} SolutionI64;
+
+/** A solution of a TransportProblemF64, laid out as Solution. */
+typedef struct {
+    int supply_size;
+    int demand_size;
+    size_t count;
+    size_t capacity;
+    int *row;
+    int *column;
+    double *quantity;
+} SolutionF64;
+
+/** Cost of cell (i, j) of a wide problem; 0 for a dummy point's cells. */
+#define WIDE_COST_AT(tp, i, j) (HAS_COST(tp, i, j) ? (tp)->cost[COST_INDEX(tp, i, j)] : 0)
+
+/**
+ * Declares the storage, file and method functions of one wide precision;
+ * they mirror the int32 functions of the same name without the suffix.
+ */
+#define DECLARE_PRECISION_API(SUFFIX, PROBLEM, SOLUTION, VALUE)                                    \
+    /* Problem storage */                                                                        \
+    void init_transport_problem##SUFFIX(PROBLEM *tp, int supply_size, int demand_size);          \
+    void free_transport_problem##SUFFIX(PROBLEM *tp);                                            \
+    void build_cost_transpose##SUFFIX(PROBLEM *tp);                                              \
+    int balance_transport_problem##SUFFIX(PROBLEM *tp);                                          \
+    const VALUE *cost_row##SUFFIX(const PROBLEM *tp, int i, VALUE *buffer);                      \
+    const VALUE *cost_column##SUFFIX(const PROBLEM *tp, int j, VALUE *buffer);                   \
+    /* Problem files */                                                                          \
+    int load_problem_file##SUFFIX(const char *path, PROBLEM *tp);                                \
+    /* Solutions */                                                                              \
+    void init_solution##SUFFIX(SOLUTION *solution, int supply_size, int demand_size);            \
+    void free_solution##SUFFIX(SOLUTION *solution);                                              \
+    void clear_solution##SUFFIX(SOLUTION *solution);                                             \
+    void reshape_solution##SUFFIX(SOLUTION *solution, int supply_size, int demand_size);         \
+    void add_to_solution##SUFFIX(SOLUTION *solution, int row, int column, VALUE quantity);       \
+    VALUE *solution_to_matrix##SUFFIX(const SOLUTION *solution);                                 \
+    void write_solution##SUFFIX(FILE *out, const SOLUTION *solution, VALUE total_cost,           \
+                                SolutionFormat format);                                          \
+    /* Allocation methods */                                                                     \
+    VALUE vogels_approximation_method##SUFFIX(PROBLEM *tp, SOLUTION *solution,                   \
+                                              Boolean print_iterations);                         \
+    VALUE vogels_parallel_method##SUFFIX(PROBLEM *tp, SOLUTION *solution, int num_threads,       \
+                                         Boolean print_iterations);                              \
+    VALUE north_west_corner_method##SUFFIX(PROBLEM *tp, SOLUTION *solution,                      \
+                                           Boolean print_iterations);                            \
+    VALUE least_cost_method##SUFFIX(PROBLEM *tp, SOLUTION *solution, Boolean print_iterations);  \
+    /* Optimisation methods */                                                                   \
+    VALUE modi_method##SUFFIX(PROBLEM *tp, SOLUTION *solution, Boolean print_iterations);        \
+    SolverStatus modi_solve##SUFFIX(PROBLEM *tp, SOLUTION *solution, VALUE *total_cost,          \
+                                    Boolean print_iterations);                                   \
+    /* Allocation methods on a workspace */                                                      \
+    SolverStatus north_west_corner_solve##SUFFIX(SolverWorkspace *ws, PROBLEM *tp,               \
+                                                 SOLUTION *solution, VALUE *total_cost,          \
+                                                 Boolean print_iterations);                      \
+    SolverStatus least_cost_solve##SUFFIX(SolverWorkspace *ws, PROBLEM *tp, SOLUTION *solution,  \
+                                          VALUE *total_cost, Boolean print_iterations);          \
+    SolverStatus vogels_solve##SUFFIX(SolverWorkspace *ws, PROBLEM *tp, SOLUTION *solution,      \
+                                      VALUE *total_cost, Boolean print_iterations);
+
+DECLARE_PRECISION_API(_i64, TransportProblemI64, SolutionI64, int64_t)
+DECLARE_PRECISION_API(_f64, TransportProblemF64, SolutionF64, double)
+
+#endif // PRECISION_H
@@ -0,0 +1,120 @@
+/*
+ * Compiles a template once per precision. A source file that holds a
+ * template keeps its ordinary code under #ifndef TP_TEMPLATE, defines
+ * TP_TEMPLATE as its own quoted name and includes this header, which
+ * includes the file again for every precision; the template body sits in
+ * the file's #else branch. Define TP_WIDE_ONLY first to skip the int32
+ * instance, for code whose int32 version is written out separately.
+ *
+ * No include guard: every inclusion instantiates again. Inside a body:
+ *
+ *     TP_VALUE               quantity and cost type
+ *     TP_WIDE                type for sums of costs (MODI potentials, plan costs),
+ *                            which holds a quantity times a cost exactly
+ *     TP_FITS(x)             whether a TP_WIDE total fits in a TP_VALUE
+ *     TP_PROBLEM             problem structure
+ *     TP_SOLUTION            solution structure
+ *     TP_NAME(f)             f for int32, f_i64 or f_f64 for the others
+ *     TP_COST_AT(tp, i, j)   cost of cell (i, j)
+ *     TP_MAX, TP_MIN         largest and lowest TP_VALUE
+ *     TP_FMT, TP_PRINT(x)    printf conversion and argument for a TP_VALUE
+ *     TP_WIDE_FMT, TP_WIDE_PRINT(x)  printf conversion and argument for a TP_WIDE
+ *     TP_FLOATING            1 for double, where comparisons need a tolerance
+ */
+
+#include <limits.h>
+#include <float.h>
+#include <stdint.h>
+#include "precision.h"
+
+#ifndef TP_WIDE_ONLY
+#define TP_VALUE int
+#define TP_WIDE long long
+#define TP_PROBLEM TransportProblem
+#define TP_SOLUTION Solution
+#define TP_NAME(f) f
+#define TP_COST_AT(tp, i, j) COST_AT(tp, i, j)
+#define TP_MAX INT_MAX
+#define TP_MIN INT_MIN
+#define TP_FMT "%d"
+#define TP_PRINT(x) (x)
+#define TP_WIDE_FMT "%lld"
+#define TP_WIDE_PRINT(x) (x)
+#define TP_FLOATING 0
+#define TP_FITS(x) ((x) >= INT_MIN && (x) <= INT_MAX)
+#include TP_TEMPLATE
+#undef TP_VALUE
+#undef TP_WIDE
+#undef TP_PROBLEM
+#undef TP_SOLUTION
+#undef TP_NAME
+#undef TP_COST_AT
+#undef TP_MAX
+#undef TP_MIN
+#undef TP_FMT
+#undef TP_PRINT
+#undef TP_WIDE_FMT
+#undef TP_WIDE_PRINT
+#undef TP_FLOATING
+#undef TP_FITS
+#endif
+
+#define TP_VALUE int64_t
+#define TP_WIDE WideI64
+#define TP_PROBLEM TransportProblemI64
+#define TP_SOLUTION SolutionI64
+#define TP_NAME(f) f##_i64
+#define TP_COST_AT(tp, i, j) WIDE_COST_AT(tp, i, j)
+#define TP_MAX INT64_MAX
+#define TP_MIN INT64_MIN
+#define TP_FMT "%lld"
+#define TP_PRINT(x) ((long long)(x))
+#define TP_WIDE_FMT "%.0Lf"
+#define TP_WIDE_PRINT(x) ((long double)(x))
+#define TP_FLOATING 0
+#define TP_FITS(x) ((x) >= INT64_MIN && (x) <= INT64_MAX)
+#include TP_TEMPLATE
+#undef TP_VALUE
+#undef TP_WIDE
+#undef TP_PROBLEM
+#undef TP_SOLUTION
+#undef TP_NAME
+#undef TP_COST_AT
+#undef TP_MAX
+#undef TP_MIN
+#undef TP_FMT
+#undef TP_PRINT
+#undef TP_WIDE_FMT
+#undef TP_WIDE_PRINT
+#undef TP_FLOATING
+#undef TP_FITS
+
+#define TP_VALUE double
+#define TP_WIDE double
+#define TP_PROBLEM TransportProblemF64
+#define TP_SOLUTION SolutionF64
+#define TP_NAME(f) f##_f64
+#define TP_COST_AT(tp, i, j) WIDE_COST_AT(tp, i, j)
+#define TP_MAX DBL_MAX
+#define TP_MIN (-DBL_MAX)
+#define TP_FMT "%.15g"
+#define TP_PRINT(x) (x)
+#define TP_WIDE_FMT "%.15g"
+#define TP_WIDE_PRINT(x) (x)
+#define TP_FLOATING 1
+#define TP_FITS(x) 1
+#include TP_TEMPLATE
+#undef TP_VALUE
+#undef TP_WIDE
+#undef TP_PROBLEM
+#undef TP_SOLUTION
+#undef TP_NAME
+#undef TP_COST_AT
+#undef TP_MAX
+#undef TP_MIN
+#undef TP_FMT
+#undef TP_PRINT
+#undef TP_WIDE_FMT
+#undef TP_WIDE_PRINT
+#undef TP_FLOATING
+#undef TP_FITS
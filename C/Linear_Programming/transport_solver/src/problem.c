@@ -0,0 +1,488 @@
+#ifndef TP_TEMPLATE
+#define _POSIX_C_SOURCE 200809L  // munmap
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <sys/mman.h>
+#include "transport.h"
+#include "cost_function.h"
+
+#define TRANSPOSE_BLOCK 32 // Tile edge for the cache-blocked transpose
+
+/**
+ * Allocates the vectors and the contiguous cost buffer of a problem.
+ * Supplies, demands and costs start out zero.
+ *
+ * @param tp Pointer to the TransportationProblem structure to initialise.
+ * @param supply_size Number of supply points.
+ * @param demand_size Number of demand points.
+ */
+void init_transport_problem(
+        TransportProblem *tp,
+        int supply_size,
+        int demand_size
+) {
+    tp->supply_size = supply_size;
+    tp->demand_size = demand_size;
+    tp->supply = (int *)calloc(supply_size + 1, sizeof(int));
+    tp->demand = (int *)calloc(demand_size + 1, sizeof(int));
+    tp->cost = (int *)calloc((size_t)supply_size * demand_size + 1, sizeof(int));
+    tp->cost_transposed = NULL;
+    tp->mapping = NULL;
+    tp->mapping_length = 0;
+    tp->cost_function = NULL;
+    tp->cost_rows = supply_size;
+    tp->cost_columns = demand_size;
+
+    if (!tp->supply || !tp->demand || !tp->cost) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Allocates the vectors of a problem whose costs are computed on demand.
+ * No cost buffer is allocated; the problem takes ownership of the cost
+ * function and frees it with itself.
+ *
+ * @param tp Pointer to the TransportationProblem structure to initialise.
+ * @param supply_size Number of supply points.
+ * @param demand_size Number of demand points.
+ * @param cost_function Prepared cost function for supply_size x demand_size lanes.
+ */
+void init_implicit_transport_problem(
+        TransportProblem *tp,
+        int supply_size,
+        int demand_size,
+        CostFunction *cost_function
+) {
+    tp->supply_size = supply_size;
+    tp->demand_size = demand_size;
+    tp->supply = (int *)calloc(supply_size + 1, sizeof(int));
+    tp->demand = (int *)calloc(demand_size + 1, sizeof(int));
+    tp->cost = NULL;
+    tp->cost_transposed = NULL;
+    tp->mapping = NULL;
+    tp->mapping_length = 0;
+    tp->cost_function = cost_function;
+    tp->cost_rows = supply_size;
+    tp->cost_columns = demand_size;
+
+    if (!tp->supply || !tp->demand) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Releases the cost buffer, unmapping it if it lives in a file mapping.
+ *
+ * @param tp Pointer to the TransportationProblem structure.
+ */
+static void release_cost_buffer(
+        TransportProblem *tp
+) {
+    if (tp->mapping) {
+        munmap(tp->mapping, tp->mapping_length);
+    } else {
+        free(tp->cost);
+    }
+    tp->cost = NULL;
+    tp->mapping = NULL;
+    tp->mapping_length = 0;
+}
+
+/**
+ * Frees the memory held by a problem.
+ *
+ * @param tp Pointer to the TransportationProblem structure.
+ */
+void free_transport_problem(
+        TransportProblem *tp
+) {
+    free(tp->supply);
+    free(tp->demand);
+    release_cost_buffer(tp);
+    free(tp->cost_transposed);
+    free_cost_function(tp->cost_function);
+    tp->supply = NULL;
+    tp->demand = NULL;
+    tp->cost_transposed = NULL;
+    tp->cost_function = NULL;
+}
+
+/**
+ * Makes a problem use a cost block inside a file mapping instead of its own
+ * buffer. The mapping is unmapped by free_transport_problem().
+ *
+ * @param tp Pointer to an initialised TransportationProblem structure.
+ * @param cost Row-major supply_size x demand_size costs inside the mapping.
+ * @param mapping Start of the mapping.
+ * @param mapping_length Length of the mapping in bytes.
+ */
+void adopt_cost_mapping(
+        TransportProblem *tp,
+        int *cost,
+        void *mapping,
+        size_t mapping_length
+) {
+    free(tp->cost);
+    tp->cost = cost;
+    tp->mapping = mapping;
+    tp->mapping_length = mapping_length;
+}
+
+/**
+ * Computes the cost of cell (i, j) of a problem with implicit costs; this
+ * is COST_AT's path when there is no cost buffer.
+ *
+ * @param tp Pointer to the TransportationProblem structure.
+ * @param i Supply point.
+ * @param j Demand point.
+ * @return The cost.
+ */
+int implicit_cost(
+        const TransportProblem *tp,
+        int i,
+        int j
+) {
+    return cost_function_at(tp->cost_function, i, j);
+}
+
+/**
+ * Gives the costs of row i against the demand points the costs cover: a
+ * pointer into the cost buffer, or the costs evaluated in one batch into
+ * buffer when they are implicit. A dummy demand point's cell lies past
+ * them and costs 0; a dummy supply point's row is all zeros.
+ *
+ * @param tp Pointer to the TransportationProblem structure.
+ * @param i Supply point.
+ * @param buffer Scratch space for cost_columns costs.
+ * @return The cost_columns costs of the row; valid until buffer is reused.
+ */
+const int *cost_row(
+        const TransportProblem *tp,
+        int i,
+        int *buffer
+) {
+    if (i >= tp->cost_rows) {
+        memset(buffer, 0, tp->cost_columns * sizeof(int));
+        return buffer;
+    }
+    if (tp->cost) {
+        return &tp->cost[COST_INDEX(tp, i, 0)];
+    }
+    cost_function_row(tp->cost_function, i, tp->cost_columns, buffer);
+    return buffer;
+}
+
+/**
+ * Gives the costs of column j against the supply points the costs cover:
+ * a pointer into the transposed copy if it was built, otherwise the costs
+ * gathered or evaluated into buffer. A dummy supply point's cell lies past
+ * them and costs 0; a dummy demand point's column is all zeros.
+ *
+ * @param tp Pointer to the TransportationProblem structure.
+ * @param j Demand point.
+ * @param buffer Scratch space for cost_rows costs.
+ * @return The cost_rows costs of the column; valid until buffer is reused.
+ */
+const int *cost_column(
+        const TransportProblem *tp,
+        int j,
+        int *buffer
+) {
+    int i;
+
+    if (j >= tp->cost_columns) {
+        memset(buffer, 0, tp->cost_rows * sizeof(int));
+        return buffer;
+    }
+    if (tp->cost_transposed) {
+        return &tp->cost_transposed[(size_t)j * tp->cost_rows];
+    }
+    if (tp->cost) {
+        for (i = 0; i < tp->cost_rows; i++) {
+            buffer[i] = tp->cost[COST_INDEX(tp, i, j)];
+        }
+    } else {
+        cost_function_column(tp->cost_function, j, tp->cost_rows, buffer);
+    }
+    return buffer;
+}
+
+/**
+ * Builds the column-major copy of the cost buffer, so a column's costs are
+ * contiguous. Does nothing if the copy already exists or the costs are
+ * implicit, since cost_column() then evaluates a column in one batch. If
+ * the copy cannot be allocated it stays NULL and cost_column() gathers
+ * each column from the row-major buffer instead.
+ *
+ * @param tp Pointer to the TransportationProblem structure.
+ */
+void build_cost_transpose(
+        TransportProblem *tp
+) {
+    int m = tp->cost_rows, n = tp->cost_columns;
+    int bi, bj, i, j, i_end, j_end;
+
+    if (tp->cost_transposed || !tp->cost) {
+        return;
+    }
+    tp->cost_transposed = (int *)malloc(((size_t)m * n + 1) * sizeof(int));
+    if (!tp->cost_transposed) {
+        return;
+    }
+
+    // Tiles keep both the reads and the writes within a few cache lines
+    for (bi = 0; bi < m; bi += TRANSPOSE_BLOCK) {
+        i_end = (bi + TRANSPOSE_BLOCK < m) ? bi + TRANSPOSE_BLOCK : m;
+        for (bj = 0; bj < n; bj += TRANSPOSE_BLOCK) {
+            j_end = (bj + TRANSPOSE_BLOCK < n) ? bj + TRANSPOSE_BLOCK : n;
+            for (i = bi; i < i_end; i++) {
+                for (j = bj; j < j_end; j++) {
+                    tp->cost_transposed[(size_t)j * m + i] = tp->cost[(size_t)i * n + j];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Balances the transportation problem by adding a dummy supply or demand
+ * node if necessary. The dummy's cells cost 0 and are not stored (see
+ * TransportProblem), so this takes constant time and leaves the cost
+ * buffer, which may be a read-only file mapping, untouched.
+ *
+ * @param tp Pointer to the TransportationProblem structure to be balanced.
+ * @return 0 on success, -1 if the total supply or demand does not fit in an
+ *         int (the problem is left as it was).
+ */
+int balance_transport_problem(TransportProblem *tp) {
+    long long total_supply = 0, total_demand = 0;
+    int m = tp->supply_size, n = tp->demand_size;
+
+    // Calculate total supply
+    for (int i = 0; i < m; i++) {
+        total_supply += tp->supply[i];
+    }
+
+    // Calculate total demand
+    for (int j = 0; j < n; j++) {
+        total_demand += tp->demand[j];
+    }
+
+    if (total_supply > INT_MAX || total_demand > INT_MAX) {
+        return -1;
+    }
+    if (total_supply == total_demand) {
+        // The problem is already balanced
+        return 0;
+    }
+    if (m != tp->cost_rows || n != tp->cost_columns) {
+        fprintf(stderr, "The problem already has a dummy point and is still unbalanced.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // The spare slot of each vector holds the dummy's quantity
+    if (total_supply > total_demand) {
+        tp->demand[n] = (int)(total_supply - total_demand);
+        tp->demand_size++;
+    } else {
+        tp->supply[m] = (int)(total_demand - total_supply);
+        tp->supply_size++;
+    }
+    return 0;
+}
+
+// Storage of the wide precisions, whose problems always own a dense cost buffer
+#define TP_TEMPLATE "problem.c"
+#define TP_WIDE_ONLY
+#include "precision_template.h"
+
+#else // Template body
+
+/**
+ * Allocates the vectors and the contiguous cost buffer of a problem.
+ * Supplies, demands and costs start out zero.
+ *
+ * @param tp Pointer to the problem structure to initialise.
+ * @param supply_size Number of supply points.
+ * @param demand_size Number of demand points.
+ */
+void TP_NAME(init_transport_problem)(
+        TP_PROBLEM *tp,
+        int supply_size,
+        int demand_size
+) {
+    tp->supply_size = supply_size;
+    tp->demand_size = demand_size;
+    tp->supply = (TP_VALUE *)calloc(supply_size + 1, sizeof(TP_VALUE));
+    tp->demand = (TP_VALUE *)calloc(demand_size + 1, sizeof(TP_VALUE));
+    tp->cost = (TP_VALUE *)calloc((size_t)supply_size * demand_size + 1, sizeof(TP_VALUE));
+    tp->cost_transposed = NULL;
+    tp->cost_rows = supply_size;
+    tp->cost_columns = demand_size;
+
+    if (!tp->supply || !tp->demand || !tp->cost) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Frees the memory held by a problem.
+ *
+ * @param tp Pointer to the problem structure.
+ */
+void TP_NAME(free_transport_problem)(
+        TP_PROBLEM *tp
+) {
+    free(tp->supply);
+    free(tp->demand);
+    free(tp->cost);
+    free(tp->cost_transposed);
+    tp->supply = NULL;
+    tp->demand = NULL;
+    tp->cost = NULL;
+    tp->cost_transposed = NULL;
+}
+
+/**
+ * Gives the costs of row i against the demand points the costs cover, as
+ * cost_row() does.
+ *
+ * @param tp Pointer to the problem structure.
+ * @param i Supply point.
+ * @param buffer Scratch space for cost_columns costs.
+ * @return The cost_columns costs of the row; valid until buffer is reused.
+ */
+const TP_VALUE *TP_NAME(cost_row)(
+        const TP_PROBLEM *tp,
+        int i,
+        TP_VALUE *buffer
+) {
+    if (i >= tp->cost_rows) {
+        memset(buffer, 0, tp->cost_columns * sizeof(TP_VALUE));
+        return buffer;
+    }
+    return &tp->cost[COST_INDEX(tp, i, 0)];
+}
+
+/**
+ * Gives the costs of column j against the supply points the costs cover,
+ * as cost_column() does.
+ *
+ * @param tp Pointer to the problem structure.
+ * @param j Demand point.
+ * @param buffer Scratch space for cost_rows costs.
+ * @return The cost_rows costs of the column; valid until buffer is reused.
+ */
+const TP_VALUE *TP_NAME(cost_column)(
+        const TP_PROBLEM *tp,
+        int j,
+        TP_VALUE *buffer
+) {
+    int i;
+
+    if (j >= tp->cost_columns) {
+        memset(buffer, 0, tp->cost_rows * sizeof(TP_VALUE));
+        return buffer;
+    }
+    if (tp->cost_transposed) {
+        return &tp->cost_transposed[(size_t)j * tp->cost_rows];
+    }
+    for (i = 0; i < tp->cost_rows; i++) {
+        buffer[i] = tp->cost[COST_INDEX(tp, i, j)];
+    }
+    return buffer;
+}
+
+/**
+ * Builds the column-major copy of the cost buffer, so a column's costs are
+ * contiguous. Does nothing if the copy already exists, and leaves it NULL
+ * (so cost_column() gathers from the row-major buffer) if it cannot be
+ * allocated.
+ *
+ * @param tp Pointer to the problem structure.
+ */
+void TP_NAME(build_cost_transpose)(
+        TP_PROBLEM *tp
+) {
+    int m = tp->cost_rows, n = tp->cost_columns;
+    int bi, bj, i, j, i_end, j_end;
+
+    if (tp->cost_transposed) {
+        return;
+    }
+    tp->cost_transposed = (TP_VALUE *)malloc(((size_t)m * n + 1) * sizeof(TP_VALUE));
+    if (!tp->cost_transposed) {
+        return;
+    }
+
+    for (bi = 0; bi < m; bi += TRANSPOSE_BLOCK) {
+        i_end = (bi + TRANSPOSE_BLOCK < m) ? bi + TRANSPOSE_BLOCK : m;
+        for (bj = 0; bj < n; bj += TRANSPOSE_BLOCK) {
+            j_end = (bj + TRANSPOSE_BLOCK < n) ? bj + TRANSPOSE_BLOCK : n;
+            for (i = bi; i < i_end; i++) {
+                for (j = bj; j < j_end; j++) {
+                    tp->cost_transposed[(size_t)j * m + i] = tp->cost[(size_t)i * n + j];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Balances the problem by adding a dummy supply or demand node if
+ * necessary, in constant time as balance_transport_problem() does.
+ * Floating-point totals count as balanced when they differ by less than a
+ * relative 1e-9, which is rounding rather than a real surplus.
+ *
+ * @param tp Pointer to the problem structure to be balanced.
+ * @return 0 on success, -1 if the total supply or demand does not fit in
+ *         the value type (the problem is left as it was).
+ */
+int TP_NAME(balance_transport_problem)(
+        TP_PROBLEM *tp
+) {
+    TP_WIDE total_supply = 0, total_demand = 0;
+    int m = tp->supply_size, n = tp->demand_size;
+
+    for (int i = 0; i < m; i++) {
+        total_supply += tp->supply[i];
+    }
+    for (int j = 0; j < n; j++) {
+        total_demand += tp->demand[j];
+    }
+
+    if (!TP_FITS(total_supply) || !TP_FITS(total_demand)) {
+        return -1;
+    }
+#if TP_FLOATING
+    if (fabs(total_supply - total_demand) <= 1e-9 * (fabs(total_supply) + fabs(total_demand))) {
+        return 0;
+    }
+#else
+    if (total_supply == total_demand) {
+        return 0;
+    }
+#endif
+    if (m != tp->cost_rows || n != tp->cost_columns) {
+        fprintf(stderr, "The problem already has a dummy point and is still unbalanced.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (total_supply > total_demand) {
+        tp->demand[n] = (TP_VALUE)(total_supply - total_demand);
+        tp->demand_size++;
+    } else {
+        tp->supply[m] = (TP_VALUE)(total_demand - total_supply);
+        tp->supply_size++;
+    }
+    return 0;
+}
+
+#endif // TP_TEMPLATE
@@ -0,0 +1,678 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include "transport.h"
+#include "sparse_problem.h"
+
+/*
+ * Binary problem files.
+ *
+ * A file is a fixed 64-byte header followed by sections that each start on
+ * an 8-byte boundary, all in the byte order of the machine that wrote it:
+ *
+ *     header
+ *     supply       int64[supply_size]
+ *     demand       int64[demand_size]
+ *     dense:       cost[supply_size * demand_size], row-major
+ *     sparse or    row_start uint64[supply_size + 1]
+ *     routes:      column    uint32[entries]
+ *                  cost      cost[entries]
+ *
+ * Costs are cost_width bytes wide (2, 4 or 8). A sparse block lists the
+ * cells of row i at positions row_start[i] .. row_start[i + 1] - 1; every
+ * other cell costs default_cost. A routes block has the same sections but
+ * holds a SparseTransportProblem: the cells it leaves out are forbidden,
+ * and the columns of a row must be strictly ascending. A dense block of 4-byte costs is used in
+ * place from the mapped file, so loading it only touches the header and
+ * the vectors; other layouts and widths are converted into a cost buffer.
+ */
+
+#define PROBLEM_MAGIC "TGPROB\0\n"
+#define PROBLEM_FORMAT_VERSION 1
+#define PROBLEM_BYTE_ORDER 0x01020304u
+
+typedef enum {
+    PROBLEM_DENSE,
+    PROBLEM_SPARSE,
+    PROBLEM_ROUTES
+} ProblemLayout;
+
+typedef struct {
+    char magic[8];           // PROBLEM_MAGIC
+    uint32_t version;        // PROBLEM_FORMAT_VERSION
+    uint32_t byte_order;     // PROBLEM_BYTE_ORDER as stored by the writer
+    uint32_t cost_width;     // Bytes per cost: 2, 4 or 8
+    uint32_t layout;         // ProblemLayout
+    int64_t supply_size;
+    int64_t demand_size;
+    uint64_t entries;        // Costs stored in the cost section
+    int64_t default_cost;    // Cost of the cells a sparse block leaves out
+    uint64_t reserved;
+} ProblemFileHeader;
+
+/** Rounds a byte offset up to the next section boundary. */
+#define SECTION_ALIGN(offset) (((offset) + 7) & ~(uint64_t)7)
+
+/**
+ * Validated header and section offsets of a binary problem file.
+ */
+typedef struct {
+    ProblemFileHeader header;
+    uint64_t supply;         // Offset of the supply section
+    uint64_t demand;         // Offset of the demand section
+    uint64_t rows;           // Offset of row_start, sparse and routes layouts only
+    uint64_t columns;        // Offset of the column section, sparse and routes layouts only
+    uint64_t costs;          // Offset of the cost section
+} ProblemSections;
+
+/**
+ * Tells whether a buffer starts like a binary problem file.
+ *
+ * @param data File contents.
+ * @param length Number of bytes.
+ * @return TRUE if the magic number matches.
+ */
+Boolean is_problem_binary(
+        const char *data,
+        size_t length
+) {
+    return (length >= sizeof(ProblemFileHeader) &&
+            memcmp(data, PROBLEM_MAGIC, 8) == 0) ? TRUE : FALSE;
+}
+
+/**
+ * Reads cost k of a cost section.
+ *
+ * @param costs Start of the cost section.
+ * @param width Bytes per cost.
+ * @param k Index of the cost.
+ * @return The cost, widened to 64 bits.
+ */
+static int64_t cost_entry(
+        const char *costs,
+        uint32_t width,
+        size_t k
+) {
+    int16_t c16;
+    int32_t c32;
+    int64_t c64;
+
+    switch (width) {
+        case 2:
+            memcpy(&c16, costs + k * 2, 2);
+            return c16;
+        case 4:
+            memcpy(&c32, costs + k * 4, 4);
+            return c32;
+        default:
+            memcpy(&c64, costs + k * 8, 8);
+            return c64;
+    }
+}
+
+/**
+ * Copies a supply or demand section into an int vector, reporting the first
+ * value that is negative or does not fit in an int.
+ *
+ * @param section Start of the section.
+ * @param out Destination vector.
+ * @param count Number of values.
+ * @param what Name of the section, for the error message.
+ * @param path Path of the file, for the error message.
+ * @return 0 on success, -1 on error.
+ */
+static int read_vector(
+        const char *section,
+        int *out,
+        int64_t count,
+        const char *what,
+        const char *path
+) {
+    int64_t k, v;
+
+    for (k = 0; k < count; k++) {
+        memcpy(&v, section + k * 8, 8);
+        if (v < 0 || v > INT_MAX) {
+            fprintf(stderr, "%s: %s quantity %lld as value %lld of the %s.\n",
+                    path, (v < 0) ? "negative" : "out-of-range", (long long)v,
+                    (long long)(k + 1), what);
+            return -1;
+        }
+        out[k] = (int)v;
+    }
+    return 0;
+}
+
+/**
+ * Converts a dense cost section into the problem's cost buffer.
+ *
+ * @param tp Pointer to the TransportationProblem structure.
+ * @param costs Start of the cost section.
+ * @param width Bytes per cost.
+ * @return 0 on success, -1 if a cost does not fit in an int.
+ */
+static int fill_dense_costs(
+        TransportProblem *tp,
+        const char *costs,
+        uint32_t width
+) {
+    size_t cells = (size_t)tp->supply_size * tp->demand_size;
+    size_t k;
+    int64_t c;
+
+    for (k = 0; k < cells; k++) {
+        c = cost_entry(costs, width, k);
+        if (c < INT_MIN || c > INT_MAX) return -1;
+        tp->cost[k] = (int)c;
+    }
+    return 0;
+}
+
+/**
+ * Expands a sparse cost block into the problem's cost buffer.
+ *
+ * @param tp Pointer to the TransportationProblem structure.
+ * @param header File header.
+ * @param rows Start of the row_start section.
+ * @param columns Start of the column section.
+ * @param costs Start of the cost section.
+ * @return 0 on success, -1 if the block is inconsistent or a cost does not fit in an int.
+ */
+static int fill_sparse_costs(
+        TransportProblem *tp,
+        const ProblemFileHeader *header,
+        const char *rows,
+        const char *columns,
+        const char *costs
+) {
+    const uint64_t *row_start = (const uint64_t *)(const void *)rows;
+    const uint32_t *column = (const uint32_t *)(const void *)columns;
+    size_t cells = (size_t)tp->supply_size * tp->demand_size;
+    size_t k;
+    uint64_t e;
+    int64_t c;
+    int i;
+
+    if (row_start[0] != 0 || row_start[tp->supply_size] != header->entries) return -1;
+    for (k = 0; k < cells; k++) {
+        tp->cost[k] = (int)header->default_cost;
+    }
+    for (i = 0; i < tp->supply_size; i++) {
+        if (row_start[i] > row_start[i + 1]) return -1;
+        for (e = row_start[i]; e < row_start[i + 1]; e++) {
+            c = cost_entry(costs, header->cost_width, e);
+            if (column[e] >= (uint32_t)tp->demand_size || c < INT_MIN || c > INT_MAX) return -1;
+            tp->cost[COST_INDEX(tp, i, column[e])] = (int)c;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Tells whether a binary problem file holds a problem with forbidden routes.
+ *
+ * @param data File contents.
+ * @param length Number of bytes.
+ * @return TRUE if the magic number matches and the layout is PROBLEM_ROUTES.
+ */
+Boolean is_route_problem_binary(
+        const char *data,
+        size_t length
+) {
+    ProblemFileHeader header;
+
+    if (!is_problem_binary(data, length)) {
+        return FALSE;
+    }
+    memcpy(&header, data, sizeof(header));
+    return (header.layout == PROBLEM_ROUTES) ? TRUE : FALSE;
+}
+
+/**
+ * Validates the header of a binary problem file and locates its sections.
+ *
+ * @param path Path of the file, for error messages.
+ * @param data File contents.
+ * @param length Number of bytes.
+ * @param sections Receives the header and the section offsets.
+ * @return 0 on success, -1 on error (reported on stderr).
+ */
+static int locate_sections(
+        const char *path,
+        const char *data,
+        size_t length,
+        ProblemSections *sections
+) {
+    ProblemFileHeader *header = &sections->header;
+    uint64_t cells, offset, end;
+
+    memcpy(header, data, sizeof(*header));
+    if (header->byte_order != PROBLEM_BYTE_ORDER) {
+        fprintf(stderr, "%s: written with a different byte order.\n", path);
+        return -1;
+    }
+    if (header->version != PROBLEM_FORMAT_VERSION) {
+        fprintf(stderr, "%s: unsupported format version %u.\n", path, (unsigned)header->version);
+        return -1;
+    }
+    if ((header->cost_width != 2 && header->cost_width != 4 && header->cost_width != 8) ||
+            header->layout > PROBLEM_ROUTES ||
+            header->supply_size <= 0 || header->supply_size > INT_MAX ||
+            header->demand_size <= 0 || header->demand_size > INT_MAX ||
+            header->default_cost < INT_MIN || header->default_cost > INT_MAX) {
+        fprintf(stderr, "%s: invalid header.\n", path);
+        return -1;
+    }
+    cells = (uint64_t)header->supply_size * (uint64_t)header->demand_size;
+    if (header->layout == PROBLEM_DENSE ? header->entries != cells : header->entries > cells) {
+        fprintf(stderr, "%s: invalid header.\n", path);
+        return -1;
+    }
+
+    // Section offsets, checked against the file length before any access
+    sections->supply = sizeof(ProblemFileHeader);
+    sections->demand = SECTION_ALIGN(sections->supply + (uint64_t)header->supply_size * 8);
+    offset = SECTION_ALIGN(sections->demand + (uint64_t)header->demand_size * 8);
+    sections->rows = 0;
+    sections->columns = 0;
+    if (header->layout != PROBLEM_DENSE) {
+        sections->rows = offset;
+        sections->columns = SECTION_ALIGN(sections->rows + ((uint64_t)header->supply_size + 1) * 8);
+        offset = SECTION_ALIGN(sections->columns + header->entries * 4);
+    }
+    sections->costs = offset;
+    end = sections->costs + header->entries * header->cost_width;
+    if (end > length) {
+        fprintf(stderr, "%s: truncated, expected %llu bytes but found %zu.\n",
+                path, (unsigned long long)end, length);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Builds a problem from the contents of a binary problem file.
+ *
+ * @param path Path of the file, for error messages.
+ * @param data File contents.
+ * @param length Number of bytes.
+ * @param mapped TRUE if data is a private writable mapping the problem may keep.
+ * @param tp Pointer to the TransportationProblem structure to fill; initialised here.
+ * @return 1 if tp kept the mapping (the caller must not unmap it), 0 on
+ *         success without it, -1 on error (reported on stderr, tp left empty).
+ */
+int parse_problem_binary(
+        const char *path,
+        char *data,
+        size_t length,
+        Boolean mapped,
+        TransportProblem *tp
+) {
+    ProblemSections sections;
+    const ProblemFileHeader *header = &sections.header;
+
+    if (locate_sections(path, data, length, &sections) != 0) {
+        return -1;
+    }
+    if (header->layout == PROBLEM_ROUTES) {
+        fprintf(stderr, "%s: the problem has forbidden routes and needs a sparse solver.\n", path);
+        return -1;
+    }
+
+    init_transport_problem(tp, (int)header->supply_size, (int)header->demand_size);
+    if (read_vector(data + sections.supply, tp->supply, header->supply_size,
+                    "supply vector", path) != 0 ||
+            read_vector(data + sections.demand, tp->demand, header->demand_size,
+                        "demand vector", path) != 0) {
+        free_transport_problem(tp);
+        return -1;
+    }
+
+    if (header->layout == PROBLEM_DENSE && header->cost_width == 4 && mapped) {
+        adopt_cost_mapping(tp, (int *)(void *)(data + sections.costs), data, length);
+        return 1;
+    }
+
+    if ((header->layout == PROBLEM_DENSE ?
+            fill_dense_costs(tp, data + sections.costs, header->cost_width) :
+            fill_sparse_costs(tp, header, data + sections.rows, data + sections.columns,
+                              data + sections.costs)) != 0) {
+        fprintf(stderr, "%s: invalid cost block or a cost that does not fit in an int.\n", path);
+        free_transport_problem(tp);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Copies a routes block into a sparse problem's CSR arrays.
+ *
+ * @param sp Pointer to the SparseTransportProblem structure, sized for the block.
+ * @param header File header.
+ * @param rows Start of the row_start section.
+ * @param columns Start of the column section.
+ * @param costs Start of the cost section.
+ * @return 0 on success, -1 if the block is inconsistent or a cost does not fit in an int.
+ */
+static int fill_routes(
+        SparseTransportProblem *sp,
+        const ProblemFileHeader *header,
+        const char *rows,
+        const char *columns,
+        const char *costs
+) {
+    const uint64_t *row_start = (const uint64_t *)(const void *)rows;
+    const uint32_t *column = (const uint32_t *)(const void *)columns;
+    uint64_t e;
+    int64_t c;
+    int i;
+
+    if (row_start[0] != 0 || row_start[sp->supply_size] != header->entries) return -1;
+    for (i = 0; i < sp->supply_size; i++) {
+        if (row_start[i] > row_start[i + 1]) return -1;
+        sp->route_start[i] = (size_t)row_start[i];
+        for (e = row_start[i]; e < row_start[i + 1]; e++) {
+            c = cost_entry(costs, header->cost_width, e);
+            if (column[e] >= (uint32_t)sp->demand_size || c < INT_MIN || c > INT_MAX) return -1;
+            if (e > row_start[i] && column[e] <= column[e - 1]) return -1;
+            sp->route_col[e] = (int)column[e];
+            sp->route_cost[e] = (int)c;
+        }
+    }
+    sp->route_start[sp->supply_size] = (size_t)header->entries;
+    return 0;
+}
+
+/**
+ * Builds a sparse problem from the contents of a binary problem file with
+ * the routes layout.
+ *
+ * @param path Path of the file, for error messages.
+ * @param data File contents.
+ * @param length Number of bytes.
+ * @param sp Pointer to the SparseTransportProblem structure to fill; initialised here.
+ * @return 0 on success, -1 on error (reported on stderr, sp left empty).
+ */
+int parse_route_problem_binary(
+        const char *path,
+        const char *data,
+        size_t length,
+        SparseTransportProblem *sp
+) {
+    ProblemSections sections;
+    const ProblemFileHeader *header = &sections.header;
+
+    if (locate_sections(path, data, length, &sections) != 0) {
+        return -1;
+    }
+    if (header->layout != PROBLEM_ROUTES) {
+        fprintf(stderr, "%s: not a problem with forbidden routes.\n", path);
+        return -1;
+    }
+
+    init_sparse_problem(sp, (int)header->supply_size, (int)header->demand_size,
+                        (size_t)header->entries);
+    if (read_vector(data + sections.supply, sp->supply, header->supply_size,
+                    "supply vector", path) != 0 ||
+            read_vector(data + sections.demand, sp->demand, header->demand_size,
+                        "demand vector", path) != 0) {
+        free_sparse_problem(sp);
+        return -1;
+    }
+    if (fill_routes(sp, header, data + sections.rows, data + sections.columns,
+                    data + sections.costs) != 0) {
+        fprintf(stderr, "%s: invalid route block or a cost that does not fit in an int.\n", path);
+        free_sparse_problem(sp);
+        return -1;
+    }
+    build_sparse_columns(sp);
+    return 0;
+}
+
+/**
+ * Writes zero bytes up to the next section boundary.
+ *
+ * @param out Destination stream.
+ * @param offset Current offset, advanced to the boundary.
+ */
+static void pad_section(
+        FILE *out,
+        uint64_t *offset
+) {
+    static const char zeros[8] = {0};
+    uint64_t aligned = SECTION_ALIGN(*offset);
+
+    fwrite(zeros, 1, (size_t)(aligned - *offset), out);
+    *offset = aligned;
+}
+
+/**
+ * Writes a vector as an int64 section.
+ *
+ * @param out Destination stream.
+ * @param values Vector.
+ * @param count Number of values.
+ * @param offset Current offset, advanced past the section and its padding.
+ */
+static void write_vector(
+        FILE *out,
+        const int *values,
+        int count,
+        uint64_t *offset
+) {
+    int64_t v;
+    int k;
+
+    for (k = 0; k < count; k++) {
+        v = values[k];
+        fwrite(&v, 8, 1, out);
+    }
+    *offset += (uint64_t)count * 8;
+    pad_section(out, offset);
+}
+
+/**
+ * Writes one cost at the chosen width.
+ *
+ * @param out Destination stream.
+ * @param cost Cost, already checked to fit.
+ * @param width Bytes per cost.
+ */
+static void write_cost(
+        FILE *out,
+        int cost,
+        int width
+) {
+    int16_t c16 = (int16_t)cost;
+    int32_t c32 = (int32_t)cost;
+    int64_t c64 = cost;
+
+    switch (width) {
+        case 2:
+            fwrite(&c16, 2, 1, out);
+            break;
+        case 4:
+            fwrite(&c32, 4, 1, out);
+            break;
+        default:
+            fwrite(&c64, 8, 1, out);
+            break;
+    }
+}
+
+/**
+ * Saves a problem as a binary problem file.
+ *
+ * @param path Path of the file to write.
+ * @param tp Pointer to the TransportationProblem structure.
+ * @param cost_width Bytes per cost: 2, 4 or 8.
+ * @param sparse TRUE to store only the cells whose cost differs from default_cost.
+ * @param default_cost Cost of the cells a sparse file leaves out.
+ * @return 0 on success, -1 on error (reported on stderr).
+ */
+int save_problem_binary(
+        const char *path,
+        const TransportProblem *tp,
+        int cost_width,
+        Boolean sparse,
+        int default_cost
+) {
+    size_t cells = (size_t)tp->supply_size * tp->demand_size;
+    ProblemFileHeader header;
+    uint64_t offset, entries = 0;
+    uint32_t j32;
+    size_t k;
+    int i, j;
+
+    if (cost_width != 2 && cost_width != 4 && cost_width != 8) {
+        fprintf(stderr, "Cost width must be 2, 4 or 8 bytes.\n");
+        return -1;
+    }
+    if (!tp->cost) {
+        fprintf(stderr, "A problem with implicit costs has no cost matrix to save.\n");
+        return -1;
+    }
+    if (tp->cost_rows != tp->supply_size || tp->cost_columns != tp->demand_size) {
+        fprintf(stderr, "A balanced problem's dummy point has no stored costs; save it before balancing.\n");
+        return -1;
+    }
+    for (k = 0; k < cells; k++) {
+        if (cost_width == 2 && (tp->cost[k] < INT16_MIN || tp->cost[k] > INT16_MAX)) {
+            fprintf(stderr, "Cost %d of cell %zu does not fit in 16 bits.\n", tp->cost[k], k);
+            return -1;
+        }
+        if (!sparse || tp->cost[k] != default_cost) entries++;
+    }
+
+    FILE *out = fopen(path, "wb");
+    if (!out) {
+        perror(path);
+        return -1;
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PROBLEM_MAGIC, 8);
+    header.version = PROBLEM_FORMAT_VERSION;
+    header.byte_order = PROBLEM_BYTE_ORDER;
+    header.cost_width = (uint32_t)cost_width;
+    header.layout = sparse ? PROBLEM_SPARSE : PROBLEM_DENSE;
+    header.supply_size = tp->supply_size;
+    header.demand_size = tp->demand_size;
+    header.entries = entries;
+    header.default_cost = sparse ? default_cost : 0;
+    fwrite(&header, sizeof(header), 1, out);
+    offset = sizeof(header);
+
+    write_vector(out, tp->supply, tp->supply_size, &offset);
+    write_vector(out, tp->demand, tp->demand_size, &offset);
+
+    if (sparse) {
+        // Row starts, then the columns and the costs of the stored cells
+        entries = 0;
+        fwrite(&entries, 8, 1, out);
+        for (i = 0; i < tp->supply_size; i++) {
+            for (j = 0; j < tp->demand_size; j++) {
+                if (COST_AT(tp, i, j) != default_cost) entries++;
+            }
+            fwrite(&entries, 8, 1, out);
+        }
+        offset += ((uint64_t)tp->supply_size + 1) * 8;
+        for (i = 0; i < tp->supply_size; i++) {
+            for (j = 0; j < tp->demand_size; j++) {
+                if (COST_AT(tp, i, j) == default_cost) continue;
+                j32 = (uint32_t)j;
+                fwrite(&j32, 4, 1, out);
+            }
+        }
+        offset += entries * 4;
+        pad_section(out, &offset);
+    }
+    for (k = 0; k < cells; k++) {
+        if (sparse && tp->cost[k] == default_cost) continue;
+        write_cost(out, tp->cost[k], cost_width);
+    }
+
+    if (ferror(out) | fclose(out)) {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Saves a sparse problem as a binary problem file with the routes layout.
+ *
+ * @param path Path of the file to write.
+ * @param sp Pointer to the SparseTransportProblem structure.
+ * @param cost_width Bytes per cost: 2, 4 or 8.
+ * @return 0 on success, -1 on error (reported on stderr).
+ */
+int save_sparse_problem_binary(
+        const char *path,
+        const SparseTransportProblem *sp,
+        int cost_width
+) {
+    ProblemFileHeader header;
+    uint64_t offset, start;
+    uint32_t j32;
+    size_t e;
+    int i;
+
+    if (cost_width != 2 && cost_width != 4 && cost_width != 8) {
+        fprintf(stderr, "Cost width must be 2, 4 or 8 bytes.\n");
+        return -1;
+    }
+    for (e = 0; e < sp->route_count; e++) {
+        if (cost_width == 2 && (sp->route_cost[e] < INT16_MIN || sp->route_cost[e] > INT16_MAX)) {
+            fprintf(stderr, "Cost %d of route (%d, %d) does not fit in 16 bits.\n",
+                    sp->route_cost[e], sp->route_row[e], sp->route_col[e]);
+            return -1;
+        }
+    }
+
+    FILE *out = fopen(path, "wb");
+    if (!out) {
+        perror(path);
+        return -1;
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PROBLEM_MAGIC, 8);
+    header.version = PROBLEM_FORMAT_VERSION;
+    header.byte_order = PROBLEM_BYTE_ORDER;
+    header.cost_width = (uint32_t)cost_width;
+    header.layout = PROBLEM_ROUTES;
+    header.supply_size = sp->supply_size;
+    header.demand_size = sp->demand_size;
+    header.entries = sp->route_count;
+    fwrite(&header, sizeof(header), 1, out);
+    offset = sizeof(header);
+
+    write_vector(out, sp->supply, sp->supply_size, &offset);
+    write_vector(out, sp->demand, sp->demand_size, &offset);
+
+    for (i = 0; i <= sp->supply_size; i++) {
+        start = sp->route_start[i];
+        fwrite(&start, 8, 1, out);
+    }
+    offset += ((uint64_t)sp->supply_size + 1) * 8;
+    for (e = 0; e < sp->route_count; e++) {
+        j32 = (uint32_t)sp->route_col[e];
+        fwrite(&j32, 4, 1, out);
+    }
+    offset += (uint64_t)sp->route_count * 4;
+    pad_section(out, &offset);
+    for (e = 0; e < sp->route_count; e++) {
+        write_cost(out, sp->route_cost[e], cost_width);
+    }
+
+    if (ferror(out) | fclose(out)) {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
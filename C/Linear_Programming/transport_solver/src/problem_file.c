@@ -0,0 +1,949 @@
+#ifndef TP_TEMPLATE
+#define _POSIX_C_SOURCE 200809L  // mmap, posix_madvise
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "transport.h"
+#include "sparse_problem.h"
+#include "cost_function.h"
+#include "text_scanner.h"
+
+#define READ_BLOCK_SIZE (1 << 20) // Read size when the input cannot be mapped
+
+/*
+ * Plain-text problem files, as read by the batch mode:
+ *
+ *     # optional comment lines
+ *     <supply points> <demand points>
+ *     <supply vector>
+ *     <demand vector>
+ *     <cost matrix, one row per line>
+ *
+ * A problem with forbidden routes lists its allowed routes instead of a
+ * cost matrix; it is told apart by a third value on the size line:
+ *
+ *     <supply points> <demand points> <routes>
+ *     <supply vector>
+ *     <demand vector>
+ *     <supply point> <demand point> <cost>, one line per route (0-based)
+ *
+ * A problem with implicit costs gives the points' locations instead of a
+ * cost matrix, headed by the distance metric and the cost per unit of
+ * distance (see cost_function.h):
+ *
+ *     <supply points> <demand points>
+ *     <supply vector>
+ *     <demand vector>
+ *     euclidean|manhattan|haversine <rate>
+ *     <x> <y> [rate factor], one line per supply point
+ *     <x> <y> [rate factor], one line per demand point
+ *
+ * Values may be separated by commas, whitespace or both, so the rows can be
+ * pasted exactly as they are typed at the interactive prompts. The file is
+ * memory-mapped and scanned in place, with the values written straight
+ * into the problem's buffers; errors name the line and column of the field.
+ */
+
+/**
+ * Maps a whole file into memory. Regular files are mapped privately;
+ * anything else (a pipe, or standard input given as "-") is read in large
+ * blocks into a heap buffer.
+ *
+ * @param path Path of the file, or "-" for standard input.
+ * @param length Receives the number of bytes.
+ * @param mapped Receives TRUE if the buffer must be released with munmap().
+ * @return The file contents, or NULL on error (reported on stderr).
+ */
+static char *map_problem_file(
+        const char *path,
+        size_t *length,
+        Boolean *mapped
+) {
+    int fd = (strcmp(path, "-") == 0) ? STDIN_FILENO : open(path, O_RDONLY);
+    struct stat st;
+    char *text = NULL, *grown;
+    size_t size = 0, capacity = 0;
+    ssize_t got;
+
+    *mapped = FALSE;
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        // Private and writable, so a binary cost block can be used in place
+        text = (char *)mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (text != MAP_FAILED) {
+            posix_madvise(text, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+            if (fd != STDIN_FILENO) close(fd);
+            *mapped = TRUE;
+            *length = (size_t)st.st_size;
+            return text;
+        }
+        text = NULL;
+    }
+
+    do {
+        if (capacity - size < READ_BLOCK_SIZE) {
+            capacity = capacity ? capacity * 2 : 4 * READ_BLOCK_SIZE;
+            grown = (char *)realloc(text, capacity);
+            if (!grown) {
+                fprintf(stderr, "Memory allocation failed.\n");
+                exit(EXIT_FAILURE);
+            }
+            text = grown;
+        }
+        got = read(fd, text + size, capacity - size);
+        if (got > 0) size += (size_t)got;
+    } while (got > 0 || (got < 0 && errno == EINTR));
+
+    if (got < 0) {
+        perror(path);
+        free(text);
+        text = NULL;
+    }
+    if (fd != STDIN_FILENO) close(fd);
+    *length = size;
+    return text;
+}
+
+/**
+ * Reads count integers into values, reporting the first bad or missing one
+ * with its line and column.
+ *
+ * @param scanner Pointer to the scanner over the file.
+ * @param values Destination buffer.
+ * @param count Number of integers to read.
+ * @param non_negative Boolean flag to reject negative values (quantities).
+ * @param what Name of the section, for the error message.
+ * @param path Path of the file, for the error message.
+ * @return 0 on success, -1 on error.
+ */
+static int scan_values(
+        TextScanner *scanner,
+        int *values,
+        size_t count,
+        Boolean non_negative,
+        const char *what,
+        const char *path
+) {
+    size_t k;
+    ScanStatus status;
+
+    for (k = 0; k < count; k++) {
+        status = scan_int(scanner, &values[k]);
+        if (status == SCAN_OK && (!non_negative || values[k] >= 0)) continue;
+
+        if (status == SCAN_END) {
+            fprintf(stderr, "%s:%zu:%zu: file ends after %zu of the %zu values of the %s.\n",
+                    path, scanner->field_line, scanner->field_column, k, count, what);
+        } else {
+            fprintf(stderr, "%s:%zu:%zu: %s '%.*s' as value %zu of the %s.\n",
+                    path, scanner->field_line, scanner->field_column,
+                    (status == SCAN_OK) ? "negative quantity" :
+                    (status == SCAN_RANGE) ? "out-of-range integer" : "malformed integer",
+                    (int)scan_field_length(scanner), scanner->field, k + 1, what);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Reads count integers into values as scan_values() does.
+ *
+ * @param scanner Pointer to the scanner over the file.
+ * @param values Destination buffer.
+ * @param count Number of integers to read.
+ * @param what Name of the section, for the error message.
+ * @param path Path of the file, for the error message.
+ * @return 0 on success, -1 on error.
+ */
+static int read_values(
+        TextScanner *scanner,
+        int *values,
+        size_t count,
+        const char *what,
+        const char *path
+) {
+    return scan_values(scanner, values, count, FALSE, what, path);
+}
+
+/**
+ * Reads count supplies or demands into values as scan_values() does; a
+ * negative quantity is an error.
+ *
+ * @param scanner Pointer to the scanner over the file.
+ * @param values Destination buffer.
+ * @param count Number of quantities to read.
+ * @param what Name of the section, for the error message.
+ * @param path Path of the file, for the error message.
+ * @return 0 on success, -1 on error.
+ */
+static int read_quantities(
+        TextScanner *scanner,
+        int *values,
+        size_t count,
+        const char *what,
+        const char *path
+) {
+    return scan_values(scanner, values, count, TRUE, what, path);
+}
+
+/**
+ * Reports a bad or missing number read with scan_double().
+ *
+ * @param scanner Pointer to the scanner, positioned after the field.
+ * @param status What the scan returned.
+ * @param what What the number is, for the error message.
+ * @param path Path of the file, for the error message.
+ */
+static void report_number(
+        const TextScanner *scanner,
+        ScanStatus status,
+        const char *what,
+        const char *path
+) {
+    if (status == SCAN_END) {
+        fprintf(stderr, "%s:%zu:%zu: file ends before the %s.\n",
+                path, scanner->field_line, scanner->field_column, what);
+    } else {
+        fprintf(stderr, "%s:%zu:%zu: %s '%.*s' as the %s.\n",
+                path, scanner->field_line, scanner->field_column,
+                (status == SCAN_RANGE) ? "out-of-range number" : "malformed number",
+                (int)scan_field_length(scanner), scanner->field, what);
+    }
+}
+
+/**
+ * Reads the locations of count points, one "x y [rate factor]" line each.
+ * The factor is optional per line, so it is only taken when the next field
+ * is on the same line as the coordinates.
+ *
+ * @param scanner Pointer to the scanner over the file.
+ * @param x Receives the x coordinates (longitudes).
+ * @param y Receives the y coordinates (latitudes).
+ * @param factor Receives the rate factors; left as they are where none is given.
+ * @param count Number of points.
+ * @param what Name of the points, for the error message.
+ * @param path Path of the file, for the error message.
+ * @return 0 on success, -1 on error.
+ */
+static int read_points(
+        TextScanner *scanner,
+        double *x,
+        double *y,
+        double *factor,
+        int count,
+        const char *what,
+        const char *path
+) {
+    TextScanner next;
+    ScanStatus status;
+    char name[64];
+    size_t line;
+    double value;
+    int k;
+
+    for (k = 0; k < count; k++) {
+        snprintf(name, sizeof(name), "x coordinate of %s %d", what, k + 1);
+        status = scan_double(scanner, &x[k]);
+        if (status != SCAN_OK) {
+            report_number(scanner, status, name, path);
+            return -1;
+        }
+        line = scanner->field_line;
+        name[0] = 'y';
+        status = scan_double(scanner, &y[k]);
+        if (status == SCAN_OK && scanner->field_line != line) {
+            fprintf(stderr, "%s:%zu: line ends before the %s.\n", path, line, name);
+            return -1;
+        }
+        if (status != SCAN_OK) {
+            report_number(scanner, status, name, path);
+            return -1;
+        }
+
+        next = *scanner;
+        status = scan_double(&next, &value);
+        if (status != SCAN_END && next.field_line == line) {
+            if (status != SCAN_OK) {
+                snprintf(name, sizeof(name), "rate factor of %s %d", what, k + 1);
+                report_number(&next, status, name, path);
+                return -1;
+            }
+            factor[k] = value;
+            *scanner = next;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Tells whether the next field is a word rather than a number. The scanner
+ * is copied, so nothing is consumed.
+ *
+ * @param scanner Pointer to the scanner.
+ * @return TRUE if the next field starts with a letter.
+ */
+static Boolean is_word_next(
+        const TextScanner *scanner
+) {
+    TextScanner peek = *scanner;
+    double value;
+    char c;
+
+    if (scan_double(&peek, &value) != SCAN_MALFORMED) {
+        return FALSE;
+    }
+    c = (char)(*peek.field | 0x20);
+    return (c >= 'a' && c <= 'z') ? TRUE : FALSE;
+}
+
+/**
+ * Tells whether a problem's costs are implicit: after the supply and
+ * demand vectors the next field is a word (the metric) rather than a cost.
+ * The scanner is copied, so nothing is consumed; bad vectors are left for
+ * the caller to report.
+ *
+ * @param scanner Scanner positioned after the size line.
+ * @param supply_size Number of supply points.
+ * @param demand_size Number of demand points.
+ * @param costs Receives a scanner positioned at the metric.
+ * @return TRUE if a metric line follows the vectors.
+ */
+static Boolean has_cost_function(
+        const TextScanner *scanner,
+        int supply_size,
+        int demand_size,
+        TextScanner *costs
+) {
+    TextScanner peek = *scanner;
+    size_t k, count = (size_t)supply_size + demand_size;
+    int value;
+
+    for (k = 0; k < count; k++) {
+        if (scan_int(&peek, &value) != SCAN_OK) {
+            return FALSE;
+        }
+    }
+    *costs = peek;
+    return is_word_next(&peek);
+}
+
+/**
+ * Reads the metric line and the point locations of a problem with
+ * implicit costs, then its vectors.
+ *
+ * @param path Path of the file, for error messages.
+ * @param scanner Scanner positioned at the supply vector.
+ * @param costs Scanner positioned at the metric line; left after the demand points.
+ * @param supply_size Number of supply points.
+ * @param demand_size Number of demand points.
+ * @param tp Pointer to the TransportationProblem structure to fill; initialised here.
+ * @return 0 on success, -1 on error (reported on stderr, tp left empty).
+ */
+static int parse_implicit_costs(
+        const char *path,
+        TextScanner *scanner,
+        TextScanner *costs,
+        int supply_size,
+        int demand_size,
+        TransportProblem *tp
+) {
+    CostFunction *cf;
+    CostMetric metric;
+    ScanStatus status;
+    double rate;
+    int value;
+
+    scan_int(costs, &value);  // The metric name, known not to be a number
+    if (!parse_cost_metric(costs->field, scan_field_length(costs), &metric)) {
+        fprintf(stderr, "%s:%zu:%zu: unknown metric '%.*s'; use euclidean, manhattan "
+                "or haversine.\n", path, costs->field_line, costs->field_column,
+                (int)scan_field_length(costs), costs->field);
+        return -1;
+    }
+    status = scan_double(costs, &rate);
+    if (status != SCAN_OK) {
+        report_number(costs, status, "cost per unit of distance", path);
+        return -1;
+    }
+
+    cf = init_cost_function(metric, supply_size, demand_size, rate);
+    if (read_points(costs, cf->supply_x, cf->supply_y, cf->supply_rate, supply_size,
+                    "supply point", path) != 0 ||
+            read_points(costs, cf->demand_x, cf->demand_y, cf->demand_rate, demand_size,
+                        "demand point", path) != 0) {
+        free_cost_function(cf);
+        return -1;
+    }
+    prepare_cost_function(cf);
+
+    init_implicit_transport_problem(tp, supply_size, demand_size, cf);
+    if (read_quantities(scanner, tp->supply, supply_size, "supply vector", path) != 0 ||
+            read_quantities(scanner, tp->demand, demand_size, "demand vector", path) != 0) {
+        free_transport_problem(tp);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Reads one dense problem, with a cost matrix or point locations, and
+ * leaves the scanner after its last value.
+ *
+ * @param path Path of the file, for error messages.
+ * @param scanner Scanner positioned at the size line.
+ * @param tp Pointer to the TransportationProblem structure to fill; initialised here.
+ * @param last Receives the name of the problem's last section, for a
+ *             message about data after it.
+ * @return 0 on success, -1 on error (reported on stderr, tp left empty).
+ */
+static int parse_problem(
+        const char *path,
+        TextScanner *scanner,
+        TransportProblem *tp,
+        const char **last
+) {
+    int sizes[2];
+    TextScanner costs;
+
+    if (read_values(scanner, sizes, 2, "problem size", path) != 0) {
+        return -1;
+    }
+    if (sizes[0] <= 0 || sizes[1] <= 0) {
+        fprintf(stderr, "%s: the numbers of supply and demand points must be positive.\n", path);
+        return -1;
+    }
+    if (has_cost_function(scanner, sizes[0], sizes[1], &costs)) {
+        if (parse_implicit_costs(path, scanner, &costs, sizes[0], sizes[1], tp) != 0) {
+            return -1;
+        }
+        *scanner = costs;
+        *last = "demand points";
+        return 0;
+    }
+
+    // Values go straight into the problem's vectors and cost buffer
+    init_transport_problem(tp, sizes[0], sizes[1]);
+    if (read_quantities(scanner, tp->supply, sizes[0], "supply vector", path) != 0 ||
+            read_quantities(scanner, tp->demand, sizes[1], "demand vector", path) != 0 ||
+            read_values(scanner, tp->cost, (size_t)sizes[0] * sizes[1], "cost matrix", path) != 0) {
+        free_transport_problem(tp);
+        return -1;
+    }
+    *last = "cost matrix";
+    return 0;
+}
+
+/**
+ * Builds a problem from the contents of a plain-text problem file.
+ *
+ * @param path Path of the file, for error messages.
+ * @param text File contents.
+ * @param length Number of bytes.
+ * @param tp Pointer to the TransportationProblem structure to fill; initialised here.
+ * @return 0 on success, -1 on error (reported on stderr, tp left empty).
+ */
+static int parse_problem_text(
+        const char *path,
+        const char *text,
+        size_t length,
+        TransportProblem *tp
+) {
+    TextScanner scanner;
+    const char *last;
+    int value;
+
+    init_text_scanner(&scanner, text, length);
+
+    if (parse_problem(path, &scanner, tp, &last) != 0) {
+        return -1;
+    }
+    if (scan_int(&scanner, &value) != SCAN_END) {
+        fprintf(stderr, "%s:%zu:%zu: unexpected data after the %s.\n",
+                path, scanner.field_line, scanner.field_column, last);
+        free_transport_problem(tp);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Tells whether the problem a scanner is positioned at lists routes: its
+ * size line then holds exactly three values. The scanner is copied, so
+ * nothing is consumed.
+ *
+ * @param at Scanner positioned at the size line.
+ * @return TRUE for a route problem.
+ */
+static Boolean is_route_problem_next(
+        const TextScanner *at
+) {
+    TextScanner scanner = *at;
+    size_t line;
+    int value, k;
+
+    if (scan_int(&scanner, &value) != SCAN_OK) {
+        return FALSE;
+    }
+    line = scanner.field_line;
+    for (k = 0; k < 3; k++) {
+        if (scan_int(&scanner, &value) != SCAN_OK || scanner.field_line != line) {
+            return (k == 2) ? TRUE : FALSE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * Tells whether a plain-text problem file lists routes.
+ *
+ * @param text File contents.
+ * @param length Number of bytes.
+ * @return TRUE for a route file.
+ */
+static Boolean is_route_problem_text(
+        const char *text,
+        size_t length
+) {
+    TextScanner scanner;
+
+    init_text_scanner(&scanner, text, length);
+    return is_route_problem_next(&scanner);
+}
+
+/**
+ * Builds a sparse problem from the contents of a plain-text route file.
+ *
+ * @param path Path of the file, for error messages.
+ * @param text File contents.
+ * @param length Number of bytes.
+ * @param sp Pointer to the SparseTransportProblem structure to fill; initialised here.
+ * @return 0 on success, -1 on error (reported on stderr, sp left empty).
+ */
+static int parse_route_problem_text(
+        const char *path,
+        const char *text,
+        size_t length,
+        SparseTransportProblem *sp
+) {
+    int sizes[3];
+    int *supply = NULL, *demand = NULL, *triples = NULL;
+    TextScanner scanner;
+    int status = -1;
+
+    init_text_scanner(&scanner, text, length);
+
+    if (read_values(&scanner, sizes, 3, "problem size", path) != 0) {
+        return -1;
+    }
+    if (sizes[0] <= 0 || sizes[1] <= 0 || sizes[2] < 0) {
+        fprintf(stderr, "%s: the numbers of supply and demand points must be positive "
+                "and the number of routes non-negative.\n", path);
+        return -1;
+    }
+
+    supply = (int *)malloc(sizes[0] * sizeof(int));
+    demand = (int *)malloc(sizes[1] * sizeof(int));
+    triples = (int *)malloc(((size_t)sizes[2] * 3 + 1) * sizeof(int));
+    if (!supply || !demand || !triples) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (read_quantities(&scanner, supply, sizes[0], "supply vector", path) == 0 &&
+            read_quantities(&scanner, demand, sizes[1], "demand vector", path) == 0 &&
+            read_values(&scanner, triples, (size_t)sizes[2] * 3, "route list", path) == 0) {
+        if (scan_int(&scanner, &sizes[2]) != SCAN_END) {
+            fprintf(stderr, "%s:%zu:%zu: unexpected data after the route list.\n",
+                    path, scanner.field_line, scanner.field_column);
+        } else if (sparse_problem_from_triples(sp, sizes[0], sizes[1], (size_t)sizes[2],
+                                               triples) == 0) {
+            memcpy(sp->supply, supply, sizes[0] * sizeof(int));
+            memcpy(sp->demand, demand, sizes[1] * sizeof(int));
+            status = 0;
+        }
+    }
+
+    free(supply);
+    free(demand);
+    free(triples);
+    return status;
+}
+
+/**
+ * Loads a dense problem or, if sp is given, a problem with forbidden routes.
+ *
+ * @param path Path of the file, or "-" for standard input.
+ * @param tp Pointer to the TransportationProblem structure for a dense problem.
+ * @param sp Pointer to the SparseTransportProblem structure for a route problem, or NULL.
+ * @return 0 for a dense problem, 1 for a route problem, -1 on error.
+ */
+static int load_file(
+        const char *path,
+        TransportProblem *tp,
+        SparseTransportProblem *sp
+) {
+    size_t length;
+    Boolean mapped;
+    Boolean routes;
+    int status;
+    char *text = map_problem_file(path, &length, &mapped);
+
+    if (!text) {
+        return -1;
+    }
+    routes = is_problem_binary(text, length) ? is_route_problem_binary(text, length)
+                                              : is_route_problem_text(text, length);
+    if (routes && !sp) {
+        fprintf(stderr, "%s: the problem has forbidden routes and needs a sparse solver.\n", path);
+        status = -1;
+    } else if (routes) {
+        status = is_problem_binary(text, length) ?
+                 parse_route_problem_binary(path, text, length, sp) :
+                 parse_route_problem_text(path, text, length, sp);
+        if (status == 0) {
+            status = 1;
+        }
+    } else if (is_problem_binary(text, length)) {
+        status = parse_problem_binary(path, text, length, mapped, tp);
+        if (status == 1) {
+            return 0;  // The problem now owns the mapping
+        }
+    } else {
+        status = parse_problem_text(path, text, length, tp);
+    }
+
+    if (mapped) {
+        munmap(text, length);
+    } else {
+        free(text);
+    }
+    return status;
+}
+
+/**
+ * Loads a problem from a problem file, plain-text or binary (see
+ * problem_binary.c); the two are told apart by the binary magic number.
+ *
+ * @param path Path of the file, or "-" for standard input.
+ * @param tp Pointer to the TransportationProblem structure to fill; initialised here.
+ * @return 0 on success, -1 on error (reported on stderr, tp left empty).
+ */
+int load_problem_file(
+        const char *path,
+        TransportProblem *tp
+) {
+    return load_file(path, tp, NULL);
+}
+
+/**
+ * Loads a problem file that may hold either a dense problem or a problem
+ * with forbidden routes; only the structure for the kind found is filled.
+ *
+ * @param path Path of the file, or "-" for standard input.
+ * @param tp Pointer to the TransportationProblem structure for a dense problem.
+ * @param sp Pointer to the SparseTransportProblem structure for a route problem.
+ * @return 0 for a dense problem, 1 for a route problem, -1 on error (reported on stderr).
+ */
+int load_any_problem_file(
+        const char *path,
+        TransportProblem *tp,
+        SparseTransportProblem *sp
+) {
+    return load_file(path, tp, sp);
+}
+
+/*
+ * A problem stream is a plain-text file holding any number of dense
+ * problems one after the other, each laid out as a problem file of its own
+ * (comments included), read a problem at a time. Like a problem file it is
+ * mapped, or read whole from a pipe.
+ */
+struct ProblemStream {
+    const char *path;
+    char *text;
+    size_t length;
+    Boolean mapped;     // TRUE if text must be released with munmap()
+    TextScanner scanner;
+};
+
+/**
+ * Opens a problem stream.
+ *
+ * @param path Path of the file, or "-" for standard input.
+ * @return The stream, or NULL on error (reported on stderr).
+ */
+ProblemStream *open_problem_stream(
+        const char *path
+) {
+    ProblemStream *stream = (ProblemStream *)malloc(sizeof(ProblemStream));
+
+    if (!stream) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    stream->path = path;
+    stream->text = map_problem_file(path, &stream->length, &stream->mapped);
+    if (!stream->text) {
+        free(stream);
+        return NULL;
+    }
+    if (is_problem_binary(stream->text, stream->length)) {
+        fprintf(stderr, "%s: a problem stream must be plain text.\n", path);
+        close_problem_stream(stream);
+        return NULL;
+    }
+    init_text_scanner(&stream->scanner, stream->text, stream->length);
+    return stream;
+}
+
+/**
+ * Reads the next problem of a stream.
+ *
+ * @param stream Stream from open_problem_stream().
+ * @param tp Pointer to the TransportationProblem structure to fill; initialised here.
+ * @return 1 if a problem was read, 0 at the end of the stream, -1 on error
+ *         (reported on stderr, tp left empty).
+ */
+int read_stream_problem(
+        ProblemStream *stream,
+        TransportProblem *tp
+) {
+    TextScanner peek = stream->scanner;
+    const char *last;
+    int value;
+
+    if (scan_int(&peek, &value) == SCAN_END) {
+        return 0;
+    }
+    if (is_route_problem_next(&stream->scanner)) {
+        fprintf(stderr, "%s:%zu:%zu: a problem with forbidden routes cannot be read from a "
+                "stream.\n", stream->path, peek.field_line, peek.field_column);
+        return -1;
+    }
+    return (parse_problem(stream->path, &stream->scanner, tp, &last) == 0) ? 1 : -1;
+}
+
+/**
+ * Closes a problem stream. Problems read from it stay valid.
+ *
+ * @param stream Stream from open_problem_stream().
+ */
+void close_problem_stream(
+        ProblemStream *stream
+) {
+    if (stream->mapped) {
+        munmap(stream->text, stream->length);
+    } else {
+        free(stream->text);
+    }
+    free(stream);
+}
+
+// Plain-text problem files in the wide precisions
+#define TP_TEMPLATE "problem_file.c"
+#define TP_WIDE_ONLY
+#include "precision_template.h"
+
+#else // Template body
+
+#define scan_wide_values TP_NAME(scan_wide_values)
+#define read_wide_values TP_NAME(read_wide_values)
+#define read_wide_quantities TP_NAME(read_wide_quantities)
+#define parse_wide_problem_text TP_NAME(parse_wide_problem_text)
+
+/**
+ * Reads count values of the precision into values, reporting the first bad
+ * or missing one as scan_values() does.
+ *
+ * @param scanner Pointer to the scanner over the file.
+ * @param values Destination buffer.
+ * @param count Number of values to read.
+ * @param non_negative Boolean flag to reject negative values (quantities).
+ * @param what Name of the section, for the error message.
+ * @param path Path of the file, for the error message.
+ * @return 0 on success, -1 on error.
+ */
+static int scan_wide_values(
+        TextScanner *scanner,
+        TP_VALUE *values,
+        size_t count,
+        Boolean non_negative,
+        const char *what,
+        const char *path
+) {
+    size_t k;
+    ScanStatus status;
+
+    for (k = 0; k < count; k++) {
+#if TP_FLOATING
+        status = scan_double(scanner, &values[k]);
+#else
+        status = scan_int64(scanner, &values[k]);
+#endif
+        if (status == SCAN_OK && (!non_negative || values[k] >= 0)) continue;
+
+        if (status == SCAN_END) {
+            fprintf(stderr, "%s:%zu:%zu: file ends after %zu of the %zu values of the %s.\n",
+                    path, scanner->field_line, scanner->field_column, k, count, what);
+        } else if (status == SCAN_OK) {
+            fprintf(stderr, "%s:%zu:%zu: negative quantity '%.*s' as value %zu of the %s.\n",
+                    path, scanner->field_line, scanner->field_column,
+                    (int)scan_field_length(scanner), scanner->field, k + 1, what);
+        } else {
+            fprintf(stderr, "%s:%zu:%zu: %s %s '%.*s' as value %zu of the %s.\n",
+                    path, scanner->field_line, scanner->field_column,
+                    (status == SCAN_RANGE) ? "out-of-range" : "malformed",
+                    TP_FLOATING ? "number" : "integer",
+                    (int)scan_field_length(scanner), scanner->field, k + 1, what);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Reads count values of the precision into values as scan_wide_values() does.
+ *
+ * @param scanner Pointer to the scanner over the file.
+ * @param values Destination buffer.
+ * @param count Number of values to read.
+ * @param what Name of the section, for the error message.
+ * @param path Path of the file, for the error message.
+ * @return 0 on success, -1 on error.
+ */
+static int read_wide_values(
+        TextScanner *scanner,
+        TP_VALUE *values,
+        size_t count,
+        const char *what,
+        const char *path
+) {
+    return scan_wide_values(scanner, values, count, FALSE, what, path);
+}
+
+/**
+ * Reads count supplies or demands of the precision into values as
+ * scan_wide_values() does; a negative quantity is an error.
+ *
+ * @param scanner Pointer to the scanner over the file.
+ * @param values Destination buffer.
+ * @param count Number of quantities to read.
+ * @param what Name of the section, for the error message.
+ * @param path Path of the file, for the error message.
+ * @return 0 on success, -1 on error.
+ */
+static int read_wide_quantities(
+        TextScanner *scanner,
+        TP_VALUE *values,
+        size_t count,
+        const char *what,
+        const char *path
+) {
+    return scan_wide_values(scanner, values, count, TRUE, what, path);
+}
+
+/**
+ * Builds a problem from the contents of a plain-text problem file with a
+ * cost matrix.
+ *
+ * @param path Path of the file, for error messages.
+ * @param text File contents.
+ * @param length Number of bytes.
+ * @param tp Pointer to the problem structure to fill; initialised here.
+ * @return 0 on success, -1 on error (reported on stderr, tp left empty).
+ */
+static int parse_wide_problem_text(
+        const char *path,
+        const char *text,
+        size_t length,
+        TP_PROBLEM *tp
+) {
+    int sizes[2];
+    TextScanner scanner;
+
+    init_text_scanner(&scanner, text, length);
+
+    if (read_values(&scanner, sizes, 2, "problem size", path) != 0) {
+        return -1;
+    }
+    if (sizes[0] <= 0 || sizes[1] <= 0) {
+        fprintf(stderr, "%s: the numbers of supply and demand points must be positive.\n", path);
+        return -1;
+    }
+
+    TP_NAME(init_transport_problem)(tp, sizes[0], sizes[1]);
+    if (read_wide_quantities(&scanner, tp->supply, sizes[0], "supply vector", path) != 0 ||
+            read_wide_quantities(&scanner, tp->demand, sizes[1], "demand vector", path) != 0) {
+        TP_NAME(free_transport_problem)(tp);
+        return -1;
+    }
+    if (is_word_next(&scanner)) {
+        fprintf(stderr, "%s: costs computed from point locations need int32 precision.\n", path);
+        TP_NAME(free_transport_problem)(tp);
+        return -1;
+    }
+    if (read_wide_values(&scanner, tp->cost, (size_t)sizes[0] * sizes[1], "cost matrix", path) != 0) {
+        TP_NAME(free_transport_problem)(tp);
+        return -1;
+    }
+    if (scan_int(&scanner, &sizes[0]) != SCAN_END) {
+        fprintf(stderr, "%s:%zu:%zu: unexpected data after the cost matrix.\n",
+                path, scanner.field_line, scanner.field_column);
+        TP_NAME(free_transport_problem)(tp);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Loads a problem from a plain-text problem file with a cost matrix. Binary
+ * files, route files and point locations hold int32 problems and are
+ * refused with a message.
+ *
+ * @param path Path of the file, or "-" for standard input.
+ * @param tp Pointer to the problem structure to fill; initialised here.
+ * @return 0 on success, -1 on error (reported on stderr, tp left empty).
+ */
+int TP_NAME(load_problem_file)(
+        const char *path,
+        TP_PROBLEM *tp
+) {
+    size_t length;
+    Boolean mapped;
+    int status = -1;
+    char *text = map_problem_file(path, &length, &mapped);
+
+    if (!text) {
+        return -1;
+    }
+    if (is_problem_binary(text, length)) {
+        fprintf(stderr, "%s: binary problem files need int32 precision.\n", path);
+    } else if (is_route_problem_text(text, length)) {
+        fprintf(stderr, "%s: problems with forbidden routes need int32 precision.\n", path);
+    } else {
+        status = parse_wide_problem_text(path, text, length, tp);
+    }
+
+    if (mapped) {
+        munmap(text, length);
+    } else {
+        free(text);
+    }
+    return status;
+}
+
+#undef scan_wide_values
+#undef read_wide_values
+#undef read_wide_quantities
+#undef parse_wide_problem_text
+
+#endif // TP_TEMPLATE
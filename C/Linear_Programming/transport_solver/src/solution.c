@@ -0,0 +1,470 @@
+#ifndef TP_TEMPLATE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "transport.h"
+
+/*
+ * Solutions and the solution writer.
+ *
+ * Methods add the cells they fill to a Solution as they go, so a plan
+ * costs memory and output in the number of cells that carry units rather
+ * than supply points x demand points. write_solution() streams it through
+ * a buffer of its own and formats numbers by hand, so writing a large plan
+ * is one fwrite per buffer instead of one fprintf per value.
+ *
+ * A binary solution file is a fixed 64-byte header followed by three
+ * sections that each start on an 8-byte boundary, in the byte order of the
+ * machine that wrote it:
+ *
+ *     header
+ *     row          int32[count]
+ *     column       int32[count]
+ *     quantity     quantity[count]
+ *
+ * Quantities are int32, int64 or double, as the precision the problem was
+ * solved in; quantity_width and floating tell which.
+ */
+
+#define SOLUTION_MAGIC "TGSOL\0\0\n"
+#define SOLUTION_FORMAT_VERSION 1
+#define SOLUTION_BYTE_ORDER 0x01020304u
+
+typedef struct {
+    char magic[8];           // SOLUTION_MAGIC
+    uint32_t version;        // SOLUTION_FORMAT_VERSION
+    uint32_t byte_order;     // SOLUTION_BYTE_ORDER as stored by the writer
+    uint32_t quantity_width; // Bytes per quantity: 4 or 8
+    uint32_t floating;       // 1 if quantities and the total cost are doubles
+    int64_t supply_size;
+    int64_t demand_size;
+    uint64_t count;          // Cells in each section
+    union {
+        int64_t integer;
+        double floating;
+    } total_cost;
+    uint64_t reserved;
+} SolutionFileHeader;
+
+/** Rounds a byte offset up to the next section boundary. */
+#define SECTION_ALIGN(offset) (((offset) + 7) & ~(uint64_t)7)
+
+/** Bytes the text writer collects before handing them to the stream. */
+#define OUTPUT_BUFFER_SIZE (1 << 16)
+
+/**
+ * Text written to a stream in large blocks.
+ */
+typedef struct {
+    FILE *out;
+    size_t used;
+    char data[OUTPUT_BUFFER_SIZE];
+} OutputBuffer;
+
+/**
+ * Hands the buffered text to the stream.
+ *
+ * @param buffer Pointer to the output buffer.
+ */
+static void flush_output(
+        OutputBuffer *buffer
+) {
+    fwrite(buffer->data, 1, buffer->used, buffer->out);
+    buffer->used = 0;
+}
+
+/**
+ * Appends a string.
+ *
+ * @param buffer Pointer to the output buffer.
+ * @param text String to append.
+ */
+static void put_text(
+        OutputBuffer *buffer,
+        const char *text
+) {
+    size_t length = strlen(text);
+
+    if (buffer->used + length > OUTPUT_BUFFER_SIZE) {
+        flush_output(buffer);
+    }
+    memcpy(buffer->data + buffer->used, text, length);
+    buffer->used += length;
+}
+
+/**
+ * Appends one character.
+ *
+ * @param buffer Pointer to the output buffer.
+ * @param c Character to append.
+ */
+static void put_char(
+        OutputBuffer *buffer,
+        char c
+) {
+    if (buffer->used == OUTPUT_BUFFER_SIZE) {
+        flush_output(buffer);
+    }
+    buffer->data[buffer->used++] = c;
+}
+
+/**
+ * Appends an integer in decimal, as printf's %lld would.
+ *
+ * @param buffer Pointer to the output buffer.
+ * @param value Integer to append.
+ */
+static void put_integer(
+        OutputBuffer *buffer,
+        long long value
+) {
+    char digits[24];
+    int k = sizeof(digits);
+    unsigned long long magnitude = (value < 0) ? 0ULL - (unsigned long long)value
+                                               : (unsigned long long)value;
+
+    do {
+        digits[--k] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        digits[--k] = '-';
+    }
+    if (buffer->used + (sizeof(digits) - k) > OUTPUT_BUFFER_SIZE) {
+        flush_output(buffer);
+    }
+    memcpy(buffer->data + buffer->used, digits + k, sizeof(digits) - k);
+    buffer->used += sizeof(digits) - k;
+}
+
+/**
+ * Writes zero bytes up to the next section boundary.
+ *
+ * @param out Destination stream.
+ * @param offset Current offset, advanced to the boundary.
+ */
+static void pad_section(
+        FILE *out,
+        uint64_t *offset
+) {
+    static const char zeros[8] = {0};
+    uint64_t aligned = SECTION_ALIGN(*offset);
+
+    fwrite(zeros, 1, (size_t)(aligned - *offset), out);
+    *offset = aligned;
+}
+
+/**
+ * Writes an array as one section of a binary solution file.
+ *
+ * @param out Destination stream.
+ * @param values Array to write.
+ * @param size Bytes per element.
+ * @param count Number of elements.
+ * @param offset Current offset, advanced past the section and its padding.
+ */
+static void write_section(
+        FILE *out,
+        const void *values,
+        size_t size,
+        size_t count,
+        uint64_t *offset
+) {
+    if (count > 0) {
+        fwrite(values, size, count, out);
+    }
+    *offset += (uint64_t)size * count;
+    pad_section(out, offset);
+}
+
+// Solutions in every precision
+#define TP_TEMPLATE "solution.c"
+#include "precision_template.h"
+
+#else // Template body
+
+#define put_value TP_NAME(put_value)
+#define write_solution_text TP_NAME(write_solution_text)
+#define write_solution_binary TP_NAME(write_solution_binary)
+
+/**
+ * Initialises an empty solution with room for a basic solution's cells.
+ *
+ * @param solution Pointer to the solution structure.
+ * @param supply_size Number of supply points.
+ * @param demand_size Number of demand points.
+ */
+void TP_NAME(init_solution)(
+        TP_SOLUTION *solution,
+        int supply_size,
+        int demand_size
+) {
+    solution->supply_size = supply_size;
+    solution->demand_size = demand_size;
+    solution->count = 0;
+    solution->capacity = (size_t)supply_size + demand_size;
+    solution->row = (int *)malloc(solution->capacity * sizeof(int));
+    solution->column = (int *)malloc(solution->capacity * sizeof(int));
+    solution->quantity = (TP_VALUE *)malloc(solution->capacity * sizeof(TP_VALUE));
+
+    if (!solution->row || !solution->column || !solution->quantity) {
+        fprintf(stderr, "Memory allocation failed for results.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Frees the memory held by a solution.
+ *
+ * @param solution Pointer to the solution structure.
+ */
+void TP_NAME(free_solution)(
+        TP_SOLUTION *solution
+) {
+    free(solution->row);
+    free(solution->column);
+    free(solution->quantity);
+    solution->row = NULL;
+    solution->column = NULL;
+    solution->quantity = NULL;
+    solution->count = 0;
+    solution->capacity = 0;
+}
+
+/**
+ * Empties a solution, keeping its memory for the next plan.
+ *
+ * @param solution Pointer to the solution structure.
+ */
+void TP_NAME(clear_solution)(
+        TP_SOLUTION *solution
+) {
+    solution->count = 0;
+}
+
+/**
+ * Empties a solution for a plan of another problem, keeping its memory; it
+ * grows as the plan needs.
+ *
+ * @param solution Pointer to the solution structure.
+ * @param supply_size Number of supply points of the next problem.
+ * @param demand_size Number of demand points of the next problem.
+ */
+void TP_NAME(reshape_solution)(
+        TP_SOLUTION *solution,
+        int supply_size,
+        int demand_size
+) {
+    solution->supply_size = supply_size;
+    solution->demand_size = demand_size;
+    solution->count = 0;
+}
+
+/**
+ * Adds a cell to a solution. A cell without units is left out, so a
+ * degenerate basis's epsilon cells never appear.
+ *
+ * @param solution Pointer to the solution structure.
+ * @param row Supply point.
+ * @param column Demand point.
+ * @param quantity Units shipped from row to column.
+ */
+void TP_NAME(add_to_solution)(
+        TP_SOLUTION *solution,
+        int row,
+        int column,
+        TP_VALUE quantity
+) {
+    if (quantity == 0) {
+        return;
+    }
+    if (solution->count == solution->capacity) {
+        size_t capacity = 2 * solution->capacity + 1;
+        int *rows = (int *)realloc(solution->row, capacity * sizeof(int));
+        int *columns = rows ? (int *)realloc(solution->column, capacity * sizeof(int)) : NULL;
+        TP_VALUE *quantities = columns ? (TP_VALUE *)realloc(solution->quantity,
+                                                             capacity * sizeof(TP_VALUE)) : NULL;
+
+        if (!quantities) {
+            fprintf(stderr, "Memory allocation failed for results.\n");
+            exit(EXIT_FAILURE);
+        }
+        solution->row = rows;
+        solution->column = columns;
+        solution->quantity = quantities;
+        solution->capacity = capacity;
+    }
+    solution->row[solution->count] = row;
+    solution->column[solution->count] = column;
+    solution->quantity[solution->count] = quantity;
+    solution->count++;
+}
+
+/**
+ * Builds the dense allocation matrix of a solution.
+ *
+ * @param solution Pointer to the solution structure.
+ * @return Row-major supply_size x demand_size matrix; release it with free().
+ */
+TP_VALUE *TP_NAME(solution_to_matrix)(
+        const TP_SOLUTION *solution
+) {
+    size_t n = (size_t)solution->demand_size;
+    TP_VALUE *matrix = (TP_VALUE *)calloc((size_t)solution->supply_size * n + 1,
+                                          sizeof(TP_VALUE));
+    size_t k;
+
+    if (!matrix) {
+        fprintf(stderr, "Memory allocation failed for results.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (k = 0; k < solution->count; k++) {
+        matrix[(size_t)solution->row[k] * n + solution->column[k]] += solution->quantity[k];
+    }
+    return matrix;
+}
+
+/**
+ * Appends a quantity or cost of the precision, as TP_FMT prints it.
+ *
+ * @param buffer Pointer to the output buffer.
+ * @param value Value to append.
+ */
+static void put_value(
+        OutputBuffer *buffer,
+        TP_VALUE value
+) {
+#if TP_FLOATING
+    char text[32];
+
+    snprintf(text, sizeof(text), TP_FMT, value);
+    put_text(buffer, text);
+#else
+    put_integer(buffer, (long long)value);
+#endif
+}
+
+/**
+ * Writes a solution in one of the text formats.
+ *
+ * @param out Destination stream.
+ * @param solution Pointer to the solution structure.
+ * @param total_cost Total cost of the plan.
+ * @param format SOLUTION_MATRIX, SOLUTION_LIST or SOLUTION_CSV.
+ */
+static void write_solution_text(
+        FILE *out,
+        const TP_SOLUTION *solution,
+        TP_VALUE total_cost,
+        SolutionFormat format
+) {
+    OutputBuffer *buffer = (OutputBuffer *)malloc(sizeof(OutputBuffer));
+    char separator = (format == SOLUTION_CSV) ? ',' : ' ';
+    size_t k;
+    int i, j;
+
+    if (!buffer) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    buffer->out = out;
+    buffer->used = 0;
+
+    put_text(buffer, (format == SOLUTION_CSV) ? "# Total Cost: " : "Total Cost: ");
+    put_value(buffer, total_cost);
+    put_char(buffer, '\n');
+
+    if (format == SOLUTION_MATRIX) {
+        TP_VALUE *matrix = TP_NAME(solution_to_matrix)(solution);
+        const TP_VALUE *row = matrix;
+
+        for (i = 0; i < solution->supply_size; i++, row += solution->demand_size) {
+            for (j = 0; j < solution->demand_size; j++) {
+                if (j > 0) put_char(buffer, ' ');
+                put_value(buffer, row[j]);
+            }
+            put_char(buffer, '\n');
+        }
+        free(matrix);
+    } else {
+        if (format == SOLUTION_CSV) {
+            put_text(buffer, "supply,demand,quantity\n");
+        }
+        for (k = 0; k < solution->count; k++) {
+            put_integer(buffer, solution->row[k]);
+            put_char(buffer, separator);
+            put_integer(buffer, solution->column[k]);
+            put_char(buffer, separator);
+            put_value(buffer, solution->quantity[k]);
+            put_char(buffer, '\n');
+        }
+    }
+
+    flush_output(buffer);
+    free(buffer);
+}
+
+/**
+ * Writes a solution as a binary solution file.
+ *
+ * @param out Destination stream.
+ * @param solution Pointer to the solution structure.
+ * @param total_cost Total cost of the plan.
+ */
+static void write_solution_binary(
+        FILE *out,
+        const TP_SOLUTION *solution,
+        TP_VALUE total_cost
+) {
+    SolutionFileHeader header;
+    uint64_t offset;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SOLUTION_MAGIC, 8);
+    header.version = SOLUTION_FORMAT_VERSION;
+    header.byte_order = SOLUTION_BYTE_ORDER;
+    header.quantity_width = (uint32_t)sizeof(TP_VALUE);
+    header.floating = TP_FLOATING;
+    header.supply_size = solution->supply_size;
+    header.demand_size = solution->demand_size;
+    header.count = solution->count;
+#if TP_FLOATING
+    header.total_cost.floating = total_cost;
+#else
+    header.total_cost.integer = total_cost;
+#endif
+    fwrite(&header, sizeof(header), 1, out);
+    offset = sizeof(header);
+
+    write_section(out, solution->row, sizeof(int), solution->count, &offset);
+    write_section(out, solution->column, sizeof(int), solution->count, &offset);
+    write_section(out, solution->quantity, sizeof(TP_VALUE), solution->count, &offset);
+}
+
+/**
+ * Writes the total cost and the plan of a solution.
+ *
+ * @param out Destination stream.
+ * @param solution Pointer to the solution structure.
+ * @param total_cost Total cost of the plan.
+ * @param format Layout of the output.
+ */
+void TP_NAME(write_solution)(
+        FILE *out,
+        const TP_SOLUTION *solution,
+        TP_VALUE total_cost,
+        SolutionFormat format
+) {
+    if (format == SOLUTION_BINARY) {
+        write_solution_binary(out, solution, total_cost);
+    } else {
+        write_solution_text(out, solution, total_cost, format);
+    }
+}
+
+#undef put_value
+#undef write_solution_text
+#undef write_solution_binary
+
+#endif // TP_TEMPLATE
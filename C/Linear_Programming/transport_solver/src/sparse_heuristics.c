@@ -0,0 +1,434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include "sparse_problem.h"
+#include "workspace.h"
+#include "line_kernels.h"
+
+/*
+ * VAM, North-West Corner and Least Cost on sparse problems. Forbidden
+ * routes simply do not exist, so every scan walks allowed routes only. The
+ * tie-breaks are those of the dense methods: with every route allowed the
+ * allocations are the same. Unlike the dense case, a heuristic can strand
+ * supply on a point whose allowed routes have all closed; it then stops
+ * with a message and sparse_plan_is_complete() reports the plan as
+ * incomplete.
+ */
+
+/**
+ * Working state shared by the sparse heuristics.
+ */
+typedef struct {
+    int *supply;          // Remaining supply
+    int *demand;          // Remaining demand
+    uint64_t *row_done;   // Done mask of closed rows
+    uint64_t *col_done;   // Done mask of closed columns
+    long long supply_left;
+} SparseState;
+
+/**
+ * Copies the supplies and demands and clears the flows.
+ *
+ * @param sp Pointer to the SparseTransportProblem structure.
+ * @param state Working state to initialise.
+ * @param flow Per-route results, cleared here.
+ */
+static void init_sparse_state(
+        const SparseTransportProblem *sp,
+        SparseState *state,
+        int *flow
+) {
+    int i, j;
+
+    state->supply = (int *)malloc((sp->supply_size + 1) * sizeof(int));
+    state->demand = (int *)malloc((sp->demand_size + 1) * sizeof(int));
+    state->row_done = alloc_done_mask(sp->supply_size);
+    state->col_done = alloc_done_mask(sp->demand_size);
+    if (!state->supply || !state->demand) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    state->supply_left = 0;
+    for (i = 0; i < sp->supply_size; i++) {
+        state->supply[i] = sp->supply[i];
+        state->supply_left += sp->supply[i];
+    }
+    for (j = 0; j < sp->demand_size; j++) {
+        state->demand[j] = sp->demand[j];
+    }
+    memset(flow, 0, sp->route_count * sizeof(int));
+}
+
+/**
+ * Frees the working state.
+ *
+ * @param state Working state.
+ */
+static void free_sparse_state(
+        SparseState *state
+) {
+    free(state->supply);
+    free(state->demand);
+    free(state->row_done);
+    free(state->col_done);
+}
+
+/**
+ * Ships as much as possible over one route and closes the row or column
+ * that runs out.
+ *
+ * @param sp Pointer to the SparseTransportProblem structure.
+ * @param state Working state.
+ * @param flow Per-route results.
+ * @param route Route to allocate.
+ * @return Quantity shipped.
+ */
+static int allocate_route(
+        const SparseTransportProblem *sp,
+        SparseState *state,
+        int *flow,
+        size_t route
+) {
+    int r = sp->route_row[route], c = sp->route_col[route];
+    int q = (state->demand[c] <= state->supply[r]) ? state->demand[c] : state->supply[r];
+
+    flow[route] = q;
+    state->supply[r] -= q;
+    state->demand[c] -= q;
+    state->supply_left -= q;
+    if (state->supply[r] == 0) DONE_MASK_SET(state->row_done, r);
+    if (state->demand[c] == 0) DONE_MASK_SET(state->col_done, c);
+    return q;
+}
+
+/**
+ * Cached VAM penalty of one row or column.
+ */
+typedef struct {
+    int penalty;          // min2 - min1, or 0 with fewer than two open routes
+    int min_cost;         // Cheapest open route's cost
+    size_t min_route;     // Cheapest open route, SIZE_MAX if the line has none
+} LinePenalty;
+
+/**
+ * Computes the VAM penalty of one row or column over its open routes. The
+ * cheapest route is the first in the line's order, so ties go to the lowest
+ * index on the other side, as in the dense methods.
+ *
+ * @param sp Pointer to the SparseTransportProblem structure.
+ * @param state Working state.
+ * @param index Row or column index.
+ * @param is_row TRUE for a row, FALSE for a column.
+ * @param line Receives the penalty, the minimum and the cheapest route.
+ */
+static void sparse_penalty(
+        const SparseTransportProblem *sp,
+        const SparseState *state,
+        int index,
+        Boolean is_row,
+        LinePenalty *line
+) {
+    int min1 = INT_MAX, min2 = INT_MAX, c;
+    size_t k, first, last, route;
+
+    line->min_route = SIZE_MAX;
+    first = is_row ? sp->route_start[index] : sp->col_start[index];
+    last = is_row ? sp->route_start[index + 1] : sp->col_start[index + 1];
+    for (k = first; k < last; k++) {
+        route = is_row ? k : sp->col_route[k];
+        if (is_row ? DONE_MASK_TEST(state->col_done, sp->route_col[route])
+                   : DONE_MASK_TEST(state->row_done, sp->route_row[route])) continue;
+        c = sp->route_cost[route];
+        if (c < min1) {
+            min2 = min1;
+            min1 = c;
+            line->min_route = route;
+        } else if (c < min2) {
+            min2 = c;
+        }
+    }
+    line->min_cost = min1;
+    line->penalty = (min2 != INT_MAX) ? (min2 - min1) : 0;
+}
+
+/**
+ * Finds the open row or column with the maximum cached penalty; ties go to
+ * the lowest index. Lines without an open route are passed over.
+ *
+ * @param lines Cached penalties of the rows or of the columns.
+ * @param done Done mask of the same lines.
+ * @param count Number of lines.
+ * @return Index of the line, -1 if no line qualifies.
+ */
+static int sparse_max_penalty(
+        const LinePenalty *lines,
+        const uint64_t *done,
+        int count
+) {
+    int i, best = -1;
+
+    for (i = 0; i < count; i++) {
+        if (DONE_MASK_TEST(done, i) || lines[i].min_route == SIZE_MAX) continue;
+        if (best < 0 || lines[i].penalty > lines[best].penalty) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * Recomputes the cached penalties of the open lines that share a route
+ * with a line that has just closed; no other line's open routes change.
+ *
+ * @param sp Pointer to the SparseTransportProblem structure.
+ * @param state Working state.
+ * @param index Closed row or column.
+ * @param is_row TRUE if a row closed, FALSE if a column closed.
+ * @param crossing Cached penalties of the lines on the other side.
+ */
+static void refresh_crossing_lines(
+        const SparseTransportProblem *sp,
+        const SparseState *state,
+        int index,
+        Boolean is_row,
+        LinePenalty *crossing
+) {
+    size_t k, first, last, route;
+    int other;
+
+    first = is_row ? sp->route_start[index] : sp->col_start[index];
+    last = is_row ? sp->route_start[index + 1] : sp->col_start[index + 1];
+    for (k = first; k < last; k++) {
+        route = is_row ? k : sp->col_route[k];
+        other = is_row ? sp->route_col[route] : sp->route_row[route];
+        if (DONE_MASK_TEST(is_row ? state->col_done : state->row_done, other)) continue;
+        sparse_penalty(sp, state, other, !is_row, &crossing[other]);
+    }
+}
+
+/**
+ * Narrows the cost of a plan to an int, exiting if it does not fit.
+ *
+ * @param plan_cost Total cost of the plan.
+ * @return The total cost.
+ */
+static int checked_total_cost(
+        long long plan_cost
+) {
+    if (plan_cost > INT_MAX || plan_cost < INT_MIN) {
+        fprintf(stderr, "%s\n", solver_status_message(SOLVER_COST_OVERFLOW));
+        exit(EXIT_FAILURE);
+    }
+    return (int)plan_cost;
+}
+
+/**
+ * Solves a sparse transportation problem using Vogel's Approximation Method.
+ * The row/column choice follows choose_cell in vogels.c. Penalties are
+ * cached per line and only refreshed around closed lines, so an iteration
+ * costs a scan of the cached penalties plus the routes next to the closure.
+ *
+ * @param sp Pointer to a balanced SparseTransportProblem structure.
+ * @param flow Pre-allocated per-route buffer to store the allocation results.
+ * @param print_iterations Boolean flag to enable/disable printing each iteration.
+ * @return Total cost of the transportation plan.
+ */
+int sparse_vogels_method(
+        SparseTransportProblem *sp,
+        int *flow,
+        Boolean print_iterations
+) {
+    SparseState state;
+    long long total_cost = 0;
+    int iteration = 0;
+    int best_row, best_col, r, c, q, i;
+    size_t route;
+    LinePenalty *rows = (LinePenalty *)malloc((sp->supply_size + 1) * sizeof(LinePenalty));
+    LinePenalty *cols = (LinePenalty *)malloc((sp->demand_size + 1) * sizeof(LinePenalty));
+
+    if (!rows || !cols) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    init_sparse_state(sp, &state, flow);
+    for (i = 0; i < sp->supply_size; i++) {
+        sparse_penalty(sp, &state, i, TRUE, &rows[i]);
+    }
+    for (i = 0; i < sp->demand_size; i++) {
+        sparse_penalty(sp, &state, i, FALSE, &cols[i]);
+    }
+
+    while (state.supply_left > 0) {
+        iteration++;
+        best_row = sparse_max_penalty(rows, state.row_done, sp->supply_size);
+        best_col = sparse_max_penalty(cols, state.col_done, sp->demand_size);
+        if (best_row < 0) {
+            fprintf(stderr, "No allowed route left for the remaining supply.\n");
+            break;
+        }
+
+        // Compare penalties exactly as the dense method does; a line with an
+        // open route implies one on the other side, so best_col >= 0 here
+        if (rows[best_row].penalty == cols[best_col].penalty) {
+            route = (rows[best_row].min_cost < cols[best_col].min_cost) ?
+                    rows[best_row].min_route : cols[best_col].min_route;
+        } else if (rows[best_row].penalty > cols[best_col].penalty) {
+            route = cols[best_col].min_route;
+        } else {
+            route = rows[best_row].min_route;
+        }
+
+        r = sp->route_row[route];
+        c = sp->route_col[route];
+        q = allocate_route(sp, &state, flow, route);
+        total_cost += (long long)q * sp->route_cost[route];
+        if (DONE_MASK_TEST(state.row_done, r)) refresh_crossing_lines(sp, &state, r, TRUE, cols);
+        if (DONE_MASK_TEST(state.col_done, c)) refresh_crossing_lines(sp, &state, c, FALSE, rows);
+
+        if (print_iterations) {
+            printf("Iteration %d:\n", iteration);
+            printf("  Allocated %d units to cell (%d, %d) with cost %d.\n", q,
+                   r, c, sp->route_cost[route]);
+            printf("  Remaining Supply: ");
+            for (i = 0; i < sp->supply_size; i++) {
+                printf("%d ", state.supply[i]);
+            }
+            printf("\n  Remaining Demand: ");
+            for (i = 0; i < sp->demand_size; i++) {
+                printf("%d ", state.demand[i]);
+            }
+            printf("\n\n");
+        }
+    }
+
+    free(rows);
+    free(cols);
+    free_sparse_state(&state);
+    return checked_total_cost(total_cost);
+}
+
+/**
+ * Solves a sparse transportation problem using the North-West Corner Method.
+ * Each row in turn fills its allowed routes to open columns from left to
+ * right, which on a dense problem is the usual staircase walk.
+ *
+ * @param sp Pointer to a balanced SparseTransportProblem structure.
+ * @param flow Pre-allocated per-route buffer to store the allocation results.
+ * @param print_iterations Boolean flag to enable/disable printing each allocation step.
+ * @return Total cost of the transportation plan.
+ */
+int sparse_north_west_corner_method(
+        SparseTransportProblem *sp,
+        int *flow,
+        Boolean print_iterations
+) {
+    SparseState state;
+    long long total_cost = 0;
+    int iteration = 0;
+    int i, c, q;
+    size_t e;
+
+    init_sparse_state(sp, &state, flow);
+
+    for (i = 0; i < sp->supply_size; i++) {
+        for (e = sp->route_start[i]; e < sp->route_start[i + 1] && state.supply[i] > 0; e++) {
+            c = sp->route_col[e];
+            if (DONE_MASK_TEST(state.col_done, c)) continue;
+
+            q = allocate_route(sp, &state, flow, e);
+            total_cost += (long long)q * sp->route_cost[e];
+            iteration++;
+
+            if (print_iterations) {
+                printf("Allocation %d: %d units to cell (%d, %d) with cost %d.\n",
+                       iteration, q, i, c, sp->route_cost[e]);
+                printf("  Remaining Supply[%d]: %d\n", i, state.supply[i]);
+                printf("  Remaining Demand[%d]: %d\n\n", c, state.demand[c]);
+            }
+        }
+    }
+    if (state.supply_left > 0) {
+        fprintf(stderr, "No allowed route left for the remaining supply.\n");
+    }
+
+    free_sparse_state(&state);
+    return checked_total_cost(total_cost);
+}
+
+/**
+ * Orders two (cost, route) keys.
+ *
+ * @param a First key.
+ * @param b Second key.
+ * @return Negative, zero or positive as for qsort.
+ */
+static int compare_keys(
+        const void *a,
+        const void *b
+) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * Solves a sparse transportation problem using the Least Cost Cell Method.
+ * The routes are sorted once by cost and then by index, which is row-major
+ * order, and walked skipping routes on closed lines.
+ *
+ * @param sp Pointer to a balanced SparseTransportProblem structure.
+ * @param flow Pre-allocated per-route buffer to store the allocation results.
+ * @param print_iterations Boolean flag to enable/disable printing each allocation step.
+ * @return Total cost of the transportation plan.
+ */
+int sparse_least_cost_method(
+        SparseTransportProblem *sp,
+        int *flow,
+        Boolean print_iterations
+) {
+    SparseState state;
+    long long total_cost = 0;
+    int iteration = 0;
+    int r, c, q;
+    size_t k, e;
+    uint64_t *keys = (uint64_t *)malloc((sp->route_count + 1) * sizeof(uint64_t));
+
+    if (!keys) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    init_sparse_state(sp, &state, flow);
+
+    // Flipping the sign bit makes unsigned order match signed order
+    for (e = 0; e < sp->route_count; e++) {
+        keys[e] = ((uint64_t)((uint32_t)sp->route_cost[e] ^ 0x80000000u) << 32) | (uint32_t)e;
+    }
+    qsort(keys, sp->route_count, sizeof(uint64_t), compare_keys);
+
+    for (k = 0; k < sp->route_count && state.supply_left > 0; k++) {
+        e = (size_t)(uint32_t)keys[k];
+        r = sp->route_row[e];
+        c = sp->route_col[e];
+        if (DONE_MASK_TEST(state.row_done, r) || DONE_MASK_TEST(state.col_done, c)) continue;
+
+        q = allocate_route(sp, &state, flow, e);
+        total_cost += (long long)q * sp->route_cost[e];
+        iteration++;
+
+        if (print_iterations) {
+            printf("Allocation %d: %d units to cell (%d, %d) with cost %d.\n",
+                   iteration, q, r, c, sp->route_cost[e]);
+            printf("  Remaining Supply[%d]: %d\n", r, state.supply[r]);
+            printf("  Remaining Demand[%d]: %d\n\n", c, state.demand[c]);
+        }
+    }
+    if (state.supply_left > 0) {
+        fprintf(stderr, "No allowed route left for the remaining supply.\n");
+    }
+
+    free(keys);
+    free_sparse_state(&state);
+    return checked_total_cost(total_cost);
+}
@@ -0,0 +1,342 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "sparse_problem.h"
+
+/**
+ * Allocates the vectors and route arrays of a sparse problem. Supplies,
+ * demands and route_start start out zero; the CSC view is built later by
+ * build_sparse_columns().
+ *
+ * @param sp Pointer to the SparseTransportProblem structure to initialise.
+ * @param supply_size Number of supply points.
+ * @param demand_size Number of demand points.
+ * @param route_count Number of allowed routes.
+ */
+void init_sparse_problem(
+        SparseTransportProblem *sp,
+        int supply_size,
+        int demand_size,
+        size_t route_count
+) {
+    sp->supply_size = supply_size;
+    sp->demand_size = demand_size;
+    sp->route_count = route_count;
+    sp->supply = (int *)calloc(supply_size + 1, sizeof(int));
+    sp->demand = (int *)calloc(demand_size + 1, sizeof(int));
+    sp->route_start = (size_t *)calloc(supply_size + 2, sizeof(size_t));
+    sp->route_row = (int *)malloc((route_count + 1) * sizeof(int));
+    sp->route_col = (int *)malloc((route_count + 1) * sizeof(int));
+    sp->route_cost = (int *)malloc((route_count + 1) * sizeof(int));
+    sp->col_start = NULL;
+    sp->col_route = NULL;
+
+    if (!sp->supply || !sp->demand || !sp->route_start || !sp->route_row ||
+            !sp->route_col || !sp->route_cost) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Frees the memory held by a sparse problem.
+ *
+ * @param sp Pointer to the SparseTransportProblem structure.
+ */
+void free_sparse_problem(
+        SparseTransportProblem *sp
+) {
+    free(sp->supply);
+    free(sp->demand);
+    free(sp->route_start);
+    free(sp->route_row);
+    free(sp->route_col);
+    free(sp->route_cost);
+    free(sp->col_start);
+    free(sp->col_route);
+    memset(sp, 0, sizeof(*sp));
+}
+
+/**
+ * Builds the route_row array and the CSC view from the CSR routes.
+ * Because routes are numbered row by row, listing them by ascending index
+ * within each column keeps the supply points ascending.
+ *
+ * @param sp Pointer to the SparseTransportProblem structure.
+ */
+void build_sparse_columns(
+        SparseTransportProblem *sp
+) {
+    size_t e;
+    int i, j;
+
+    free(sp->col_start);
+    free(sp->col_route);
+    sp->col_start = (size_t *)calloc(sp->demand_size + 2, sizeof(size_t));
+    sp->col_route = (size_t *)malloc((sp->route_count + 1) * sizeof(size_t));
+    if (!sp->col_start || !sp->col_route) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (i = 0; i < sp->supply_size; i++) {
+        for (e = sp->route_start[i]; e < sp->route_start[i + 1]; e++) {
+            sp->route_row[e] = i;
+        }
+    }
+    // Counting sort of the routes by column
+    for (e = 0; e < sp->route_count; e++) {
+        sp->col_start[sp->route_col[e] + 2]++;
+    }
+    for (j = 0; j < sp->demand_size; j++) {
+        sp->col_start[j + 2] += sp->col_start[j + 1];
+    }
+    for (e = 0; e < sp->route_count; e++) {
+        sp->col_route[sp->col_start[sp->route_col[e] + 1]++] = e;
+    }
+}
+
+/**
+ * Builds a sparse problem from a list of (row, column, cost) routes in any
+ * order. The routes are put in CSR order with two stable counting sorts,
+ * by column and then by row.
+ *
+ * @param sp Pointer to the SparseTransportProblem structure to fill; initialised here.
+ * @param supply_size Number of supply points.
+ * @param demand_size Number of demand points.
+ * @param route_count Number of routes.
+ * @param triples Row, column and cost of each route, one triple after another.
+ * @return 0 on success, -1 on an out-of-range or duplicate route (reported on stderr, sp left empty).
+ */
+int sparse_problem_from_triples(
+        SparseTransportProblem *sp,
+        int supply_size,
+        int demand_size,
+        size_t route_count,
+        const int *triples
+) {
+    size_t *by_col = (size_t *)malloc((route_count + 1) * sizeof(size_t));
+    size_t *col_next = (size_t *)calloc(demand_size + 1, sizeof(size_t));
+    const int *route;
+    size_t e, k, pos;
+    int j;
+
+    if (!by_col || !col_next) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (e = 0; e < route_count; e++) {
+        route = triples + 3 * e;
+        if (route[0] < 0 || route[0] >= supply_size || route[1] < 0 || route[1] >= demand_size) {
+            fprintf(stderr, "Route %zu (%d, %d) is outside the %d x %d problem.\n",
+                    e + 1, route[0], route[1], supply_size, demand_size);
+            free(by_col);
+            free(col_next);
+            return -1;
+        }
+    }
+
+    init_sparse_problem(sp, supply_size, demand_size, route_count);
+
+    // Stable counting sort by column
+    for (e = 0; e < route_count; e++) {
+        col_next[triples[3 * e + 1] + 1]++;
+    }
+    for (j = 0; j < demand_size; j++) {
+        col_next[j + 1] += col_next[j];
+    }
+    for (e = 0; e < route_count; e++) {
+        by_col[col_next[triples[3 * e + 1]]++] = e;
+    }
+
+    // Stable counting sort by row, which keeps the columns ascending
+    for (e = 0; e < route_count; e++) {
+        sp->route_start[triples[3 * e] + 2]++;
+    }
+    for (j = 0; j < supply_size; j++) {
+        sp->route_start[j + 2] += sp->route_start[j + 1];
+    }
+    for (k = 0; k < route_count; k++) {
+        route = triples + 3 * by_col[k];
+        pos = sp->route_start[route[0] + 1]++;
+        sp->route_col[pos] = route[1];
+        sp->route_cost[pos] = route[2];
+    }
+    free(by_col);
+    free(col_next);
+
+    build_sparse_columns(sp);
+    for (e = 1; e < route_count; e++) {
+        if (sp->route_row[e] == sp->route_row[e - 1] && sp->route_col[e] == sp->route_col[e - 1]) {
+            fprintf(stderr, "Route (%d, %d) is listed more than once.\n",
+                    sp->route_row[e], sp->route_col[e]);
+            free_sparse_problem(sp);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Balances a sparse problem by adding a dummy supply or demand point if
+ * necessary. The dummy point gets a zero-cost route to every point on the
+ * other side, so only supply_size or demand_size routes are added.
+ *
+ * @param sp Pointer to the SparseTransportProblem structure to be balanced.
+ * @return 0 on success, -1 if the total supply or demand does not fit in an
+ *         int (the problem is left as it was).
+ */
+int balance_sparse_problem(
+        SparseTransportProblem *sp
+) {
+    long long total_supply = 0, total_demand = 0;
+    int m = sp->supply_size, n = sp->demand_size;
+    size_t count = sp->route_count;
+    size_t e, pos;
+    int i, j;
+
+    for (i = 0; i < m; i++) total_supply += sp->supply[i];
+    for (j = 0; j < n; j++) total_demand += sp->demand[j];
+    if (total_supply > INT_MAX || total_demand > INT_MAX) {
+        return -1;
+    }
+    if (total_supply == total_demand) {
+        return 0;
+    }
+
+    size_t added = (total_supply > total_demand) ? (size_t)m : (size_t)n;
+    int *route_col = (int *)malloc((count + added + 1) * sizeof(int));
+    int *route_cost = (int *)malloc((count + added + 1) * sizeof(int));
+    if (!route_col || !route_cost) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (total_supply > total_demand) {
+        // Dummy demand point n closes every row
+        sp->demand = (int *)realloc(sp->demand, (n + 1) * sizeof(int));
+        if (!sp->demand) {
+            fprintf(stderr, "Memory allocation failed for dummy demand.\n");
+            exit(EXIT_FAILURE);
+        }
+        sp->demand[n] = (int)(total_supply - total_demand);
+        sp->demand_size++;
+        pos = 0;
+        for (i = 0; i < m; i++) {
+            e = sp->route_start[i];
+            sp->route_start[i] = pos;
+            for (; e < sp->route_start[i + 1]; e++) {
+                route_col[pos] = sp->route_col[e];
+                route_cost[pos++] = sp->route_cost[e];
+            }
+            route_col[pos] = n;
+            route_cost[pos++] = 0;  // Zero cost for dummy demand
+        }
+        sp->route_start[m] = pos;
+    } else {
+        // Dummy supply point m, one route per column, appended as the last row
+        sp->supply = (int *)realloc(sp->supply, (m + 1) * sizeof(int));
+        sp->route_start = (size_t *)realloc(sp->route_start, (m + 3) * sizeof(size_t));
+        if (!sp->supply || !sp->route_start) {
+            fprintf(stderr, "Memory allocation failed for dummy supply.\n");
+            exit(EXIT_FAILURE);
+        }
+        sp->supply[m] = (int)(total_demand - total_supply);
+        sp->supply_size++;
+        memcpy(route_col, sp->route_col, count * sizeof(int));
+        memcpy(route_cost, sp->route_cost, count * sizeof(int));
+        for (j = 0; j < n; j++) {
+            route_col[count + j] = j;
+            route_cost[count + j] = 0;  // Zero cost for dummy supply
+        }
+        sp->route_start[m + 1] = count + n;
+    }
+
+    free(sp->route_col);
+    free(sp->route_cost);
+    free(sp->route_row);
+    sp->route_col = route_col;
+    sp->route_cost = route_cost;
+    sp->route_count = count + added;
+    sp->route_row = (int *)malloc((sp->route_count + 1) * sizeof(int));
+    if (!sp->route_row) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    build_sparse_columns(sp);
+    return 0;
+}
+
+/**
+ * Allocates a zeroed per-route results buffer.
+ *
+ * @param sp Pointer to the SparseTransportProblem structure.
+ * @return The results buffer; release it with free().
+ */
+int *alloc_sparse_results(
+        const SparseTransportProblem *sp
+) {
+    int *flow = (int *)calloc(sp->route_count + 1, sizeof(int));
+
+    if (!flow) {
+        fprintf(stderr, "Memory allocation failed for results.\n");
+        exit(EXIT_FAILURE);
+    }
+    return flow;
+}
+
+/**
+ * Checks that a plan ships every supply and meets every demand. A heuristic
+ * can strand supply on a point whose allowed routes have all closed.
+ *
+ * @param sp Pointer to the SparseTransportProblem structure.
+ * @param flow Quantity on each route.
+ * @return TRUE if all supplies and demands are met exactly.
+ */
+Boolean sparse_plan_is_complete(
+        const SparseTransportProblem *sp,
+        const int *flow
+) {
+    long long *shipped = (long long *)calloc(sp->supply_size + sp->demand_size + 1, sizeof(long long));
+    Boolean complete = TRUE;
+    size_t e;
+    int x;
+
+    if (!shipped) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (e = 0; e < sp->route_count; e++) {
+        shipped[sp->route_row[e]] += flow[e];
+        shipped[sp->supply_size + sp->route_col[e]] += flow[e];
+    }
+    for (x = 0; x < sp->supply_size && complete; x++) {
+        if (shipped[x] != sp->supply[x]) complete = FALSE;
+    }
+    for (x = 0; x < sp->demand_size && complete; x++) {
+        if (shipped[sp->supply_size + x] != sp->demand[x]) complete = FALSE;
+    }
+    free(shipped);
+    return complete;
+}
+
+/**
+ * Fills a solution with the routes that carry units, in route order.
+ *
+ * @param sp Pointer to the SparseTransportProblem structure that was solved.
+ * @param flow Quantity on each route.
+ * @param solution Solution initialised for the problem's size; emptied first.
+ */
+void sparse_flow_to_solution(
+        const SparseTransportProblem *sp,
+        const int *flow,
+        Solution *solution
+) {
+    size_t e;
+
+    clear_solution(solution);
+    for (e = 0; e < sp->route_count; e++) {
+        add_to_solution(solution, sp->route_row[e], sp->route_col[e], flow[e]);
+    }
+}
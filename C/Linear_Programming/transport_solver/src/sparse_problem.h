@@ -0,0 +1,62 @@
+#ifndef SPARSE_PROBLEM_H
+#define SPARSE_PROBLEM_H
+
+#include "transport.h"
+#include "min_cost_flow.h"
+
+/*
+ * A transportation problem in which only some supply/demand pairs are
+ * allowed routes; every other pair is forbidden rather than merely
+ * expensive.
+ *
+ * Routes are stored once in compressed sparse row (CSR) order: the routes
+ * of supply point i are route_start[i] .. route_start[i + 1] - 1, with
+ * ascending demand points. A compressed sparse column (CSC) view lists, for
+ * every demand point j, the indices of its routes by ascending supply
+ * point. Memory and the methods' scans scale with the number of routes,
+ * not with supply_size x demand_size. Solutions hold one quantity per
+ * route.
+ */
+typedef struct {
+    int supply_size;
+    int demand_size;
+    int *supply;
+    int *demand;
+    size_t route_count;
+    size_t *route_start;  // supply_size + 1 entries
+    int *route_row;       // Supply point of each route
+    int *route_col;       // Demand point of each route, ascending within a row
+    int *route_cost;
+    size_t *col_start;    // CSC view: demand_size + 1 entries
+    size_t *col_route;    // Routes of each demand point, ascending supply points
+} SparseTransportProblem;
+
+// Problem storage
+void init_sparse_problem(SparseTransportProblem *sp, int supply_size, int demand_size,
+                         size_t route_count);
+void free_sparse_problem(SparseTransportProblem *sp);
+int sparse_problem_from_triples(SparseTransportProblem *sp, int supply_size, int demand_size,
+                                size_t route_count, const int *triples);
+void build_sparse_columns(SparseTransportProblem *sp);
+int balance_sparse_problem(SparseTransportProblem *sp);
+int *alloc_sparse_results(const SparseTransportProblem *sp);
+Boolean sparse_plan_is_complete(const SparseTransportProblem *sp, const int *flow);
+void sparse_flow_to_solution(const SparseTransportProblem *sp, const int *flow, Solution *solution);
+
+// Problem files
+Boolean is_route_problem_binary(const char *data, size_t length);
+int parse_route_problem_binary(const char *path, const char *data, size_t length,
+                               SparseTransportProblem *sp);
+int load_any_problem_file(const char *path, TransportProblem *tp, SparseTransportProblem *sp);
+int save_sparse_problem_binary(const char *path, const SparseTransportProblem *sp, int cost_width);
+
+// Allocation methods
+int sparse_vogels_method(SparseTransportProblem *sp, int *flow, Boolean print_iterations);
+int sparse_north_west_corner_method(SparseTransportProblem *sp, int *flow, Boolean print_iterations);
+int sparse_least_cost_method(SparseTransportProblem *sp, int *flow, Boolean print_iterations);
+
+// Optimisation methods
+int sparse_min_cost_flow_method(SparseTransportProblem *sp, int *flow, McfAlgorithm algorithm,
+                                Boolean print_iterations);
+
+#endif // SPARSE_PROBLEM_H
@@ -0,0 +1,277 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include "text_scanner.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__BYTE_ORDER__) && \
+        __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define TEXT_SCANNER_SWAR 1
+#else
+#define TEXT_SCANNER_SWAR 0
+#endif
+
+#define MAX_NUMBER_LENGTH 64 // Longest field scan_double() converts
+
+/**
+ * Points a scanner at a text buffer.
+ *
+ * @param scanner Pointer to the scanner.
+ * @param text Text to scan; it does not need a terminating NUL.
+ * @param length Number of characters in text.
+ */
+void init_text_scanner(
+        TextScanner *scanner,
+        const char *text,
+        size_t length
+) {
+    scanner->p = text;
+    scanner->end = text + length;
+    scanner->line_start = text;
+    scanner->line = 1;
+    scanner->field = text;
+    scanner->field_line = 1;
+    scanner->field_column = 1;
+}
+
+/**
+ * Tells whether a character ends a field.
+ *
+ * @param c Character.
+ * @return Non-zero for separators and the comment marker.
+ */
+static int is_delimiter(
+        char c
+) {
+    return c == ',' || c == ' ' || c == '\t' || c == '\n' || c == '\r' ||
+           c == '\v' || c == '\f' || c == '#';
+}
+
+/**
+ * Skips the separators, blank lines and comments before the next field,
+ * keeping count of lines, and records the field's position.
+ *
+ * @param scanner Pointer to the scanner.
+ * @return Start of the field, or the end of the text if none is left.
+ */
+static const char *skip_to_field(
+        TextScanner *scanner
+) {
+    const char *p = scanner->p, *end = scanner->end;
+
+    while (p < end) {
+        if (*p == '\n') {
+            scanner->line++;
+            scanner->line_start = ++p;
+        } else if (*p == '#') {
+            while (p < end && *p != '\n') p++;
+        } else if (is_delimiter(*p)) {
+            p++;
+        } else {
+            break;
+        }
+    }
+    scanner->p = p;
+    scanner->field = p;
+    scanner->field_line = scanner->line;
+    scanner->field_column = (size_t)(p - scanner->line_start) + 1;
+    return p;
+}
+
+#if TEXT_SCANNER_SWAR
+
+/**
+ * Reads up to eight leading decimal digits at once. The eight bytes are
+ * tested for digits in parallel, the run of leading digits is found with a
+ * count of trailing zeros and the digits are combined with three multiplies
+ * instead of a loop.
+ *
+ * @param p Eight readable bytes.
+ * @param value Receives the value of the leading digits.
+ * @return Number of leading digits, 0 to 8.
+ */
+static int swar_digits(
+        const char *p,
+        uint64_t *value
+) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    uint64_t chunk, high, nondigit, digits;
+    int count;
+
+    memcpy(&chunk, p, sizeof(chunk));
+    // A byte is a digit when both it and it plus 6 have 0x3 as high nibble.
+    // A carry out of a byte only comes from a non-digit, after which nothing
+    // is looked at.
+    nondigit = ((chunk & (0xF0 * ones)) ^ (0x30 * ones)) |
+               (((chunk + 0x06 * ones) & (0xF0 * ones)) ^ (0x30 * ones));
+    high = (((nondigit & (0x7F * ones)) + 0x7F * ones) | nondigit) & (0x80 * ones);
+    count = high ? __builtin_ctzll(high) / 8 : 8;
+    if (count == 0) {
+        *value = 0;
+        return 0;
+    }
+
+    // Keep the digits, moved up so missing ones read as leading zeros
+    digits = (chunk - 0x30 * ones) << (8 * (8 - count));
+    digits = (digits * 10) + (digits >> 8);
+    digits = (((digits & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+              (((digits >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    *value = digits;
+    return count;
+}
+
+#endif // TEXT_SCANNER_SWAR
+
+/**
+ * Scans the next integer whose magnitude is at most limit, or limit + 1
+ * when negative. Separators, blank lines and comments before it are
+ * skipped; the field must then run up to a delimiter or the end of the
+ * text. On SCAN_MALFORMED and SCAN_RANGE the field's position is left in
+ * field_line and field_column and the scanner moves past the field.
+ *
+ * @param scanner Pointer to the scanner.
+ * @param limit Largest positive value.
+ * @param value Receives the integer.
+ * @return SCAN_OK, SCAN_END, SCAN_MALFORMED or SCAN_RANGE.
+ */
+static ScanStatus scan_integer(
+        TextScanner *scanner,
+        uint64_t limit,
+        int64_t *value
+) {
+    const char *p, *end = scanner->end, *digits;
+    int negative = 0, more = 1;
+    uint64_t v = 0;
+    ScanStatus status = SCAN_OK;
+
+    p = skip_to_field(scanner);
+    if (p == end) {
+        return SCAN_END;
+    }
+
+    if (*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        p++;
+    }
+    digits = p;
+#if TEXT_SCANNER_SWAR
+    if (end - p >= 8) {
+        int count = swar_digits(p, &v);
+        p += count;
+        more = (count == 8);
+    }
+#endif
+    // Once the value is out of range it sticks above the limit, so it cannot wrap
+    while (more && p < end && (unsigned)(*p - '0') < 10) {
+        v = (v <= (limit + 1) / 10) ? v * 10 + (uint64_t)(*p - '0') : limit + 2;
+        p++;
+    }
+    if (p == digits || (p < end && !is_delimiter(*p))) {
+        status = SCAN_MALFORMED;
+    } else if (v > limit + (uint64_t)negative) {
+        status = SCAN_RANGE;
+    }
+
+    if (status != SCAN_OK) {
+        while (p < end && !is_delimiter(*p)) p++;
+        scanner->p = p;
+        return status;
+    }
+    scanner->p = p;
+    // -v is formed in unsigned arithmetic, as -(limit + 1) may not fit before the conversion
+    *value = negative ? (int64_t)(0 - v) : (int64_t)v;
+    return SCAN_OK;
+}
+
+/**
+ * Scans the next integer, which must fit in an int (see scan_integer()).
+ *
+ * @param scanner Pointer to the scanner.
+ * @param value Receives the integer.
+ * @return SCAN_OK, SCAN_END, SCAN_MALFORMED or SCAN_RANGE.
+ */
+ScanStatus scan_int(
+        TextScanner *scanner,
+        int *value
+) {
+    int64_t v;
+    ScanStatus status = scan_integer(scanner, INT_MAX, &v);
+
+    if (status == SCAN_OK) {
+        *value = (int)v;
+    }
+    return status;
+}
+
+/**
+ * Scans the next integer, which must fit in an int64_t (see scan_integer()).
+ *
+ * @param scanner Pointer to the scanner.
+ * @param value Receives the integer.
+ * @return SCAN_OK, SCAN_END, SCAN_MALFORMED or SCAN_RANGE.
+ */
+ScanStatus scan_int64(
+        TextScanner *scanner,
+        int64_t *value
+) {
+    return scan_integer(scanner, INT64_MAX, value);
+}
+
+/**
+ * Scans the next decimal number, such as a coordinate or a rate. Fields are
+ * delimited as for scan_int() and converted with strtod(), so exponents are
+ * accepted; infinities and NaNs are not.
+ *
+ * @param scanner Pointer to the scanner.
+ * @param value Receives the number.
+ * @return SCAN_OK, SCAN_END, SCAN_MALFORMED or SCAN_RANGE.
+ */
+ScanStatus scan_double(
+        TextScanner *scanner,
+        double *value
+) {
+    const char *p = skip_to_field(scanner);
+    char field[MAX_NUMBER_LENGTH + 1], *parsed;
+    size_t length;
+    double v;
+
+    if (p == scanner->end) {
+        return SCAN_END;
+    }
+    length = scan_field_length(scanner);
+    scanner->p = p + length;
+    if (length > MAX_NUMBER_LENGTH) {
+        return SCAN_MALFORMED;
+    }
+
+    // strtod() needs a terminated string, and the text may not have one
+    memcpy(field, p, length);
+    field[length] = '\0';
+    errno = 0;
+    v = strtod(field, &parsed);
+    if (parsed != field + length || !isfinite(v)) {
+        return SCAN_MALFORMED;
+    }
+    if (errno == ERANGE && fabs(v) > 1.0) {
+        return SCAN_RANGE;
+    }
+    *value = v;
+    return SCAN_OK;
+}
+
+/**
+ * Length of the last field scanned, for quoting it in error messages.
+ *
+ * @param scanner Pointer to the scanner.
+ * @return Number of characters from the field's start to the next delimiter.
+ */
+size_t scan_field_length(
+        const TextScanner *scanner
+) {
+    const char *p = scanner->field;
+
+    while (p < scanner->end && !is_delimiter(*p)) p++;
+    return (size_t)(p - scanner->field);
+}
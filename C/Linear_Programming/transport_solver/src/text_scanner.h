@@ -0,0 +1,37 @@
+#ifndef TEXT_SCANNER_H
+#define TEXT_SCANNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Number scanner over an in-memory text buffer (a mapped file or a line
+ * read at a prompt). Values are separated by commas and/or whitespace and
+ * a # starts a comment running to the end of the line. The scanner tracks
+ * the line and column of every value so callers can point at bad data.
+ */
+
+typedef enum {
+    SCAN_OK,
+    SCAN_END,        // No value left
+    SCAN_MALFORMED,  // The field is not a number of the kind asked for
+    SCAN_RANGE       // The field does not fit in the type asked for
+} ScanStatus;
+
+typedef struct {
+    const char *p;           // Next character
+    const char *end;         // One past the last character
+    const char *line_start;  // First character of the current line
+    size_t line;             // Current line, from 1
+    const char *field;       // Start of the last field scanned
+    size_t field_line;       // Line of the last field scanned
+    size_t field_column;     // Column of the last field scanned, from 1
+} TextScanner;
+
+void init_text_scanner(TextScanner *scanner, const char *text, size_t length);
+ScanStatus scan_int(TextScanner *scanner, int *value);
+ScanStatus scan_int64(TextScanner *scanner, int64_t *value);
+ScanStatus scan_double(TextScanner *scanner, double *value);
+size_t scan_field_length(const TextScanner *scanner);
+
+#endif // TEXT_SCANNER_H
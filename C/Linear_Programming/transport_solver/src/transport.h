@@ -19,33 +19,148 @@ typedef enum boolean {
 
 #define MAX_INPUT_SIZE 1000
 
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * A transportation problem. Costs live in one contiguous row-major buffer:
+ * the cost of shipping from supply point i to demand point j is
+ * cost[i * cost_columns + j] (see COST_AT). Column scans can use the
+ * column-major copy cost_transposed once build_cost_transpose() has made it.
+ * A problem loaded from a binary problem file may use the file's cost block
+ * in place; mapping then holds the file and is released with the problem.
+ *
+ * A problem with implicit costs has no cost buffer at all: cost is NULL and
+ * cost_function computes each cost from the points' coordinates when it is
+ * read (see cost_function.h). Methods read costs through COST_AT, cost_row()
+ * and cost_column(), which serve both kinds.
+ *
+ * Costs cover the first cost_rows supply points and cost_columns demand
+ * points. balance_transport_problem() adds a dummy point past them whose
+ * cells all cost 0 without storing them, so the cost buffer is never
+ * copied or written; cost_row() and cost_column() give only the covered
+ * entries and COST_AT gives 0 for the dummy's cells. The supply and demand
+ * vectors keep one spare slot for the dummy's quantity.
+ */
+typedef struct CostFunction CostFunction;
+typedef struct ProblemStream ProblemStream;
+
 typedef struct {
     int supply_size;
     int demand_size;
     int *supply;
     int *demand;
-    int **cost_matrix;
+    int *cost;             // cost_rows x cost_columns, row-major; NULL with implicit costs
+    int *cost_transposed;  // cost_columns x cost_rows, row-major; NULL until built
+    void *mapping;         // File mapping the cost buffer lives in, NULL if cost is malloc'd
+    size_t mapping_length;
+    CostFunction *cost_function;  // Implicit costs, owned by the problem; NULL if cost is set
+    int cost_rows;         // Supply points the costs cover; supply_size - 1 with a dummy supply
+    int cost_columns;      // Demand points the costs cover; demand_size - 1 with a dummy demand
 } TransportProblem;
 
+/**
+ * A solution: the cells that carry units, one (row, column, quantity)
+ * triple each, in the order the method placed them. A basic solution has
+ * at most supply_size + demand_size - 1 of them, so a solution stays small
+ * however many cells the problem has. solution_to_matrix() gives the dense
+ * allocation matrix where one is wanted, for small problems.
+ */
+typedef struct {
+    int supply_size;
+    int demand_size;
+    size_t count;          // Cells that carry units
+    size_t capacity;       // Cells the arrays have room for
+    int *row;
+    int *column;
+    int *quantity;
+} Solution;
+
+/** How write_solution() lays a solution out. */
+typedef enum {
+    SOLUTION_MATRIX,       // Total cost, then the allocation matrix one row per line
+    SOLUTION_LIST,         // Total cost, then one "supply demand quantity" line per cell
+    SOLUTION_CSV,          // A "# Total Cost" line, a header, then one CSV record per cell
+    SOLUTION_BINARY        // Binary solution file, see src/solution.c
+} SolutionFormat;
+
+/** Index of cell (i, j) in a row-major supply_size x demand_size buffer. */
+#define CELL_INDEX(tp, i, j) ((size_t)(i) * (size_t)(tp)->demand_size + (size_t)(j))
+
+/** Index of cell (i, j) in the cost buffer, cost_rows x cost_columns. */
+#define COST_INDEX(tp, i, j) ((size_t)(i) * (size_t)(tp)->cost_columns + (size_t)(j))
+
+/** Tells whether cell (i, j) has a stored or computed cost, rather than being a dummy's. */
+#define HAS_COST(tp, i, j) ((i) < (tp)->cost_rows && (j) < (tp)->cost_columns)
+
+/** Cost of cell (i, j), stored or computed; 0 for a dummy point's cells. */
+#define COST_AT(tp, i, j) (!HAS_COST(tp, i, j) ? 0 : (tp)->cost ? (tp)->cost[COST_INDEX(tp, i, j)] \
+                                                               : implicit_cost(tp, i, j))
+
 typedef enum {
     VOGELS_APPROXIMATION,
+    VOGELS_PARALLEL,
     NORTH_WEST_CORNER,
-    LEAST_COST
+    LEAST_COST,
+    NETWORK_SIMPLEX,
+    SUCCESSIVE_SHORTEST_PATH,
+    COST_SCALING
 } AllocationMethod;
 
+// Problem storage
+void init_transport_problem(TransportProblem *tp, int supply_size, int demand_size);
+void init_implicit_transport_problem(TransportProblem *tp, int supply_size, int demand_size,
+                                     CostFunction *cost_function);
+void free_transport_problem(TransportProblem *tp);
+void adopt_cost_mapping(TransportProblem *tp, int *cost, void *mapping, size_t mapping_length);
+void build_cost_transpose(TransportProblem *tp);
+int balance_transport_problem(TransportProblem *tp);
+
+// Cost access
+int implicit_cost(const TransportProblem *tp, int i, int j);
+const int *cost_row(const TransportProblem *tp, int i, int *buffer);
+const int *cost_column(const TransportProblem *tp, int j, int *buffer);
+
+// Problem files
+int load_problem_file(const char *path, TransportProblem *tp);
+Boolean is_problem_binary(const char *data, size_t length);
+int parse_problem_binary(const char *path, char *data, size_t length, Boolean mapped, TransportProblem *tp);
+int save_problem_binary(const char *path, const TransportProblem *tp, int cost_width, Boolean sparse,
+                        int default_cost);
+ProblemStream *open_problem_stream(const char *path);
+int read_stream_problem(ProblemStream *stream, TransportProblem *tp);
+void close_problem_stream(ProblemStream *stream);
+
+// Solutions
+void init_solution(Solution *solution, int supply_size, int demand_size);
+void free_solution(Solution *solution);
+void clear_solution(Solution *solution);
+void reshape_solution(Solution *solution, int supply_size, int demand_size);
+void add_to_solution(Solution *solution, int row, int column, int quantity);
+int *solution_to_matrix(const Solution *solution);
+void write_solution(FILE *out, const Solution *solution, int total_cost, SolutionFormat format);
+
 // Input functions
 void parse_comma_separated_values(const char *input, int *array, int expected_size);
 int get_confirmation(const char *message);
 void input_vector(int *vector, int size, const char *prompt);
-void input_matrix(int **matrix, int rows, int cols, const char *prompt);
+void input_matrix(int *matrix, int rows, int cols, const char *prompt);
 
 // Utility functions
 void print_vector(const int *vector, int size);
-void print_matrix(int **matrix, int rows, int cols);
+void print_matrix(const int *matrix, int rows, int cols);
 
 // Allocation methods
-int vogels_approximation_method(TransportProblem *tp, int **results, Boolean print_iterations);
-int north_west_corner_method(TransportProblem *tp, int **results, Boolean print_iterations);
-int least_cost_method(TransportProblem *tp, int **results, Boolean print_iterations);
+int vogels_approximation_method(TransportProblem *tp, Solution *solution, Boolean print_iterations);
+int vogels_incremental_method(TransportProblem *tp, Solution *solution, Boolean print_iterations);
+int vogels_parallel_method(TransportProblem *tp, Solution *solution, int num_threads,
+                           Boolean print_iterations);
+int north_west_corner_method(TransportProblem *tp, Solution *solution, Boolean print_iterations);
+int least_cost_method(TransportProblem *tp, Solution *solution, Boolean print_iterations);
+int least_cost_sorted_method(TransportProblem *tp, Solution *solution, Boolean print_iterations);
+
+// Optimisation methods
+int modi_method(TransportProblem *tp, Solution *solution, Boolean print_iterations);
+int network_simplex_method(TransportProblem *tp, Solution *solution, Boolean print_iterations);
 
 #endif // TRANSPORT_H
@@ -1,9 +1,102 @@
+#ifndef TP_TEMPLATE
+#define _POSIX_C_SOURCE 200809L  // sysconf
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "transport.h"
+#include "line_kernels.h"
+#include "workspace.h"
 
-#define MAX_ITERATIONS 1000 // To prevent potential infinite loops
+// Vogel's Approximation Method, compiled once per precision
+#define TP_TEMPLATE "vogels.c"
+#include "precision_template.h"
+
+#else // Template body
+
+// Types and helpers get a name per precision
+#define LinePick TP_NAME(LinePick)
+#define PenaltyWorker TP_NAME(PenaltyWorker)
+#define PenaltyPool TP_NAME(PenaltyPool)
+#define alloc_line_buffer TP_NAME(alloc_line_buffer)
+#define diff TP_NAME(diff)
+#define max_penalty TP_NAME(max_penalty)
+#define choose_cell TP_NAME(choose_cell)
+#define next_cell TP_NAME(next_cell)
+#define scan_chunk TP_NAME(scan_chunk)
+#define penalty_worker TP_NAME(penalty_worker)
+#define init_penalty_pool TP_NAME(init_penalty_pool)
+#define free_penalty_pool TP_NAME(free_penalty_pool)
+#define next_cell_parallel TP_NAME(next_cell_parallel)
+#define vogels_run TP_NAME(vogels_run)
+#define vogels_run_alone TP_NAME(vogels_run_alone)
+
+typedef struct PenaltyPool PenaltyPool;
+
+/**
+ * The line with the highest penalty among those scanned, as max_penalty
+ * reports it.
+ */
+typedef struct {
+    int row;            // Row of the line's minimum cost cell, -1 if no line is open
+    int col;            // Column of that cell, -1 if no line is open
+    TP_VALUE cost;      // Minimum cost of the line
+    TP_VALUE penalty;   // Penalty of the line, TP_MIN if no line is open
+} LinePick;
+
+/**
+ * One worker of the penalty pool, with the best row and column it found in
+ * its chunk during the last scan.
+ */
+typedef struct {
+    PenaltyPool *pool;
+    int id;
+    pthread_t thread;
+    Boolean started;  // FALSE for worker 0 and for any thread that failed to start
+    TP_VALUE *line;   // Scratch for one row or column of implicit or dummy costs
+    LinePick row_pick;
+    LinePick col_pick;
+} PenaltyWorker;
+
+/**
+ * A fixed set of threads that split every penalty scan between them. Worker
+ * w owns the w-th contiguous chunk of the rows and of the columns; the
+ * calling thread acts as worker 0. A scan is started by bumping generation
+ * and is over once pending drops to zero.
+ */
+struct PenaltyPool {
+    TP_PROBLEM *tp;
+    const uint64_t *row_done;
+    const uint64_t *col_done;
+    int num_workers;
+    PenaltyWorker *workers;
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t finish;
+    unsigned long generation;
+    int pending;
+    Boolean stop;
+};
+
+/**
+ * Allocates scratch space for one row or column of costs.
+ *
+ * @param tp Pointer to the TransportationProblem structure.
+ * @return Space for max(supply_size, demand_size) costs; release it with free().
+ */
+static TP_VALUE *alloc_line_buffer(
+        const TP_PROBLEM *tp
+) {
+    int len = (tp->supply_size > tp->demand_size) ? tp->supply_size : tp->demand_size;
+    TP_VALUE *line = (TP_VALUE *)malloc(((size_t)len + 1) * sizeof(TP_VALUE));
+
+    if (!line) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    return line;
+}
 
 /**
  * Computes the difference between the two smallest costs in a row or column.
@@ -11,160 +104,375 @@
  * @param index Index of the row or column.
  * @param len Length of the row or column.
  * @param is_row Boolean indicating whether to process a row (TRUE) or column (FALSE).
- * @param res Array to store the results: res[0] = min2 - min1, res[1] = min1, res[2] = index of min1.
+ * @param penalty Output min2 - min1, 0 with fewer than two open costs.
+ * @param min_cost Output min1.
+ * @param min_pos Output index of min1 within the line.
  * @param tp Pointer to the TransportationProblem structure.
- * @param row_done Array indicating completed rows.
- * @param col_done Array indicating completed columns.
+ * @param row_done Done mask of completed rows.
+ * @param col_done Done mask of completed columns.
+ * @param scratch Space for len costs, used for implicit costs and a dummy's line.
  */
 static void diff(
         int index,
         int len,
         Boolean is_row,
-        int *res,
-        TransportProblem *tp,
-        Boolean *row_done,
-        Boolean *col_done
+        TP_VALUE *penalty,
+        TP_VALUE *min_cost,
+        int *min_pos,
+        TP_PROBLEM *tp,
+        const uint64_t *row_done,
+        const uint64_t *col_done,
+        TP_VALUE *scratch
 ) {
-    int i, c;
-    int min1 = INT_MAX, min2 = INT_MAX, min_p = -1;
+    TP_VALUE min1, min2;
+    const uint64_t *crossing_done = is_row ? col_done : row_done;
+    int covered = is_row ? tp->cost_columns : tp->cost_rows;
+    // Rows come from the cost buffer, columns from its transposed copy, so
+    // either scan walks contiguous memory; implicit costs are evaluated
+    // into scratch a whole line at a time. A dummy point's cell is not
+    // stored and is taken in after the scan
+    const TP_VALUE *line = is_row ? TP_NAME(cost_row)(tp, index, scratch)
+                                  : TP_NAME(cost_column)(tp, index, scratch);
 
-    for (i = 0; i < len; ++i) {
-        if (is_row) {
-            if (col_done[i]) continue;
-            c = tp->cost_matrix[index][i];
-        } else {
-            if (row_done[i]) continue;
-            c = tp->cost_matrix[i][index];
-        }
-        if (c < min1) {
-            min2 = min1;
-            min1 = c;
-            min_p = i;
-        } else if (c < min2) {
-            min2 = c;
-        }
-    }
+    TP_NAME(line_min2)(line, crossing_done, covered, &min1, &min2, min_pos);
+    LINE_MIN2_ADD_DUMMY(crossing_done, covered, len, &min1, &min2, min_pos);
 
-    res[0] = (min2 != INT_MAX) ? (min2 - min1) : 0; // Handle cases with less than two costs
-    res[1] = min1;
-    res[2] = min_p;
+    *penalty = (min2 != TP_MAX) ? (min2 - min1) : 0; // Handle cases with less than two costs
+    *min_cost = min1;
 }
 
 /**
- * Finds the row or column with the maximum penalty.
+ * Finds the row or column with the maximum penalty among lines first..last-1.
+ * Ties go to the lowest index.
  * 
- * @param len1 Number of rows or columns.
+ * @param first First row or column to scan.
+ * @param last One past the last row or column to scan.
  * @param len2 Number of columns or rows.
  * @param is_row Boolean indicating whether to process rows (TRUE) or columns (FALSE).
- * @param res Array to store the results:
- *            res[0] = row or column index with maximum penalty,
- *            res[1] = position of minimum cost within that row or column,
- *            res[2] = minimum cost,
- *            res[3] = maximum penalty value.
+ * @param pick Output line with the maximum penalty and the cell of its minimum cost.
  * @param tp Pointer to the TransportationProblem structure.
- * @param row_done Array indicating completed rows.
- * @param col_done Array indicating completed columns.
+ * @param row_done Done mask of completed rows.
+ * @param col_done Done mask of completed columns.
+ * @param scratch Space for len2 costs, used for implicit costs and a dummy's line.
  */
 static void max_penalty(
-        int len1,
+        int first,
+        int last,
         int len2,
         Boolean is_row,
-        int *res,
-        TransportProblem *tp,
-        Boolean *row_done,
-        Boolean *col_done
+        LinePick *pick,
+        TP_PROBLEM *tp,
+        const uint64_t *row_done,
+        const uint64_t *col_done,
+        TP_VALUE *scratch
 ) {
-    int i;
-    int pc = -1, pm = -1, mc = -1;
-    int md = INT_MIN; // Maximum difference (penalty)
-    int res2[3];
-
-    for (i = 0; i < len1; ++i) {
-        if ((is_row && row_done[i]) || (!is_row && col_done[i])) continue;
-        diff(i, len2, is_row, res2, tp, row_done, col_done);
-        if (res2[0] > md) {
-            md = res2[0];  // Update maximum difference
-            pm = i;        // Index of row or column with maximum penalty
-            mc = res2[1];  // Minimum cost in that row or column
-            pc = res2[2];  // Position of minimum cost
+    int i, pos;
+    int pc = -1, pm = -1;
+    TP_VALUE mc = -1;
+    TP_VALUE md = TP_MIN; // Maximum difference (penalty)
+    TP_VALUE penalty, min_cost;
+
+    for (i = first; i < last; ++i) {
+        if (DONE_MASK_TEST(is_row ? row_done : col_done, i)) continue;
+        diff(i, len2, is_row, &penalty, &min_cost, &pos, tp, row_done, col_done, scratch);
+        if (penalty > md) {
+            md = penalty;   // Update maximum difference
+            pm = i;         // Index of row or column with maximum penalty
+            mc = min_cost;  // Minimum cost in that row or column
+            pc = pos;       // Position of minimum cost
         }
     }
 
-    if (is_row) {
-        res[0] = pm;
-        res[1] = pc;
+    pick->row = is_row ? pm : pc;
+    pick->col = is_row ? pc : pm;
+    pick->cost = mc;
+    pick->penalty = md;
+}
+
+/**
+ * Picks between the best row and the best column found by max_penalty.
+ * 
+ * @param cell Output pick whose row and col are the cell to allocate.
+ * @param row_pick Best row, as returned by max_penalty.
+ * @param col_pick Best column, as returned by max_penalty.
+ */
+static void choose_cell(
+        LinePick *cell,
+        const LinePick *row_pick,
+        const LinePick *col_pick
+) {
+    // Compare penalties and choose the one with the higher penalty
+    if (row_pick->penalty == col_pick->penalty) {
+        // If penalties are equal, choose the one with the lower cost
+        *cell = (row_pick->cost < col_pick->cost) ? *row_pick : *col_pick;
+    } else if (row_pick->penalty > col_pick->penalty) {
+        *cell = *col_pick;
     } else {
-        res[0] = pc;
-        res[1] = pm;
+        *cell = *row_pick;
     }
-    res[2] = mc;
-    res[3] = md;
 }
 
 /**
  * Determines the next cell to allocate based on the maximum penalty.
  * 
- * @param res Array to store the results: res[0] = row index, res[1] = column index.
+ * @param cell Output pick whose row and col are the cell to allocate.
  * @param tp Pointer to the TransportationProblem structure.
- * @param row_done Array indicating completed rows.
- * @param col_done Array indicating completed columns.
+ * @param row_done Done mask of completed rows.
+ * @param col_done Done mask of completed columns.
+ * @param scratch Space for one row or column, used for implicit costs and a dummy's line.
  */
 static void next_cell(
-        int *res,
-        TransportProblem *tp,
-        Boolean *row_done,
-        Boolean *col_done
+        LinePick *cell,
+        TP_PROBLEM *tp,
+        const uint64_t *row_done,
+        const uint64_t *col_done,
+        TP_VALUE *scratch
 ) {
-    int res1[4], res2[4];
-    int i;
+    LinePick row_pick, col_pick;
 
     // Find the row with the maximum penalty
-    max_penalty(tp->supply_size, tp->demand_size, TRUE, res1, tp, row_done, col_done);
+    max_penalty(0, tp->supply_size, tp->demand_size, TRUE, &row_pick, tp, row_done, col_done,
+                scratch);
     // Find the column with the maximum penalty
-    max_penalty(tp->demand_size, tp->supply_size, FALSE, res2, tp, row_done, col_done);
+    max_penalty(0, tp->demand_size, tp->supply_size, FALSE, &col_pick, tp, row_done, col_done,
+                scratch);
 
-    // Compare penalties and choose the one with the higher penalty
-    if (res1[3] == res2[3]) {
-        // If penalties are equal, choose the one with the lower cost
-        if (res1[2] < res2[2]) {
-            for (i = 0; i < 4; ++i) res[i] = res1[i];
-        } else {
-            for (i = 0; i < 4; ++i) res[i] = res2[i];
+    choose_cell(cell, &row_pick, &col_pick);
+}
+
+/**
+ * Scans one worker's chunk of the rows and of the columns.
+ *
+ * @param pool Pointer to the penalty pool.
+ * @param id Index of the worker whose chunk is scanned.
+ */
+static void scan_chunk(
+        PenaltyPool *pool,
+        int id
+) {
+    TP_PROBLEM *tp = pool->tp;
+    int m = tp->supply_size, n = tp->demand_size;
+    int t = pool->num_workers;
+    PenaltyWorker *w = &pool->workers[id];
+
+    max_penalty((int)((long long)m * id / t), (int)((long long)m * (id + 1) / t), n, TRUE,
+                &w->row_pick, tp, pool->row_done, pool->col_done, w->line);
+    max_penalty((int)((long long)n * id / t), (int)((long long)n * (id + 1) / t), m, FALSE,
+                &w->col_pick, tp, pool->row_done, pool->col_done, w->line);
+}
+
+/**
+ * Thread body of a pool worker: scans its chunk each time a new scan starts.
+ *
+ * @param arg Pointer to the worker's PenaltyWorker entry.
+ * @return NULL once the pool is stopped.
+ */
+static void *penalty_worker(
+        void *arg
+) {
+    PenaltyWorker *w = (PenaltyWorker *)arg;
+    PenaltyPool *pool = w->pool;
+    unsigned long seen = 0;
+
+    while (1) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seen && !pool->stop) {
+            pthread_cond_wait(&pool->start, &pool->lock);
         }
-    } else if (res1[3] > res2[3]) {
-        for (i = 0; i < 4; ++i) res[i] = res2[i];
-    } else {
-        for (i = 0; i < 4; ++i) res[i] = res1[i];
+        if (pool->stop) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        scan_chunk(pool, w->id);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->finish);
+        }
+        pthread_mutex_unlock(&pool->lock);
     }
 }
 
 /**
- * Solves the transportation problem using Vogel's Approximation Method.
- * 
+ * Starts the worker threads of a penalty pool. A thread that cannot be
+ * created is not fatal: its chunk is scanned by the calling thread instead.
+ *
+ * @param pool Pointer to the penalty pool to initialise.
+ * @param tp Pointer to the TransportationProblem structure.
+ * @param row_done Done mask of completed rows.
+ * @param col_done Done mask of completed columns.
+ * @param num_workers Number of chunks, including the calling thread's.
+ */
+static void init_penalty_pool(
+        PenaltyPool *pool,
+        TP_PROBLEM *tp,
+        const uint64_t *row_done,
+        const uint64_t *col_done,
+        int num_workers
+) {
+    int w;
+
+    pool->tp = tp;
+    pool->row_done = row_done;
+    pool->col_done = col_done;
+    pool->num_workers = num_workers;
+    pool->generation = 0;
+    pool->pending = 0;
+    pool->stop = FALSE;
+    pool->workers = (PenaltyWorker *)calloc(num_workers, sizeof(PenaltyWorker));
+    if (!pool->workers) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (pthread_mutex_init(&pool->lock, NULL) != 0 ||
+            pthread_cond_init(&pool->start, NULL) != 0 ||
+            pthread_cond_init(&pool->finish, NULL) != 0) {
+        fprintf(stderr, "Thread pool initialisation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (w = 0; w < num_workers; w++) {
+        pool->workers[w].pool = pool;
+        pool->workers[w].id = w;
+        pool->workers[w].line = alloc_line_buffer(tp);
+        pool->workers[w].started = (w > 0 &&
+                pthread_create(&pool->workers[w].thread, NULL, penalty_worker,
+                               &pool->workers[w]) == 0) ? TRUE : FALSE;
+    }
+}
+
+/**
+ * Stops and joins the worker threads and frees the pool.
+ *
+ * @param pool Pointer to the penalty pool.
+ */
+static void free_penalty_pool(
+        PenaltyPool *pool
+) {
+    int w;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = TRUE;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (w = 0; w < pool->num_workers; w++) {
+        if (pool->workers[w].started) {
+            pthread_join(pool->workers[w].thread, NULL);
+        }
+        free(pool->workers[w].line);
+    }
+    pthread_cond_destroy(&pool->finish);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+}
+
+/**
+ * Determines the next cell to allocate with the penalty scans split across
+ * the pool. Chunk results are merged in index order and only a strictly
+ * higher penalty replaces the current best, so the pick is the one
+ * next_cell makes.
+ *
+ * @param cell Output pick whose row and col are the cell to allocate.
+ * @param pool Pointer to the penalty pool.
+ */
+static void next_cell_parallel(
+        LinePick *cell,
+        PenaltyPool *pool
+) {
+    LinePick row_pick = {-1, -1, -1, TP_MIN};
+    LinePick col_pick = {-1, -1, -1, TP_MIN};
+    int w, started = 0;
+
+    for (w = 0; w < pool->num_workers; w++) {
+        if (pool->workers[w].started) started++;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->generation++;
+    pool->pending = started;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    // The calling thread scans its own chunk and those of missing threads
+    for (w = 0; w < pool->num_workers; w++) {
+        if (!pool->workers[w].started) scan_chunk(pool, w);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->finish, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    for (w = 0; w < pool->num_workers; w++) {
+        if (pool->workers[w].row_pick.penalty > row_pick.penalty) {
+            row_pick = pool->workers[w].row_pick;
+        }
+        if (pool->workers[w].col_pick.penalty > col_pick.penalty) {
+            col_pick = pool->workers[w].col_pick;
+        }
+    }
+
+    choose_cell(cell, &row_pick, &col_pick);
+}
+
+/**
+ * Runs Vogel's Approximation Method, scanning penalties serially or, when
+ * num_threads is above one, across a penalty pool. The scratch arrays come
+ * from the workspace; pool workers keep line buffers of their own.
+ *
+ * @param ws Workspace the problem fits in; reset first.
  * @param tp Pointer to the TransportationProblem structure containing supply, demand, and cost matrix.
- * @param results Pre-allocated 2D array to store the allocation results.
+ * @param solution Solution to fill with the allocated cells; emptied first.
+ * @param total_cost Receives the total cost of the transportation plan.
+ * @param num_threads Number of threads sharing each penalty scan.
  * @param print_iterations Boolean flag to enable/disable printing each iteration.
- * @return Total cost of the transportation plan.
+ * @return SOLVER_OK, SOLVER_TOO_LARGE, SOLVER_NO_OPEN_CELL with the plan
+ *         allocated so far, or SOLVER_COST_OVERFLOW (with the solution
+ *         emptied) if the total cost does not fit.
  */
-int vogels_approximation_method(
-        TransportProblem *tp,
-        int **results,
+static SolverStatus vogels_run(
+        SolverWorkspace *ws,
+        TP_PROBLEM *tp,
+        TP_SOLUTION *solution,
+        TP_VALUE *total_cost,
+        int num_threads,
         Boolean print_iterations
 ) {
     int i, j;
-    int *supply = (int *)malloc(tp->supply_size * sizeof(int));
-    int *demand = (int *)malloc(tp->demand_size * sizeof(int));
-    Boolean *row_done = (Boolean *)calloc(tp->supply_size, sizeof(Boolean));
-    Boolean *col_done = (Boolean *)calloc(tp->demand_size, sizeof(Boolean));
-    int total_cost = 0;
-    int supply_left = 0;
-    int cell[4];
+    int len = (tp->supply_size > tp->demand_size) ? tp->supply_size : tp->demand_size;
+    TP_VALUE supply_left = 0;
+    int open_rows = tp->supply_size, open_cols = tp->demand_size;
+    LinePick cell;
     int iteration = 0;
+    PenaltyPool pool;
+    SolverStatus status = SOLVER_OK;
+    TP_WIDE plan_cost = 0;
 
-    // Check for memory allocation success
-    if (!supply || !demand || !row_done || !col_done) {
-        fprintf(stderr, "Memory allocation failed.\n");
-        exit(EXIT_FAILURE);
+    if (check_workspace_fits(ws, tp->supply_size, tp->demand_size) != SOLVER_OK) {
+        return SOLVER_TOO_LARGE;
+    }
+    reset_solver_workspace(ws);
+
+    TP_VALUE *supply = (TP_VALUE *)workspace_alloc(ws, tp->supply_size * sizeof(TP_VALUE));
+    TP_VALUE *demand = (TP_VALUE *)workspace_alloc(ws, tp->demand_size * sizeof(TP_VALUE));
+    uint64_t *row_done = workspace_done_mask(ws, tp->supply_size);
+    uint64_t *col_done = workspace_done_mask(ws, tp->demand_size);
+    TP_VALUE *line = (TP_VALUE *)workspace_alloc(ws, ((size_t)len + 1) * sizeof(TP_VALUE));
+
+    if (!supply || !demand || !row_done || !col_done || !line) {
+        return SOLVER_TOO_LARGE;
+    }
+
+    // Column penalties scan the column-major copy (none with implicit costs)
+    TP_NAME(build_cost_transpose)(tp);
+    if (num_threads > 1) {
+        init_penalty_pool(&pool, tp, row_done, col_done, num_threads);
     }
 
     // Copy supply and demand to local arrays to avoid modifying the original data
@@ -176,64 +484,199 @@ int vogels_approximation_method(
         demand[j] = tp->demand[j];
     }
 
-    // Initialize results matrix to zeros
-    for (i = 0; i < tp->supply_size; i++) {
-        for (j = 0; j < tp->demand_size; j++) {
-            results[i][j] = 0;
-        }
-    }
+    TP_NAME(clear_solution)(solution);
+    *total_cost = 0;
 
     // Main loop to compute the transportation plan
-    while (supply_left > 0 && iteration < MAX_ITERATIONS) {
+    // Every allocation closes a row or a column, so this runs at most m + n times.
+    // In a balanced problem supply is left only while a row and a column are
+    // open; the counts also stop double precision once the lines run out, as
+    // rounding can leave a trace of supply behind
+    while (supply_left > 0 && open_rows > 0 && open_cols > 0) {
         iteration++;
         // Determine the next cell to allocate
-        next_cell(cell, tp, row_done, col_done);
-        int r = cell[0]; // Row index
-        int c = cell[1]; // Column index
+        if (num_threads > 1) {
+            next_cell_parallel(&cell, &pool);
+        } else {
+            next_cell(&cell, tp, row_done, col_done, line);
+        }
+        int r = cell.row; // Row index
+        int c = cell.col; // Column index
+        if (r < 0 || c < 0) {
+            status = SOLVER_NO_OPEN_CELL;
+            break;
+        }
 
         // Determine the allocation quantity
-        int q = (demand[c] <= supply[r]) ? demand[c] : supply[r];
+        TP_VALUE q = (demand[c] <= supply[r]) ? demand[c] : supply[r];
 
         // Update demand and supply
         demand[c] -= q;
-        if (demand[c] == 0) col_done[c] = TRUE;
+        if (demand[c] == 0) {
+            DONE_MASK_SET(col_done, c);
+            open_cols--;
+        }
         supply[r] -= q;
-        if (supply[r] == 0) row_done[r] = TRUE;
+        if (supply[r] == 0) {
+            DONE_MASK_SET(row_done, r);
+            open_rows--;
+        }
 
-        // Store the allocation in the results matrix
-        results[r][c] = q;
+        // Record the allocation in the solution
+        TP_NAME(add_to_solution)(solution, r, c, q);
 
         // Update the remaining supply
         supply_left -= q;
 
         // Update total cost
-        total_cost += q * tp->cost_matrix[r][c];
+        plan_cost += (TP_WIDE)q * TP_COST_AT(tp, r, c);
 
         // Print iteration details if enabled
         if (print_iterations) {
             printf("Iteration %d:\n", iteration);
-            printf("  Allocated %d units to cell (%d, %d) with cost %d.\n", q, r, c, tp->cost_matrix[r][c]);
+            printf("  Allocated " TP_FMT " units to cell (%d, %d) with cost " TP_FMT ".\n",
+                   TP_PRINT(q), r, c, TP_PRINT(TP_COST_AT(tp, r, c)));
             printf("  Remaining Supply: ");
             for (i = 0; i < tp->supply_size; i++) {
-                printf("%d ", supply[i]);
+                printf(TP_FMT " ", TP_PRINT(supply[i]));
             }
             printf("\n  Remaining Demand: ");
             for (i = 0; i < tp->demand_size; i++) {
-                printf("%d ", demand[i]);
+                printf(TP_FMT " ", TP_PRINT(demand[i]));
             }
             printf("\n\n");
         }
     }
 
-    if (iteration == MAX_ITERATIONS) {
-        fprintf(stderr, "Maximum iterations reached. Possible issue with the transportation problem.\n");
+    if (num_threads > 1) {
+        free_penalty_pool(&pool);
+    }
+
+    if (!TP_FITS(plan_cost)) {
+        TP_NAME(clear_solution)(solution);
+        return SOLVER_COST_OVERFLOW;
     }
+    *total_cost = (TP_VALUE)plan_cost;
+    return status;
+}
 
-    // Free allocated memory
-    free(supply);
-    free(demand);
-    free(row_done);
-    free(col_done);
+/**
+ * Runs vogels_run() in a workspace of its own. Running out of open cells is
+ * reported and the partial plan kept; any other failure exits.
+ *
+ * @param tp Pointer to the TransportationProblem structure containing supply, demand, and cost matrix.
+ * @param solution Solution to fill with the allocated cells; emptied first.
+ * @param num_threads Number of threads sharing each penalty scan.
+ * @param print_iterations Boolean flag to enable/disable printing each iteration.
+ * @return Total cost of the transportation plan.
+ */
+static TP_VALUE vogels_run_alone(
+        TP_PROBLEM *tp,
+        TP_SOLUTION *solution,
+        int num_threads,
+        Boolean print_iterations
+) {
+    SolverWorkspace ws;
+    TP_VALUE total_cost = 0;
+    SolverStatus status = init_solver_workspace(&ws, tp->supply_size, tp->demand_size);
 
+    if (status == SOLVER_OK) {
+        status = vogels_run(&ws, tp, solution, &total_cost, num_threads, print_iterations);
+    }
+    free_solver_workspace(&ws);
+    if (status != SOLVER_OK) {
+        fprintf(stderr, "%s\n", solver_status_message(status));
+        if (status != SOLVER_NO_OPEN_CELL) {
+            exit(EXIT_FAILURE);
+        }
+    }
     return total_cost;
 }
+
+/**
+ * Solves the transportation problem using Vogel's Approximation Method, with
+ * scratch space taken from a workspace.
+ *
+ * @param ws Workspace the problem fits in; reset first.
+ * @param tp Pointer to the TransportationProblem structure containing supply, demand, and cost matrix.
+ * @param solution Solution to fill with the allocated cells; emptied first.
+ * @param total_cost Receives the total cost of the transportation plan.
+ * @param print_iterations Boolean flag to enable/disable printing each iteration.
+ * @return SOLVER_OK, SOLVER_TOO_LARGE, SOLVER_NO_OPEN_CELL with the plan
+ *         allocated so far, or SOLVER_COST_OVERFLOW (with the solution
+ *         emptied) if the total cost does not fit.
+ */
+SolverStatus TP_NAME(vogels_solve)(
+        SolverWorkspace *ws,
+        TP_PROBLEM *tp,
+        TP_SOLUTION *solution,
+        TP_VALUE *total_cost,
+        Boolean print_iterations
+) {
+    return vogels_run(ws, tp, solution, total_cost, 1, print_iterations);
+}
+
+/**
+ * Solves the transportation problem using Vogel's Approximation Method.
+ * 
+ * @param tp Pointer to the TransportationProblem structure containing supply, demand, and cost matrix.
+ * @param solution Solution to fill with the allocated cells; emptied first.
+ * @param print_iterations Boolean flag to enable/disable printing each iteration.
+ * @return Total cost of the transportation plan.
+ */
+TP_VALUE TP_NAME(vogels_approximation_method)(
+        TP_PROBLEM *tp,
+        TP_SOLUTION *solution,
+        Boolean print_iterations
+) {
+    return vogels_run_alone(tp, solution, 1, print_iterations);
+}
+
+/**
+ * Solves the transportation problem using Vogel's Approximation Method with
+ * every penalty scan split across a pool of threads. Each thread takes a
+ * contiguous chunk of the live rows and columns; the allocations are the
+ * same as those of vogels_approximation_method.
+ * 
+ * @param tp Pointer to the TransportationProblem structure containing supply, demand, and cost matrix.
+ * @param solution Solution to fill with the allocated cells; emptied first.
+ * @param num_threads Number of threads to use; 0 or less uses one per online processor.
+ * @param print_iterations Boolean flag to enable/disable printing each iteration.
+ * @return Total cost of the transportation plan.
+ */
+TP_VALUE TP_NAME(vogels_parallel_method)(
+        TP_PROBLEM *tp,
+        TP_SOLUTION *solution,
+        int num_threads,
+        Boolean print_iterations
+) {
+    int lines = (tp->supply_size > tp->demand_size) ? tp->supply_size : tp->demand_size;
+
+    if (num_threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (online > 0) ? (int)online : 1;
+    }
+    // More chunks than lines would only add idle threads
+    if (num_threads > lines) {
+        num_threads = (lines > 0) ? lines : 1;
+    }
+    return vogels_run_alone(tp, solution, num_threads, print_iterations);
+}
+
+#undef LinePick
+#undef PenaltyWorker
+#undef PenaltyPool
+#undef alloc_line_buffer
+#undef diff
+#undef max_penalty
+#undef choose_cell
+#undef next_cell
+#undef scan_chunk
+#undef penalty_worker
+#undef init_penalty_pool
+#undef free_penalty_pool
+#undef next_cell_parallel
+#undef vogels_run
+#undef vogels_run_alone
+
+#endif // TP_TEMPLATE
@@ -0,0 +1,598 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include "transport.h"
+#include "workspace.h"
+
+/*
+ * Vogel's Approximation Method with incremental penalties.
+ *
+ * Every row keeps its columns sorted by (cost, index) and every column its
+ * rows, together with the positions of the first two lines still open. A
+ * line's penalty, minimum and argmin follow directly from those two
+ * entries, exactly as diff() computes them in vogels.c. Live rows and live
+ * columns each sit in an indexed max-heap ordered by penalty and then by
+ * lowest index, which is the order max_penalty() scans in. When a line
+ * closes only the crossing lines whose first two entries include it are
+ * advanced and re-keyed, so the allocations match
+ * vogels_approximation_method cell for cell at a fraction of the work.
+ *
+ * Sorted lines would take two cost matrices' worth of memory, which a
+ * problem with implicit costs is meant to avoid. Its lines keep only their
+ * first two open entries instead, and a line whose first or second entry
+ * closes is evaluated again in one batch to find the next two.
+ */
+
+/**
+ * The sorted candidates and heap of one direction (all rows or all columns).
+ */
+typedef struct {
+    int count;          // Number of lines
+    int len;            // Entries per line (the crossing dimension)
+    int *sorted;        // count x len crossing indices, each line by (cost, index); NULL if implicit
+    const int *cost;    // covered_count x covered_len costs, row-major by line; NULL if implicit
+    int covered_count;  // Lines the costs cover; a dummy line past them costs 0 throughout
+    int covered_len;    // Entries the costs cover; a dummy entry past them costs 0
+    int *pos1, *pos2;   // First and second open entry of each line (len if none); with
+                        // implicit costs these are crossing indices, not sorted positions
+    int *min_cost;      // Cost of the first open entry, INT_MAX if none
+    int *penalty;       // min2 - min1, or 0 with fewer than two open entries
+    int *heap;          // Live lines, best first
+    int *heap_pos;      // Position of each line in heap, -1 once closed
+    int heap_size;
+
+    const TransportProblem *tp;  // Implicit costs: evaluated a line at a time
+    Boolean is_row;
+    int *scratch;                // One line of costs with any dummy entry filled in
+} LineSet;
+
+/**
+ * Sorts the crossing indices of one line by cost with a stable LSD radix
+ * sort, so equal costs keep ascending index order.
+ *
+ * @param cost Costs of the line.
+ * @param len Number of entries.
+ * @param out Receives the sorted indices.
+ * @param buf Scratch of 2 * len keys.
+ */
+static void sort_line(
+        const int *cost,
+        int len,
+        int *out,
+        uint64_t *buf
+) {
+    uint64_t *src = buf, *dst = buf + len, *tmp;
+    size_t counts[256];
+    uint32_t key;
+    int i, b, shift;
+
+    // Flipping the sign bit makes unsigned order match signed order
+    for (i = 0; i < len; i++) {
+        key = (uint32_t)cost[i] ^ 0x80000000u;
+        src[i] = ((uint64_t)key << 32) | (uint32_t)i;
+    }
+    for (shift = 32; shift < 64; shift += 8) {
+        memset(counts, 0, sizeof(counts));
+        for (i = 0; i < len; i++) {
+            counts[(src[i] >> shift) & 0xFF]++;
+        }
+        if (len > 0 && counts[(src[0] >> shift) & 0xFF] == (size_t)len) {
+            continue;  // Every key shares this byte
+        }
+        size_t sum = 0, c;
+        for (b = 0; b < 256; b++) {
+            c = counts[b];
+            counts[b] = sum;
+            sum += c;
+        }
+        for (i = 0; i < len; i++) {
+            dst[counts[(src[i] >> shift) & 0xFF]++] = src[i];
+        }
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    for (i = 0; i < len; i++) {
+        out[i] = (int)(uint32_t)src[i];
+    }
+}
+
+/**
+ * Tells whether line a ranks above line b: higher penalty first, then the
+ * lower index.
+ *
+ * @param ls Pointer to the line set.
+ * @param a First line.
+ * @param b Second line.
+ * @return TRUE if a ranks above b.
+ */
+static Boolean line_before(
+        const LineSet *ls,
+        int a,
+        int b
+) {
+    if (ls->penalty[a] != ls->penalty[b]) {
+        return (ls->penalty[a] > ls->penalty[b]) ? TRUE : FALSE;
+    }
+    return (a < b) ? TRUE : FALSE;
+}
+
+/**
+ * Moves the heap entry at position i down to where it belongs.
+ *
+ * @param ls Pointer to the line set.
+ * @param i Heap position.
+ */
+static void heap_sift_down(
+        LineSet *ls,
+        int i
+) {
+    int line = ls->heap[i], child;
+
+    while ((child = 2 * i + 1) < ls->heap_size) {
+        if (child + 1 < ls->heap_size && line_before(ls, ls->heap[child + 1], ls->heap[child])) {
+            child++;
+        }
+        if (!line_before(ls, ls->heap[child], line)) break;
+        ls->heap[i] = ls->heap[child];
+        ls->heap_pos[ls->heap[i]] = i;
+        i = child;
+    }
+    ls->heap[i] = line;
+    ls->heap_pos[line] = i;
+}
+
+/**
+ * Restores heap order over all live lines.
+ *
+ * @param ls Pointer to the line set.
+ */
+static void heapify(
+        LineSet *ls
+) {
+    int i;
+
+    for (i = ls->heap_size / 2 - 1; i >= 0; i--) {
+        heap_sift_down(ls, i);
+    }
+}
+
+/**
+ * Removes a closed line from the heap. The last entry fills the gap, so
+ * the caller re-establishes heap order with heapify().
+ *
+ * @param ls Pointer to the line set.
+ * @param line Line to remove.
+ */
+static void heap_remove(
+        LineSet *ls,
+        int line
+) {
+    int i = ls->heap_pos[line];
+
+    ls->heap_pos[line] = -1;
+    ls->heap_size--;
+    if (i < ls->heap_size) {
+        ls->heap[i] = ls->heap[ls->heap_size];
+        ls->heap_pos[ls->heap[i]] = i;
+    }
+}
+
+/**
+ * Gives the crossing index of an open-entry position of a line.
+ *
+ * @param ls Pointer to the line set.
+ * @param line Line to read.
+ * @param pos pos1 or pos2 of the line.
+ * @return Crossing index, -1 if the position is past the end.
+ */
+static int entry_at(
+        const LineSet *ls,
+        int line,
+        int pos
+) {
+    if (pos >= ls->len) {
+        return -1;
+    }
+    return ls->sorted ? ls->sorted[(size_t)line * ls->len + pos] : pos;
+}
+
+/**
+ * Gives the cost of an entry of a line.
+ *
+ * @param ls Pointer to the line set; costs stored.
+ * @param line Line to read.
+ * @param k Crossing index.
+ * @return The cost, 0 for a dummy point's cell.
+ */
+static int line_cost(
+        const LineSet *ls,
+        int line,
+        int k
+) {
+    if (line >= ls->covered_count || k >= ls->covered_len) {
+        return 0;
+    }
+    return ls->cost[(size_t)line * ls->covered_len + k];
+}
+
+/**
+ * Gives all len costs of a line, with the zero cost of a dummy crossing
+ * line filled in after the covered entries.
+ *
+ * @param ls Pointer to the line set.
+ * @param line Line to read.
+ * @return The costs; valid until the scratch line is reused.
+ */
+static const int *full_line(
+        LineSet *ls,
+        int line
+) {
+    const int *cost = ls->is_row ? cost_row(ls->tp, line, ls->scratch)
+                                 : cost_column(ls->tp, line, ls->scratch);
+
+    if (ls->covered_len == ls->len) {
+        return cost;
+    }
+    if (cost != ls->scratch) {
+        memcpy(ls->scratch, cost, ls->covered_len * sizeof(int));
+    }
+    memset(&ls->scratch[ls->covered_len], 0, (ls->len - ls->covered_len) * sizeof(int));
+    return ls->scratch;
+}
+
+/**
+ * Finds a line's first two open entries, in (cost, index) order, by
+ * evaluating its implicit costs again.
+ *
+ * @param ls Pointer to the line set.
+ * @param line Line to refresh.
+ * @param crossing_done Closed flags of the crossing lines.
+ */
+static void refresh_implicit_line(
+        LineSet *ls,
+        int line,
+        const Boolean *crossing_done
+) {
+    const int *cost = full_line(ls, line);
+    int a1 = ls->len, a2 = ls->len, k;
+
+    // Only a strictly lower cost moves an entry, so ties keep the lower index
+    for (k = 0; k < ls->len; k++) {
+        if (crossing_done[k]) continue;
+        if (a1 == ls->len || cost[k] < cost[a1]) {
+            a2 = a1;
+            a1 = k;
+        } else if (a2 == ls->len || cost[k] < cost[a2]) {
+            a2 = k;
+        }
+    }
+    ls->pos1[line] = a1;
+    ls->pos2[line] = a2;
+    ls->min_cost[line] = (a1 < ls->len) ? cost[a1] : INT_MAX;
+    ls->penalty[line] = (a2 < ls->len) ? cost[a2] - cost[a1] : 0;
+}
+
+/**
+ * Moves a line's first two open entries past closed crossing lines and
+ * recomputes its penalty.
+ *
+ * @param ls Pointer to the line set.
+ * @param line Line to refresh.
+ * @param crossing_done Closed flags of the crossing lines.
+ */
+static void refresh_line(
+        LineSet *ls,
+        int line,
+        const Boolean *crossing_done
+) {
+    if (!ls->sorted) {
+        refresh_implicit_line(ls, line, crossing_done);
+        return;
+    }
+
+    const int *sorted = &ls->sorted[(size_t)line * ls->len];
+    int p1 = ls->pos1[line], p2 = ls->pos2[line];
+
+    while (p1 < ls->len && crossing_done[sorted[p1]]) p1++;
+    if (p2 <= p1) p2 = p1 + 1;
+    while (p2 < ls->len && crossing_done[sorted[p2]]) p2++;
+    ls->pos1[line] = p1;
+    ls->pos2[line] = p2;
+    ls->min_cost[line] = (p1 < ls->len) ? line_cost(ls, line, sorted[p1]) : INT_MAX;
+    ls->penalty[line] = (p2 < ls->len) ?
+                        line_cost(ls, line, sorted[p2]) - line_cost(ls, line, sorted[p1]) : 0;
+}
+
+/**
+ * Reports a line's minimum cost and its position, as diff() would.
+ *
+ * @param ls Pointer to the line set.
+ * @param line Line to read.
+ * @param min_cost Receives the minimum open cost, INT_MAX if none.
+ * @return Crossing index of the minimum, -1 if none.
+ */
+static int line_min(
+        const LineSet *ls,
+        int line,
+        int *min_cost
+) {
+    *min_cost = ls->min_cost[line];
+    return entry_at(ls, line, ls->pos1[line]);
+}
+
+/**
+ * Frees a line set.
+ *
+ * @param ls Pointer to the line set.
+ */
+static void free_line_set(
+        LineSet *ls
+) {
+    free(ls->sorted);
+    free(ls->scratch);
+    free(ls->pos1);
+    free(ls->pos2);
+    free(ls->min_cost);
+    free(ls->penalty);
+    free(ls->heap);
+    free(ls->heap_pos);
+}
+
+/**
+ * Sorts every line (or, with implicit costs, finds the first two entries
+ * of every line), sets up the open-entry positions and builds the heap.
+ *
+ * @param ls Pointer to the line set to initialise.
+ * @param tp Pointer to the TransportationProblem structure; costs transposed if stored.
+ * @param is_row TRUE for the rows, FALSE for the columns.
+ * @param crossing_done Closed flags of the crossing lines, all FALSE.
+ * @return SOLVER_OK, or SOLVER_OUT_OF_MEMORY with nothing left allocated.
+ */
+static SolverStatus init_line_set(
+        LineSet *ls,
+        const TransportProblem *tp,
+        Boolean is_row,
+        const Boolean *crossing_done
+) {
+    int count = is_row ? tp->supply_size : tp->demand_size;
+    int len = is_row ? tp->demand_size : tp->supply_size;
+    const int *cost = is_row ? tp->cost : tp->cost_transposed;
+    uint64_t *buf = NULL;
+    int i;
+
+    ls->count = count;
+    ls->len = len;
+    ls->cost = cost;
+    ls->covered_count = is_row ? tp->cost_rows : tp->cost_columns;
+    ls->covered_len = is_row ? tp->cost_columns : tp->cost_rows;
+    ls->tp = tp;
+    ls->is_row = is_row;
+    ls->sorted = NULL;
+    ls->scratch = (int *)malloc(((size_t)len + 1) * sizeof(int));
+    if (cost) {
+        buf = (uint64_t *)malloc((2 * (size_t)len + 1) * sizeof(uint64_t));
+        ls->sorted = (int *)malloc(((size_t)count * len + 1) * sizeof(int));
+    }
+    ls->pos1 = (int *)malloc((count + 1) * sizeof(int));
+    ls->pos2 = (int *)malloc((count + 1) * sizeof(int));
+    ls->min_cost = (int *)malloc((count + 1) * sizeof(int));
+    ls->penalty = (int *)malloc((count + 1) * sizeof(int));
+    ls->heap = (int *)malloc((count + 1) * sizeof(int));
+    ls->heap_pos = (int *)malloc((count + 1) * sizeof(int));
+    if ((cost && (!buf || !ls->sorted)) || !ls->scratch || !ls->pos1 || !ls->pos2 ||
+            !ls->min_cost || !ls->penalty || !ls->heap || !ls->heap_pos) {
+        free(buf);
+        free_line_set(ls);
+        return SOLVER_OUT_OF_MEMORY;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (cost) {
+            sort_line(full_line(ls, i), len, &ls->sorted[(size_t)i * len], buf);
+            ls->pos1[i] = 0;
+            ls->pos2[i] = 1;
+        }
+        refresh_line(ls, i, crossing_done);
+        ls->heap[i] = i;
+        ls->heap_pos[i] = i;
+    }
+    ls->heap_size = count;
+    heapify(ls);
+
+    free(buf);
+    return SOLVER_OK;
+}
+
+/**
+ * Closes a line and re-keys every crossing line that had it among its
+ * first two open entries.
+ *
+ * @param closed Line set the closed line belongs to.
+ * @param line Line being closed.
+ * @param crossing Line set of the other direction.
+ * @param done Closed flags of closed's lines; line is marked here.
+ */
+static void close_line(
+        LineSet *closed,
+        int line,
+        LineSet *crossing,
+        Boolean *done
+) {
+    int k, x;
+
+    done[line] = TRUE;
+    heap_remove(closed, line);
+    heapify(closed);
+    for (k = 0; k < crossing->heap_size; k++) {
+        x = crossing->heap[k];
+        if (entry_at(crossing, x, crossing->pos1[x]) == line ||
+                entry_at(crossing, x, crossing->pos2[x]) == line) {
+            refresh_line(crossing, x, done);
+        }
+    }
+    // Re-keyed in place during the scan; one bottom-up pass restores the order
+    heapify(crossing);
+}
+
+/**
+ * Solves the transportation problem using Vogel's Approximation Method with
+ * incrementally maintained penalties.
+ *
+ * Produces the same allocations as vogels_approximation_method, including
+ * its tie-breaking, but each iteration only touches the lines affected by
+ * the rows and columns it closes, and there is no iteration cap. With
+ * implicit costs it keeps only two entries per line and memory stays
+ * linear in the number of points.
+ *
+ * @param tp Pointer to the TransportationProblem structure containing supply, demand, and cost matrix.
+ * @param solution Solution to fill with the allocated cells; emptied first.
+ * @param total_cost Receives the total cost of the transportation plan.
+ * @param print_iterations Boolean flag to enable/disable printing each iteration.
+ * @return SOLVER_OK, SOLVER_NO_OPEN_CELL with the plan allocated so far,
+ *         SOLVER_OUT_OF_MEMORY if the line sets cannot be allocated, or
+ *         SOLVER_COST_OVERFLOW (with the solution emptied) if the total cost
+ *         does not fit.
+ */
+SolverStatus vogels_incremental_solve(
+        TransportProblem *tp,
+        Solution *solution,
+        int *total_cost,
+        Boolean print_iterations
+) {
+    int m = tp->supply_size, n = tp->demand_size;
+    int i, j, r, c, q, row_min, col_min, row_arg, col_arg;
+    int *supply = (int *)malloc((m + 1) * sizeof(int));
+    int *demand = (int *)malloc((n + 1) * sizeof(int));
+    Boolean *row_done = (Boolean *)calloc(m + 1, sizeof(Boolean));
+    Boolean *col_done = (Boolean *)calloc(n + 1, sizeof(Boolean));
+    long long plan_cost = 0;
+    int supply_left = 0;
+    int iteration = 0;
+    LineSet rows, cols;
+    SolverStatus status = SOLVER_OK;
+
+    if (!supply || !demand || !row_done || !col_done) {
+        status = SOLVER_OUT_OF_MEMORY;
+    } else {
+        build_cost_transpose(tp);
+        status = init_line_set(&rows, tp, TRUE, col_done);
+        if (status == SOLVER_OK) {
+            status = init_line_set(&cols, tp, FALSE, row_done);
+            if (status != SOLVER_OK) {
+                free_line_set(&rows);
+            }
+        }
+    }
+    if (status != SOLVER_OK) {
+        free(supply);
+        free(demand);
+        free(row_done);
+        free(col_done);
+        return status;
+    }
+
+    for (i = 0; i < m; i++) {
+        supply[i] = tp->supply[i];
+        supply_left += supply[i];
+    }
+    for (j = 0; j < n; j++) {
+        demand[j] = tp->demand[j];
+    }
+    clear_solution(solution);
+
+    while (supply_left > 0 && rows.heap_size > 0 && cols.heap_size > 0) {
+        iteration++;
+
+        // The best row and the best column, compared as next_cell() does
+        // (the side with the smaller penalty wins, ties on the lower cost)
+        row_arg = line_min(&rows, rows.heap[0], &row_min);
+        col_arg = line_min(&cols, cols.heap[0], &col_min);
+        if (rows.penalty[rows.heap[0]] == cols.penalty[cols.heap[0]]) {
+            if (row_min < col_min) {
+                r = rows.heap[0];
+                c = row_arg;
+            } else {
+                r = col_arg;
+                c = cols.heap[0];
+            }
+        } else if (rows.penalty[rows.heap[0]] > cols.penalty[cols.heap[0]]) {
+            r = col_arg;
+            c = cols.heap[0];
+        } else {
+            r = rows.heap[0];
+            c = row_arg;
+        }
+        if (r < 0 || c < 0) {
+            status = SOLVER_NO_OPEN_CELL;
+            break;
+        }
+
+        q = (demand[c] <= supply[r]) ? demand[c] : supply[r];
+        demand[c] -= q;
+        supply[r] -= q;
+        add_to_solution(solution, r, c, q);
+        supply_left -= q;
+        plan_cost += (long long)q * COST_AT(tp, r, c);
+
+        if (demand[c] == 0) close_line(&cols, c, &rows, col_done);
+        if (supply[r] == 0) close_line(&rows, r, &cols, row_done);
+
+        if (print_iterations) {
+            printf("Iteration %d:\n", iteration);
+            printf("  Allocated %d units to cell (%d, %d) with cost %d.\n", q, r, c, COST_AT(tp, r, c));
+            printf("  Remaining Supply: ");
+            for (i = 0; i < m; i++) {
+                printf("%d ", supply[i]);
+            }
+            printf("\n  Remaining Demand: ");
+            for (i = 0; i < n; i++) {
+                printf("%d ", demand[i]);
+            }
+            printf("\n\n");
+        }
+    }
+
+    free_line_set(&rows);
+    free_line_set(&cols);
+    free(supply);
+    free(demand);
+    free(row_done);
+    free(col_done);
+
+    if (plan_cost > INT_MAX || plan_cost < INT_MIN) {
+        clear_solution(solution);
+        return SOLVER_COST_OVERFLOW;
+    }
+    *total_cost = (int)plan_cost;
+    return status;
+}
+
+/**
+ * Solves the transportation problem with vogels_incremental_solve().
+ * Running out of open cells is reported and the partial plan kept; an
+ * overflowing total cost or a failed allocation exits.
+ *
+ * @param tp Pointer to the TransportationProblem structure containing supply, demand, and cost matrix.
+ * @param solution Solution to fill with the allocated cells; emptied first.
+ * @param print_iterations Boolean flag to enable/disable printing each iteration.
+ * @return Total cost of the transportation plan.
+ */
+int vogels_incremental_method(
+        TransportProblem *tp,
+        Solution *solution,
+        Boolean print_iterations
+) {
+    int total_cost = 0;
+    SolverStatus status = vogels_incremental_solve(tp, solution, &total_cost, print_iterations);
+
+    if (status != SOLVER_OK) {
+        fprintf(stderr, "%s\n", solver_status_message(status));
+        if (status != SOLVER_NO_OPEN_CELL) {
+            exit(EXIT_FAILURE);
+        }
+    }
+    return total_cost;
+}
@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "workspace.h"
+#include "line_kernels.h"
+
+/** Alignment of every block handed out, a cache line. */
+#define WORKSPACE_ALIGN 64
+
+/** Rounds a byte count up to the block alignment. */
+#define ALIGN_UP(bytes) (((bytes) + (WORKSPACE_ALIGN - 1)) & ~(size_t)(WORKSPACE_ALIGN - 1))
+
+/**
+ * Initialises a workspace for problems of up to max_supply_size x
+ * max_demand_size points, with room for the dummy point balancing adds.
+ * The arena holds what the largest user needs, the Least Cost Method:
+ * supply and demand copies, two done masks, a line buffer and the row
+ * minima with their columns, all at the widest precision.
+ *
+ * @param ws Pointer to the workspace structure.
+ * @param max_supply_size Largest number of supply points.
+ * @param max_demand_size Largest number of demand points.
+ * @return SOLVER_OK, or SOLVER_OUT_OF_MEMORY with the workspace left empty.
+ */
+SolverStatus init_solver_workspace(
+        SolverWorkspace *ws,
+        int max_supply_size,
+        int max_demand_size
+) {
+    size_t m = (size_t)max_supply_size + 1;
+    size_t n = (size_t)max_demand_size + 1;
+    size_t line = ((m > n) ? m : n) + 1;
+    size_t value = sizeof(int64_t);
+
+    ws->size = ALIGN_UP(m * value) + ALIGN_UP(n * value) +
+               ALIGN_UP((DONE_MASK_WORDS(m) + 1) * sizeof(uint64_t)) +
+               ALIGN_UP((DONE_MASK_WORDS(n) + 1) * sizeof(uint64_t)) +
+               ALIGN_UP(line * value) + ALIGN_UP((m + 1) * value) +
+               ALIGN_UP((m + 1) * sizeof(int));
+    ws->used = 0;
+    ws->max_supply_size = max_supply_size;
+    ws->max_demand_size = max_demand_size;
+    ws->arena = (char *)aligned_alloc(WORKSPACE_ALIGN, ws->size);
+
+    if (!ws->arena) {
+        ws->size = 0;
+        return SOLVER_OUT_OF_MEMORY;
+    }
+    return SOLVER_OK;
+}
+
+/**
+ * Frees the arena of a workspace.
+ *
+ * @param ws Pointer to the workspace structure.
+ */
+void free_solver_workspace(
+        SolverWorkspace *ws
+) {
+    free(ws->arena);
+    ws->arena = NULL;
+    ws->size = 0;
+    ws->used = 0;
+}
+
+/**
+ * Hands every block back to the arena; the memory itself is kept.
+ *
+ * @param ws Pointer to the workspace structure.
+ */
+void reset_solver_workspace(
+        SolverWorkspace *ws
+) {
+    ws->used = 0;
+}
+
+/**
+ * Takes a block from the arena. The contents are left as they are.
+ *
+ * @param ws Pointer to the workspace structure.
+ * @param bytes Size of the block.
+ * @return The block, aligned to a cache line, or NULL if the arena is used up.
+ */
+void *workspace_alloc(
+        SolverWorkspace *ws,
+        size_t bytes
+) {
+    size_t size = ALIGN_UP(bytes);
+    void *block;
+
+    if (size > ws->size - ws->used) {
+        return NULL;
+    }
+    block = ws->arena + ws->used;
+    ws->used += size;
+    return block;
+}
+
+/**
+ * Takes a cleared done mask for n lines from the arena.
+ *
+ * @param ws Pointer to the workspace structure.
+ * @param n Number of lines.
+ * @return The mask, or NULL if the arena is used up.
+ */
+uint64_t *workspace_done_mask(
+        SolverWorkspace *ws,
+        int n
+) {
+    size_t bytes = (DONE_MASK_WORDS(n) + 1) * sizeof(uint64_t);
+    uint64_t *mask = (uint64_t *)workspace_alloc(ws, bytes);
+
+    if (mask) {
+        memset(mask, 0, bytes);
+    }
+    return mask;
+}
+
+/**
+ * Tells whether a problem, possibly balanced with a dummy point, fits in a
+ * workspace.
+ *
+ * @param ws Pointer to the workspace structure.
+ * @param supply_size Number of supply points of the problem.
+ * @param demand_size Number of demand points of the problem.
+ * @return SOLVER_OK, or SOLVER_TOO_LARGE.
+ */
+SolverStatus check_workspace_fits(
+        const SolverWorkspace *ws,
+        int supply_size,
+        int demand_size
+) {
+    if (!ws->arena || supply_size > ws->max_supply_size + 1 ||
+            demand_size > ws->max_demand_size + 1) {
+        return SOLVER_TOO_LARGE;
+    }
+    return SOLVER_OK;
+}
+
+/**
+ * Describes a solver status for an error message.
+ *
+ * @param status Status returned by a solve.
+ * @return A sentence describing it.
+ */
+const char *solver_status_message(
+        SolverStatus status
+) {
+    switch (status) {
+        case SOLVER_OK:
+            return "Solved.";
+        case SOLVER_OUT_OF_MEMORY:
+            return "Memory allocation failed.";
+        case SOLVER_TOO_LARGE:
+            return "The problem is larger than the solver workspace.";
+        case SOLVER_NO_OPEN_CELL:
+            return "No open cell left. Possible issue with the transportation problem.";
+        case SOLVER_INFEASIBLE:
+            return "No feasible plan: the supply cannot be shipped to the demand.";
+        case SOLVER_NEGATIVE_QUANTITY:
+            return "Supplies and demands must not be negative.";
+        case SOLVER_COST_OVERFLOW:
+            return "The total cost does not fit in the integer type; pick a wider one with -p.";
+        case SOLVER_QUANTITY_OVERFLOW:
+            return "The total supply or demand does not fit in the integer type; pick a wider one with -p.";
+        default:
+            return "Unknown solver status.";
+    }
+}
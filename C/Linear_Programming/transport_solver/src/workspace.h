@@ -0,0 +1,65 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "transport.h"
+
+/*
+ * Solver workspaces.
+ *
+ * A workspace is one arena allocated up front for the largest problem it
+ * will see. A solve carves its scratch arrays (supply and demand copies,
+ * done masks, line buffers) out of it with a bump pointer and hands them
+ * back by resetting it, so solving many problems in a loop allocates
+ * nothing per solve. The *_solve functions report failures as a
+ * SolverStatus instead of exiting, and leave the workspace reusable.
+ */
+
+typedef enum {
+    SOLVER_OK,
+    SOLVER_OUT_OF_MEMORY,    // The workspace could not be allocated
+    SOLVER_TOO_LARGE,        // The problem is larger than the workspace was sized for
+    SOLVER_NO_OPEN_CELL,     // Supply was left without an open cell; the plan is partial
+    SOLVER_INFEASIBLE,       // No plan moves all the supply to the demand
+    SOLVER_NEGATIVE_QUANTITY,// A supply or demand is negative
+    SOLVER_COST_OVERFLOW,    // The total cost does not fit in the precision's type
+    SOLVER_QUANTITY_OVERFLOW // The total supply or demand does not fit in the precision's type
+} SolverStatus;
+
+typedef struct {
+    char *arena;
+    size_t size;             // Bytes in the arena
+    size_t used;             // Bytes handed out since the last reset
+    int max_supply_size;     // Largest problem the arena was sized for, before balancing
+    int max_demand_size;
+} SolverWorkspace;
+
+// Workspace storage
+SolverStatus init_solver_workspace(SolverWorkspace *ws, int max_supply_size, int max_demand_size);
+void free_solver_workspace(SolverWorkspace *ws);
+void reset_solver_workspace(SolverWorkspace *ws);
+void *workspace_alloc(SolverWorkspace *ws, size_t bytes);
+uint64_t *workspace_done_mask(SolverWorkspace *ws, int n);
+SolverStatus check_workspace_fits(const SolverWorkspace *ws, int supply_size, int demand_size);
+const char *solver_status_message(SolverStatus status);
+
+// Allocation methods on a workspace
+SolverStatus north_west_corner_solve(SolverWorkspace *ws, TransportProblem *tp, Solution *solution,
+                                     int *total_cost, Boolean print_iterations);
+SolverStatus least_cost_solve(SolverWorkspace *ws, TransportProblem *tp, Solution *solution,
+                              int *total_cost, Boolean print_iterations);
+SolverStatus least_cost_sorted_solve(SolverWorkspace *ws, TransportProblem *tp, Solution *solution,
+                                     int *total_cost, Boolean print_iterations);
+SolverStatus vogels_solve(SolverWorkspace *ws, TransportProblem *tp, Solution *solution,
+                          int *total_cost, Boolean print_iterations);
+
+// Methods reporting a status that need no workspace
+SolverStatus vogels_incremental_solve(TransportProblem *tp, Solution *solution, int *total_cost,
+                                      Boolean print_iterations);
+SolverStatus modi_solve(TransportProblem *tp, Solution *solution, int *total_cost,
+                        Boolean print_iterations);
+SolverStatus network_simplex_solve(TransportProblem *tp, Solution *solution, int *total_cost,
+                                   Boolean print_iterations);
+
+#endif // WORKSPACE_H
@@ -0,0 +1,36 @@
+/**
+ * @file    test_balance.c
+ * @brief   Test program for balancing with a virtual dummy point.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // fork
+#include "test_support.h"
+
+/**
+ * @brief Balancing adds the dummy point on the short side.
+ */
+static void test_balancing_adds_a_dummy(void) {
+    TransportProblem tp;
+
+    init_problem(&tp, 3, 3, known_instance(2)->supply, known_instance(2)->demand,
+                 known_instance(2)->cost);
+    CHECK_EQUAL(0, balance_transport_problem(&tp));
+    CHECK_EQUAL(3, tp.supply_size);
+    CHECK_EQUAL(4, tp.demand_size);
+    CHECK_EQUAL(40, tp.demand[3]);
+    CHECK_EQUAL(0, COST_AT(&tp, 1, 3));
+    free_transport_problem(&tp);
+
+    init_problem(&tp, 2, 3, known_instance(3)->supply, known_instance(3)->demand,
+                 known_instance(3)->cost);
+    CHECK_EQUAL(0, balance_transport_problem(&tp));
+    CHECK_EQUAL(3, tp.supply_size);
+    CHECK_EQUAL(3, tp.demand_size);
+    CHECK_EQUAL(20, tp.supply[2]);
+    free_transport_problem(&tp);
+}
+
+int main(void) {
+    test_balancing_adds_a_dummy();
+    return report_checks();
+}
@@ -0,0 +1,85 @@
+/**
+ * @file    test_least_cost_sorted.c
+ * @brief   Test program for the Least Cost Method over a sorted cell order.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // fork
+#include "test_support.h"
+#include "workspace.h"
+
+/**
+ * @brief The sorted order allocates the same cells as the rescanning Least
+ *        Cost Method, and MODI takes the plan to the known optimum.
+ */
+static void test_sorted_order_matches_least_cost(const Instance *inst) {
+    TransportProblem tp;
+    Solution expected, solution;
+    SolverWorkspace ws;
+    char label[64];
+    int expected_cost, total_cost;
+    size_t k;
+
+    init_instance(&tp, inst);
+    CHECK_EQUAL(SOLVER_OK, init_solver_workspace(&ws, inst->supply_size, inst->demand_size));
+    init_solution(&expected, tp.supply_size, tp.demand_size);
+    init_solution(&solution, tp.supply_size, tp.demand_size);
+
+    CHECK_EQUAL(SOLVER_OK, least_cost_solve(&ws, &tp, &expected, &expected_cost, FALSE));
+    CHECK_EQUAL(SOLVER_OK, least_cost_sorted_solve(&ws, &tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(expected_cost, total_cost);
+    CHECK_EQUAL(expected.count, solution.count);
+    for (k = 0; k < expected.count && k < solution.count; k++) {
+        CHECK_EQUAL(expected.row[k], solution.row[k]);
+        CHECK_EQUAL(expected.column[k], solution.column[k]);
+        CHECK_EQUAL(expected.quantity[k], solution.quantity[k]);
+    }
+
+    snprintf(label, sizeof(label), "%s, sorted Least Cost and MODI", inst->name);
+    CHECK_EQUAL(SOLVER_OK, modi_solve(&tp, &solution, &total_cost, FALSE));
+    check_plan(&tp, &solution, total_cost, inst->optimal_cost, label);
+
+    free_solution(&expected);
+    free_solution(&solution);
+    free_solver_workspace(&ws);
+    free_transport_problem(&tp);
+}
+
+/**
+ * @brief A failure comes back as a status, with no partial plan, and only
+ *        the wrapper exits.
+ */
+static void test_failures_are_reported(void) {
+    static const int supply[] = {2000000000}, demand[] = {2000000000}, cost[] = {2};
+    TransportProblem tp;
+    Solution solution;
+    SolverWorkspace ws;
+    int total_cost = -1;
+
+    init_problem(&tp, 1, 1, supply, demand, cost);
+    init_solution(&solution, 1, 1);
+
+    CHECK_EQUAL(SOLVER_OK, init_solver_workspace(&ws, 1, 1));
+    CHECK_EQUAL(SOLVER_COST_OVERFLOW, least_cost_sorted_solve(&ws, &tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+    CHECK_EQUAL(EXIT_FAILURE, exit_status_of(least_cost_sorted_method, &tp));
+    free_solver_workspace(&ws);
+    free_transport_problem(&tp);
+
+    init_instance(&tp, known_instance(0));
+    CHECK_EQUAL(SOLVER_OK, init_solver_workspace(&ws, 1, 1));
+    CHECK_EQUAL(SOLVER_TOO_LARGE, least_cost_sorted_solve(&ws, &tp, &solution, &total_cost, FALSE));
+    free_solver_workspace(&ws);
+    free_transport_problem(&tp);
+
+    free_solution(&solution);
+}
+
+int main(void) {
+    int k;
+
+    for (k = 0; k < INSTANCE_COUNT; k++) {
+        test_sorted_order_matches_least_cost(known_instance(k));
+    }
+    test_failures_are_reported();
+    return report_checks();
+}
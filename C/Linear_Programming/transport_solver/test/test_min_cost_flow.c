@@ -0,0 +1,93 @@
+/**
+ * @file    test_min_cost_flow.c
+ * @brief   Test program for the successive-shortest-path and cost-scaling
+ *          min-cost flow solvers.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // fork
+#include "test_support.h"
+#include "min_cost_flow.h"
+
+/**
+ * @brief Both min-cost flow modes reach the known optimum, with a plan that
+ *        meets every supply and demand.
+ */
+static void test_min_cost_flow_reaches_the_optimum(const Instance *inst) {
+    TransportProblem tp;
+    Solution solution;
+    char label[64];
+    int total_cost;
+
+    init_instance(&tp, inst);
+    init_solution(&solution, tp.supply_size, tp.demand_size);
+
+    snprintf(label, sizeof(label), "%s, successive shortest paths", inst->name);
+    CHECK_EQUAL(SOLVER_OK, min_cost_flow_solve(&tp, &solution, MCF_SUCCESSIVE_SHORTEST_PATH,
+                                               &total_cost, FALSE));
+    check_plan(&tp, &solution, total_cost, inst->optimal_cost, label);
+
+    snprintf(label, sizeof(label), "%s, cost scaling", inst->name);
+    CHECK_EQUAL(SOLVER_OK, min_cost_flow_solve(&tp, &solution, MCF_COST_SCALING, &total_cost, FALSE));
+    check_plan(&tp, &solution, total_cost, inst->optimal_cost, label);
+
+    free_solution(&solution);
+    free_transport_problem(&tp);
+}
+
+static int successive_shortest_paths(TransportProblem *tp, Solution *solution, Boolean print) {
+    return min_cost_flow_method(tp, solution, MCF_SUCCESSIVE_SHORTEST_PATH, print);
+}
+
+/**
+ * @brief An unbalanced problem is reported as infeasible with no partial
+ *        plan left behind, and the wrapper exits with a failure status.
+ */
+static void test_infeasible_problem_fails(void) {
+    static const int supply[] = {10, 10}, demand[] = {5, 5}, cost[] = {1, 2, 3, 4};
+    TransportProblem tp;
+    Solution solution;
+    int total_cost = -1;
+
+    init_problem(&tp, 2, 2, supply, demand, cost);  // Not balanced on purpose
+    init_solution(&solution, 2, 2);
+
+    CHECK_EQUAL(SOLVER_INFEASIBLE, min_cost_flow_solve(&tp, &solution, MCF_SUCCESSIVE_SHORTEST_PATH,
+                                                       &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+    CHECK_EQUAL(SOLVER_INFEASIBLE, min_cost_flow_solve(&tp, &solution, MCF_COST_SCALING,
+                                                       &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+    CHECK_EQUAL(EXIT_FAILURE, exit_status_of(successive_shortest_paths, &tp));
+
+    free_solution(&solution);
+    free_transport_problem(&tp);
+}
+
+/**
+ * @brief A negative quantity never reaches the min-cost flow network.
+ */
+static void test_negative_quantity_fails(void) {
+    static const int supply[] = {-5, 5}, demand[] = {3, -3}, cost[] = {1, 2, 3, 4};
+    TransportProblem tp;
+    Solution solution;
+    int total_cost = -1;
+
+    init_problem(&tp, 2, 2, supply, demand, cost);
+    init_solution(&solution, 2, 2);
+    CHECK_EQUAL(SOLVER_NEGATIVE_QUANTITY, min_cost_flow_solve(&tp, &solution, MCF_COST_SCALING,
+                                                              &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+    free_solution(&solution);
+    free_transport_problem(&tp);
+}
+
+int main(void) {
+    int k;
+
+    for (k = 0; k < INSTANCE_COUNT; k++) {
+        test_min_cost_flow_reaches_the_optimum(known_instance(k));
+    }
+    test_infeasible_problem_fails();
+    test_negative_quantity_fails();
+    return report_checks();
+}
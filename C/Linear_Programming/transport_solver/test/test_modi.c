@@ -0,0 +1,52 @@
+/**
+ * @file    test_modi.c
+ * @brief   Test program for the MODI optimality phase.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // fork
+#include "test_support.h"
+#include "workspace.h"
+
+/**
+ * @brief Every initial method followed by MODI reaches the known optimum,
+ *        with a plan that meets every supply and demand.
+ */
+static void test_modi_reaches_the_optimum(const Instance *inst) {
+    TransportProblem tp;
+    Solution solution;
+    SolverWorkspace ws;
+    char label[64];
+    int total_cost;
+
+    init_instance(&tp, inst);
+    CHECK_EQUAL(SOLVER_OK, init_solver_workspace(&ws, inst->supply_size, inst->demand_size));
+    init_solution(&solution, tp.supply_size, tp.demand_size);
+
+    snprintf(label, sizeof(label), "%s, VAM and MODI", inst->name);
+    CHECK_EQUAL(SOLVER_OK, vogels_incremental_solve(&tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(SOLVER_OK, modi_solve(&tp, &solution, &total_cost, FALSE));
+    check_plan(&tp, &solution, total_cost, inst->optimal_cost, label);
+
+    snprintf(label, sizeof(label), "%s, North-West Corner and MODI", inst->name);
+    CHECK_EQUAL(SOLVER_OK, north_west_corner_solve(&ws, &tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(SOLVER_OK, modi_solve(&tp, &solution, &total_cost, FALSE));
+    check_plan(&tp, &solution, total_cost, inst->optimal_cost, label);
+
+    snprintf(label, sizeof(label), "%s, Least Cost and MODI", inst->name);
+    CHECK_EQUAL(SOLVER_OK, least_cost_solve(&ws, &tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(SOLVER_OK, modi_solve(&tp, &solution, &total_cost, FALSE));
+    check_plan(&tp, &solution, total_cost, inst->optimal_cost, label);
+
+    free_solution(&solution);
+    free_solver_workspace(&ws);
+    free_transport_problem(&tp);
+}
+
+int main(void) {
+    int k;
+
+    for (k = 0; k < INSTANCE_COUNT; k++) {
+        test_modi_reaches_the_optimum(known_instance(k));
+    }
+    return report_checks();
+}
@@ -0,0 +1,60 @@
+/**
+ * @file    test_network_simplex.c
+ * @brief   Test program for the network simplex solver.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // fork
+#include "test_support.h"
+#include "workspace.h"
+
+/**
+ * @brief Network simplex reaches the known optimum, with a plan that meets
+ *        every supply and demand.
+ */
+static void test_network_simplex_reaches_the_optimum(const Instance *inst) {
+    TransportProblem tp;
+    Solution solution;
+    char label[64];
+    int total_cost;
+
+    init_instance(&tp, inst);
+    init_solution(&solution, tp.supply_size, tp.demand_size);
+
+    snprintf(label, sizeof(label), "%s, network simplex", inst->name);
+    CHECK_EQUAL(SOLVER_OK, network_simplex_solve(&tp, &solution, &total_cost, FALSE));
+    check_plan(&tp, &solution, total_cost, inst->optimal_cost, label);
+
+    free_solution(&solution);
+    free_transport_problem(&tp);
+}
+
+/**
+ * @brief An unbalanced problem is reported as infeasible with no partial
+ *        plan left behind, and the wrapper exits with a failure status.
+ */
+static void test_infeasible_problem_fails(void) {
+    static const int supply[] = {10, 10}, demand[] = {5, 5}, cost[] = {1, 2, 3, 4};
+    TransportProblem tp;
+    Solution solution;
+    int total_cost = -1;
+
+    init_problem(&tp, 2, 2, supply, demand, cost);  // Not balanced on purpose
+    init_solution(&solution, 2, 2);
+
+    CHECK_EQUAL(SOLVER_INFEASIBLE, network_simplex_solve(&tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+    CHECK_EQUAL(EXIT_FAILURE, exit_status_of(network_simplex_method, &tp));
+
+    free_solution(&solution);
+    free_transport_problem(&tp);
+}
+
+int main(void) {
+    int k;
+
+    for (k = 0; k < INSTANCE_COUNT; k++) {
+        test_network_simplex_reaches_the_optimum(known_instance(k));
+    }
+    test_infeasible_problem_fails();
+    return report_checks();
+}
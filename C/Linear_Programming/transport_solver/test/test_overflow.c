@@ -0,0 +1,177 @@
+/**
+ * @file    test_overflow.c
+ * @brief   Test program for the totals that do not fit the precision.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // fork
+#include "test_support.h"
+#include "workspace.h"
+#include "precision.h"
+#include "min_cost_flow.h"
+
+/**
+ * @brief A total supply or demand beyond INT_MAX is refused when balancing.
+ */
+static void test_quantity_overflow_fails(void) {
+    static const int supply[] = {2000000000, 2000000000}, demand[] = {2000000000, 2000000000};
+    static const int cost[] = {1, 2, 3, 4};
+    TransportProblem tp;
+
+    init_problem(&tp, 2, 2, supply, demand, cost);
+    CHECK_EQUAL(-1, balance_transport_problem(&tp));
+    CHECK_EQUAL(2, tp.supply_size);
+    CHECK_EQUAL(2, tp.demand_size);
+    free_transport_problem(&tp);
+}
+
+/**
+ * @brief Every method refuses a total cost beyond INT_MAX instead of
+ *        returning a wrapped one.
+ */
+static void test_cost_overflow_fails(void) {
+    static const int supply[] = {2000000000}, demand[] = {2000000000}, cost[] = {2};
+    TransportProblem tp;
+    Solution solution;
+    SolverWorkspace ws;
+    int total_cost = -1;
+
+    init_problem(&tp, 1, 1, supply, demand, cost);
+    CHECK_EQUAL(0, balance_transport_problem(&tp));
+    CHECK_EQUAL(SOLVER_OK, init_solver_workspace(&ws, 1, 1));
+    init_solution(&solution, 1, 1);
+
+    CHECK_EQUAL(SOLVER_COST_OVERFLOW, north_west_corner_solve(&ws, &tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+    CHECK_EQUAL(SOLVER_COST_OVERFLOW, least_cost_solve(&ws, &tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+    CHECK_EQUAL(SOLVER_COST_OVERFLOW, vogels_solve(&ws, &tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+    CHECK_EQUAL(SOLVER_COST_OVERFLOW, vogels_incremental_solve(&tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+    CHECK_EQUAL(SOLVER_COST_OVERFLOW, network_simplex_solve(&tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+    CHECK_EQUAL(SOLVER_COST_OVERFLOW, min_cost_flow_solve(&tp, &solution, MCF_SUCCESSIVE_SHORTEST_PATH,
+                                                          &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+
+    free_solution(&solution);
+    free_solver_workspace(&ws);
+    free_transport_problem(&tp);
+}
+
+/**
+ * @brief MODI refuses an optimum whose cost falls below INT_MIN, even when
+ *        the initial plan's cost fits.
+ */
+static void test_modi_cost_overflow_fails(void) {
+    static const int supply[] = {1000000000, 1000000000}, demand[] = {1000000000, 1000000000};
+    static const int cost[] = {0, -2, -2, 0};
+    TransportProblem tp;
+    Solution solution;
+    SolverWorkspace ws;
+    int total_cost = -1;
+
+    init_problem(&tp, 2, 2, supply, demand, cost);
+    CHECK_EQUAL(0, balance_transport_problem(&tp));
+    CHECK_EQUAL(SOLVER_OK, init_solver_workspace(&ws, 2, 2));
+    init_solution(&solution, 2, 2);
+
+    CHECK_EQUAL(SOLVER_OK, north_west_corner_solve(&ws, &tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(0, total_cost);
+    CHECK_EQUAL(SOLVER_COST_OVERFLOW, modi_solve(&tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+
+    free_solution(&solution);
+    free_solver_workspace(&ws);
+    free_transport_problem(&tp);
+}
+
+/* Builds a 2 x 2 int64 problem */
+static void init_problem_i64(TransportProblemI64 *tp, const int64_t *supply, const int64_t *demand,
+                             const int64_t *cost) {
+    init_transport_problem_i64(tp, 2, 2);
+    memcpy(tp->supply, supply, 2 * sizeof(int64_t));
+    memcpy(tp->demand, demand, 2 * sizeof(int64_t));
+    memcpy(tp->cost, cost, 4 * sizeof(int64_t));
+}
+
+/**
+ * @brief The int64 methods refuse a total beyond the int64 range instead of
+ *        returning a wrapped one, and still return a total that just fits.
+ */
+static void test_int64_overflow_fails(void) {
+    static const int64_t supply[] = {4000000000LL, 4000000000LL};
+    static const int64_t cost[] = {4000000000000000000LL, 4000000000000000000LL,
+                                   4000000000000000000LL, 4000000000000000000LL};
+    static const int64_t fit_supply[] = {2, 0}, fit_demand[] = {1, 1};
+    static const int64_t fit_cost[] = {4000000000000000000LL, 1, 1, 1};
+    static const int64_t modi_cost[] = {0, -3000000000LL, -3000000000LL, 0};
+    static const int64_t big_supply[] = {5000000000000000000LL, 5000000000000000000LL};
+    TransportProblemI64 tp;
+    SolutionI64 solution;
+    SolverWorkspace ws;
+    int64_t total_cost = -1;
+
+    CHECK_EQUAL(SOLVER_OK, init_solver_workspace(&ws, 2, 2));
+    init_solution_i64(&solution, 2, 2);
+
+    init_problem_i64(&tp, supply, supply, cost);
+    CHECK_EQUAL(0, balance_transport_problem_i64(&tp));
+    CHECK_EQUAL(SOLVER_COST_OVERFLOW, north_west_corner_solve_i64(&ws, &tp, &solution, &total_cost,
+                                                                  FALSE));
+    CHECK_EQUAL(0, solution.count);
+    CHECK_EQUAL(SOLVER_COST_OVERFLOW, least_cost_solve_i64(&ws, &tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+    CHECK_EQUAL(SOLVER_COST_OVERFLOW, vogels_solve_i64(&ws, &tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+    free_transport_problem_i64(&tp);
+
+    init_problem_i64(&tp, fit_supply, fit_demand, fit_cost);
+    CHECK_EQUAL(0, balance_transport_problem_i64(&tp));
+    CHECK_EQUAL(SOLVER_OK, north_west_corner_solve_i64(&ws, &tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(4000000000000000001LL, total_cost);
+    free_transport_problem_i64(&tp);
+
+    // The initial plan costs 0; the optimum ships 8e9 units at -3e9 each
+    init_problem_i64(&tp, supply, supply, modi_cost);
+    CHECK_EQUAL(0, balance_transport_problem_i64(&tp));
+    CHECK_EQUAL(SOLVER_OK, north_west_corner_solve_i64(&ws, &tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(0, total_cost);
+    CHECK_EQUAL(SOLVER_COST_OVERFLOW, modi_solve_i64(&tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(0, solution.count);
+    free_transport_problem_i64(&tp);
+
+    init_problem_i64(&tp, big_supply, supply, cost);
+    CHECK_EQUAL(-1, balance_transport_problem_i64(&tp));
+    CHECK_EQUAL(2, tp.supply_size);
+    CHECK_EQUAL(2, tp.demand_size);
+    free_transport_problem_i64(&tp);
+
+    free_solution_i64(&solution);
+    free_solver_workspace(&ws);
+}
+
+/**
+ * @brief The method wrappers the command line uses exit with a failure
+ *        status rather than hand back a wrong plan.
+ */
+static void test_method_wrappers_exit_on_failure(void) {
+    static const int big_supply[] = {2000000000}, big_demand[] = {2000000000}, big_cost[] = {2};
+    TransportProblem tp;
+
+    init_problem(&tp, 1, 1, big_supply, big_demand, big_cost);
+    CHECK_EQUAL(EXIT_FAILURE, exit_status_of(vogels_incremental_method, &tp));
+    CHECK_EQUAL(EXIT_FAILURE, exit_status_of(north_west_corner_method, &tp));
+    CHECK_EQUAL(EXIT_FAILURE, exit_status_of(least_cost_sorted_method, &tp));
+    CHECK_EQUAL(EXIT_FAILURE, exit_status_of(network_simplex_method, &tp));
+    free_transport_problem(&tp);
+}
+
+int main(void) {
+    test_quantity_overflow_fails();
+    test_cost_overflow_fails();
+    test_modi_cost_overflow_fails();
+    test_int64_overflow_fails();
+    test_method_wrappers_exit_on_failure();
+    return report_checks();
+}
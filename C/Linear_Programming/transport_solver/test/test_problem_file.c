@@ -0,0 +1,49 @@
+/**
+ * @file    test_problem_file.c
+ * @brief   Test program for the problem file loaders.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // mkstemp
+#include "test_support.h"
+#include "sparse_problem.h"
+
+/* Writes text to a new temporary file; its path goes to path */
+static void write_temp_file(char *path, const char *text) {
+    strcpy(path, "/tmp/test_problem_fileXXXXXX");
+    int fd = mkstemp(path);
+    if (fd < 0 || write(fd, text, strlen(text)) != (ssize_t)strlen(text)) {
+        perror("test_problem_file");
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+}
+
+/**
+ * @brief The text loaders reject a negative supply or demand.
+ */
+static void test_loaders_reject_negative_quantities(void) {
+    static const char *files[] = {
+        "2 2\n-5,5\n3,-3\n1,2\n3,4\n",
+        "2 2\n5,5\n3,7\n1,2\n3,4\n",
+        "2 2 2\n5,5\n3,-7\n0 0 1\n1 1 4\n",
+    };
+    static const int expected[] = {-1, 0, -1};
+    TransportProblem tp;
+    SparseTransportProblem sp;
+    char path[32];
+    int k, loaded;
+
+    for (k = 0; k < 3; k++) {
+        write_temp_file(path, files[k]);
+        loaded = load_any_problem_file(path, &tp, &sp);
+        CHECK_EQUAL(expected[k], loaded);
+        if (loaded == 0) free_transport_problem(&tp);
+        if (loaded == 1) free_sparse_problem(&sp);
+        unlink(path);
+    }
+}
+
+int main(void) {
+    test_loaders_reject_negative_quantities();
+    return report_checks();
+}
@@ -0,0 +1,133 @@
+/**
+ * @file    test_support.h
+ * @brief   Checks and small problems shared by the solver test programs.
+ */
+
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "transport.h"
+
+static int checks_run = 0;
+static int checks_failed = 0;
+
+/* Records one check; the failures are listed with their location */
+#define CHECK_EQUAL(expected, actual) \
+    check_equal((long long)(expected), (long long)(actual), #actual, __FILE__, __LINE__)
+
+static inline void check_equal(long long expected, long long actual, const char *what,
+                               const char *file, int line) {
+    checks_run++;
+    if (expected != actual) {
+        checks_failed++;
+        printf("%s:%d: %s is %lld, expected %lld\n", file, line, what, actual, expected);
+    }
+}
+
+/* Prints the tally; the result is the test program's exit status */
+static inline int report_checks(void) {
+    printf("%d checks, %d failed\n", checks_run, checks_failed);
+    return (checks_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* A small dense problem with its optimal cost, which an independent
+   min-cost flow solver agrees on */
+typedef struct {
+    const char *name;
+    int supply_size;
+    int demand_size;
+    int supply[3];
+    int demand[3];
+    int cost[9];
+    int optimal_cost;
+} Instance;
+
+#define INSTANCE_COUNT 4
+
+/* Returns one of the INSTANCE_COUNT known instances */
+static inline const Instance *known_instance(int k) {
+    static const Instance instances[INSTANCE_COUNT] = {
+        /* The example of the README */
+        {"readme", 3, 3, {20, 30, 25}, {10, 35, 30},
+         {8, 6, 10, 9, 12, 13, 14, 9, 16}, 735},
+        /* Every North-West Corner allocation closes a row and a column at
+           once, so the initial basis has 3 of the 5 cells MODI needs */
+        {"degenerate", 3, 3, {20, 30, 50}, {20, 30, 50},
+         {4, 6, 8, 5, 3, 7, 9, 4, 2}, 270},
+        /* Supply exceeds demand by 40: balancing adds a dummy column */
+        {"dummy demand", 3, 3, {50, 60, 40}, {30, 45, 35},
+         {7, 3, 6, 4, 8, 5, 6, 5, 9}, 435},
+        /* Demand exceeds supply by 20: balancing adds a dummy row */
+        {"dummy supply", 2, 3, {30, 25}, {20, 30, 25},
+         {6, 4, 9, 5, 8, 3}, 195},
+    };
+    return &instances[k];
+}
+
+/* Builds a problem from vectors and a row-major cost matrix, unbalanced */
+static inline void init_problem(TransportProblem *tp, int m, int n, const int *supply,
+                                const int *demand, const int *cost) {
+    init_transport_problem(tp, m, n);
+    memcpy(tp->supply, supply, m * sizeof(int));
+    memcpy(tp->demand, demand, n * sizeof(int));
+    memcpy(tp->cost, cost, (size_t)m * n * sizeof(int));
+}
+
+/* Builds a known instance, balanced */
+static inline void init_instance(TransportProblem *tp, const Instance *inst) {
+    init_problem(tp, inst->supply_size, inst->demand_size, inst->supply, inst->demand, inst->cost);
+    CHECK_EQUAL(0, balance_transport_problem(tp));
+}
+
+/* Checks that a plan ships every supply to every demand at the given total */
+static inline void check_plan(const TransportProblem *tp, const Solution *solution, int total_cost,
+                              int expected_cost, const char *label) {
+    long long shipped[8] = {0}, received[8] = {0}, cost = 0;
+    int i, j, failed = checks_failed;
+    size_t k;
+
+    for (k = 0; k < solution->count; k++) {
+        CHECK_EQUAL(1, solution->quantity[k] >= 0);
+        shipped[solution->row[k]] += solution->quantity[k];
+        received[solution->column[k]] += solution->quantity[k];
+        cost += (long long)solution->quantity[k] * COST_AT(tp, solution->row[k], solution->column[k]);
+    }
+    for (i = 0; i < tp->supply_size; i++) {
+        CHECK_EQUAL(tp->supply[i], shipped[i]);
+    }
+    for (j = 0; j < tp->demand_size; j++) {
+        CHECK_EQUAL(tp->demand[j], received[j]);
+    }
+    CHECK_EQUAL(cost, total_cost);
+    CHECK_EQUAL(expected_cost, total_cost);
+    if (checks_failed != failed) {
+        printf("  in %s\n", label);
+    }
+}
+
+/* Runs a method wrapper in a child process and returns its exit status */
+static inline int exit_status_of(int (*method)(TransportProblem *, Solution *, Boolean),
+                                 TransportProblem *tp) {
+    Solution solution;
+    int status;
+    pid_t pid;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0) {
+        init_solution(&solution, tp->supply_size, tp->demand_size);
+        method(tp, &solution, FALSE);
+        _exit(EXIT_SUCCESS);
+    }
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) {
+        return -1;
+    }
+    return WEXITSTATUS(status);
+}
+
+#endif // TEST_SUPPORT_H
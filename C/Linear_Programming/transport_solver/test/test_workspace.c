@@ -0,0 +1,95 @@
+/**
+ * @file    test_workspace.c
+ * @brief   Test program for the solvers that run on a reusable workspace.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // fork
+#include <sys/resource.h>
+#include "test_support.h"
+#include "workspace.h"
+
+/**
+ * @brief The workspace VAM followed by MODI reaches the known optimum,
+ *        with a plan that meets every supply and demand.
+ */
+static void test_workspace_vam_reaches_the_optimum(const Instance *inst) {
+    TransportProblem tp;
+    Solution solution;
+    SolverWorkspace ws;
+    char label[64];
+    int total_cost;
+
+    init_instance(&tp, inst);
+    CHECK_EQUAL(SOLVER_OK, init_solver_workspace(&ws, inst->supply_size, inst->demand_size));
+    init_solution(&solution, tp.supply_size, tp.demand_size);
+
+    snprintf(label, sizeof(label), "%s, workspace VAM and MODI", inst->name);
+    CHECK_EQUAL(SOLVER_OK, vogels_solve(&ws, &tp, &solution, &total_cost, FALSE));
+    CHECK_EQUAL(SOLVER_OK, modi_solve(&tp, &solution, &total_cost, FALSE));
+    check_plan(&tp, &solution, total_cost, inst->optimal_cost, label);
+
+    free_solution(&solution);
+    free_solver_workspace(&ws);
+    free_transport_problem(&tp);
+}
+
+/* Runs incremental VAM on a problem in a child process whose address
+   space has only a few megabytes to spare, and returns the solver status.
+   The child exits with 64 plus the status, which an exit(EXIT_FAILURE)
+   inside the solver cannot pass for */
+static int incremental_vam_status_under_limit(TransportProblem *tp) {
+    Solution solution;
+    struct rlimit limit;
+    unsigned long pages = 0;
+    int status, total_cost;
+    FILE *statm;
+    pid_t pid;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0) {
+        init_solution(&solution, 1, 1);
+        statm = fopen("/proc/self/statm", "r");
+        if (!statm || fscanf(statm, "%lu", &pages) != 1) {
+            _exit(EXIT_FAILURE);
+        }
+        fclose(statm);
+        limit.rlim_cur = limit.rlim_max = pages * (rlim_t)sysconf(_SC_PAGESIZE) + (8 << 20);
+        setrlimit(RLIMIT_AS, &limit);
+        _exit(64 + vogels_incremental_solve(tp, &solution, &total_cost, FALSE));
+    }
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) {
+        return -1;
+    }
+    return WEXITSTATUS(status) - 64;
+}
+
+/**
+ * @brief Incremental VAM reports a failed allocation as a status, so a
+ *        batch worker can carry on, rather than exiting the process.
+ */
+static void test_incremental_vam_reports_out_of_memory(void) {
+    TransportProblem tp;
+    int i;
+
+    // The sorted rows alone take 16 MB, well past the limit
+    init_transport_problem(&tp, 2000, 2000);
+    for (i = 0; i < 2000; i++) {
+        tp.supply[i] = tp.demand[i] = 1;
+    }
+    memset(tp.cost, 0, (size_t)2000 * 2000 * sizeof(int));
+    CHECK_EQUAL(SOLVER_OUT_OF_MEMORY, incremental_vam_status_under_limit(&tp));
+    free_transport_problem(&tp);
+}
+
+int main(void) {
+    int k;
+
+    for (k = 0; k < INSTANCE_COUNT; k++) {
+        test_workspace_vam_reaches_the_optimum(known_instance(k));
+    }
+#ifndef __SANITIZE_ADDRESS__  // The sanitizer's shadow memory needs the address space
+    test_incremental_vam_reports_out_of_memory();
+#endif
+    return report_checks();
+}